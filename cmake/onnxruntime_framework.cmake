@@ -100,6 +100,11 @@ if (CMAKE_SYSTEM_NAME STREQUAL "Emscripten")
   target_link_libraries(onnxruntime_framework ${ABSEIL_LIBS})
 endif()
 
+# shm_open, used by shared memory pre-packed weights, is in librt before glibc 2.34
+if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+  target_link_libraries(onnxruntime_framework rt)
+endif()
+
 set_target_properties(onnxruntime_framework PROPERTIES FOLDER "ONNXRuntime")
 # need onnx to build to create headers that this project includes
 add_dependencies(onnxruntime_framework ${onnxruntime_EXTERNAL_DEPENDENCIES})
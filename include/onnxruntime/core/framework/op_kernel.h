@@ -129,6 +129,25 @@ class OpKernel {
     return Status::OK();
   }
 
+  // Override this function to let the session use pre-packed weights loaded from the on-disk pre-packed weights
+  // cache instead of calling PrePack(). The buffers were produced by PrePack() of a kernel with the same op type,
+  // attributes and input types, for a tensor with the same content, on a CPU with the same features.
+  // The kernel must set up the state PrePack() derives from the tensor and use the buffers as in
+  // UseSharedPrePackedBuffers(). Kernels whose pre-packed weights depend on anything else, e.g. other constant
+  // inputs, must not override it.
+  // @param tensor: The initialized constant tensor the buffers were packed from
+  // @param prepacked_buffers: The buffers in the order PrePack() stored them in. The deleters are NULL.
+  // @param input_idx: The input index of the tensor in this kernel
+  // @param used_cached_buffers: Boolean flag set by the kernel implementation indicating that the buffers were
+  //                             used. If false, PrePack() is called instead.
+  virtual Status UseCachedPrePackedBuffers(const Tensor& /*tensor*/,
+                                           std::vector<BufferUniquePtr>& /*prepacked_buffers*/,
+                                           int /*input_idx*/,
+                                           /*out*/ bool& used_cached_buffers) {
+    used_cached_buffers = false;
+    return Status::OK();
+  }
+
   const OrtDevice GetDevice(OrtMemType mem_type) const;
   const OpKernelInfo& Info() const {
     return *op_kernel_info_;
@@ -39,6 +39,8 @@
 #pragma warning(disable : 4127)
 #pragma warning(disable : 4805)
 #endif
+#include <array>
+#include <chrono>
 #include <memory>
 #include "unsupported/Eigen/CXX11/ThreadPool"
 
@@ -78,6 +80,10 @@
 //
 //   This spin-then-block behavior is configured via a flag provided
 //   when creating the thread pool, and by the constant spin_count.
+//   With ThreadOptions::adaptive_spinning, each worker instead spins
+//   for a duration learned from the recent gaps between its tasks,
+//   and blocks right away when those gaps were too long to be worth
+//   spinning for.
 //
 // - Although all tasks are simple void()->void functions,
 //   conceptually there are three different kinds:
@@ -231,6 +237,9 @@ class ThreadPoolProfiler {
   void LogCoreAndBlock(std::ptrdiff_t){};
   void LogThreadId(int){};
   void LogRun(int){};
+  void LogSteal(int){};
+  void LogIdleStart(int){};
+  void LogIdleEnd(int){};
   std::string DumpChildThreadStat() { return {}; }
 };
 #else
@@ -257,6 +266,9 @@ class ThreadPoolProfiler {
   void LogCoreAndBlock(std::ptrdiff_t block_size);  // called in main thread to log core and block size for task breakdown
   void LogThreadId(int thread_idx);                 // called in child thread to log its id
   void LogRun(int thread_idx);                      // called in child thread to log num of run
+  void LogSteal(int thread_idx);                    // called in child thread to log a task stolen from another thread
+  void LogIdleStart(int thread_idx);                // called in child thread when it runs out of work
+  void LogIdleEnd(int thread_idx);                  // called in child thread when it finds work again
   std::string DumpChildThreadStat();                // return all child statitics collected so far
 
  private:
@@ -284,6 +296,10 @@ class ThreadPoolProfiler {
   struct ORT_ALIGN_TO_AVOID_FALSE_SHARING ChildThreadStat {
     std::thread::id thread_id_;
     uint64_t num_run_ = 0;
+    uint64_t num_steal_ = 0;  // tasks taken from the queues of other threads
+    uint64_t idle_us_ = 0;    // time spent spinning or blocked without work
+    onnxruntime::TimePoint idle_start_point_;
+    bool idle_ = false;
     onnxruntime::TimePoint last_logged_point_ = Clock::now();
     int32_t core_ = -1;  // core that the child thread is running on
   };
@@ -303,7 +319,8 @@ class ExtendedThreadPoolInterface : public Eigen::ThreadPoolInterface {
  public:
   // Start/end a parallel section, within which calls to
   // RunInParallelSection may be made.  Parallel sections are
-  // non-nesting.
+  // non-nesting, but RunInParallel may be called from within a loop
+  // of a parallel section.
   virtual void StartParallelSection(ThreadPoolParallelSection& ps) = 0;
   virtual void EndParallelSection(ThreadPoolParallelSection& ps) = 0;
 
@@ -730,6 +747,27 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     return profiler_.Stop();
   }
 
+  // Counters of the spin-then-block policy, summed over the worker threads.
+  struct SpinStats {
+    uint64_t num_spin_hits = 0;
+    uint64_t num_blocks = 0;
+    uint64_t num_wake_ups = 0;
+    std::chrono::nanoseconds spin_time{0};
+    std::chrono::nanoseconds wake_up_latency{0};
+  };
+
+  SpinStats GetSpinStats() const {
+    SpinStats stats;
+    for (const auto& td : worker_data_) {
+      stats.num_spin_hits += td.num_spin_hits.load(std::memory_order_relaxed);
+      stats.num_blocks += td.num_blocks.load(std::memory_order_relaxed);
+      stats.num_wake_ups += td.num_wake_ups.load(std::memory_order_relaxed);
+      stats.spin_time += std::chrono::nanoseconds(td.spin_ns.load(std::memory_order_relaxed));
+      stats.wake_up_latency += std::chrono::nanoseconds(td.wake_up_latency_ns.load(std::memory_order_relaxed));
+    }
+    return stats;
+  }
+
   struct Tag {
     constexpr Tag() : v_(0) {
     }
@@ -773,6 +811,7 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
         env_(env),
         num_threads_(num_threads),
         allow_spinning_(allow_spinning),
+        adaptive_spinning_(allow_spinning && thread_options.adaptive_spinning),
         set_denormal_as_zero_(thread_options.set_denormal_as_zero),
         worker_data_(num_threads),
         all_coprimes_(num_threads),
@@ -1094,32 +1133,76 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
       // threads, hence we must cap at num_threads_.
       assert(par_idx < preferred_workers.size());
       unsigned q_idx = preferred_workers[par_idx] % num_threads_;
-      assert(q_idx < num_threads_);
-      WorkerData& td = worker_data_[q_idx];
-      Queue& q = td.queue;
-      unsigned w_idx;
-
-      // Attempt to enqueue the task
-      auto push_status = q.PushBackWithTag([worker_fn, par_idx, &preferred_workers, &ps, this]() {
-        // Record the worker thread that actually runs this task.
-        // This will form the preferred worker for the next loop.
-        UpdatePreferredWorker(preferred_workers, par_idx);
-        worker_fn(par_idx);
-        ps.tasks_finished++;
-      },
-                                           pt.tag, w_idx);
-
-      // Queue accepted the task; wake the thread that owns the queue.
-      // In addition, if the queue was non-empty, attempt to wake
-      // another thread (which may then steal the task).
-      if (push_status == PushResult::ACCEPTED_IDLE || push_status == PushResult::ACCEPTED_BUSY) {
-        ps.tasks.push_back({q_idx, w_idx});
-        td.EnsureAwake();
-        if (push_status == PushResult::ACCEPTED_BUSY) {
-          worker_data_[Rand(&pt.rand) % num_threads_].EnsureAwake();
-        }
+      ScheduleOnWorker(pt, ps, preferred_workers, q_idx, par_idx, worker_fn);
+    }
+  }
+
+  // Schedule [par_idx_start,par_idx_end) for a nested loop.  The
+  // preferred workers are likely to be busy running the enclosing
+  // loop, and would only reach the new tasks once they finish their
+  // part of it.  Hence tasks are first pushed to workers that are
+  // currently idle, one task per worker.  The remaining tasks go to
+  // the preferred workers as usual, where workers that become idle
+  // later can steal them.
+
+  void ScheduleOnIdleWorkers(PerThread& pt,
+                             ThreadPoolParallelSection& ps,
+                             InlinedVector<int>& preferred_workers,
+                             unsigned par_idx_start,
+                             unsigned par_idx_end,
+                             std::function<void(unsigned)> worker_fn) {
+    auto par_idx = par_idx_start;
+    const unsigned first_q_idx = Rand(&pt.rand) % num_threads_;
+    for (unsigned i = 0; i < num_threads_ && par_idx < par_idx_end; ++i) {
+      unsigned q_idx = (first_q_idx + i) % num_threads_;
+      if ((pt.pool == this && static_cast<unsigned>(pt.thread_id) == q_idx) ||
+          worker_data_[q_idx].GetStatus() == WorkerData::ThreadStatus::Active) {
+        continue;
+      }
+      if (ScheduleOnWorker(pt, ps, preferred_workers, q_idx, par_idx, worker_fn)) {
+        ++par_idx;
       }
     }
+    ScheduleOnPreferredWorkers(pt, ps, preferred_workers, par_idx, par_idx_end, std::move(worker_fn));
+  }
+
+  // Push the task for par_idx to the queue of worker q_idx.  Returns
+  // false if the queue rejected the task.
+
+  bool ScheduleOnWorker(PerThread& pt,
+                        ThreadPoolParallelSection& ps,
+                        InlinedVector<int>& preferred_workers,
+                        unsigned q_idx,
+                        unsigned par_idx,
+                        const std::function<void(unsigned)>& worker_fn) {
+    assert(q_idx < num_threads_);
+    WorkerData& td = worker_data_[q_idx];
+    Queue& q = td.queue;
+    unsigned w_idx;
+
+    // Attempt to enqueue the task
+    auto push_status = q.PushBackWithTag([worker_fn, par_idx, &preferred_workers, &ps, this]() {
+      // Record the worker thread that actually runs this task.
+      // This will form the preferred worker for the next loop.
+      UpdatePreferredWorker(preferred_workers, par_idx);
+      worker_fn(par_idx);
+      ps.tasks_finished++;
+    },
+                                         pt.tag, w_idx);
+
+    // Queue accepted the task; wake the thread that owns the queue.
+    // In addition, if the queue was non-empty, attempt to wake
+    // another thread (which may then steal the task).
+    if (push_status == PushResult::ACCEPTED_IDLE || push_status == PushResult::ACCEPTED_BUSY) {
+      ps.tasks.push_back({q_idx, w_idx});
+      td.EnsureAwake();
+      if (push_status == PushResult::ACCEPTED_BUSY) {
+        worker_data_[Rand(&pt.rand) % num_threads_].EnsureAwake();
+      }
+      return true;
+    }
+
+    return false;
   }
 
   //......................................................................
@@ -1156,7 +1239,8 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
                              ThreadPoolParallelSection& ps,
                              unsigned new_dop,
                              bool dispatch_async,
-                             std::function<void(unsigned)> worker_fn) {
+                             std::function<void(unsigned)> worker_fn,
+                             bool nested = false) {
     // Ensure that the vector of preferred workers is sufficient for the
     // size of the loop we are entering.  We do this before dispatching
     // tasks for the loop in order to avoid any races between changes to
@@ -1225,6 +1309,9 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
           ps.dispatch_q_idx = -1;  // failed to enqueue dispatch_task
         }
         profiler_.LogEnd(ThreadPoolProfiler::DISTRIBUTION_ENQUEUE);
+      } else if (nested) {
+        // Synchronous dispatch, borrowing idle workers
+        ScheduleOnIdleWorkers(pt, ps, preferred_workers, current_dop, new_dop, std::move(worker_fn));
       } else {
         // Synchronous dispatch
         ScheduleOnPreferredWorkers(pt, ps, preferred_workers, current_dop, new_dop, std::move(worker_fn));
@@ -1298,18 +1385,37 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
   //  2. run fn(...) itself.
   // For all other threads:
   //  1. run fn(...);
+  //
+  // A loop is nested if it's entered by a worker of this pool, or by a
+  // thread that is already leading a loop or a parallel section.  The
+  // enclosing loop occupies the preferred workers, so a nested loop
+  // dispatches its tasks synchronously to idle workers instead of
+  // handing them to a dispatcher.  Its tasks get their own tag, so
+  // that ending the nested loop can't revoke tasks of the enclosing
+  // one.
   void RunInParallel(std::function<void(unsigned idx)> fn, unsigned n, std::ptrdiff_t block_size) override {
     ORT_ENFORCE(n <= num_threads_ + 1, "More work items than threads");
     profiler_.LogStartAndCoreAndBlock(block_size);
     PerThread* pt = GetPerThread();
+    const bool leading_par_section = pt->leading_par_section;
+    const bool nested = leading_par_section || pt->pool == this;
+    const Tag tag = pt->tag;
+    if (leading_par_section) {
+      pt->leading_par_section = false;
+      pt->tag = Tag::GetNext();
+    }
     ThreadPoolParallelSection ps;
     StartParallelSectionInternal(*pt, ps);
-    RunInParallelInternal(*pt, ps, n, true, fn);  // select dispatcher and do job distribution;
+    RunInParallelInternal(*pt, ps, n, !nested, fn, nested);  // select dispatcher and do job distribution;
     profiler_.LogEndAndStart(ThreadPoolProfiler::DISTRIBUTION);
     fn(0);  // run fn(0)
     profiler_.LogEndAndStart(ThreadPoolProfiler::RUN);
     EndParallelSectionInternal(*pt, ps);  // wait for all
     profiler_.LogEnd(ThreadPoolProfiler::WAIT);
+    if (leading_par_section) {
+      pt->leading_par_section = true;
+      pt->tag = tag;
+    }
   }
 
   int NumThreads() const final {
@@ -1375,7 +1481,7 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     uint64_t rand{0};                 // Random generator state.
     int thread_id{-1};                // Worker thread index in pool.
     Tag tag{};                        // Work item tag used to identify this thread.
-    bool leading_par_section{false};  // Leading a parallel section (used only for asserts)
+    bool leading_par_section{false};  // Leading a parallel section (used for asserts and to detect nested loops)
 
     // When this thread is entering a parallel section, it will
     // initially push work to this set of workers.  The aim is to
@@ -1389,12 +1495,79 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
 #pragma warning(pop)
 #endif  // _MSC_VER
 
+  using SpinClock = std::chrono::steady_clock;
+
   struct WorkerData {
     constexpr WorkerData() : thread(), queue() {
     }
     std::unique_ptr<Thread> thread;
     Queue queue;
 
+    // Counters of the spin-then-block policy.  They are only written by
+    // the thread itself, and read by GetSpinStats.
+    std::atomic<uint64_t> num_spin_hits{0};
+    std::atomic<uint64_t> num_blocks{0};
+    std::atomic<uint64_t> num_wake_ups{0};
+    std::atomic<int64_t> spin_ns{0};
+    std::atomic<int64_t> wake_up_latency_ns{0};
+
+    // State of the adaptive spin policy, only accessed by the thread
+    // itself.  Gap bucket i counts the recent gaps between tasks that
+    // were shorter than 2^(i+1) us, and the last bucket all longer
+    // gaps.  The counts are halved every kGapWindow gaps so that the
+    // policy follows changes in load.
+    static constexpr int kNumGapBuckets = 16;
+    static constexpr uint32_t kGapWindow = 64;
+    static constexpr uint32_t kGapWeight = 16;
+    static constexpr int64_t kMaxAdaptiveSpinNs = (int64_t{1} << 13) * 1000;
+    std::array<uint32_t, kNumGapBuckets> gap_counts{};
+    uint32_t num_gaps = 0;
+    int64_t spin_limit_ns = kMaxAdaptiveSpinNs;
+
+    void RecordSpin(SpinClock::duration spin_time, bool hit) {
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(spin_time).count();
+      spin_ns.store(spin_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+      if (hit) {
+        num_spin_hits.store(num_spin_hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+    }
+
+    // Record a gap between tasks and update the spin limit to the
+    // bound below which three quarters of the recent gaps fall.  If
+    // that bound is above kMaxAdaptiveSpinNs, spinning would mostly
+    // burn CPU time before blocking anyway, so the thread blocks right
+    // away.
+    void RecordGap(SpinClock::duration gap) {
+      const auto gap_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(gap).count());
+      int bucket = 0;
+      while (bucket < kNumGapBuckets - 1 && (gap_us >> (bucket + 1)) != 0) {
+        ++bucket;
+      }
+      gap_counts[bucket] += kGapWeight;
+      if (++num_gaps % kGapWindow == 0) {
+        for (auto& count : gap_counts) {
+          count /= 2;
+        }
+      }
+
+      uint64_t total = 0;
+      for (const auto count : gap_counts) {
+        total += count;
+      }
+      const uint64_t target = (total * 3 + 3) / 4;
+      uint64_t cumulative = 0;
+      int limit_bucket = 0;
+      for (; limit_bucket < kNumGapBuckets - 1; ++limit_bucket) {
+        cumulative += gap_counts[limit_bucket];
+        if (cumulative >= target) {
+          break;
+        }
+      }
+
+      const int64_t limit_ns = (int64_t{1} << (limit_bucket + 1)) * 1000;
+      spin_limit_ns = limit_bucket < kNumGapBuckets - 1 && limit_ns <= kMaxAdaptiveSpinNs ? limit_ns : 0;
+    }
+
     // Each thread has a status, available read-only without locking, and protected
     // by the mutex field below for updates.  The status is used for three
     // purposes:
@@ -1449,6 +1622,7 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
         assert(seen != ThreadStatus::Blocking);
         if (seen == ThreadStatus::Blocked) {
           status.store(ThreadStatus::Waking, std::memory_order_relaxed);
+          wake_time = SpinClock::now();
           lk.unlock();
           cv.notify_one();
         }
@@ -1475,9 +1649,14 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
       status.store(ThreadStatus::Blocking, std::memory_order_relaxed);
       if (should_block()) {
         status.store(ThreadStatus::Blocked, std::memory_order_relaxed);
+        num_blocks.store(num_blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
         do {
           cv.wait(lk);
         } while (status.load(std::memory_order_relaxed) == ThreadStatus::Blocked);
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(SpinClock::now() - wake_time);
+        wake_up_latency_ns.store(wake_up_latency_ns.load(std::memory_order_relaxed) + latency.count(),
+                                 std::memory_order_relaxed);
+        num_wake_ups.store(num_wake_ups.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
         post_block();
       }
       status.store(ThreadStatus::Spinning, std::memory_order_relaxed);
@@ -1487,11 +1666,13 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     std::atomic<ThreadStatus> status{ThreadStatus::Spinning};
     OrtMutex mutex;
     OrtCondVar cv;
+    SpinClock::time_point wake_time;  // when EnsureAwake woke the thread, protected by mutex
   };
 
   Environment& env_;
   const unsigned num_threads_;
   const bool allow_spinning_;
+  const bool adaptive_spinning_;
   const bool set_denormal_as_zero_;
   Eigen::MaxSizeVector<WorkerData> worker_data_;
   Eigen::MaxSizeVector<Eigen::MaxSizeVector<unsigned>> all_coprimes_;
@@ -1542,10 +1723,18 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     while (!should_exit) {
       Task t = q.PopFront();
       if (!t) {
+        profiler_.LogIdleStart(thread_id);
+        const auto idle_start = SpinClock::now();
+        // The adaptive policy bounds the time spent spinning, checking
+        // the clock every few iterations.
+        constexpr int spin_clock_interval = 16;
+        const int64_t spin_limit_ns = adaptive_spinning_ ? td.spin_limit_ns : 0;
+        const int thread_spin_count = adaptive_spinning_ && spin_limit_ns == 0 ? 0 : spin_count;
         // Spin waiting for work.
-        for (int i = 0; i < spin_count && !done_; i++) {
+        for (int i = 0; i < thread_spin_count && !done_; i++) {
           if (((i + 1) % steal_count == 0)) {
             t = Steal(StealAttemptKind::TRY_ONE);
+            if (t) profiler_.LogSteal(thread_id);
           } else {
             t = q.PopFront();
           }
@@ -1554,8 +1743,13 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
           if (spin_loop_status_.load(std::memory_order_relaxed) == SpinLoopStatus::kIdle) {
             break;
           }
+          if (spin_limit_ns > 0 && i % spin_clock_interval == spin_clock_interval - 1 &&
+              SpinClock::now() - idle_start >= std::chrono::nanoseconds(spin_limit_ns)) {
+            break;
+          }
           onnxruntime::concurrency::SpinPause();
         }
+        td.RecordSpin(SpinClock::now() - idle_start, static_cast<bool>(t));
 
         // Attempt to block
         if (!t) {
@@ -1619,11 +1813,19 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
           // blocking, or are exiting, then either work was pushed to
           // us, or it was pushed to an overloaded queue
           if (!t) t = q.PopFront();
-          if (!t) t = Steal(StealAttemptKind::TRY_ALL);
+          if (!t) {
+            t = Steal(StealAttemptKind::TRY_ALL);
+            if (t) profiler_.LogSteal(thread_id);
+          }
+        }
+
+        if (t && adaptive_spinning_) {
+          td.RecordGap(SpinClock::now() - idle_start);
         }
       }
 
       if (t) {
+        profiler_.LogIdleEnd(thread_id);
         td.SetActive();
         t();
         profiler_.LogRun(thread_id);
@@ -16,12 +16,19 @@ limitations under the License.
 /* Modifications Copyright (c) Microsoft. */
 
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <map>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <functional>
 #include <memory>
 #include "core/common/common.h"
 #include "core/platform/env.h"
+#include "core/platform/ort_mutex.h"
 
 #include <functional>
 #include <memory>
@@ -95,6 +102,35 @@ limitations under the License.
 //   rates in per-core caches across the series of short loops used in
 //   operators like GRU.
 //
+// - Parallel loops may be nested, e.g. a loop over the heads of an
+//   attention layer inside a loop over the batch.  The threads running
+//   the outer loop are busy, so the inner loop pushes its tasks to idle
+//   workers first.  Tasks left in the queues of busy workers are stolen
+//   by workers that become idle, and any iterations no other thread
+//   picks up run in the thread that entered the inner loop.  Steal and
+//   idle counters of the workers are reported by the profiler.
+//
+// - A pool shared by several clients, such as the global thread pools
+//   used by several sessions, can be divided into weighted shares
+//   (ThreadPool::Share).  While runs of several shares are in
+//   progress, each loop is limited to its share's part of the threads,
+//   so the loops of different sessions run side by side, and the time
+//   the threads spend on the runs of each share is accounted to it.
+//
+// - The costs TryParallelFor is given can be replaced by measured
+//   costs (ThreadPool::LoopCostTable).  The loops of a kernel are
+//   measured during calibration runs, keyed by the kernel and the size
+//   of its inputs, and later loops with the same key use the measured
+//   cost per iteration to choose the degree of parallelism and block
+//   size.
+//
+// - On CPUs with cores of different performance, such as the P-cores
+//   and E-cores of hybrid x86 CPUs, loops are split into smaller
+//   blocks so that the faster cores pick up more of them.  The batches
+//   of TryBatchParallelFor take chunks of iterations in proportion to
+//   the capacity of the core running them, as reported by
+//   Env::GetProcessorCapacities, instead of equal parts.
+//
 // There are some known areas for exploration here:
 //
 // - The cost-based heuristics were developed prior to recent changes
@@ -193,7 +229,8 @@ class ThreadPool {
   // They have no effect when using OpenMP.
   //
   // Parallel sections may not be nested, and may not be used inside
-  // parallel loops.
+  // parallel loops.  Parallel loops inside the loops of a parallel
+  // section run outside the section.
 
   class ParallelSection {
    public:
@@ -213,6 +250,179 @@ class ThreadPool {
     ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ParallelSection);
   };
 
+  // Priority of a run, e.g. an InferenceSession::Run call.
+  enum class RunPriority {
+    kLow,
+    kNormal,
+    kHigh,
+  };
+
+  // Sets the priority of the runs executed by the calling thread until the scope is exited, and counts high
+  // priority runs as in progress on the thread pool.
+  //
+  // While a high priority run is in progress on a pool, parallel loops of low priority runs only dispatch
+  // work to the caller's thread, and pool threads already helping with such a loop stop claiming iterations
+  // at the next block boundary. The remaining iterations are run by the thread that entered the loop, so the
+  // pool's threads are available to the high priority run.
+  class ScopedRunPriority {
+   public:
+    ScopedRunPriority(ThreadPool* tp, RunPriority priority);
+    ~ScopedRunPriority();
+
+   private:
+    ThreadPool* tp_;
+    RunPriority priority_;
+    RunPriority prev_priority_;
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ScopedRunPriority);
+  };
+
+  // Priority of the run executing on the calling thread. RunPriority::kNormal outside of a ScopedRunPriority.
+  static RunPriority CurrentRunPriority();
+
+  // Count a high priority run that's queued but not yet executing, e.g. by RunAsync, so that low priority
+  // loops make room for it before it starts. Each call must be paired with a call to EndHighPriorityRun.
+  static void BeginHighPriorityRun(ThreadPool* tp);
+  static void EndHighPriorityRun(ThreadPool* tp);
+
+  struct ShareStats {
+    uint64_t num_loops = 0;          // parallel loops of runs of the share that were run on the pool
+    uint64_t num_limited_loops = 0;  // loops that used fewer threads because other shares had runs in progress
+    std::chrono::nanoseconds cpu_time{0};
+  };
+
+  // A weighted share of a pool that is used by several clients, e.g. the InferenceSessions using the global thread
+  // pools of an environment.
+  //
+  // While runs of more than one share are in progress on a pool, a parallel loop of a share is run by at most its
+  // weighted part of the pool's threads, rounded up, so the loops of concurrent runs are interleaved on the pool in
+  // proportion to the weights instead of each one claiming all threads. Loops entered outside of a share are not
+  // limited.
+  //
+  // The CPU time of a share is the time the threads spend in its runs, plus the time the pool's threads spend
+  // helping with the parallel loops of its runs. It is measured with a wall clock, so it also counts time the
+  // threads are descheduled while the machine is oversubscribed.
+  //
+  // The pool, if any, must outlive the share, and the share must outlive its runs.
+  class Share {
+   public:
+    Share(ThreadPool* tp, int weight);
+    ~Share();
+
+    int Weight() const { return weight_; }
+
+    ShareStats GetStats() const;
+
+   private:
+    friend class ThreadPool;
+
+    ThreadPool* const tp_;
+    const int weight_;
+    std::atomic<int> num_runs_{0};
+    std::atomic<uint64_t> num_loops_{0};
+    std::atomic<uint64_t> num_limited_loops_{0};
+    std::atomic<int64_t> cpu_time_ns_{0};
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Share);
+  };
+
+  // Counts a run of the share as in progress until the scope is exited, and accounts the parallel loops entered by
+  // the calling thread to the share. Has no effect if the share is nullptr.
+  class ScopedShare {
+   public:
+    explicit ScopedShare(Share* share);
+    ~ScopedShare();
+
+   private:
+    Share* share_;
+    Share* prev_share_;
+    std::chrono::steady_clock::time_point start_;
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ScopedShare);
+  };
+
+  // Measured costs per iteration of parallel loops, used by TryParallelFor instead of the costs estimated by the
+  // callers.
+  //
+  // A loop is keyed by the key of the ScopedLoopCost it is entered in and its order among the loops of the scope.
+  // The cost of a loop is the time the threads spend in its iterations divided by the number of iterations, so it
+  // does not depend on how many threads ran the loop. Costs are measured in nanoseconds and converted to the cycles
+  // the cost model takes with the frequency of the processors.
+  //
+  // Measurements are recorded under a lock. Loops only use the costs published by Freeze(), which they look up
+  // without a lock by the hash of their key.
+  class LoopCostTable {
+   public:
+    // Processor frequency assumed if the system doesn't report it.
+    static constexpr double kDefaultCyclesPerNanosecond = 3.0;
+
+    // `cycles_per_ns` converts the measured costs to cycles, i.e. the frequency of the processors in GHz.
+    explicit LoopCostTable(double cycles_per_ns = kDefaultCyclesPerNanosecond);
+
+    // Add a measurement of `num_iterations` iterations that took `total_time` over all threads. Loops use it once
+    // the table is frozen again.
+    void Record(const std::string& key, std::chrono::nanoseconds total_time, std::ptrdiff_t num_iterations);
+
+    // Returns false if the loop hasn't been measured.
+    bool TryGetCost(const std::string& key, double& ns_per_iteration) const;
+
+    // Publishes the measured costs to the loops. Must not be called while loops run with the table.
+    void Freeze();
+
+    // Returns false if the loop with the key hash had no cost when the table was frozen. Lock-free.
+    bool TryGetFrozenCost(uint64_t key_hash, double& cycles_per_iteration) const;
+
+    size_t Size() const;
+
+    double CyclesPerNanosecond() const { return cycles_per_ns_; }
+
+    // Hash of the key `piece` appended to a key with hash `prefix_hash`. Hashing a key in pieces gives the same hash
+    // as hashing it at once, so the key of a loop doesn't need to be built to look its cost up.
+    static constexpr uint64_t kEmptyKeyHash = 14695981039346656037ULL;
+    static uint64_t HashKey(std::string_view piece, uint64_t prefix_hash = kEmptyKeyHash);
+    // Hash of the decimal digits of a non-negative `value` appended to a key with hash `prefix_hash`.
+    static uint64_t HashKey(int64_t value, uint64_t prefix_hash);
+
+    // The table is written as one line per loop: the key, the cost per iteration in nanoseconds and the number of
+    // iterations it was measured over, separated by tabs. Loaded loops are added to the measurements already in the
+    // table.
+    Status Save(std::ostream& stream) const;
+    Status Load(std::istream& stream);
+
+   private:
+    struct Entry {
+      double total_ns = 0;
+      double num_iterations = 0;
+    };
+
+    const double cycles_per_ns_;
+    mutable OrtMutex mutex_;
+    std::map<std::string, Entry> entries_;
+    // cycles per iteration of the loops, sorted by the hash of their key
+    std::vector<std::pair<uint64_t, double>> frozen_costs_;
+  };
+
+  // Keys the parallel loops the calling thread enters through TryParallelFor in the scope, and either measures them
+  // into the table or applies the costs the frozen table has for them. Loops nested in a parallel loop are not keyed.
+  // Has no effect if the table is nullptr.
+  class ScopedLoopCost {
+   public:
+    ScopedLoopCost(LoopCostTable* table, std::string key, bool calibrate);
+
+    // Applies the costs of the table to the loops of the key with hash `key_hash`, without building the key.
+    ScopedLoopCost(LoopCostTable* table, uint64_t key_hash);
+
+    ~ScopedLoopCost();
+
+   private:
+    friend class ThreadPool;
+
+    LoopCostTable* table_;
+    std::string key_;
+    uint64_t key_hash_;
+    bool calibrate_;
+    int num_loops_ = 0;
+    ScopedLoopCost* prev_loop_cost_;
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ScopedLoopCost);
+  };
+
   // The below API allows to disable spinning
   // This is used to support real-time scenarios where
   // spinning between relatively infrequent requests
@@ -221,6 +431,22 @@ class ThreadPool {
 
   void DisableSpinning();
 
+  // Counters of the spin-then-block policy of the pool's threads, summed over the threads.
+  //
+  // Spinning trades CPU time for latency: a thread that finds work while spinning saves the time a blocked thread
+  // takes to resume after being woken. The latency saved is roughly num_spin_hits times the average wake-up latency,
+  // wake_up_latency / num_wake_ups, at the cost of spin_time.
+  struct SpinStats {
+    uint64_t num_spin_hits = 0;  // times a thread found work while spinning
+    uint64_t num_blocks = 0;     // times a thread blocked without work
+    uint64_t num_wake_ups = 0;   // times a blocked thread was woken
+    std::chrono::nanoseconds spin_time{0};        // time spent spinning, with or without finding work
+    std::chrono::nanoseconds wake_up_latency{0};  // time from waking a blocked thread until it resumed
+  };
+
+  // All zero if there is no pool or the pool has no threads.
+  static SpinStats GetSpinStats(const ThreadPool* tp);
+
   // Schedules fn() for execution in the pool of threads.  The function may run
   // synchronously if it cannot be enqueued.  This will occur if the thread pool's
   // degree-of-parallelism is 1, but it may also occur for implementation-dependent
@@ -307,6 +533,23 @@ class ThreadPool {
       return;
     }
 
+    if (!tp->processor_capacities_.empty()) {
+      // the batches take chunks of the iterations until none are left, so a faster core runs more iterations than a
+      // slower one instead of waiting for it to finish an equal part
+      std::atomic<std::ptrdiff_t> next{0};
+      tp->SimpleParallelFor(num_batches, [&](std::ptrdiff_t) {
+        const std::ptrdiff_t chunk_size = tp->GetBatchChunkSize(total, num_batches);
+        for (std::ptrdiff_t first = next.fetch_add(chunk_size, std::memory_order_relaxed); first < total;
+             first = next.fetch_add(chunk_size, std::memory_order_relaxed)) {
+          const std::ptrdiff_t last = std::min(first + chunk_size, total);
+          for (std::ptrdiff_t i = first; i < last; i++) {
+            fn(i);
+          }
+        }
+      });
+      return;
+    }
+
     tp->SimpleParallelFor(num_batches, [&](std::ptrdiff_t batch_index) {
       auto work = PartitionWork(batch_index, num_batches, total);
       for (std::ptrdiff_t i = work.start; i < work.end; i++) {
@@ -428,6 +671,27 @@ class ThreadPool {
 
   // Force the thread pool to run in hybrid mode on a normal cpu.
   bool force_hybrid_ = false;
+
+  // Capacities of the logical processors, indexed by processor id, if the threads of the pool run on cores of
+  // different performance. Empty otherwise.
+  std::vector<int> processor_capacities_;
+
+  // Returns the number of iterations a batch of TryBatchParallelFor takes at a time on the calling thread's core.
+  std::ptrdiff_t GetBatchChunkSize(std::ptrdiff_t total, std::ptrdiff_t num_batches) const;
+
+  // Number of high priority runs queued or in progress on this pool.
+  std::atomic<int> num_high_priority_runs_{0};
+
+  // Whether a low priority loop should leave the remaining iterations to the thread that entered it.
+  bool ShouldYieldToHighPriority(RunPriority loop_priority) const {
+    return loop_priority == RunPriority::kLow && num_high_priority_runs_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Sum of the weights of the shares with runs in progress on this pool.
+  std::atomic<int> active_share_weight_{0};
+
+  // Returns the number of work items, at most n, a loop of the share may use given the shares with runs in progress.
+  unsigned GetShareOfWorkItems(const Share& share, unsigned n) const;
 };
 
 }  // namespace concurrency
@@ -299,6 +299,9 @@ ORT_RUNTIME_CLASS(DnnlProviderOptions);
 ORT_RUNTIME_CLASS(Op);
 ORT_RUNTIME_CLASS(OpAttr);
 ORT_RUNTIME_CLASS(Logger);
+ORT_RUNTIME_CLASS(SessionPool);
+ORT_RUNTIME_CLASS(RingBuffer);
+ORT_RUNTIME_CLASS(PreparedRun);
 
 #ifdef _WIN32
 typedef _Return_type_success_(return == 0) OrtStatus* OrtStatusPtr;
@@ -2762,6 +2765,10 @@ struct OrtApi {
    *  Use -1 to allow ORT to choose the default 1GB for max_power_of_two_extend_bytes.
    *  Ultimately, the allocation size is determined by the allocation memory request.
    *  Further allocation sizes are governed by the arena extend strategy.
+   * "max_thread_cache_bytes": Maximum number of bytes of freed chunks each thread keeps for reuse by its next
+   *  allocations of the same size class, so they don't take the arena lock. Only allocations up to 1MB are cached.
+   *  A thread's cache is returned to the arena at the end of each session run, when the thread exits, and when the arena
+   *  shrinks or runs out of memory. Default is 0, which disables them.
    *
    * \param[in] arena_config_keys Keys to configure the arena
    * \param[in] arena_config_values Values to configure the arena
@@ -4413,6 +4420,212 @@ struct OrtApi {
    * \since Version 1.16.
    */
   ORT_API2_STATUS(KernelContext_GetResource, _In_ const OrtKernelContext* context, _In_ int resouce_version, _In_ int resource_id, _Outptr_ void** resource);
+
+  /// \name OrtSessionPool
+  /// @{
+
+  /** \brief Create a pool of sessions of one model that share their initializers and pre-packed weights
+   *
+   * The initializers of the main graph are loaded once and shared by all sessions of the pool, as if they had been
+   * added with AddInitializer, and the sessions share one ::OrtPrepackedWeightsContainer. Unless
+   * "session.use_env_allocators" is set in the options, the sessions use the allocators registered with the
+   * ::OrtEnv, if any. Initializers are only shared for ONNX format models.
+   *
+   * \param[in] env
+   * \param[in] model_path
+   * \param[in] options
+   * \param[in] num_sessions Number of sessions in the pool. Must be greater than 0.
+   * \param[out] out Returned pool. Must be freed with OrtApi::ReleaseSessionPool
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(CreateSessionPool, _In_ const OrtEnv* env, _In_ const ORTCHAR_T* model_path,
+                  _In_ const OrtSessionOptions* options, size_t num_sessions, _Outptr_ OrtSessionPool** out);
+
+  /** \brief Create a pool of sessions from a model stored in memory
+   *
+   * \see OrtApi::CreateSessionPool
+   *
+   * \param[in] env
+   * \param[in] model_data
+   * \param[in] model_data_length
+   * \param[in] options
+   * \param[in] num_sessions Number of sessions in the pool. Must be greater than 0.
+   * \param[out] out Returned pool. Must be freed with OrtApi::ReleaseSessionPool
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(CreateSessionPoolFromArray, _In_ const OrtEnv* env, _In_ const void* model_data,
+                  size_t model_data_length, _In_ const OrtSessionOptions* options, size_t num_sessions,
+                  _Outptr_ OrtSessionPool** out);
+
+  /** \brief Take an idle session out of the pool
+   *
+   * Does not block. If every session of the pool is in use, `out` is set to nullptr.
+   * The session is owned by the pool. It must not be released with OrtApi::ReleaseSession but given back with
+   * OrtApi::SessionPoolReturnSession once the caller is done with it.
+   *
+   * \param[in] pool
+   * \param[out] out The session, or nullptr if no session is idle.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(SessionPoolAcquireSession, _Inout_ OrtSessionPool* pool, _Outptr_result_maybenull_ OrtSession** out);
+
+  /** \brief Give a session obtained from OrtApi::SessionPoolAcquireSession back to the pool
+   *
+   * Fails if the session does not belong to the pool or was already given back.
+   *
+   * \param[in] pool
+   * \param[in] session
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(SessionPoolReturnSession, _Inout_ OrtSessionPool* pool, _In_ OrtSession* session);
+
+  /** \brief Release an ::OrtSessionPool and all of its sessions
+   *
+   * Sessions that are still in use stay valid. The pool is then released when the last of them is given back with
+   * OrtApi::SessionPoolReturnSession, which is the only function that may be called with the pool afterwards.
+   *
+   * \since Version 1.17.
+   */
+  ORT_CLASS_RELEASE(SessionPool);
+
+  /// @}
+
+  /// \name OrtRingBuffer
+  /// @{
+
+  /** \brief Create a ring buffer that outputs can be placed in without an allocation or a copy
+   *
+   * Outputs bound to the ring buffer with OrtApi::BindOutputToRingBuffer are written to the next free slot of
+   * `buffer` by OrtApi::RunWithBinding. A slot is returned to the ring buffer when the last ::OrtValue referring to
+   * the output in it is released. Slots are reused in the order they were handed out, so an output that is held on
+   * to for a long time keeps the slots after it from being reused.
+   *
+   * \param[in] mem_info Location of `buffer`.
+   * \param[in] buffer The memory to hand out. It is not owned by the ring buffer and must outlive every output
+   *                   placed in it.
+   * \param[in] buffer_size Size of `buffer` in bytes.
+   * \param[out] out Returned ring buffer. Must be freed with OrtApi::ReleaseRingBuffer
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(CreateRingBuffer, _In_ const OrtMemoryInfo* mem_info, _In_ void* buffer, size_t buffer_size,
+                  _Outptr_ OrtRingBuffer** out);
+
+  /** \brief Bind an output to a ring buffer
+   *
+   * Every run places the output in the next free slot of the ring buffer. The output of the previous run stays valid
+   * as long as the caller holds an ::OrtValue obtained from OrtApi::GetBoundOutputValues.
+   * If the ring buffer is full, the output is not a numeric tensor or it is produced on a different device than the
+   * ring buffer's, the output is allocated as if it was bound with OrtApi::BindOutputToDevice.
+   *
+   * \param[in] binding_ptr
+   * \param[in] name
+   * \param[in] ring_buffer The binding keeps the ring buffer alive.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(BindOutputToRingBuffer, _Inout_ OrtIoBinding* binding_ptr, _In_ const char* name,
+                  _In_ const OrtRingBuffer* ring_buffer);
+
+  /** \brief Release an ::OrtRingBuffer
+   *
+   * Outputs placed in the ring buffer and bindings to it remain valid.
+   *
+   * \since Version 1.17.
+   */
+  ORT_CLASS_RELEASE(RingBuffer);
+
+  /// @}
+  /// \name OrtSession
+  /// @{
+
+  /** \brief Return the time spent warming up the session
+   *
+   * Warm-up runs at the end of session creation if the "session.warm_up.input_shapes" session configuration entry
+   * is set. See onnxruntime_session_options_config_keys.h.
+   *
+   * \param[in] session
+   * \param[out] out Nanoseconds spent warming up. 0 if the session was not warmed up.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(SessionGetWarmUpDurationNs, _In_ const OrtSession* session, _Out_ uint64_t* out);
+
+  /// @}
+  /// \name OrtPreparedRun
+  /// @{
+
+  /** \brief Resolve the inputs and outputs of a run once, for running a session repeatedly with OrtApi::RunPrepared
+   *
+   * Every input must be a tensor with a fixed shape in the model.
+   *
+   * \param[in] session
+   * \param[in] input_names Array of null terminated UTF8 encoded strings of the input names, in the order
+   *                        OrtApi::RunPrepared takes the inputs
+   * \param[in] input_len Number of elements in the input_names array
+   * \param[in] output_names Array of null terminated UTF8 encoded strings of the output names, in the order
+   *                         OrtApi::RunPrepared returns the outputs
+   * \param[in] output_names_len Number of elements in the output_names array
+   * \param[out] out Returned prepared run. Must be freed with OrtApi::ReleasePreparedRun
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(CreatePreparedRun, _Inout_ OrtSession* session,
+                  _In_reads_(input_len) const char* const* input_names, size_t input_len,
+                  _In_reads_(output_names_len) const char* const* output_names, size_t output_names_len,
+                  _Outptr_ OrtPreparedRun** out);
+
+  /** \brief Run the model with a prepared run
+   *
+   * Same as OrtApi::Run, except that the input and output names are not resolved again and the inputs are only
+   * checked against the element types and shapes resolved when the run was prepared.
+   * A prepared run must not be used by concurrent calls. Create one prepared run per thread instead.
+   *
+   * \param[in] session The session the run was prepared with
+   * \param[in] run_options If nullptr, will use a default ::OrtRunOptions
+   * \param[in] prepared_run
+   * \param[in] inputs Array of ::OrtValue%s in the order of the prepared input names
+   * \param[in] input_len Number of elements in the inputs array
+   * \param[out] outputs Array of ::OrtValue%s in the order of the prepared output names. Null entries are
+   *                     filled with ::OrtValue%s allocated by onnxruntime, others are used as pre-allocated outputs.
+   * \param[in] output_len Number of elements in the outputs array
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.17.
+   */
+  ORT_API2_STATUS(RunPrepared, _Inout_ OrtSession* session, _In_opt_ const OrtRunOptions* run_options,
+                  _Inout_ OrtPreparedRun* prepared_run,
+                  _In_reads_(input_len) const OrtValue* const* inputs, size_t input_len,
+                  _Inout_updates_all_(output_len) OrtValue** outputs, size_t output_len);
+
+  /** \brief Release an ::OrtPreparedRun
+   *
+   * \since Version 1.17.
+   */
+  ORT_CLASS_RELEASE(PreparedRun);
+
+  /// @}
 };
 
 /*
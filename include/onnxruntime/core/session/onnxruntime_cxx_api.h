@@ -522,6 +522,9 @@ ORT_DEFINE_RELEASE(Status);
 ORT_DEFINE_RELEASE(OpAttr);
 ORT_DEFINE_RELEASE(Op);
 ORT_DEFINE_RELEASE(KernelInfo);
+ORT_DEFINE_RELEASE(SessionPool);
+ORT_DEFINE_RELEASE(RingBuffer);
+ORT_DEFINE_RELEASE(PreparedRun);
 
 #undef ORT_DEFINE_RELEASE
 
@@ -985,6 +988,7 @@ struct ModelMetadata : detail::Base<OrtModelMetadata> {
 };
 
 struct IoBinding;
+struct PreparedRun;
 
 namespace detail {
 
@@ -1027,6 +1031,7 @@ struct ConstSessionImpl : Base<T> {
   AllocatedStringPtr GetOverridableInitializerNameAllocated(size_t index, OrtAllocator* allocator) const;  ///< Wraps OrtApi::SessionGetOverridableInitializerName
 
   uint64_t GetProfilingStartTimeNs() const;  ///< Wraps OrtApi::SessionGetProfilingStartTimeNs
+  uint64_t GetWarmUpDurationNs() const;      ///< Wraps OrtApi::SessionGetWarmUpDurationNs
   ModelMetadata GetModelMetadata() const;    ///< Wraps OrtApi::SessionGetModelMetadata
 
   TypeInfo GetInputTypeInfo(size_t index) const;                   ///< Wraps OrtApi::SessionGetInputTypeInfo
@@ -1067,6 +1072,21 @@ struct SessionImpl : ConstSessionImpl<T> {
 
   void Run(const RunOptions& run_options, const IoBinding&);  ///< Wraps OrtApi::RunWithBinding
 
+  /** \brief Run the model with a prepared run, returning results in user provided outputs
+   *
+   * Wraps OrtApi::RunPrepared
+   *
+   * \param[in] run_options
+   * \param[in] prepared_run Created from this session. Must not be used by concurrent calls.
+   * \param[in] input_values Array of Value objects of length input_count, in the order of the prepared input names
+   * \param[in] input_count Number of elements in the input_values array
+   * \param[out] output_values Array of Value objects of length output_count, in the order of the prepared output
+   *             names. Empty values are filled with outputs allocated by onnxruntime.
+   * \param[in] output_count Number of elements in the output_values array
+   */
+  void Run(const RunOptions& run_options, PreparedRun& prepared_run, const Value* input_values, size_t input_count,
+           Value* output_values, size_t output_count);
+
   /** \brief Run the model asynchronously in a thread owned by intra op thread pool
    *
    * Wraps OrtApi::RunAsync
@@ -1119,6 +1139,25 @@ struct Session : detail::SessionImpl<OrtSession> {
   UnownedSession GetUnowned() const { return UnownedSession{this->p_}; }
 };
 
+/** \brief Wrapper around ::OrtSessionPool
+ *
+ */
+struct SessionPool : detail::Base<OrtSessionPool> {
+  explicit SessionPool(std::nullptr_t) {}  ///< Create an empty SessionPool object, must be assigned a valid one to be used
+  SessionPool(const Env& env, const ORTCHAR_T* model_path, const SessionOptions& options,
+              size_t num_sessions);  ///< Wraps OrtApi::CreateSessionPool
+  SessionPool(const Env& env, const void* model_data, size_t model_data_length, const SessionOptions& options,
+              size_t num_sessions);  ///< Wraps OrtApi::CreateSessionPoolFromArray
+
+  /** \brief Take an idle session out of the pool. Wraps OrtApi::SessionPoolAcquireSession
+   *
+   * \return The session, or a null UnownedSession if every session of the pool is in use.
+   */
+  UnownedSession TryAcquireSession();
+
+  void ReturnSession(UnownedSession session);  ///< Wraps OrtApi::SessionPoolReturnSession
+};
+
 namespace detail {
 template <typename T>
 struct MemoryInfoImpl : Base<T> {
@@ -1838,6 +1877,7 @@ struct IoBindingImpl : ConstIoBindingImpl<T> {
   void BindInput(const char* name, const Value&);
   void BindOutput(const char* name, const Value&);
   void BindOutput(const char* name, const OrtMemoryInfo*);
+  void BindOutput(const char* name, const OrtRingBuffer*);  ///< Wraps OrtApi::BindOutputToRingBuffer
   void ClearBoundInputs();
   void ClearBoundOutputs();
   void SynchronizeInputs();
@@ -1859,6 +1899,26 @@ struct IoBinding : detail::IoBindingImpl<OrtIoBinding> {
   UnownedIoBinding GetUnowned() const { return UnownedIoBinding{this->p_}; }
 };
 
+/** \brief Wrapper around ::OrtRingBuffer
+ *
+ * Outputs bound to it with IoBinding::BindOutput are placed directly in the caller's buffer.
+ */
+struct RingBuffer : detail::Base<OrtRingBuffer> {
+  explicit RingBuffer(std::nullptr_t) {}  ///< Create an empty RingBuffer object, must be assigned a valid one to be used
+  RingBuffer(const OrtMemoryInfo* mem_info, void* buffer, size_t buffer_size);  ///< Wraps OrtApi::CreateRingBuffer
+};
+
+/** \brief Wrapper around ::OrtPreparedRun
+ *
+ * The inputs and outputs of a run resolved once, for running a session repeatedly with Session::Run.
+ */
+struct PreparedRun : detail::Base<OrtPreparedRun> {
+  explicit PreparedRun(std::nullptr_t) {}  ///< Create an empty PreparedRun object, must be assigned a valid one to be used
+  /// Wraps OrtApi::CreatePreparedRun
+  PreparedRun(Session& session, const char* const* input_names, size_t input_count,
+              const char* const* output_names, size_t output_count);
+};
+
 /*! \struct Ort::ArenaCfg
  * \brief it is a structure that represents the configuration of an arena based allocator
  * \details Please see docs/C_API.md for details
@@ -327,6 +327,11 @@ inline void IoBindingImpl<T>::BindOutput(const char* name, const OrtMemoryInfo*
   ThrowOnError(GetApi().BindOutputToDevice(this->p_, name, mem_info));
 }
 
+template <typename T>
+inline void IoBindingImpl<T>::BindOutput(const char* name, const OrtRingBuffer* ring_buffer) {
+  ThrowOnError(GetApi().BindOutputToRingBuffer(this->p_, name, ring_buffer));
+}
+
 template <typename T>
 inline void IoBindingImpl<T>::ClearBoundInputs() {
   GetApi().ClearBoundInputs(this->p_);
@@ -415,6 +420,15 @@ inline IoBinding::IoBinding(Session& session) {
   ThrowOnError(GetApi().CreateIoBinding(session, &this->p_));
 }
 
+inline RingBuffer::RingBuffer(const OrtMemoryInfo* mem_info, void* buffer, size_t buffer_size) {
+  ThrowOnError(GetApi().CreateRingBuffer(mem_info, buffer, buffer_size, &this->p_));
+}
+
+inline PreparedRun::PreparedRun(Session& session, const char* const* input_names, size_t input_count,
+                                const char* const* output_names, size_t output_count) {
+  ThrowOnError(GetApi().CreatePreparedRun(session, input_names, input_count, output_names, output_count, &this->p_));
+}
+
 inline ArenaCfg::ArenaCfg(size_t max_mem, int arena_extend_strategy, int initial_chunk_size_bytes, int max_dead_bytes_per_chunk) {
   ThrowOnError(GetApi().CreateArenaCfg(max_mem, arena_extend_strategy, initial_chunk_size_bytes, max_dead_bytes_per_chunk, &p_));
 }
@@ -919,6 +933,13 @@ inline uint64_t ConstSessionImpl<T>::GetProfilingStartTimeNs() const {
   return out;
 }
 
+template <typename T>
+inline uint64_t ConstSessionImpl<T>::GetWarmUpDurationNs() const {
+  uint64_t out;
+  ThrowOnError(GetApi().SessionGetWarmUpDurationNs(this->p_, &out));
+  return out;
+}
+
 template <typename T>
 inline ModelMetadata ConstSessionImpl<T>::GetModelMetadata() const {
   OrtModelMetadata* out;
@@ -972,6 +993,15 @@ inline void SessionImpl<T>::Run(const RunOptions& run_options, const IoBinding&
   ThrowOnError(GetApi().RunWithBinding(this->p_, run_options, io_binding));
 }
 
+template <typename T>
+inline void SessionImpl<T>::Run(const RunOptions& run_options, PreparedRun& prepared_run, const Value* input_values,
+                                size_t input_count, Value* output_values, size_t output_count) {
+  auto ort_input_values = reinterpret_cast<const OrtValue* const*>(input_values);
+  auto ort_output_values = reinterpret_cast<OrtValue**>(output_values);
+  ThrowOnError(GetApi().RunPrepared(this->p_, run_options, prepared_run, ort_input_values, input_count,
+                                    ort_output_values, output_count));
+}
+
 template <typename T>
 inline void SessionImpl<T>::RunAsync(const RunOptions& run_options, const char* const* input_names, const Value* input_values, size_t input_count,
                                      const char* const* output_names, Value* output_values, size_t output_count, RunAsyncCallbackFn callback, void* user_data) {
@@ -1035,6 +1065,27 @@ inline Session::Session(const Env& env, const void* model_data, size_t model_dat
                                                                             prepacked_weights_container, &this->p_));
 }
 
+inline SessionPool::SessionPool(const Env& env, const ORTCHAR_T* model_path, const SessionOptions& options,
+                                size_t num_sessions) {
+  ThrowOnError(GetApi().CreateSessionPool(env, model_path, options, num_sessions, &this->p_));
+}
+
+inline SessionPool::SessionPool(const Env& env, const void* model_data, size_t model_data_length,
+                                const SessionOptions& options, size_t num_sessions) {
+  ThrowOnError(GetApi().CreateSessionPoolFromArray(env, model_data, model_data_length, options, num_sessions,
+                                                   &this->p_));
+}
+
+inline UnownedSession SessionPool::TryAcquireSession() {
+  OrtSession* session = nullptr;
+  ThrowOnError(GetApi().SessionPoolAcquireSession(this->p_, &session));
+  return UnownedSession{session};
+}
+
+inline void SessionPool::ReturnSession(UnownedSession session) {
+  ThrowOnError(GetApi().SessionPoolReturnSession(this->p_, session));
+}
+
 inline AllocatedStringPtr ModelMetadata::GetProducerNameAllocated(OrtAllocator* allocator) const {
   char* out;
   ThrowOnError(GetApi().ModelMetadataGetProducerName(p_, allocator, &out));
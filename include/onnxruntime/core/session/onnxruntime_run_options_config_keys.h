@@ -30,3 +30,21 @@ static const char* const kOrtRunOptionsConfigEnableMemoryArenaShrinkage = "memor
 // Per default it will be set to '0'
 // Taking CUDA EP as an example, it omit triggering cudaStreamSynchronize on the compute stream.
 static const char* const kOrtRunOptionsConfigDisableSynchronizeExecutionProviders = "disable_synchronize_execution_providers";
+
+// Priority of the run when it shares the intra-op thread pool with other concurrent runs.
+// While a "high" priority run is in progress, parallel loops of "low" priority runs only use the thread calling Run
+// and release the pool's threads at the next block boundary, so the high priority run gets the pool's threads first.
+// For RunAsync, a high priority run takes precedence from the time it is submitted, including when it is pipelined.
+// Option values:
+// - "low": yield the intra-op thread pool to high priority runs.
+// - "normal": [DEFAULT]
+// - "high": take precedence over low priority runs.
+static const char* const kOrtRunOptionsConfigRunPriority = "run.priority";
+
+// Maximum time in milliseconds a Run call may take, counted from when it is called.
+// The run is checked against its deadline before each step of the execution plan, where the terminate flag is checked.
+// A run that misses its deadline is aborted with an error status, and the memory of its intermediate values is
+// returned to the arena. A node that is executing when the deadline passes is completed first.
+// The deadline also applies to the subgraphs of control flow nodes and to the stages of a pipelined run.
+// "0": [DEFAULT] no deadline.
+static const char* const kOrtRunOptionsConfigRunDeadlineMillis = "run.deadline_ms";
@@ -20,6 +20,32 @@
 // If the config value is set to "1" then the prepacking is disabled, otherwise prepacking is enabled (default value)
 static const char* const kOrtSessionOptionsConfigDisablePrepacking = "session.disable_prepacking";
 
+// Prefix of the names of POSIX shared memory regions to store the pre-packed weights of CPU kernels in.
+// Processes that pack the same weights map the same region instead of each keeping a copy, so the memory used by
+// pre-packed weights stays constant in the number of processes serving a model. A region is named after the prefix,
+// the op type and the hash of the pre-packed buffers, and is only used if its content matches the buffers the
+// session packed. Regions persist after the processes exit so processes started later attach to them; they can be
+// removed from /dev/shm. Use a prefix per deployment, e.g. a hash of the model.
+// Pre-packed weights of initializers shared with AddInitializer and a PrepackedWeightsContainer are not affected.
+// Not supported on Windows and Android, where pre-packed weights stay in private memory.
+// Option values:
+// - "": Pre-packed weights are stored in private memory. [DEFAULT]
+// - A prefix without '/': Pre-packed weights are stored in shared memory regions with names starting with it.
+static const char* const kOrtSessionOptionsConfigSharedPrepackedWeightsPrefix =
+    "session.shared_prepacked_weights_prefix";
+
+// Directory to store the pre-packed weights of CPU kernels in, so that later sessions load them instead of packing
+// the weights again. Files are mapped into memory, so processes loading the same weights share their pages.
+// Entries are keyed by the node's op type, attributes and input types and by the content of the weight, and are
+// ignored if they were written by a different onnxruntime build or on a CPU with different features.
+// Only kernels that implement OpKernel::UseCachedPrePackedBuffers() skip packing; the weights of other kernels are
+// packed as usual. The directory is created if it doesn't exist and is never cleaned up by onnxruntime.
+// Option values:
+// - "": Pre-packed weights are not cached on disk. [DEFAULT]
+// - A directory: Pre-packed weights are cached in it.
+static const char* const kOrtSessionOptionsConfigPrepackedWeightsCacheDir =
+    "session.prepacked_weights_cache_dir";
+
 // A value of "1" means allocators registered in the env will be used. "0" means the allocators created in the session
 // will be used. Use this to override the usage of env allocators on a per session level.
 static const char* const kOrtSessionOptionsConfigUseEnvAllocators = "session.use_env_allocators";
@@ -111,6 +137,16 @@ static const char* const kOrtSessionOptionsConfigUseORTModelBytesDirectly = "ses
 static const char* const kOrtSessionOptionsConfigUseORTModelBytesForInitializers =
     "session.use_ort_model_bytes_for_initializers";
 
+// Memory map an ONNX model file loaded from a path instead of reading it, and refer initializers of the main graph
+// whose data is stored inline in the model to their data in the read-only mapping instead of copying it.
+// This reduces the peak memory usage and the load time of models with large inline initializers, and the pages of
+// the initializers are shared by all processes that load the same file.
+// The model file must not be modified while the session exists. Ignored if an optimized model is saved.
+// Option values:
+// - "0": The model file is read and initializers are copied. [DEFAULT]
+// - "1": The model file is mapped and initializers refer to the mapping.
+static const char* const kOrtSessionOptionsConfigMapInlineInitializers = "session.map_inline_initializers";
+
 // This should only be specified when exporting an ORT format model for use on a different platform.
 // If the ORT format model will be used on ARM platforms set to "1". For other platforms set to "0"
 // Available since version 1.11.
@@ -190,6 +226,28 @@ static const char* const kNodePartitionConfigFile = "session.node_partition_conf
 //    Hence 64-65 is an invalid configuration, because a windows thread cannot be attached to processors across group boundary.
 static const char* const kOrtSessionOptionsConfigIntraOpThreadAffinities = "session.intra_op_thread_affinities";
 
+// Binds a session to a NUMA node. The threads of the session's intra-op and inter-op thread pools are pinned to the
+// logical processors of the node, and the memory of the CPU execution provider the session adds when none is registered,
+// which holds the weights and the CPU arena, is placed on the node.
+// To serve from several nodes, create a session per node. Each session then has a copy of the weights on its node.
+// Option values:
+// - "-1": The session is not bound to a NUMA node. [DEFAULT]
+// - A NUMA node id, e.g. "1". Fails if the system doesn't report the node.
+// Requires per session threads, and can't be combined with "session.intra_op_thread_affinities".
+// The calling thread is not pinned.
+static const char* const kOrtSessionOptionsConfigNumaNode = "session.numa_node";
+
+// Backs the memory of the CPU execution provider the session adds when none is registered, which holds the weights
+// and the CPU arena, with huge pages to reduce TLB misses. Allocations of at least 2MB, which include the arena
+// regions, are mapped from the huge page pool (MAP_HUGETLB) if it has enough free pages, and otherwise as
+// transparent huge pages (madvise(MADV_HUGEPAGE)) that the kernel backs with huge pages where it can.
+// The arena grows in multiples of 2MB. The number of bytes actually backed by huge pages is reported as
+// huge_page_bytes in the statistics of the allocator.
+// Option values:
+// - "0": Regular pages are used. [DEFAULT]
+// - "1": Huge pages are used. Only supported on Linux; other platforms use regular pages.
+static const char* const kOrtSessionOptionsConfigUseHugePages = "session.use_huge_pages";
+
 // This option will dump out the model to assist debugging any issues with layout transformation,
 // and is primarily intended for developer usage. It is only relevant if an execution provider that requests
 // NHWC layout is enabled such as NNAPI, XNNPACK or QNN.
@@ -225,3 +283,163 @@ static const char* const kOrtSessionOptionsOptimizedModelExternalInitializersFil
 // Use this config to control the minimum size of the initializer when externalizing it during serialization
 static const char* const kOrtSessionOptionsOptimizedModelExternalInitializersMinSizeInBytes =
     "session.optimized_model_external_initializers_min_size_in_bytes";
+
+// Enables dynamic batching of concurrent Run() calls on the same session.
+// Concurrent requests are collected for up to "session.dynamic_batching.timeout_us" microseconds or until this many
+// requests are pending, concatenated along "session.dynamic_batching.batch_axis", executed once, and the outputs are
+// split back to each caller. Every output of the model must carry the batch dimension on the same axis; if it does
+// not, the collected requests are executed one by one.
+// Only requests whose feeds are CPU tensors and that do not provide pre-allocated outputs are batched.
+// Option values:
+// - "0" or "1": Dynamic batching is disabled. [DEFAULT]
+// - Any integer greater than 1: the maximum number of requests in a batch.
+static const char* const kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize =
+    "session.dynamic_batching.max_batch_size";
+
+// Maximum time in microseconds the first request of a batch waits for other requests to join.
+// Default is "1000". Only used if dynamic batching is enabled.
+static const char* const kOrtSessionOptionsConfigDynamicBatchingTimeoutMicros = "session.dynamic_batching.timeout_us";
+
+// The axis of the model inputs and outputs that requests are concatenated along. Default is "0".
+// Only used if dynamic batching is enabled.
+static const char* const kOrtSessionOptionsConfigDynamicBatchingBatchAxis = "session.dynamic_batching.batch_axis";
+
+// Enables pipelined execution of RunAsync() calls on the same session.
+// The steps of the execution plan are split into this many stages. Each stage executes one request at a time and
+// hands it over to the next stage when done, so the first nodes of a request execute while the last nodes of the
+// previous request are still executing. Requests are executed on the intra-op thread pool.
+// Only used if the session runs on CPU only and its execution plan has a single stream, which is the case for the
+// sequential execution mode. Requests that need device copies or whose outputs are pre-allocated are executed
+// as a whole.
+// Option values:
+// - "0" or "1": Pipelined execution is disabled. [DEFAULT]
+// - Any integer greater than 1: the number of stages.
+static const char* const kOrtSessionOptionsConfigPipelinedExecutionNumStages = "session.pipelined_execution.num_stages";
+
+// Symbolic dimensions of the model inputs whose values are rounded up to a bucket boundary before looking up the
+// memory pattern cache, so that inputs whose shapes differ only in these dimensions share one memory pattern.
+// A bucket keeps the memory patterns of up to 4 of the shapes seen in it. A run uses the smallest pattern that fits
+// its shapes, and the pattern of a shape replaces the patterns of the shapes that fit in it.
+// Option values:
+// - "": no bucketing, every distinct set of input shapes has its own memory pattern. [DEFAULT]
+// - A comma separated list of dim_param names, e.g. "batch,sequence".
+// - "*": bucket every symbolic dimension of the model inputs.
+// Only used if memory pattern is enabled.
+static const char* const kOrtSessionOptionsConfigMemoryPatternBucketDims = "session.memory_pattern.bucket_dims";
+
+// Granularity of the buckets for "session.memory_pattern.bucket_dims".
+// Option values:
+// - "0": round up to the next power of two. [DEFAULT]
+// - Any positive integer N: round up to the next multiple of N.
+static const char* const kOrtSessionOptionsConfigMemoryPatternBucketSize = "session.memory_pattern.bucket_size";
+
+// Maximum number of memory patterns cached per graph. When the cache is full the least recently used pattern is
+// evicted. Default is "0", which means the cache is unbounded.
+static const char* const kOrtSessionOptionsConfigMemoryPatternCacheMaxEntries =
+    "session.memory_pattern.cache_max_entries";
+
+// Keeps the memory pattern buffer of a finished run and hands it to a later run whose memory pattern fits in it, so
+// that runs with a cached memory pattern don't allocate the buffer their intermediate tensors are placed in.
+// The session keeps at most as many buffers per device as it has executed runs concurrently. The memory they hold
+// is not released by arena shrinkage.
+// Option values:
+// - "0": The memory pattern buffers are freed at the end of each run. [DEFAULT]
+// - "1": The memory pattern buffers are reused.
+// Only used if memory pattern is enabled. Buffers allocated on a stream are not reused.
+static const char* const kOrtSessionOptionsConfigMemoryPatternReuseBuffers = "session.memory_pattern.reuse_buffers";
+
+// Warms up the session at the end of InferenceSession::Initialize by running it once for each of the given sets of
+// input shapes with zero filled inputs. This moves the cost of the first runs (lazy kernel initialization, arena
+// growth, thread pool start-up, memory pattern tracing) out of the first requests. Afterwards the memory arenas are
+// grown to the peak usage seen during warm-up and the free memory of the CPU arenas is pre-faulted.
+// The time spent warming up is reported by OrtApi::SessionGetWarmUpDurationNs.
+// Option values:
+// - "": no warm-up. [DEFAULT]
+// - A semicolon separated list of input shape sets. Each set is a comma separated list of "input_name:dim_0x...xdim_n".
+//   e.g. "input_ids:1x128,attention_mask:1x128;input_ids:8x512,attention_mask:8x512".
+//   Inputs that are not listed must have a fixed shape. A scalar input is written as "input_name:".
+static const char* const kOrtSessionOptionsConfigWarmUpInputShapes = "session.warm_up.input_shapes";
+
+// Enables caching the outputs of Run() calls keyed by the content of their inputs. A request whose inputs and
+// requested outputs match a cached one returns copies of the cached outputs without executing the model, so this
+// must only be enabled for deterministic models.
+// Only requests whose inputs and outputs are non-string CPU tensors and whose outputs are not pre-allocated are
+// cached.
+// Option values:
+// - "0": The result cache is disabled. [DEFAULT]
+// - Any positive integer: the maximum number of bytes of inputs and outputs held by the cache. The least recently
+//   used entries are evicted to stay within it.
+static const char* const kOrtSessionOptionsConfigResultCacheMaxBytes = "session.result_cache.max_bytes";
+
+// Time in milliseconds after which a cached result expires. Default is "0", which means results don't expire.
+// Only used if the result cache is enabled.
+static const char* const kOrtSessionOptionsConfigResultCacheTtlMillis = "session.result_cache.ttl_ms";
+
+// Sets a budget for the memory of the intermediate values of a Run() call. A request whose planned peak exceeds the
+// budget is executed as a sequence of smaller requests over slices of the batch (axis 0 of every input), and the
+// outputs of the slices are concatenated. The peak of a batch size is taken from the memory pattern planned for it,
+// so memory patterns must be enabled. Before a pattern exists, the slice size is estimated from the peak of the
+// largest pattern seen per batch entry, starting with a single batch entry.
+// The budget applies to each request on its own, and the slices of a request share its run deadline. Requests are only
+// split if axis 0 of every input and output of the model is the same symbolic dimension. Requests with inputs that
+// are not CPU tensors sharing the size of axis 0, or with pre-allocated outputs, are executed unsplit. A request that
+// must be split fails if one of its outputs doesn't have the batch size on axis 0. Runs with an IOBinding and prepared
+// runs are not supported with a budget.
+// Option values:
+// - "0": No budget. [DEFAULT]
+// - Any positive integer: the budget in bytes.
+static const char* const kOrtSessionOptionsConfigActivationMemoryBudgetBytes = "session.activation_memory_budget_bytes";
+
+// Gives the session a weighted share of its intra-op thread pool. This is meant for sessions using the global thread
+// pools of an environment. While runs of more than one session with a share are in progress on the pool, a parallel
+// loop of a session is run by at most its weighted part of the pool's threads, so the sessions' loops run side by side
+// instead of each one claiming all threads. The CPU time of the session's runs is accounted to its share.
+// Option values:
+// - "0": The session has no share, and its parallel loops may use all threads of the pool. [DEFAULT]
+// - Any positive integer: the weight of the session's share.
+static const char* const kOrtSessionOptionsConfigThreadPoolShareWeight = "session.thread_pool_share_weight";
+
+// Configure how long the intra-op threads spin before blocking when they run out of work, if spinning is allowed.
+// Spinning keeps a core busy, but saves the latency of waking a blocked thread when work arrives during the spin.
+// With "adaptive", each thread spins for as long as three quarters of the recent gaps between its tasks lasted, and
+// blocks right away if those gaps were longer than a few milliseconds, e.g. between requests at a low request rate.
+// Only used by the session's own intra-op thread pool.
+// Option values:
+// - "fixed": spin for a fixed number of iterations. [DEFAULT]
+// - "adaptive": spin for a duration learned from the recent gaps between tasks.
+static const char* const kOrtSessionOptionsConfigIntraOpSpinMode = "session.intra_op.spin_mode";
+
+// Path of a file with the measured costs of the parallel loops of the kernels, which replace the costs the kernels
+// estimate when choosing how many threads run a loop and how many iterations each block of the loop gets. A loop is
+// keyed by its op, the size of the op's inputs and its order among the op's loops. Loops that are not in the table use
+// the estimated costs. The table is read when the session is initialized, if the file exists, and is written by
+// calibration. As the costs are measured on one machine, the file is meant to be kept alongside the model for that
+// machine.
+// Option values:
+// - "": The estimated costs are used, unless the loops are calibrated. [DEFAULT]
+// - A file path.
+static const char* const kOrtSessionOptionsConfigLoopCostTableFile = "session.loop_cost_table_file";
+
+// Measure the costs of the parallel loops of the kernels during the warm-up runs of
+// "session.warm_up.input_shapes", which must be set. Each shape set is run twice, and the loops are measured in the
+// second run. The costs measured replace the table in "session.loop_cost_table_file", if set, and are used by the
+// runs of the session.
+// Option values:
+// - "0": Not calibrated. [DEFAULT]
+// - "1": Calibrated during warm-up.
+static const char* const kOrtSessionOptionsConfigLoopCostCalibration = "session.loop_cost_calibration";
+
+// Pin the threads of the session's intra-op thread pool to a class of cores on CPUs with cores of different
+// performance, such as the P-cores and E-cores of hybrid x86 CPUs. E.g. a background session can be kept on the
+// efficiency cores, so that they don't slow down a latency sensitive session running on the performance cores. Unless
+// the number of intra-op threads is set, the pool gets a thread per physical core of the class. Nothing is pinned on
+// CPUs whose cores are alike, or whose core performance is not known.
+// Regardless of this option, the parallel loops of a thread pool that runs on both classes of cores are split into
+// smaller parts, so that the faster cores run more of them.
+// Option values:
+// - "all": The threads may run on all cores. [DEFAULT]
+// - "performance": The threads are pinned to the cores that are not efficiency cores.
+// - "efficiency": The threads are pinned to the efficiency cores.
+// Pinning threads requires per session threads and can't be combined with "session.intra_op_thread_affinities" or
+// "session.numa_node". The calling thread is not pinned.
+static const char* const kOrtSessionOptionsConfigIntraOpCoreClass = "session.intra_op.core_class";
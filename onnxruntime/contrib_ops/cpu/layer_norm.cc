@@ -9,15 +9,18 @@
 namespace onnxruntime {
 namespace contrib {
 // original LayerNormalization contrib op (incorrectly using onnx domain though)
+// Y can reuse the buffer of X as each row of X is read before the same row of Y is written
 #define REGISTER_CONTRIB_KERNELS(T)                                                                         \
   ONNX_OPERATOR_VERSIONED_TYPED_KERNEL_EX(LayerNormalization, kOnnxDomain, 1, 16, T, kCpuExecutionProvider, \
                                           KernelDefBuilder()                                                \
+                                              .MayInplace(0, 0)                                             \
                                               .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())        \
                                               .TypeConstraint("U", DataTypeImpl::GetTensorType<T>())        \
                                               .TypeConstraint("V", DataTypeImpl::GetTensorType<T>()),       \
                                           LayerNorm<false>);                                                \
   ONNX_OPERATOR_TYPED_KERNEL_EX(SimplifiedLayerNormalization, kOnnxDomain, 1, T, kCpuExecutionProvider,     \
                                 KernelDefBuilder()                                                          \
+                                    .MayInplace(0, 0)                                                       \
                                     .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())                  \
                                     .TypeConstraint("U", DataTypeImpl::GetTensorType<T>())                  \
                                     .TypeConstraint("V", DataTypeImpl::GetTensorType<T>()),                 \
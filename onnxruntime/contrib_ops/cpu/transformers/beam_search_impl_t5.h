@@ -173,7 +173,9 @@ Status BeamSearchT5<T>::Execute(const FeedsFetchesManager& encoder_feeds_fetches
                                              ExecutionMode::ORT_SEQUENTIAL,
                                              this->context_.GetTerminateFlag(),
                                              this->context_.Logger(),
-                                             this->ort_stream_));
+                                             this->ort_stream_,
+                                             /*sync_subgraph_fetches*/ false,
+                                             this->context_.GetDeadline()));
 
 #ifdef DEBUG_GENERATION
   const IConsoleDumper* dumper = this->GetConsoleDumper();
@@ -324,7 +326,9 @@ Status BeamSearchT5<T>::Execute(const FeedsFetchesManager& encoder_feeds_fetches
                                     ExecutionMode::ORT_SEQUENTIAL,
                                     this->context_.GetTerminateFlag(),
                                     this->context_.Logger(),
-                                    this->ort_stream_);
+                                    this->ort_stream_,
+                                    /*sync_subgraph_fetches*/ false,
+                                    this->context_.GetDeadline());
 
     ORT_RETURN_IF_ERROR(status);
 
@@ -166,7 +166,9 @@ Status BeamSearchWhisper<T>::Execute(const FeedsFetchesManager& encoder_feeds_fe
                                              ExecutionMode::ORT_SEQUENTIAL,
                                              this->context_.GetTerminateFlag(),
                                              this->context_.Logger(),
-                                             this->ort_stream_));
+                                             this->ort_stream_,
+                                             /*sync_subgraph_fetches*/ false,
+                                             this->context_.GetDeadline()));
 
 #ifdef DEBUG_GENERATION
   const IConsoleDumper* dumper = this->GetConsoleDumper();
@@ -312,7 +314,9 @@ Status BeamSearchWhisper<T>::Execute(const FeedsFetchesManager& encoder_feeds_fe
                                     ExecutionMode::ORT_SEQUENTIAL,
                                     this->context_.GetTerminateFlag(),
                                     this->context_.Logger(),
-                                    this->ort_stream_);
+                                    this->ort_stream_,
+                                    /*sync_subgraph_fetches*/ false,
+                                    this->context_.GetDeadline());
 
     ORT_RETURN_IF_ERROR(status);
 
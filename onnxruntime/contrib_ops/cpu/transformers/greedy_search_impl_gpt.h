@@ -292,7 +292,9 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
                                       ExecutionMode::ORT_SEQUENTIAL,
                                       this->context_.GetTerminateFlag(),
                                       this->context_.Logger(),
-                                      this->ort_stream_);
+                                      this->ort_stream_,
+                                      /*sync_subgraph_fetches*/ false,
+                                      this->context_.GetDeadline());
     } else {
 #ifdef DEBUG_NODE_INPUTS_OUTPUTS
       const_cast<SessionState&>(this->decoder_session_state_).IncrementGraphExecutionCounter();
@@ -305,7 +307,9 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
                                       ExecutionMode::ORT_SEQUENTIAL,
                                       this->context_.GetTerminateFlag(),
                                       this->context_.Logger(),
-                                      this->ort_stream_);
+                                      this->ort_stream_,
+                                      /*sync_subgraph_fetches*/ false,
+                                      this->context_.GetDeadline());
     }
 
     ORT_RETURN_IF_ERROR(status);
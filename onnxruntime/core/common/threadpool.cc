@@ -13,12 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <locale>
 #include <memory>
 #include <optional>
+#include <ostream>
 
 #include "core/platform/threadpool.h"
 #include "core/common/common.h"
 #include "core/common/cpuid_info.h"
+#include "core/common/parse_string.h"
 #include "core/common/eigen_common_wrapper.h"
 #include "core/platform/EigenNonBlockingThreadPool.h"
 #include "core/platform/ort_mutex.h"
@@ -230,11 +236,37 @@ void ThreadPoolProfiler::LogRun(int thread_idx) {
   }
 }
 
+void ThreadPoolProfiler::LogSteal(int thread_idx) {
+  if (enabled_) {
+    child_thread_stats_[thread_idx].num_steal_++;
+  }
+}
+
+void ThreadPoolProfiler::LogIdleStart(int thread_idx) {
+  if (enabled_) {
+    child_thread_stats_[thread_idx].idle_start_point_ = Clock::now();
+    child_thread_stats_[thread_idx].idle_ = true;
+  }
+}
+
+void ThreadPoolProfiler::LogIdleEnd(int thread_idx) {
+  auto& stat = child_thread_stats_[thread_idx];
+  // the profiler may have been started while the thread was idle
+  if (stat.idle_) {
+    if (enabled_) {
+      stat.idle_us_ += TimeDiffMicroSeconds(stat.idle_start_point_, Clock::now());
+    }
+    stat.idle_ = false;
+  }
+}
+
 std::string ThreadPoolProfiler::DumpChildThreadStat() {
   std::stringstream ss;
   for (int i = 0; i < num_threads_; ++i) {
     ss << "\"" << child_thread_stats_[i].thread_id_ << "\": {"
        << "\"num_run\": " << child_thread_stats_[i].num_run_ << ", "
+       << "\"num_steal\": " << child_thread_stats_[i].num_steal_ << ", "
+       << "\"idle_us\": " << child_thread_stats_[i].idle_us_ << ", "
        << "\"core\": " << child_thread_stats_[i].core_ << "}"
        << (i == num_threads_ - 1 ? "" : ",");
   }
@@ -389,6 +421,30 @@ ThreadPool::ThreadPool(Env* env,
       assert(thread_options_.affinities.size() >= size_t(threads_to_create));
     }
 
+    // the pool is hybrid if its threads may run on both efficiency cores and faster cores
+    auto capacities = env->GetProcessorCapacities();
+    bool has_efficiency_processors = false;
+    bool has_performance_processors = false;
+    auto add_processor = [&](int processor) {
+      if (processor >= 0 && static_cast<size_t>(processor) < capacities.size() && capacities[processor] > 0) {
+        const bool is_efficiency_processor = IsEfficiencyProcessorCapacity(capacities[processor]);
+        has_efficiency_processors |= is_efficiency_processor;
+        has_performance_processors |= !is_efficiency_processor;
+      }
+    };
+    if (thread_options_.affinities.empty()) {
+      for (int processor = 0, end = static_cast<int>(capacities.size()); processor < end; ++processor) {
+        add_processor(processor);
+      }
+    } else {
+      for (const auto& affinity : thread_options_.affinities) {
+        std::for_each(affinity.begin(), affinity.end(), add_processor);
+      }
+    }
+    if (has_efficiency_processors && has_performance_processors) {
+      processor_capacities_ = std::move(capacities);
+    }
+
     extended_eigen_threadpool_ =
         std::make_unique<ThreadPoolTempl<Env> >(name,
                                                 threads_to_create,
@@ -415,6 +471,13 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     return;
   }
 
+  // the pool's threads are needed by a high priority run
+  const RunPriority loop_priority = CurrentRunPriority();
+  if (ShouldYieldToHighPriority(loop_priority)) {
+    fn(0, total);
+    return;
+  }
+
   auto d_of_p = DegreeOfParallelism(this);
   if (thread_options_.dynamic_block_base_ <= 0) {
     // Split the work across threads in the pool.  Each work item will run a loop claiming iterations,
@@ -432,6 +495,10 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
       while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, block_size)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
+        // Work item 0 runs in the thread that entered the loop and claims any iterations left behind.
+        if (idx != 0 && ShouldYieldToHighPriority(loop_priority)) {
+          break;
+        }
       }
     };
     // Run the work in the thread pool (and in the current thread).  Synchronization with helping
@@ -455,6 +522,9 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
         if (b > 1) {
           b = static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(todo) / num_of_blocks)));
         }
+        if (idx != 0 && ShouldYieldToHighPriority(loop_priority)) {
+          break;
+        }
       }
     };
     // Distribute task among all threads in the pool, reduce number of work items if
@@ -495,6 +565,251 @@ std::string ThreadPool::StopProfiling() {
 
 namespace {
 thread_local std::optional<ThreadPoolParallelSection> current_parallel_section;
+// Set while the thread runs its part of a parallel loop.
+thread_local bool in_parallel_loop = false;
+thread_local ThreadPool::RunPriority current_run_priority = ThreadPool::RunPriority::kNormal;
+// The share the thread's time is accounted to, set in the scope of a run of the share, and while a pool thread
+// helps with a parallel loop of the share.
+thread_local ThreadPool::Share* current_share = nullptr;
+// The innermost scope keying the parallel loops the thread enters.
+thread_local ThreadPool::ScopedLoopCost* current_loop_cost = nullptr;
+}  // namespace
+
+ThreadPool::ScopedRunPriority::ScopedRunPriority(ThreadPool* tp, RunPriority priority)
+    : tp_(tp), priority_(priority), prev_priority_(current_run_priority) {
+  current_run_priority = priority_;
+  if (priority_ == RunPriority::kHigh) {
+    BeginHighPriorityRun(tp_);
+  }
+}
+
+ThreadPool::ScopedRunPriority::~ScopedRunPriority() {
+  if (priority_ == RunPriority::kHigh) {
+    EndHighPriorityRun(tp_);
+  }
+  current_run_priority = prev_priority_;
+}
+
+ThreadPool::RunPriority ThreadPool::CurrentRunPriority() {
+  return current_run_priority;
+}
+
+void ThreadPool::BeginHighPriorityRun(ThreadPool* tp) {
+  if (tp) {
+    tp->num_high_priority_runs_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ThreadPool::EndHighPriorityRun(ThreadPool* tp) {
+  if (tp) {
+    tp->num_high_priority_runs_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+ThreadPool::Share::Share(ThreadPool* tp, int weight) : tp_(tp), weight_(weight) {
+  ORT_ENFORCE(weight_ > 0, "The weight of a thread pool share must be positive: ", weight_);
+}
+
+ThreadPool::Share::~Share() {
+  assert(num_runs_.load(std::memory_order_relaxed) == 0);
+}
+
+ThreadPool::ShareStats ThreadPool::Share::GetStats() const {
+  ShareStats stats;
+  stats.num_loops = num_loops_.load(std::memory_order_relaxed);
+  stats.num_limited_loops = num_limited_loops_.load(std::memory_order_relaxed);
+  stats.cpu_time = std::chrono::nanoseconds(cpu_time_ns_.load(std::memory_order_relaxed));
+  return stats;
+}
+
+ThreadPool::ScopedShare::ScopedShare(Share* share) : share_(share), prev_share_(current_share) {
+  if (share_ == nullptr) {
+    return;
+  }
+
+  current_share = share_;
+  start_ = std::chrono::steady_clock::now();
+  if (share_->num_runs_.fetch_add(1, std::memory_order_relaxed) == 0 && share_->tp_) {
+    share_->tp_->active_share_weight_.fetch_add(share_->weight_, std::memory_order_relaxed);
+  }
+}
+
+ThreadPool::ScopedShare::~ScopedShare() {
+  if (share_ == nullptr) {
+    return;
+  }
+
+  if (share_->num_runs_.fetch_sub(1, std::memory_order_relaxed) == 1 && share_->tp_) {
+    share_->tp_->active_share_weight_.fetch_sub(share_->weight_, std::memory_order_relaxed);
+  }
+
+  // the time of a nested run is part of the enclosing run of the same share
+  if (prev_share_ != share_) {
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    share_->cpu_time_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                   std::memory_order_relaxed);
+  }
+
+  current_share = prev_share_;
+}
+
+unsigned ThreadPool::GetShareOfWorkItems(const Share& share, unsigned n) const {
+  const int active_weight = active_share_weight_.load(std::memory_order_relaxed);
+  if (active_weight <= share.weight_) {
+    return n;
+  }
+
+  const int64_t num_threads_inc_main = static_cast<int64_t>(NumThreads()) + 1;
+  const int64_t share_of_threads = (num_threads_inc_main * share.weight_ + active_weight - 1) / active_weight;
+  return static_cast<unsigned>(std::min<int64_t>(n, std::max<int64_t>(share_of_threads, 1)));
+}
+
+ThreadPool::LoopCostTable::LoopCostTable(double cycles_per_ns) : cycles_per_ns_(cycles_per_ns) {
+  ORT_ENFORCE(cycles_per_ns_ > 0, "Invalid processor frequency: ", cycles_per_ns_, " cycles per nanosecond");
+}
+
+uint64_t ThreadPool::LoopCostTable::HashKey(std::string_view piece, uint64_t prefix_hash) {
+  // FNV-1a
+  uint64_t hash = prefix_hash;
+  for (const char c : piece) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t ThreadPool::LoopCostTable::HashKey(int64_t value, uint64_t prefix_hash) {
+  char digits[20];
+  size_t num_digits = 0;
+  do {
+    digits[sizeof(digits) - ++num_digits] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0 && num_digits < sizeof(digits));
+  return HashKey(std::string_view(digits + sizeof(digits) - num_digits, num_digits), prefix_hash);
+}
+
+void ThreadPool::LoopCostTable::Record(const std::string& key, std::chrono::nanoseconds total_time,
+                                       std::ptrdiff_t num_iterations) {
+  if (num_iterations <= 0) {
+    return;
+  }
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto& entry = entries_[key];
+  entry.total_ns += static_cast<double>(total_time.count());
+  entry.num_iterations += static_cast<double>(num_iterations);
+}
+
+bool ThreadPool::LoopCostTable::TryGetCost(const std::string& key, double& ns_per_iteration) const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+
+  ns_per_iteration = it->second.total_ns / it->second.num_iterations;
+  return true;
+}
+
+void ThreadPool::LoopCostTable::Freeze() {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  frozen_costs_.clear();
+  frozen_costs_.reserve(entries_.size());
+  for (const auto& [key, entry] : entries_) {
+    frozen_costs_.emplace_back(HashKey(key), entry.total_ns / entry.num_iterations * cycles_per_ns_);
+  }
+  std::sort(frozen_costs_.begin(), frozen_costs_.end());
+}
+
+bool ThreadPool::LoopCostTable::TryGetFrozenCost(uint64_t key_hash, double& cycles_per_iteration) const {
+  auto it = std::lower_bound(frozen_costs_.begin(), frozen_costs_.end(), key_hash,
+                             [](const std::pair<uint64_t, double>& entry, uint64_t hash) { return entry.first < hash; });
+  if (it == frozen_costs_.end() || it->first != key_hash) {
+    return false;
+  }
+
+  cycles_per_iteration = it->second;
+  return true;
+}
+
+size_t ThreadPool::LoopCostTable::Size() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return entries_.size();
+}
+
+Status ThreadPool::LoopCostTable::Save(std::ostream& stream) const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  stream.imbue(std::locale::classic());
+  stream.precision(std::numeric_limits<double>::max_digits10);
+  for (const auto& [key, entry] : entries_) {
+    stream << key << '\t' << entry.total_ns / entry.num_iterations << '\t' << entry.num_iterations << '\n';
+  }
+
+  ORT_RETURN_IF(!stream, "Failed to write the loop cost table.");
+  return Status::OK();
+}
+
+Status ThreadPool::LoopCostTable::Load(std::istream& stream) {
+  std::map<std::string, Entry> loaded;
+  std::string line;
+  for (size_t line_number = 1; std::getline(stream, line); ++line_number) {
+    if (line.empty()) {
+      continue;
+    }
+
+    const auto cost_separator = line.find('\t');
+    const auto iterations_separator =
+        cost_separator == std::string::npos ? std::string::npos : line.find('\t', cost_separator + 1);
+    double ns_per_iteration = 0;
+    double num_iterations = 0;
+    ORT_RETURN_IF(iterations_separator == std::string::npos ||
+                      !TryParseStringWithClassicLocale(
+                          std::string_view(line).substr(cost_separator + 1, iterations_separator - cost_separator - 1),
+                          ns_per_iteration) ||
+                      !TryParseStringWithClassicLocale(std::string_view(line).substr(iterations_separator + 1),
+                                                       num_iterations) ||
+                      ns_per_iteration < 0 || num_iterations <= 0,
+                  "Invalid loop cost table entry on line ", line_number, ": ", line);
+
+    auto& entry = loaded[line.substr(0, cost_separator)];
+    entry.total_ns += ns_per_iteration * num_iterations;
+    entry.num_iterations += num_iterations;
+  }
+
+  ORT_RETURN_IF(stream.bad(), "Failed to read the loop cost table.");
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  for (const auto& [key, loaded_entry] : loaded) {
+    auto& entry = entries_[key];
+    entry.total_ns += loaded_entry.total_ns;
+    entry.num_iterations += loaded_entry.num_iterations;
+  }
+
+  return Status::OK();
+}
+
+ThreadPool::ScopedLoopCost::ScopedLoopCost(LoopCostTable* table, std::string key, bool calibrate)
+    : table_(table),
+      key_(std::move(key)),
+      key_hash_(LoopCostTable::HashKey(key_)),
+      calibrate_(calibrate),
+      prev_loop_cost_(current_loop_cost) {
+  if (table_) {
+    current_loop_cost = this;
+  }
+}
+
+ThreadPool::ScopedLoopCost::ScopedLoopCost(LoopCostTable* table, uint64_t key_hash)
+    : table_(table), key_hash_(key_hash), calibrate_(false), prev_loop_cost_(current_loop_cost) {
+  if (table_) {
+    current_loop_cost = this;
+  }
+}
+
+ThreadPool::ScopedLoopCost::~ScopedLoopCost() {
+  if (table_) {
+    current_loop_cost = prev_loop_cost_;
+  }
 }
 
 ThreadPool::ParallelSection::ParallelSection(ThreadPool* tp) {
@@ -516,8 +831,47 @@ ThreadPool::ParallelSection::~ParallelSection() {
 }
 
 void ThreadPool::RunInParallel(std::function<void(unsigned idx)> fn, unsigned n, std::ptrdiff_t block_size) {
+  Share* share = current_share;
+  if (share) {
+    share->num_loops_.fetch_add(1, std::memory_order_relaxed);
+  }
+
   if (underlying_threadpool_) {
-    if (current_parallel_section.has_value()) {
+    if (share) {
+      // leave the rest of the pool to the other shares with runs in progress
+      if (share->tp_ == this) {
+        const unsigned share_n = GetShareOfWorkItems(*share, n);
+        if (share_n < n) {
+          share->num_limited_loops_.fetch_add(1, std::memory_order_relaxed);
+          n = share_n;
+        }
+      }
+
+      // pool threads helping with the loop account their time to the share, and loops nested in the work items
+      // are loops of the share. The time of a thread that is already accounted is not counted twice.
+      fn = [share, fn = std::move(fn)](unsigned idx) {
+        if (current_share != nullptr) {
+          fn(idx);
+          return;
+        }
+
+        current_share = share;
+        const auto start = std::chrono::steady_clock::now();
+        auto reset_current_share = gsl::finally([share, start]() {
+          const auto elapsed = std::chrono::steady_clock::now() - start;
+          share->cpu_time_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                        std::memory_order_relaxed);
+          current_share = nullptr;
+        });
+        fn(idx);
+      };
+    }
+
+    const bool nested = in_parallel_loop;
+    in_parallel_loop = true;
+    auto reset_in_parallel_loop = gsl::finally([nested]() { in_parallel_loop = nested; });
+    // a loop nested in a loop of the parallel section can't share the section, so it runs on its own
+    if (current_parallel_section.has_value() && !nested) {
       underlying_threadpool_->RunInParallelSection(*current_parallel_section,
                                                    std::move(fn),
                                                    n, block_size);
@@ -614,6 +968,35 @@ void ThreadPool::ParallelFor(std::ptrdiff_t n, const TensorOpCost& c,
                              const std::function<void(std::ptrdiff_t first, std::ptrdiff_t)>& f) {
   ORT_ENFORCE(n >= 0);
   Eigen::TensorOpCost cost{c.bytes_loaded, c.bytes_stored, c.compute_cycles};
+  ScopedLoopCost* const scope_loop_cost = current_loop_cost;
+  ScopedLoopCost* loop_cost = in_parallel_loop ? nullptr : scope_loop_cost;
+  // loops nested in the iterations are part of the cost of the loop, whichever thread runs them
+  current_loop_cost = nullptr;
+  auto reset_current_loop_cost = gsl::finally([scope_loop_cost]() { current_loop_cost = scope_loop_cost; });
+  if (loop_cost) {
+    const int loop_index = loop_cost->num_loops_++;
+    if (loop_cost->calibrate_) {
+      const std::string key = loop_cost->key_ + "#" + std::to_string(loop_index);
+      // the measured loop itself is scheduled with the estimated cost
+      std::atomic<int64_t> total_ns{0};
+      ParallelFor(n, c, [&f, &total_ns](std::ptrdiff_t first, std::ptrdiff_t last) {
+        const auto start = std::chrono::steady_clock::now();
+        f(first, last);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        total_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                           std::memory_order_relaxed);
+      });
+      loop_cost->table_->Record(key, std::chrono::nanoseconds(total_ns.load(std::memory_order_relaxed)), n);
+      return;
+    }
+
+    const uint64_t key_hash = LoopCostTable::HashKey(loop_index, LoopCostTable::HashKey("#", loop_cost->key_hash_));
+    double cycles_per_iteration = 0;
+    if (loop_cost->table_->TryGetFrozenCost(key_hash, cycles_per_iteration)) {
+      cost = Eigen::TensorOpCost{0, 0, cycles_per_iteration};
+    }
+  }
+
   auto d_of_p = DegreeOfParallelism(this);
   // Compute small problems directly in the caller thread.
   if ((!ShouldParallelizeLoop(n)) ||
@@ -639,7 +1022,7 @@ int ThreadPool::DegreeOfParallelism(const concurrency::ThreadPool* tp) {
   // When not using OpenMP, we parallelise over the N threads created by the pool
   // tp, plus 1 for the thread entering a loop.
   if (tp) {
-    if (tp->force_hybrid_ || CPUIDInfo::GetCPUIDInfo().IsHybrid()) {
+    if (tp->force_hybrid_ || CPUIDInfo::GetCPUIDInfo().IsHybrid() || !tp->processor_capacities_.empty()) {
       return ((tp->NumThreads() + 1)) * TaskGranularityFactor;
     } else {
       return ((tp->NumThreads() + 1));
@@ -649,6 +1032,17 @@ int ThreadPool::DegreeOfParallelism(const concurrency::ThreadPool* tp) {
   }
 }
 
+std::ptrdiff_t ThreadPool::GetBatchChunkSize(std::ptrdiff_t total, std::ptrdiff_t num_batches) const {
+  // a chunk of the fastest cores is a TaskGranularityFactor part of an equal share of the iterations
+  const std::ptrdiff_t max_chunk_size = std::max<std::ptrdiff_t>(total / (num_batches * TaskGranularityFactor), 1);
+  const uint32_t processor = CPUIDInfo::GetCPUIDInfo().GetCurrentCoreIdx();
+  if (processor >= processor_capacities_.size() || processor_capacities_[processor] <= 0) {
+    return max_chunk_size;
+  }
+
+  return std::max<std::ptrdiff_t>(max_chunk_size * processor_capacities_[processor] / kMaxProcessorCapacity, 1);
+}
+
 void ThreadPool::StartProfiling(concurrency::ThreadPool* tp) {
   if (tp) {
     tp->StartProfiling();
@@ -675,6 +1069,19 @@ void ThreadPool::DisableSpinning() {
   }
 }
 
+ThreadPool::SpinStats ThreadPool::GetSpinStats(const ThreadPool* tp) {
+  SpinStats stats;
+  if (tp && tp->extended_eigen_threadpool_) {
+    const auto pool_stats = tp->extended_eigen_threadpool_->GetSpinStats();
+    stats.num_spin_hits = pool_stats.num_spin_hits;
+    stats.num_blocks = pool_stats.num_blocks;
+    stats.num_wake_ups = pool_stats.num_wake_ups;
+    stats.spin_time = pool_stats.spin_time;
+    stats.wake_up_latency = pool_stats.wake_up_latency;
+  }
+  return stats;
+}
+
 // Return the number of threads created by the pool.
 int ThreadPool::NumThreads() const {
   if (underlying_threadpool_) {
@@ -1162,6 +1162,8 @@ class PlannerImpl {
                     value_consumer_map_[input_arg_index].insert(value_consumer_map_[output_idx_global].begin(),
                                                                 value_consumer_map_[output_idx_global].end());
                     reused.insert(input_arg_index);
+                    // kernels may declare several inputs an output can be computed in place of
+                    break;
                   }
                 }
               }
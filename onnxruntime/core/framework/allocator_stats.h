@@ -22,6 +22,10 @@ struct AllocatorStats {
                                   // is known. Certain allocator may return 0 to indicate the limit is
                                   // unknown.
   int64_t bytes_limit;
+  int64_t num_thread_cache_hits;    // Number of allocations served from a thread cache (BFCArena only)
+  int64_t num_thread_cache_misses;  // Number of cacheable allocations the thread caches couldn't serve
+  int64_t thread_cache_bytes;       // Number of bytes of free chunks held by thread caches. Counted in bytes_in_use.
+  int64_t huge_page_bytes;          // Number of allocated bytes backed by huge pages (HugePageCPUAllocator only)
 
   AllocatorStats() { Clear(); }
 
@@ -35,6 +39,10 @@ struct AllocatorStats {
     this->max_alloc_size = 0;
     this->bytes_limit = 0;
     this->total_allocated_bytes = 0;
+    this->num_thread_cache_hits = 0;
+    this->num_thread_cache_misses = 0;
+    this->thread_cache_bytes = 0;
+    this->huge_page_bytes = 0;
   }
 
   std::string DebugString() const {
@@ -47,7 +55,11 @@ struct AllocatorStats {
        << "NumReserves:              " << this->num_reserves << "\n"
        << "NumArenaExtensions:       " << this->num_arena_extensions << "\n"
        << "NumArenaShrinkages:       " << this->num_arena_shrinkages << "\n"
-       << "MaxAllocSize:             " << this->max_alloc_size << "\n";
+       << "MaxAllocSize:             " << this->max_alloc_size << "\n"
+       << "NumThreadCacheHits:       " << this->num_thread_cache_hits << "\n"
+       << "NumThreadCacheMisses:     " << this->num_thread_cache_misses << "\n"
+       << "ThreadCacheBytes:         " << this->thread_cache_bytes << "\n"
+       << "HugePageBytes:            " << this->huge_page_bytes << "\n";
     return ss.str();
   }
 };
@@ -3,16 +3,23 @@
 
 #include "core/framework/allocator.h"
 #include "core/framework/bfc_arena.h"
+#include <algorithm>
+#include <atomic>
 #include <type_traits>
 
 namespace onnxruntime {
+namespace {
+std::atomic<uint64_t> next_arena_id{0};
+}  // namespace
+
 BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
                    size_t total_memory,
                    ArenaExtendStrategy arena_extend_strategy,
                    int initial_chunk_size_bytes,
                    int max_dead_bytes_per_chunk,
                    int initial_growth_chunk_size_bytes,
-                   int64_t max_power_of_two_extend_bytes)
+                   int64_t max_power_of_two_extend_bytes,
+                   size_t max_thread_cache_bytes)
     : IAllocator(OrtMemoryInfo(resource_allocator->Info().name,
                                OrtAllocatorType::OrtArenaAllocator,
                                resource_allocator->Info().device,
@@ -25,12 +32,15 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       initial_chunk_size_bytes_(initial_chunk_size_bytes),
       max_dead_bytes_per_chunk_(max_dead_bytes_per_chunk),
       initial_growth_chunk_size_bytes_(initial_growth_chunk_size_bytes),
-      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes) {
+      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes),
+      max_thread_cache_bytes_(max_thread_cache_bytes),
+      arena_id_(next_arena_id++) {
   LOGS_DEFAULT(INFO) << "Creating BFCArena for " << device_allocator_->Info().name
                      << " with following configs: initial_chunk_size_bytes: " << initial_chunk_size_bytes_
                      << " max_dead_bytes_per_chunk: " << max_dead_bytes_per_chunk_
                      << " initial_growth_chunk_size_bytes: " << initial_growth_chunk_size_bytes_
                      << " max_power_of_two_extend_bytes: " << max_power_of_two_extend_bytes_
+                     << " max_thread_cache_bytes: " << max_thread_cache_bytes_
                      << " memory limit: " << total_memory
                      << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy);
 
@@ -78,6 +88,20 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
 }
 
 BFCArena::~BFCArena() {
+  // detach the caches that threads still hold. waits for a thread that is returning its cache.
+  std::vector<std::shared_ptr<ThreadCache>> caches;
+  {
+    std::lock_guard<OrtMutex> caches_lock(thread_caches_mutex_);
+    caches = thread_caches_;
+  }
+
+  for (auto& cache : caches) {
+    std::lock_guard<OrtMutex> lock(cache->mutex);
+    cache->arena = nullptr;
+    cache->free_chunks.clear();
+    cache->size_classes.clear();
+  }
+
   for (const auto& region : region_manager_.regions()) {
     device_allocator_->Free(region.ptr());
   }
@@ -269,9 +293,224 @@ size_t BFCArena::RoundedBytes(size_t bytes) {
 }
 
 void* BFCArena::Alloc(size_t size) {
+  if (max_thread_cache_bytes_ > 0) {
+    return AllocateThroughThreadCache(size);
+  }
   return AllocateRawInternal(size, false, nullptr, false, nullptr);
 }
 
+struct BFCArena::ThreadCachesOfThread {
+  InlinedHashMap<uint64_t, std::shared_ptr<ThreadCache>> caches;
+
+  ~ThreadCachesOfThread() {
+    for (auto& entry : caches) {
+      ReleaseThreadCache(*entry.second);
+    }
+  }
+};
+
+BFCArena::ThreadCache& BFCArena::GetThreadCache() {
+  thread_local ThreadCachesOfThread caches_of_thread;
+  auto it = caches_of_thread.caches.find(arena_id_);
+  if (it != caches_of_thread.caches.end()) {
+    return *it->second;
+  }
+
+  // arena ids are never reused, so drop the caches of destroyed arenas
+  for (auto entry = caches_of_thread.caches.begin(); entry != caches_of_thread.caches.end();) {
+    std::lock_guard<OrtMutex> lock(entry->second->mutex);
+    if (entry->second->arena == nullptr) {
+      caches_of_thread.caches.erase(entry++);
+    } else {
+      ++entry;
+    }
+  }
+
+  auto cache = std::make_shared<ThreadCache>();
+  cache->arena = this;
+  {
+    std::lock_guard<OrtMutex> lock(thread_caches_mutex_);
+    thread_caches_.push_back(cache);
+  }
+  return *caches_of_thread.caches.emplace(arena_id_, std::move(cache)).first->second;
+}
+
+void BFCArena::SyncThreadCacheGeneration(ThreadCache& cache) {
+  const uint64_t generation = thread_cache_generation_.load(std::memory_order_acquire);
+  if (cache.generation != generation) {
+    cache.size_classes.clear();
+    cache.generation = generation;
+  }
+}
+
+// static
+void BFCArena::TakeCachedChunks(ThreadCache& cache, std::vector<void*>& chunks) {
+  for (auto& size_class_chunks : cache.free_chunks) {
+    chunks.insert(chunks.end(), size_class_chunks.second.begin(), size_class_chunks.second.end());
+  }
+  cache.free_chunks.clear();
+  cache.num_bytes = 0;
+}
+
+// static
+void BFCArena::ReleaseThreadCache(ThreadCache& cache) {
+  std::lock_guard<OrtMutex> cache_lock(cache.mutex);
+  BFCArena* arena = cache.arena;
+  if (arena == nullptr) {
+    return;
+  }
+
+  std::vector<void*> chunks;
+  TakeCachedChunks(cache, chunks);
+  {
+    std::lock_guard<OrtMutex> lock(arena->lock_);
+    for (void* chunk : chunks) {
+      arena->DeallocateRawInternal(chunk);
+    }
+  }
+
+  // the arena's destructor waits for cache.mutex before it finishes, so the arena is alive until here
+  std::lock_guard<OrtMutex> caches_lock(arena->thread_caches_mutex_);
+  arena->num_released_thread_cache_hits_ += cache.num_hits;
+  arena->num_released_thread_cache_misses_ += cache.num_misses;
+  auto& caches = arena->thread_caches_;
+  caches.erase(std::remove_if(caches.begin(), caches.end(),
+                              [&cache](const std::shared_ptr<ThreadCache>& c) { return c.get() == &cache; }),
+               caches.end());
+  cache.arena = nullptr;
+}
+
+void* BFCArena::AllocateThroughThreadCache(size_t num_bytes) {
+  if (num_bytes == 0) {
+    return AllocateRawInternal(num_bytes, false, nullptr, false, nullptr);
+  }
+
+  const size_t size_class = ThreadCacheSizeClass(RoundedBytes(num_bytes));
+  if (size_class > kMaxThreadCachedChunkSize || size_class > max_thread_cache_bytes_) {
+    return AllocateFlushingThreadCachesOnFailure(num_bytes);
+  }
+
+  void* ptr = nullptr;
+  ThreadCache& cache = GetThreadCache();
+  {
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    auto it = cache.free_chunks.find(size_class);
+    if (it != cache.free_chunks.end() && !it->second.empty()) {
+      ptr = it->second.back();
+      it->second.pop_back();
+      cache.num_bytes -= size_class;
+      ++cache.num_hits;
+    } else {
+      ++cache.num_misses;
+    }
+  }
+
+  if (ptr == nullptr) {
+    // allocate the whole size class so that the chunk can serve any allocation of the class once it's cached
+    ptr = AllocateFlushingThreadCachesOnFailure(size_class);
+    std::lock_guard<OrtMutex> lock(lock_);
+    ChunkFromHandle(region_manager_.get_handle(ptr))->thread_cache_size_class = size_class;
+  }
+
+  std::lock_guard<OrtMutex> lock(cache.mutex);
+  SyncThreadCacheGeneration(cache);
+  cache.size_classes[ptr] = size_class;
+  return ptr;
+}
+
+bool BFCArena::FreeToThreadCache(void* p) {
+  size_t size_class = 0;
+  ThreadCache& cache = GetThreadCache();
+  {
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    SyncThreadCacheGeneration(cache);
+    auto it = cache.size_classes.find(p);
+    if (it == cache.size_classes.end()) {
+      return false;
+    }
+    size_class = it->second;
+    cache.size_classes.erase(it);
+  }
+
+  CacheFreedChunk(p, size_class);
+  return true;
+}
+
+void BFCArena::CacheFreedChunk(void* p, size_t size_class) {
+  ThreadCache& cache = GetThreadCache();
+  {
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    if (cache.num_bytes + size_class <= max_thread_cache_bytes_) {
+      cache.free_chunks[size_class].push_back(p);
+      cache.num_bytes += size_class;
+      return;
+    }
+  }
+
+  // the cache of this thread is full
+  std::lock_guard<OrtMutex> lock(lock_);
+  DeallocateRawInternal(p);
+}
+
+void* BFCArena::AllocateFlushingThreadCachesOnFailure(size_t num_bytes) {
+  void* ptr = nullptr;
+  ORT_TRY {
+    ptr = AllocateRawInternal(num_bytes, false, nullptr, false, nullptr);
+  }
+  ORT_CATCH(const OnnxRuntimeException&) {
+    // free chunks held by the thread caches may be enough to satisfy the request once they are coalesced
+    ORT_HANDLE_EXCEPTION([&]() {
+      FlushThreadCaches();
+      ptr = AllocateRawInternal(num_bytes, false, nullptr, false, nullptr);
+    });
+  }
+  return ptr;
+}
+
+void BFCArena::FlushThreadCaches() {
+  if (max_thread_cache_bytes_ == 0) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<ThreadCache>> caches;
+  {
+    std::lock_guard<OrtMutex> caches_lock(thread_caches_mutex_);
+    caches = thread_caches_;
+  }
+
+  // take the chunks out of the caches first so that no cache lock is held while lock_ is
+  std::vector<void*> chunks;
+  for (auto& cache : caches) {
+    std::lock_guard<OrtMutex> lock(cache->mutex);
+    TakeCachedChunks(*cache, chunks);
+  }
+
+  std::lock_guard<OrtMutex> lock(lock_);
+  for (void* chunk : chunks) {
+    DeallocateRawInternal(chunk);
+  }
+}
+
+void BFCArena::FlushThreadCache() {
+  if (max_thread_cache_bytes_ == 0) {
+    return;
+  }
+
+  std::vector<void*> chunks;
+  {
+    ThreadCache& cache = GetThreadCache();
+    std::lock_guard<OrtMutex> lock(cache.mutex);
+    TakeCachedChunks(cache, chunks);
+  }
+
+  if (!chunks.empty()) {
+    std::lock_guard<OrtMutex> lock(lock_);
+    for (void* chunk : chunks) {
+      DeallocateRawInternal(chunk);
+    }
+  }
+}
+
 void* BFCArena::Reserve(size_t size) {
   if (size == 0)
     return nullptr;
@@ -377,8 +616,33 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
 }
 
 void BFCArena::GetStats(AllocatorStats* stats) {
-  std::lock_guard<OrtMutex> lock(lock_);
-  *stats = stats_;
+  {
+    std::lock_guard<OrtMutex> lock(lock_);
+    *stats = stats_;
+  }
+
+  if (max_thread_cache_bytes_ > 0) {
+    std::vector<std::shared_ptr<ThreadCache>> caches;
+    {
+      std::lock_guard<OrtMutex> caches_lock(thread_caches_mutex_);
+      caches = thread_caches_;
+      stats->num_thread_cache_hits += num_released_thread_cache_hits_;
+      stats->num_thread_cache_misses += num_released_thread_cache_misses_;
+    }
+
+    for (const auto& cache : caches) {
+      std::lock_guard<OrtMutex> lock(cache->mutex);
+      stats->num_thread_cache_hits += cache->num_hits;
+      stats->num_thread_cache_misses += cache->num_misses;
+      stats->thread_cache_bytes += static_cast<int64_t>(cache->num_bytes);
+    }
+    // hits don't reach the bins
+    stats->num_allocs += stats->num_thread_cache_hits;
+  }
+
+  AllocatorStats device_stats;
+  device_allocator_->GetStats(&device_stats);
+  stats->huge_page_bytes = device_stats.huge_page_bytes;
 }
 
 BFCArena::Chunk* BFCArena::SplitFreeChunkFromBin(BFCArena::Bin::FreeChunkSet* free_chunks,
@@ -496,19 +760,41 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
-  std::lock_guard<OrtMutex> lock(lock_);
-  auto it = reserved_chunks_.find(p);
-  if (it != reserved_chunks_.end()) {
-    device_allocator_->Free(it->first);
-    stats_.bytes_in_use -= it->second;
-    stats_.total_allocated_bytes -= it->second;
-    reserved_chunks_.erase(it);
-  } else {
-    DeallocateRawInternal(p);
+  if (max_thread_cache_bytes_ > 0 && FreeToThreadCache(p)) {
+    return;
   }
+
+  size_t size_class = 0;
+  {
+    std::lock_guard<OrtMutex> lock(lock_);
+    auto it = reserved_chunks_.find(p);
+    if (it != reserved_chunks_.end()) {
+      device_allocator_->Free(it->first);
+      stats_.bytes_in_use -= it->second;
+      stats_.total_allocated_bytes -= it->second;
+      reserved_chunks_.erase(it);
+      return;
+    }
+
+    if (max_thread_cache_bytes_ > 0) {
+      const ChunkHandle h = region_manager_.get_handle(p);
+      ORT_ENFORCE(h != kInvalidChunkHandle);
+      size_class = ChunkFromHandle(h)->thread_cache_size_class;
+    }
+
+    if (size_class == 0) {
+      DeallocateRawInternal(p);
+      return;
+    }
+  }
+
+  // handed out through the cache of another thread
+  CacheFreedChunk(p, size_class);
 }
 
 Status BFCArena::Shrink() {
+  FlushThreadCaches();
+
   std::lock_guard<OrtMutex> lock(lock_);
   auto num_regions = region_manager_.regions().size();
   std::vector<void*> region_ptrs;
@@ -573,11 +859,59 @@ Status BFCArena::Shrink() {
   return Status::OK();
 }
 
+Status BFCArena::PreGrowToPeak(bool touch_pages) {
+  std::lock_guard<OrtMutex> lock(lock_);
+  // reserved chunks are allocated from the device allocator directly and are still in use
+  size_t reserved_bytes = 0;
+  for (const auto& reserved_chunk : reserved_chunks_) {
+    reserved_bytes += reserved_chunk.second;
+  }
+
+  const auto max_bytes_in_use = static_cast<size_t>(stats_.max_bytes_in_use);
+  const size_t peak_bytes = max_bytes_in_use > reserved_bytes ? max_bytes_in_use - reserved_bytes : 0;
+
+  size_t region_bytes = 0;
+  for (const auto& region : region_manager_.regions()) {
+    region_bytes += region.memory_size();
+  }
+
+  if (region_bytes < peak_bytes) {
+    ORT_RETURN_IF_ERROR(Extend(RoundedBytes(peak_bytes - region_bytes)));
+  }
+
+  if (touch_pages) {
+    // a smaller page size only means touching some pages more than once
+    constexpr size_t kPageSize = 4096;
+    for (const auto& region : region_manager_.regions()) {
+      ChunkHandle h = region_manager_.get_handle(region.ptr());
+      while (h != kInvalidChunkHandle) {
+        const Chunk* c = ChunkFromHandle(h);
+        if (!c->in_use()) {
+          auto* p = static_cast<volatile char*>(c->ptr);
+          for (size_t offset = 0; offset < c->size; offset += kPageSize) {
+            p[offset] = 0;
+          }
+        }
+        h = c->next;
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
 void BFCArena::DeallocateRawInternal(void* ptr) {
   // Find the chunk from the ptr.
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
 
+  Chunk* c = ChunkFromHandle(h);
+  if (c->thread_cache_size_class != 0) {
+    // the size classes recorded for the chunk by the thread caches are stale from now on
+    c->thread_cache_size_class = 0;
+    thread_cache_generation_.fetch_add(1, std::memory_order_release);
+  }
+
   // Consider coalescing it.
   FreeAndMaybeCoalesce(h);
 }
@@ -16,13 +16,17 @@ limitations under the License.
 
 #pragma once
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "onnxruntime_config.h"
 
 #include "core/common/common.h"
+#include "core/common/inlined_containers.h"
 #include "core/common/logging/logging.h"
 #include "core/common/logging/severity.h"
 #include "core/common/safeint.h"
@@ -61,6 +65,7 @@ class BFCArena : public IAllocator {
   static const int DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES = 2 * 1024 * 1024;
   static const int64_t DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES = 1024 * 1024 * 1024;  // 1GB
   static const size_t DEFAULT_MAX_MEM = std::numeric_limits<size_t>::max();
+  static const size_t DEFAULT_MAX_THREAD_CACHE_BYTES = 0;  // thread caches are disabled
 
   enum ArenaType {
     BaseArena,
@@ -73,7 +78,8 @@ class BFCArena : public IAllocator {
            int initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
            int max_dead_bytes_per_chunk = DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
            int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
-           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES);
+           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+           size_t max_thread_cache_bytes = DEFAULT_MAX_THREAD_CACHE_BYTES);
 
   ~BFCArena() override;
 
@@ -85,7 +91,8 @@ class BFCArena : public IAllocator {
   // If p is NULL, no operation is performed.
   void Free(void* p) override;
 
-  // Frees all allocation regions in which no chunk is in use.
+  // Returns the free chunks held by the thread caches to the arena and
+  // then frees all allocation regions in which no chunk is in use.
   // Does not free any reserved chunks.
   // Resets the size that the arena will grow by in the next allocation to
   // `initial_growth_chunk_size_bytes_` but ultimately all
@@ -93,8 +100,23 @@ class BFCArena : public IAllocator {
   // and the allocation request.
   Status Shrink();
 
+  // Extends the arena, if needed, so that its regions can hold the peak number of bytes in use seen so far,
+  // not counting reserved chunks.
+  // If `touch_pages` is true, writes to every page of the free chunks so that the OS backs them with
+  // physical memory before the first allocation uses them. Only valid for memory that the CPU can access.
+  Status PreGrowToPeak(bool touch_pages);
+
   void* Reserve(size_t size) override;
 
+  // Returns the free chunks held by the thread caches to the arena.
+  // Done when the arena shrinks or an allocation runs out of memory.
+  void FlushThreadCaches();
+
+  // Returns the free chunks held by the cache of the calling thread to the arena. Done at the end of a run.
+  void FlushThreadCache();
+
+  bool HasThreadCaches() const { return max_thread_cache_bytes_ > 0; }
+
   void GetStats(AllocatorStats* stats) override;
 
   size_t RequestedSize(const void* ptr);
@@ -170,6 +192,10 @@ class BFCArena : public IAllocator {
 
     uint64_t stream_timestamp = 0;
 
+    // Size class of the chunk if it was handed out through the thread caches, 0 otherwise.
+    // Such a chunk stays in use while it is cached.
+    size_t thread_cache_size_class = 0;
+
     bool in_use() const { return allocation_id != -1; }
 
     std::string DebugString(BFCArena* a, bool recurse) {
@@ -412,6 +438,76 @@ class BFCArena : public IAllocator {
 
   void DumpMemoryLog(size_t num_bytes);
 
+  // Thread caches.
+  //
+  // When max_thread_cache_bytes_ is not 0, freed chunks of up to kMaxThreadCachedChunkSize bytes are kept in a cache
+  // of the freeing thread, up to max_thread_cache_bytes_ per thread, and Alloc() takes a chunk of the same size class
+  // from the cache of the calling thread before it takes lock_. Cached chunks stay in use as far as the bins are
+  // concerned. Only Alloc() uses the caches; allocations on a stream always go to the bins.
+  //
+  // The size class of a chunk handed out through the caches is stored in the chunk. The cache of the allocating thread
+  // also maps the chunk to its size class, so a chunk freed by the thread that allocated it goes back to the cache
+  // without taking lock_. Chunks freed by another thread are looked up under lock_.
+  // The entries of those maps are stale once a chunk goes back to the bins, so every time that happens
+  // thread_cache_generation_ is incremented and a cache clears its map when it sees a new generation.
+  //
+  // A cache is returned to the arena when its thread exits, and detached from the arena when the arena is destroyed.
+  // A cache's mutex may be held while thread_caches_mutex_ or lock_ is taken, but not the other way around.
+  static const size_t kMaxThreadCachedChunkSize = 1024 * 1024;
+
+  struct ThreadCache {
+    // only contended when another thread flushes the cache or reads its stats
+    OrtMutex mutex;
+    // the arena of the cache, nullptr once the cache was returned to it or the arena was destroyed
+    BFCArena* arena = nullptr;
+    // free chunks by size class
+    std::unordered_map<size_t, std::vector<void*>> free_chunks;
+    // size classes of the chunks handed out through this cache, valid for `generation`
+    InlinedHashMap<const void*, size_t> size_classes;
+    uint64_t generation = 0;
+    size_t num_bytes = 0;
+    int64_t num_hits = 0;
+    int64_t num_misses = 0;
+  };
+
+  // The caches of a thread by arena id. Returns the caches to their arenas when the thread exits.
+  struct ThreadCachesOfThread;
+
+  // Returns the cache of the calling thread, creating it on first use.
+  ThreadCache& GetThreadCache();
+
+  // Clears the size classes of `cache` if chunks went back to the bins since they were recorded.
+  // The caller must hold cache.mutex.
+  void SyncThreadCacheGeneration(ThreadCache& cache);
+
+  // Moves the free chunks of `cache` to `chunks`. The caller must hold cache.mutex.
+  static void TakeCachedChunks(ThreadCache& cache, std::vector<void*>& chunks);
+
+  // Returns the free chunks of a cache to its arena and detaches it. Called when the thread of the cache exits.
+  static void ReleaseThreadCache(ThreadCache& cache);
+
+  // Size of the chunks cached for allocations of 'rounded_bytes'. Sizes up to 1KB are a class each, larger sizes
+  // are rounded up to a quarter of their power of two so that a class wastes less than 25% of a chunk.
+  size_t ThreadCacheSizeClass(size_t rounded_bytes) {
+    if (rounded_bytes <= 1024) {
+      return rounded_bytes;
+    }
+    const size_t step = size_t{1} << (Log2FloorNonZero(rounded_bytes - 1) - 2);
+    return (rounded_bytes + step - 1) & ~(step - 1);
+  }
+
+  void* AllocateThroughThreadCache(size_t num_bytes);
+
+  // Returns false if 'p' wasn't handed out through the cache of the calling thread.
+  bool FreeToThreadCache(void* p);
+
+  // Puts a free chunk of `size_class` in the cache of the calling thread, or returns it to the bins if the cache
+  // is full.
+  void CacheFreedChunk(void* p, size_t size_class);
+
+  // Allocates from the bins. If the arena is out of memory, flushes the thread caches and tries again.
+  void* AllocateFlushingThreadCachesOnFailure(size_t num_bytes);
+
   ChunkHandle AllocateChunk();
   void DeallocateChunk(ChunkHandle h);
 
@@ -508,6 +604,19 @@ class BFCArena : public IAllocator {
   const int max_dead_bytes_per_chunk_;
   const int initial_growth_chunk_size_bytes_;
   const int64_t max_power_of_two_extend_bytes_;
+  const size_t max_thread_cache_bytes_;
+
+  // Unique among the arenas of the process. Identifies the caches of this arena in the thread local cache maps.
+  const uint64_t arena_id_;
+
+  // Incremented, under lock_, whenever a chunk handed out through the thread caches goes back to the bins.
+  std::atomic<uint64_t> thread_cache_generation_{0};
+
+  OrtMutex thread_caches_mutex_;
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_;
+  // hits and misses of the caches of exited threads
+  int64_t num_released_thread_cache_hits_ = 0;
+  int64_t num_released_thread_cache_misses_ = 0;
 
   // This flag is only relevant if Shrink() is invoked.
   // This is a boolean flag that controls whether the first allocation region
@@ -347,8 +347,7 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
 #ifdef ORT_ENABLE_STREAM
       device_streams_(device_streams),
 #endif
-      session_state_(session_state),
-      mem_patterns_(nullptr) {
+      session_state_(session_state) {
   Init(
       feed_mlvalue_idxs, feeds, session_state.GetInitializedTensors(),
 #if !defined(DISABLE_SPARSE_TENSORS)
@@ -440,10 +439,10 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
                   stream_aware_alloc->SecureTheChunk(mem_pattern_stream, device_streams_->GetStream(j), nullptr);
                 }
               } else {
-                buffer = alloc->Alloc(peak_size);
+                buffer = AllocateMemoryPatternBuffer(location, alloc, peak_size);
               }
 #else
-              buffer = alloc->Alloc(peak_size);
+              buffer = AllocateMemoryPatternBuffer(location, alloc, peak_size);
 #endif
               // handle allocator that doesn't throw
               if (buffer == nullptr) {
@@ -483,7 +482,37 @@ ExecutionFrame::ExecutionFrame(gsl::span<const int> feed_mlvalue_idxs, gsl::span
   }
 }
 
-ExecutionFrame::~ExecutionFrame() = default;
+ExecutionFrame::~ExecutionFrame() {
+  // the tensors placed in the buffers don't own them, so the buffers can be handed over before they're released
+  for (const auto& location_and_size : reusable_buffer_sizes_) {
+    auto it = buffers_.find(location_and_size.first);
+    if (it != buffers_.end()) {
+      session_state_.ReleaseMemoryPatternBuffer(location_and_size.first,
+                                                {std::move(it->second), location_and_size.second});
+    }
+  }
+}
+
+void* ExecutionFrame::AllocateMemoryPatternBuffer(const OrtDevice& location, const AllocatorPtr& alloc, size_t size) {
+  if (!session_state_.GetReuseMemoryPatternBuffers()) {
+    return alloc->Alloc(size);
+  }
+
+  void* buffer = nullptr;
+  auto released = session_state_.AcquireMemoryPatternBuffer(location, size);
+  if (released.buffer) {
+    buffer = released.buffer.release();
+    size = released.size;
+  } else {
+    buffer = alloc->Alloc(size);
+  }
+
+  if (buffer != nullptr) {
+    reusable_buffer_sizes_[location] = size;
+  }
+
+  return buffer;
+}
 
 Status ExecutionFrame::CopyTensor(const Tensor& src, Tensor& dest) const {
   return session_state_.GetDataTransferMgr().CopyTensor(src, dest);
@@ -548,8 +577,9 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
       if (block) {
         auto it = buffers_.find(location);
         if (it != buffers_.end()) {
-          // if the block is not correct, log message then fall back to default behavior
-          if (block->size_ == size) {
+          // a block may be larger than needed if the pattern was generated for larger inputs in the same
+          // shape bucket. if the block is too small, log message then fall back to default behavior
+          if (block->size_ >= size) {
             void* buffer = it->second.get();
             auto status = AllocateTensorWithPreAllocateBufferHelper(
                 ort_value, static_cast<void*>(static_cast<char*>(buffer) + block->offset_), element_type, location,
@@ -558,8 +588,6 @@ Status ExecutionFrame::AllocateMLValueTensorSelfOwnBufferHelper(OrtValue& ort_va
           } else {
             // the block size may vary especially if the model has NonZero ops, or different sequence lengths are
             // fed in, so use VERBOSE as the log level as it's expected.
-            // TODO: Should we reuse the block if the size is large enough? Would probably need to allow it
-            // to be freed if the size difference was too large so our memory usage doesn't stick at a high water mark
             LOGS(session_state_.Logger(), VERBOSE) << "For ort_value with index: " << ort_value_index
                                                    << ", block in memory pattern size is: " << block->size_
                                                    << " but the actual size is: " << size
@@ -213,6 +213,10 @@ class ExecutionFrame final : public IExecutionFrame {
   void TraceAllocate(int ort_value_idx, size_t size);
   void TraceFree(int ort_value_idx);
 
+  // Allocates the memory pattern buffer of a location, or takes one released by an earlier run if the session
+  // reuses memory pattern buffers.
+  void* AllocateMemoryPatternBuffer(const OrtDevice& location, const AllocatorPtr& alloc, size_t size);
+
   const AllocPlanPerValue& GetAllocationPlan(int ort_value_idx);
 
   Stream* GetValueStream(int ort_value_idx) const;
@@ -229,7 +233,7 @@ class ExecutionFrame final : public IExecutionFrame {
   // If we already have cached memory pattern on these input shapes
   // Use this mem pattern that create a big chunk for all the internal
   // kernel's input/output tensors.
-  const MemoryPatternGroup* mem_patterns_;
+  std::shared_ptr<const MemoryPatternGroup> mem_patterns_;
 
   // If no cached memory pattern, and we enable the memory pattern optimization
   // use this planner_ to trace the memory allocation in current executor.
@@ -238,12 +242,15 @@ class ExecutionFrame final : public IExecutionFrame {
   // Big chunks on different locations that will be used by mem_pattern.
   InlinedHashMap<OrtDevice, BufferUniquePtr> buffers_;
 
+  // Sizes of the buffers in buffers_ that are handed to later runs when the frame is destroyed.
+  InlinedHashMap<OrtDevice, size_t> reusable_buffer_sizes_;
+
   // Given the input shapes of the executed graph, ExecutionFrame tries inferring
   // all symbolic shapes. inferred_shapes_[i] is the shape of OrtValue indexed
   // by i, if the key i exists.
   // inferred_shapes_ is generated together with mem_patterns_.
   // It is never updated after creation
-  const InlinedHashMap<int, TensorShape>* inferred_shapes_{nullptr};
+  std::shared_ptr<const InlinedHashMap<int, TensorShape>> inferred_shapes_;
 
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
   // Size of virtual memory allocated before any kernel execution.
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/huge_page_cpu_allocator.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#endif
+
+#include "core/framework/allocator_stats.h"
+
+namespace onnxruntime {
+
+#if defined(__linux__)
+namespace {
+size_t RoundUpToHugePage(size_t size) {
+  return (size + HugePageCPUAllocator::kHugePageSize - 1) & ~(HugePageCPUAllocator::kHugePageSize - 1);
+}
+
+// Maps `size` bytes at a huge page aligned address and asks for transparent huge pages.
+void* MapForTransparentHugePages(size_t size) {
+  constexpr size_t kAlignment = HugePageCPUAllocator::kHugePageSize;
+  void* p = mmap(nullptr, size + kAlignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // trim the mapping to the aligned range
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(p);
+  const uintptr_t aligned_begin = (begin + kAlignment - 1) & ~(kAlignment - 1);
+  if (aligned_begin > begin) {
+    munmap(p, aligned_begin - begin);
+  }
+  const uintptr_t end = begin + size + kAlignment;
+  if (end > aligned_begin + size) {
+    munmap(reinterpret_cast<void*>(aligned_begin + size), end - (aligned_begin + size));
+  }
+
+  // the memory is still usable with regular pages if transparent huge pages are disabled
+  void* aligned = reinterpret_cast<void*>(aligned_begin);
+  madvise(aligned, size, MADV_HUGEPAGE);
+  return aligned;
+}
+}  // namespace
+#endif
+
+HugePageCPUAllocator::~HugePageCPUAllocator() {
+#if defined(__linux__)
+  for (const auto& mapping : mappings_) {
+    munmap(reinterpret_cast<void*>(mapping.first), mapping.second.size);
+  }
+#endif
+}
+
+void* HugePageCPUAllocator::Alloc(size_t size) {
+#if defined(__linux__)
+  if (size >= kHugePageSize) {
+    const size_t mapped_size = RoundUpToHugePage(size);
+    bool from_huge_page_pool = true;
+    void* p = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+      from_huge_page_pool = false;
+      p = MapForTransparentHugePages(mapped_size);
+    }
+
+    if (p != nullptr) {
+      SetNumaNode(p, mapped_size);
+      std::lock_guard<OrtMutex> lock(mutex_);
+      mappings_.emplace(reinterpret_cast<uintptr_t>(p), Mapping{mapped_size, from_huge_page_pool});
+      return p;
+    }
+  }
+#endif
+  return NumaCPUAllocator::Alloc(size);
+}
+
+void HugePageCPUAllocator::Free(void* p) {
+#if defined(__linux__)
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto it = mappings_.find(reinterpret_cast<uintptr_t>(p));
+    if (it != mappings_.end()) {
+      munmap(p, it->second.size);
+      mappings_.erase(it);
+      return;
+    }
+  }
+#endif
+  NumaCPUAllocator::Free(p);
+}
+
+void HugePageCPUAllocator::GetStats(AllocatorStats* stats) {
+  stats->huge_page_bytes = static_cast<int64_t>(GetHugePageBytes());
+}
+
+size_t HugePageCPUAllocator::GetHugePageBytes() const {
+  size_t huge_page_bytes = 0;
+#if defined(__linux__)
+  // ranges of the transparent huge page mappings, sorted by address. smaps is read without holding the lock, so
+  // Alloc and Free aren't blocked by it.
+  std::vector<std::pair<uintptr_t, uintptr_t>> transparent_ranges;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    for (const auto& mapping : mappings_) {
+      if (mapping.second.from_huge_page_pool) {
+        huge_page_bytes += mapping.second.size;
+      } else {
+        transparent_ranges.emplace_back(mapping.first, mapping.first + mapping.second.size);
+      }
+    }
+  }
+
+  if (transparent_ranges.empty()) {
+    return huge_page_bytes;
+  }
+
+  // the kernel may merge adjacent mappings, so count the memory areas that start in one of the mappings
+  std::ifstream smaps("/proc/self/smaps");
+  std::string line;
+  bool in_mapping = false;
+  while (std::getline(smaps, line)) {
+    char* end = nullptr;
+    const uintptr_t begin = std::strtoull(line.c_str(), &end, 16);
+    if (end != line.c_str() && *end == '-') {
+      // header of a memory area
+      auto it = std::upper_bound(transparent_ranges.begin(), transparent_ranges.end(), begin,
+                                 [](uintptr_t address, const std::pair<uintptr_t, uintptr_t>& range) {
+                                   return address < range.first;
+                                 });
+      in_mapping = it != transparent_ranges.begin() && begin < (--it)->second;
+    } else if (in_mapping && line.compare(0, 14, "AnonHugePages:") == 0) {
+      huge_page_bytes += static_cast<size_t>(std::strtoull(line.c_str() + 14, nullptr, 10)) * 1024;
+    }
+  }
+#endif
+  return huge_page_bytes;
+}
+
+}  // namespace onnxruntime
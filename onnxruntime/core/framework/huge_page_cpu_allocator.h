@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <map>
+
+#include "core/framework/numa_cpu_allocator.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+ * CPU allocator that backs allocations of at least the huge page size with huge pages to reduce TLB misses.
+ *
+ * On Linux, such an allocation is rounded up to a multiple of the huge page size and mapped from the huge page pool
+ * (MAP_HUGETLB) if the pool has enough free pages. Otherwise it is mapped at a huge page aligned address and marked
+ * with madvise(MADV_HUGEPAGE), so the kernel backs it with transparent huge pages where it can.
+ * Smaller allocations, and all allocations on other platforms, use regular pages.
+ *
+ * GetStats reports the number of bytes that are actually backed by huge pages in huge_page_bytes. For transparent
+ * huge pages this reads /proc/self/smaps, so it's not meant to be called on a hot path.
+ */
+class HugePageCPUAllocator : public NumaCPUAllocator {
+ public:
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+  explicit HugePageCPUAllocator(int numa_node = -1) : NumaCPUAllocator(numa_node) {}
+
+  ~HugePageCPUAllocator() override;
+
+  void* Alloc(size_t size) override;
+  void Free(void* p) override;
+  void GetStats(AllocatorStats* stats) override;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(HugePageCPUAllocator);
+
+  struct Mapping {
+    size_t size;
+    bool from_huge_page_pool;  // MAP_HUGETLB, otherwise transparent huge pages
+  };
+
+  size_t GetHugePageBytes() const;
+
+  mutable OrtMutex mutex_;
+  // huge page mappings by address
+  std::map<uintptr_t, Mapping> mappings_;
+};
+
+}  // namespace onnxruntime
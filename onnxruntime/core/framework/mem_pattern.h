@@ -26,11 +26,13 @@ class MemoryPattern {
 
   MemoryPattern(MemoryPattern&& rhs) noexcept
       : patterns_{std::move(rhs.patterns_)},
-        peak_size_{std::move(rhs.peak_size_)} {}
+        peak_size_{std::move(rhs.peak_size_)},
+        peak_size_lower_bound_{std::move(rhs.peak_size_lower_bound_)} {}
 
   MemoryPattern& operator=(MemoryPattern&& rhs) noexcept {
     patterns_ = std::move(rhs.patterns_);
     peak_size_ = std::move(rhs.peak_size_);
+    peak_size_lower_bound_ = std::move(rhs.peak_size_lower_bound_);
     return *this;
   }
 
@@ -38,6 +40,12 @@ class MemoryPattern {
     return peak_size_;
   }
 
+  // The largest total size of the blocks that are live at the same time, which no placement can go below.
+  // 0 if the pattern was traced with program counters.
+  size_t PeakSizeLowerBound() const {
+    return peak_size_lower_bound_;
+  }
+
   const MemoryBlock* GetBlock(int ml_value_idx) const {
     auto it = patterns_.find(ml_value_idx);
     if (it == patterns_.end())
@@ -56,6 +64,7 @@ class MemoryPattern {
 
   InlinedHashMap<int, MemoryBlock> patterns_;
   size_t peak_size_{0};
+  size_t peak_size_lower_bound_{0};
 };
 
 struct MemoryPatternGroup {
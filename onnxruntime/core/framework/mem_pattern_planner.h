@@ -16,6 +16,8 @@ limitations under the License.
 // Licensed under the MIT License.
 
 #pragma once
+#include <algorithm>
+#include <limits>
 #include <list>
 #include "core/common/safeint.h"
 #include "core/framework/mem_pattern.h"
@@ -26,6 +28,8 @@ namespace onnxruntime {
 // MemPatternPlanner is used to trace allocation/free steps
 // in a single iteration, record the pattern and cached for
 // future request if they have the same input shape.
+// Blocks are placed as they are traced. Once the whole iteration is traced, GenerateMemPattern() also places the
+// blocks offline knowing the lifetime of every block, and returns that placement if it has a lower peak.
 // Thread-safe.
 class MemPatternPlanner {
  public:
@@ -135,6 +139,7 @@ class MemPatternPlanner {
 
     std::lock_guard<OrtMutex> lock(lock_);
 
+    const size_t time = time_++;
     if (size == 0) {
       allocs_.emplace_back(ml_value_idx, MemoryBlock(0, 0));
       return;
@@ -175,6 +180,7 @@ class MemPatternPlanner {
     // the maximum size of the buffer.
     buffer_size_ = std::max(buffer_size_, SafeInt<size_t>(best_offset) + size);
     allocs_.emplace_back(ml_value_idx, MemoryBlock(best_offset, size));
+    allocs_.back().alloc_time_ = time;
     std::list<int>::iterator best_fit_it = blocks_.end();
     for (auto it = blocks_.begin(); it != blocks_.end(); it++) {
       if (allocs_[*it].block_.offset_ < best_offset)
@@ -192,8 +198,10 @@ class MemPatternPlanner {
   void TraceFree(int ml_value_index) {
     std::lock_guard<OrtMutex> lock(lock_);
 
+    const size_t time = time_++;
     for (auto it = blocks_.begin(); it != blocks_.end(); it++) {
       if (allocs_[*it].index_ == ml_value_index) {
+        allocs_[*it].free_time_ = time;
         blocks_.erase(it);
         break;
       }
@@ -240,6 +248,22 @@ class MemPatternPlanner {
       pattern.patterns_.insert_or_assign(alloc.index_, alloc.block_);
     }
 
+    // the program counters of training plans describe lifetimes that aren't intervals
+    if (!using_counters_) {
+      pattern.peak_size_lower_bound_ = ComputePeakSizeLowerBound();
+
+      if (pattern.peak_size_ > pattern.peak_size_lower_bound_) {
+        std::vector<MemoryBlock> blocks;
+        const size_t peak_size = PlaceOffline(blocks);
+        if (peak_size < pattern.peak_size_) {
+          pattern.peak_size_ = peak_size;
+          for (size_t i = 0, end = allocs_.size(); i < end; ++i) {
+            pattern.patterns_.insert_or_assign(allocs_[i].index_, blocks[i]);
+          }
+        }
+      }
+    }
+
     return pattern;
   }
 
@@ -249,6 +273,9 @@ class MemPatternPlanner {
     MemoryBlock block_;
     const AllocPlanPerValue::ProgramCounter* counter_{nullptr};
     bool reuse_{false};
+    // the block is live in [alloc_time_, free_time_). blocks that are never freed are live until the end.
+    size_t alloc_time_{0};
+    size_t free_time_{std::numeric_limits<size_t>::max()};
     OrtValueAllocationBlock() = default;
     OrtValueAllocationBlock(int index, const MemoryBlock& block) : index_(index), block_(block), reuse_{false} {}
     OrtValueAllocationBlock(int index, const AllocPlanPerValue::ProgramCounter& counter, const MemoryBlock& block)
@@ -256,10 +283,138 @@ class MemPatternPlanner {
     }
   };
 
+  static bool OverlappingLifetimes(const OrtValueAllocationBlock& alloc1, const OrtValueAllocationBlock& alloc2) {
+    return alloc1.alloc_time_ < alloc2.free_time_ && alloc2.alloc_time_ < alloc1.free_time_;
+  }
+
+  // Returns the largest total size of the blocks live at the same time. No placement has a lower peak.
+  size_t ComputePeakSizeLowerBound() const {
+    // (time, size delta). frees sort before allocations at the same time.
+    std::vector<std::pair<size_t, int64_t>> events;
+    events.reserve(allocs_.size() * 2);
+    for (const auto& alloc : allocs_) {
+      if (alloc.block_.size_ > 0) {
+        events.emplace_back(alloc.alloc_time_, static_cast<int64_t>(alloc.block_.size_));
+        events.emplace_back(alloc.free_time_, -static_cast<int64_t>(alloc.block_.size_));
+      }
+    }
+
+    std::sort(events.begin(), events.end());
+    SafeInt<int64_t> live_size = 0;
+    int64_t peak_size = 0;
+    for (const auto& event : events) {
+      live_size += event.second;
+      peak_size = std::max(peak_size, static_cast<int64_t>(live_size));
+    }
+
+    return static_cast<size_t>(peak_size);
+  }
+
+  // Places the blocks knowing all lifetimes. Blocks are placed one at a time into the smallest gap left by the
+  // already placed blocks with overlapping lifetimes, or after them. The blocks are tried in a few orders and the
+  // placement with the lowest peak is kept. `blocks` is set to the placement of each element of allocs_.
+  // Returns the peak size of the placement.
+  size_t PlaceOffline(std::vector<MemoryBlock>& blocks) const {
+    std::vector<size_t> order;
+    order.reserve(allocs_.size());
+    for (size_t i = 0, end = allocs_.size(); i < end; ++i) {
+      if (allocs_[i].block_.size_ > 0) {
+        order.push_back(i);
+      }
+    }
+
+    const size_t end_time = time_;
+    auto lifetime = [this, end_time](size_t i) {
+      return std::min(allocs_[i].free_time_, end_time) - allocs_[i].alloc_time_;
+    };
+
+    // largest blocks first, so small blocks fill the gaps between them
+    auto by_size = [this](size_t i1, size_t i2) {
+      return allocs_[i1].block_.size_ != allocs_[i2].block_.size_
+                 ? allocs_[i1].block_.size_ > allocs_[i2].block_.size_
+                 : allocs_[i1].alloc_time_ < allocs_[i2].alloc_time_;
+    };
+    // blocks that occupy the most memory over time first, so short-lived blocks share the space around them
+    auto by_area = [this, &lifetime, &by_size](size_t i1, size_t i2) {
+      const double area1 = static_cast<double>(allocs_[i1].block_.size_) * static_cast<double>(lifetime(i1));
+      const double area2 = static_cast<double>(allocs_[i2].block_.size_) * static_cast<double>(lifetime(i2));
+      return area1 != area2 ? area1 > area2 : by_size(i1, i2);
+    };
+
+    size_t best_peak_size = std::numeric_limits<size_t>::max();
+    std::vector<MemoryBlock> candidate;
+    for (int heuristic = 0; heuristic < 2; ++heuristic) {
+      if (heuristic == 0) {
+        std::sort(order.begin(), order.end(), by_size);
+      } else {
+        std::sort(order.begin(), order.end(), by_area);
+      }
+
+      const size_t peak_size = PlaceInOrder(order, candidate);
+      if (peak_size < best_peak_size) {
+        best_peak_size = peak_size;
+        blocks.swap(candidate);
+      }
+    }
+
+    return best_peak_size;
+  }
+
+  size_t PlaceInOrder(const std::vector<size_t>& order, std::vector<MemoryBlock>& blocks) const {
+    blocks.assign(allocs_.size(), MemoryBlock(0, 0));
+    SafeInt<size_t> peak_size = 0;
+
+    // placed blocks sorted by offset
+    std::vector<size_t> placed;
+    placed.reserve(order.size());
+    std::vector<size_t> overlapping;
+    for (size_t i : order) {
+      const size_t size = allocs_[i].block_.size_;
+
+      overlapping.clear();
+      for (size_t j : placed) {
+        if (OverlappingLifetimes(allocs_[i], allocs_[j])) {
+          overlapping.push_back(j);
+        }
+      }
+
+      size_t current = 0;
+      size_t waste_bytes = std::numeric_limits<size_t>::max();
+      size_t best_offset = 0;
+      bool best_offset_found = false;
+      for (size_t j : overlapping) {
+        if (blocks[j].offset_ >= current) {
+          auto gap = blocks[j].offset_ - current;
+          if (gap >= size && (gap - size) < waste_bytes) {
+            waste_bytes = gap - size;
+            best_offset = current;
+            best_offset_found = true;
+          }
+        }
+        current = std::max(current, blocks[j].offset_ + blocks[j].size_);
+      }
+
+      if (!best_offset_found) {
+        best_offset = current;
+      }
+
+      blocks[i] = MemoryBlock(best_offset, size);
+      peak_size = std::max(peak_size, SafeInt<size_t>(best_offset) + size);
+
+      auto insert_it = std::upper_bound(placed.begin(), placed.end(), best_offset,
+                                        [&blocks](size_t offset, size_t j) { return offset < blocks[j].offset_; });
+      placed.insert(insert_it, i);
+    }
+
+    return peak_size;
+  }
+
   std::vector<OrtValueAllocationBlock> allocs_;
   // blocks_ the list of currently allocated memory blocks, sorted in order of their offset
   std::list<int> blocks_;
   SafeInt<size_t> buffer_size_{0};
+  // number of allocations and frees traced so far
+  size_t time_{0};
   bool using_counters_;
   mutable OrtMutex lock_;
 };
@@ -3,7 +3,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 
 namespace onnxruntime {
 struct MurmurHash3 {
@@ -12,5 +16,30 @@ struct MurmurHash3 {
 
   // generate 128-bit hash from input and write to 'out'.
   static void x86_128(const void* key, int len, uint32_t seed, void* out);
+
+  // Incrementally hashes a sequence of byte ranges with x86_128. Chunks keep the length within the int it takes.
+  class Hasher {
+   public:
+    void Add(const void* data, size_t size) {
+      const auto* bytes = static_cast<const uint8_t*>(data);
+      constexpr size_t kMaxChunkSize = static_cast<size_t>(std::numeric_limits<int>::max());
+      do {
+        const size_t chunk_size = std::min(size, kMaxChunkSize);
+        uint64_t chunk_hash[2];
+        x86_128(bytes, static_cast<int>(chunk_size), static_cast<uint32_t>(hash_[0]), chunk_hash);
+        hash_[0] ^= chunk_hash[0];
+        hash_[1] ^= chunk_hash[1] + (hash_[0] << 6) + (hash_[0] >> 2);
+        bytes += chunk_size;
+        size -= chunk_size;
+      } while (size > 0);
+    }
+
+    const std::array<uint64_t, 2>& Get128() const { return hash_; }
+
+    uint64_t Get64() const { return hash_[0] ^ hash_[1]; }
+
+   private:
+    std::array<uint64_t, 2> hash_{0, 0};
+  };
 };
 }  // namespace onnxruntime
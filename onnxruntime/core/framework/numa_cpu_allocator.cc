@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/numa_cpu_allocator.h"
+
+#include "core/common/logging/logging.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+void* NumaCPUAllocator::Alloc(size_t size) {
+  void* p = CPUAllocator::Alloc(size);
+  if (p != nullptr) {
+    SetNumaNode(p, size);
+  }
+  return p;
+}
+
+void NumaCPUAllocator::SetNumaNode(void* p, size_t size) {
+  if (numa_node_ < 0) {
+    return;
+  }
+
+  auto status = Env::Default().SetMemoryNumaNode(p, size, numa_node_);
+  if (!status.IsOK()) {
+    std::call_once(warn_once_, [this, &status]() {
+      LOGS_DEFAULT(WARNING) << "Failed to place memory on NUMA node " << numa_node_ << ": "
+                            << status.ErrorMessage();
+    });
+  }
+}
+
+}  // namespace onnxruntime
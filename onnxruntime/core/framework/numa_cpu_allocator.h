@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <mutex>
+
+#include "core/framework/allocator.h"
+
+namespace onnxruntime {
+
+/**
+ * CPU allocator whose memory is backed by the memory of one NUMA node, so that it's local to the threads pinned to
+ * that node no matter which thread touches it first.
+ *
+ * Only pages that lie entirely within an allocation are placed on the node, which covers the regions of an arena.
+ * With a node of -1, or where the OS doesn't support placing memory on a node, it behaves like CPUAllocator.
+ */
+class NumaCPUAllocator : public CPUAllocator {
+ public:
+  explicit NumaCPUAllocator(int numa_node) : numa_node_(numa_node) {}
+
+  void* Alloc(size_t size) override;
+
+  int NumaNode() const { return numa_node_; }
+
+ protected:
+  // Place [p, p + size) on the node, if there is one.
+  void SetNumaNode(void* p, size_t size);
+
+ private:
+  const int numa_node_;
+  std::once_flag warn_once_;
+};
+
+}  // namespace onnxruntime
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <optional>
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
 #include "core/session/onnxruntime_c_api.h"
@@ -22,10 +24,12 @@ class OpKernelContextInternal : public OpKernelContext {
                                    const OpKernel& kernel,
                                    const logging::Logger& logger,
                                    const bool& terminate_flag,
-                                   Stream* stream)
+                                   Stream* stream,
+                                   std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt)
       : OpKernelContext(&frame, &kernel, stream, session_state.GetThreadPool(), logger),
         session_state_(session_state),
-        terminate_flag_(terminate_flag) {
+        terminate_flag_(terminate_flag),
+        deadline_(deadline) {
     const auto& implicit_inputs = kernel.Node().ImplicitInputDefs();
     int num_implicit_inputs = static_cast<int>(implicit_inputs.size());
     implicit_input_values_.reserve(num_implicit_inputs);
@@ -71,9 +75,13 @@ class OpKernelContextInternal : public OpKernelContext {
 
   const bool& GetTerminateFlag() const noexcept { return terminate_flag_; }
 
+  // Deadline of the run, to pass to the subgraphs the kernel executes.
+  const std::optional<std::chrono::steady_clock::time_point>& GetDeadline() const noexcept { return deadline_; }
+
  private:
   const SessionState& session_state_;
   const bool& terminate_flag_;
+  const std::optional<std::chrono::steady_clock::time_point> deadline_;
   std::vector<const OrtValue*> implicit_input_values_;
 };
 
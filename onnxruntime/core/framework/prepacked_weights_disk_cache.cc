@@ -0,0 +1,248 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/prepacked_weights_disk_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "core/common/alignment.h"
+#include "core/common/cpuid_info.h"
+#include "core/framework/murmurhash3.h"
+#include "core/framework/tensor.h"
+#include "core/graph/graph.h"
+#include "core/mlas/inc/mlas.h"
+#include "onnxruntime_config.h"
+
+namespace onnxruntime {
+
+namespace {
+// Layout of a file:
+//   magic, format version, key size, key, number of buffers, size of each buffer, then each buffer at a
+//   kBufferAlignment aligned offset. Placeholder buffers that are null have a size of 0.
+constexpr char kMagic[8] = {'O', 'R', 'T', 'P', 'P', 'W', '\0', '\0'};
+constexpr uint64_t kFormatVersion = 1;
+constexpr size_t kBufferAlignment = 64;
+
+// Returns the hex string of a 128-bit MurmurHash3 of the data.
+std::string HashToString(const void* data, size_t size) {
+  MurmurHash3::Hasher hasher;
+  hasher.Add(data, size);
+  const auto& hash = hasher.Get128();
+
+  std::ostringstream ss;
+  ss << std::hex << std::setfill('0') << std::setw(16) << hash[0] << std::setw(16) << hash[1];
+  return ss.str();
+}
+
+// Describes everything other than the weights that the packed layout depends on.
+std::string GetFingerprint() {
+  std::ostringstream ss;
+#if defined(ORT_VERSION)
+  ss << "version=" << ORT_VERSION << ";";
+#endif
+#if defined(ORT_BUILD_INFO)
+  ss << "build=" << ORT_BUILD_INFO << ";";
+#endif
+  const auto& cpuid_info = CPUIDInfo::GetCPUIDInfo();
+  ss << "cpu=" << cpuid_info.HasSSE3() << cpuid_info.HasSSE4_1() << cpuid_info.HasAVX() << cpuid_info.HasAVX2()
+     << cpuid_info.HasF16C() << cpuid_info.HasAVX512f() << cpuid_info.HasAVX512Skylake()
+     << cpuid_info.HasAVX512_BF16() << cpuid_info.HasAMX_BF16() << cpuid_info.HasArmNeonDot()
+     << cpuid_info.HasFp16VectorAcceleration() << ";";
+  // the sizes of packed buffers depend on the kernels MLAS selected for this CPU
+  ss << "mlas=" << MlasGetPreferredBufferAlignment() << "," << MlasGemmPackBSize(128, 128) << ","
+     << MlasGemmPackBSize(128, 128, false, false) << "," << MlasGemmPackBSize(128, 128, true, true) << ";";
+  ss << "pointer_size=" << sizeof(void*);
+  return ss.str();
+}
+
+void WriteUInt64(std::ostream& stream, uint64_t value) {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Reads a value at the offset and advances it. Returns false if the file is too short.
+bool ReadUInt64(const char* data, size_t size, size_t& offset, uint64_t& value) {
+  if (size - offset < sizeof(value)) {
+    return false;
+  }
+
+  std::memcpy(&value, data + offset, sizeof(value));
+  offset += sizeof(value);
+  return true;
+}
+}  // namespace
+
+PrepackedWeightsDiskCache::PrepackedWeightsDiskCache(std::filesystem::path directory, const logging::Logger& logger)
+    : directory_(std::move(directory)), fingerprint_(GetFingerprint()), logger_(logger) {
+  ORT_ENFORCE(!directory_.empty(), "A directory is required for the pre-packed weights cache.");
+
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    LOGS(logger_, WARNING) << "Failed to create the pre-packed weights cache directory " << directory_.string()
+                           << ": " << error.message();
+  }
+}
+
+std::string PrepackedWeightsDiskCache::GetKey(const Node& node, int input_idx, const Tensor& tensor) {
+  std::ostringstream ss;
+  ss << node.Domain() << ":" << node.OpType() << ":" << node.SinceVersion() << ";input=" << input_idx << ";";
+
+  // sort the attributes so that the key doesn't depend on the order of the hash map
+  std::map<std::string, std::string> attributes;
+  for (const auto& attribute : node.GetAttributes()) {
+    attributes.emplace(attribute.first, attribute.second.SerializeAsString());
+  }
+  for (const auto& attribute : attributes) {
+    ss << "attribute=" << attribute.first << ":" << HashToString(attribute.second.data(), attribute.second.size())
+       << ";";
+  }
+
+  for (const auto* input_def : node.InputDefs()) {
+    ss << "input_type=" << (input_def->Exists() && input_def->Type() != nullptr ? *input_def->Type() : "") << ";";
+  }
+  for (const auto* output_def : node.OutputDefs()) {
+    ss << "output_type=" << (output_def->Exists() && output_def->Type() != nullptr ? *output_def->Type() : "")
+       << ";";
+  }
+
+  ss << "tensor=" << tensor.GetElementType() << ":" << tensor.Shape().ToString() << ":"
+     << HashToString(tensor.DataRaw(), tensor.SizeInBytes());
+  return ss.str();
+}
+
+std::filesystem::path PrepackedWeightsDiskCache::GetFilePath(const std::string& key) const {
+  const std::string full_key = fingerprint_ + "\n" + key;
+  return directory_ / (HashToString(full_key.data(), full_key.size()) + ".bin");
+}
+
+const PrePackedWeights* PrepackedWeightsDiskCache::Load(const std::string& key) {
+  const std::filesystem::path file_path = GetFilePath(key);
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(file_path, error)) {
+    ++num_misses_;
+    return nullptr;
+  }
+
+  auto entry = std::make_unique<Entry>();
+  size_t file_size = 0;
+  Status status = Env::Default().GetFileLength(file_path.native().c_str(), file_size);
+  if (status.IsOK() && file_size > 0) {
+    status = Env::Default().MapFileIntoMemory(file_path.native().c_str(), 0, file_size, entry->mapped_file);
+  }
+
+  if (!status.IsOK() || file_size == 0) {
+    LOGS(logger_, WARNING) << "Failed to map pre-packed weights cache file " << file_path.string() << ": "
+                           << status.ErrorMessage();
+    ++num_misses_;
+    return nullptr;
+  }
+
+  // the file name is a hash of the key, so the key stored in the file is compared to rule out collisions.
+  // the file may also have been written by an incompatible version or truncated.
+  const char* data = entry->mapped_file.get();
+  const std::string full_key = fingerprint_ + "\n" + key;
+  size_t offset = sizeof(kMagic);
+  uint64_t format_version = 0;
+  uint64_t key_size = 0;
+  uint64_t num_buffers = 0;
+  bool valid = file_size >= sizeof(kMagic) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0 &&
+               ReadUInt64(data, file_size, offset, format_version) && format_version == kFormatVersion &&
+               ReadUInt64(data, file_size, offset, key_size) && key_size == full_key.size() &&
+               file_size - offset >= key_size && std::memcmp(data + offset, full_key.data(), key_size) == 0;
+  if (valid) {
+    offset += key_size;
+    valid = ReadUInt64(data, file_size, offset, num_buffers) &&
+            num_buffers <= (file_size - offset) / sizeof(uint64_t);
+  }
+
+  std::vector<uint64_t> buffer_sizes;
+  if (valid) {
+    buffer_sizes.resize(num_buffers);
+    for (auto& buffer_size : buffer_sizes) {
+      ReadUInt64(data, file_size, offset, buffer_size);
+    }
+
+    offset = AlignUp(offset, kBufferAlignment);
+    entry->weights.buffers_.reserve(num_buffers);
+    entry->weights.buffer_sizes_.reserve(num_buffers);
+    for (const uint64_t buffer_size : buffer_sizes) {
+      if (offset > file_size || file_size - offset < buffer_size) {
+        valid = false;
+        break;
+      }
+
+      // the mapping is released by the destructor
+      void* buffer = buffer_size > 0 ? const_cast<char*>(data + offset) : nullptr;
+      entry->weights.buffers_.emplace_back(buffer, [](void*) {});
+      entry->weights.buffer_sizes_.push_back(static_cast<size_t>(buffer_size));
+      offset += AlignUp(static_cast<size_t>(buffer_size), kBufferAlignment);
+    }
+  }
+
+  if (!valid) {
+    LOGS(logger_, INFO) << "Ignoring pre-packed weights cache file " << file_path.string()
+                        << " as it doesn't match the key or is incomplete.";
+    ++num_misses_;
+    return nullptr;
+  }
+
+  ++num_hits_;
+  entries_.push_back(std::move(entry));
+  return &entries_.back()->weights;
+}
+
+void PrepackedWeightsDiskCache::Save(const std::string& key, const PrePackedWeights& weights) {
+  const std::filesystem::path file_path = GetFilePath(key);
+  std::filesystem::path temp_file_path = file_path;
+  temp_file_path += "." + std::to_string(Env::Default().GetSelfPid()) + ".tmp";
+
+  const std::string full_key = fingerprint_ + "\n" + key;
+  bool written = false;
+  {
+    std::ofstream stream(temp_file_path, std::ios::binary | std::ios::trunc);
+    if (stream) {
+      stream.write(kMagic, sizeof(kMagic));
+      WriteUInt64(stream, kFormatVersion);
+      WriteUInt64(stream, full_key.size());
+      stream.write(full_key.data(), full_key.size());
+      WriteUInt64(stream, weights.buffers_.size());
+      for (size_t i = 0, end = weights.buffers_.size(); i < end; ++i) {
+        WriteUInt64(stream, weights.buffers_[i] != nullptr ? weights.buffer_sizes_[i] : 0);
+      }
+
+      const std::string padding(kBufferAlignment, '\0');
+      size_t offset = static_cast<size_t>(stream.tellp());
+      for (size_t i = 0, end = weights.buffers_.size(); i < end; ++i) {
+        stream.write(padding.data(), AlignUp(offset, kBufferAlignment) - offset);
+        offset = AlignUp(offset, kBufferAlignment);
+        if (weights.buffers_[i] != nullptr) {
+          stream.write(static_cast<const char*>(weights.buffers_[i].get()), weights.buffer_sizes_[i]);
+          offset += weights.buffer_sizes_[i];
+        }
+      }
+
+      written = static_cast<bool>(stream.flush());
+    }
+  }
+
+  std::error_code error;
+  if (written) {
+    // replaces an existing file atomically, so sessions loading it concurrently see either file
+    std::filesystem::rename(temp_file_path, file_path, error);
+  }
+
+  if (!written || error) {
+    LOGS(logger_, WARNING) << "Failed to write pre-packed weights cache file " << file_path.string()
+                           << (error ? ": " + error.message() : std::string());
+    std::filesystem::remove(temp_file_path, error);
+    return;
+  }
+
+  ++num_saved_;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/prepacked_weights.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+class Node;
+class Tensor;
+
+/**
+ * Stores pre-packed weights in files so that later sessions skip packing the weights again.
+ *
+ * An entry is keyed by the op type, attributes and input and output types of the node, the input index, and the
+ * data type, shape and content hash of the constant initializer. The key also contains a fingerprint of the
+ * onnxruntime build and the CPU features, as the layout MLAS packs weights in depends on both. Entries written by
+ * a different build or on a different CPU are ignored and overwritten.
+ *
+ * Files are mapped into memory read-only, so the pages are shared by all processes that load the same entry and are
+ * read from disk only when a kernel touches them. Files are written to a temporary name and renamed, so concurrent
+ * sessions never see partially written entries. Failing to read or write an entry is not an error; the kernel packs
+ * the weights as usual.
+ *
+ * Not thread-safe. An instance is used by the initialization of one session.
+ */
+class PrepackedWeightsDiskCache {
+ public:
+  PrepackedWeightsDiskCache(std::filesystem::path directory, const logging::Logger& logger);
+
+  // Returns the key of the weights a node packs from a constant initializer.
+  static std::string GetKey(const Node& node, int input_idx, const Tensor& tensor);
+
+  /**
+   * Look up pre-packed weights.
+   * @returns The weights, or nullptr on a miss. The buffers point into a read-only mapping of the file and stay
+   *          valid until this instance is destroyed.
+   */
+  const PrePackedWeights* Load(const std::string& key);
+
+  // Write pre-packed weights. The weights are not modified.
+  void Save(const std::string& key, const PrePackedWeights& weights);
+
+  size_t NumHits() const { return num_hits_; }
+  size_t NumMisses() const { return num_misses_; }
+  size_t NumSaved() const { return num_saved_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PrepackedWeightsDiskCache);
+
+  struct Entry {
+    Env::MappedMemoryPtr mapped_file;
+    PrePackedWeights weights;
+  };
+
+  std::filesystem::path GetFilePath(const std::string& key) const;
+
+  const std::filesystem::path directory_;
+  const std::string fingerprint_;
+  const logging::Logger& logger_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  size_t num_hits_ = 0;
+  size_t num_misses_ = 0;
+  size_t num_saved_ = 0;
+};
+
+}  // namespace onnxruntime
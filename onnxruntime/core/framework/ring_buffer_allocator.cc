@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/ring_buffer_allocator.h"
+
+#include <algorithm>
+
+#include "core/common/alignment.h"
+#include "core/common/logging/logging.h"
+#include "core/common/narrow.h"
+
+namespace onnxruntime {
+
+namespace {
+// slots start on a cache line boundary. matches the alignment kernels expect from the CPU allocator.
+constexpr size_t kSlotAlignment = 64;
+
+// number of bytes to skip at the start of the buffer so that every slot is aligned
+size_t AlignmentPadding(const void* buffer) {
+  const auto address = reinterpret_cast<uintptr_t>(buffer);
+  return AlignUp(address, kSlotAlignment) - address;
+}
+}  // namespace
+
+RingBufferAllocator::RingBufferAllocator(void* buffer, size_t buffer_size, const OrtMemoryInfo& memory_info)
+    : IAllocator(memory_info),
+      buffer_(static_cast<uint8_t*>(buffer) + std::min(AlignmentPadding(buffer), buffer_size)),
+      capacity_(buffer_size - std::min(AlignmentPadding(buffer), buffer_size)) {
+  ORT_ENFORCE(buffer != nullptr, "The ring buffer must not be null.");
+  stats_.bytes_limit = narrow<int64_t>(capacity_);
+}
+
+void* RingBufferAllocator::Alloc(size_t size) {
+  // a zero sized tensor still needs a distinct address
+  const size_t slot_size = AlignUp(std::max<size_t>(size, 1), kSlotAlignment);
+  if (slot_size < size || slot_size > capacity_) {
+    return nullptr;
+  }
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+
+  size_t offset = 0;
+  if (!slots_.empty()) {
+    const Slot& oldest = slots_.front();
+    const Slot& newest = slots_.back();
+    const size_t end = newest.offset + newest.size;
+    if (newest.offset >= oldest.offset) {
+      // the live slots are contiguous. use the space after them, or wrap around to the space before them.
+      if (capacity_ - end >= slot_size) {
+        offset = end;
+      } else if (oldest.offset >= slot_size) {
+        offset = 0;
+      } else {
+        return nullptr;
+      }
+    } else {
+      // the live slots have wrapped around. the only free space is between the newest and the oldest.
+      if (oldest.offset - end >= slot_size) {
+        offset = end;
+      } else {
+        return nullptr;
+      }
+    }
+  }
+
+  slots_.push_back({offset, slot_size, false});
+
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += narrow<int64_t>(slot_size);
+  stats_.total_allocated_bytes += narrow<int64_t>(slot_size);
+  stats_.max_bytes_in_use = std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
+  stats_.max_alloc_size = std::max(stats_.max_alloc_size, narrow<int64_t>(slot_size));
+
+  return buffer_ + offset;
+}
+
+void RingBufferAllocator::Free(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+
+  // Free is called from the destructors of tensors, so a pointer that is not a live slot is reported instead of
+  // throwing. It is left alone, as freeing it with another allocator could free memory this one never owned.
+  auto* ptr = static_cast<uint8_t*>(p);
+  if (ptr < buffer_ || ptr >= buffer_ + capacity_) {
+    LOGS_DEFAULT(ERROR) << "RingBufferAllocator::Free called with a pointer that was not allocated from the ring "
+                        << "buffer. It is ignored.";
+    return;
+  }
+
+  const auto offset = static_cast<size_t>(ptr - buffer_);
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+
+  auto it = std::find_if(slots_.begin(), slots_.end(),
+                         [offset](const Slot& slot) { return slot.offset == offset && !slot.released; });
+  if (it == slots_.end()) {
+    LOGS_DEFAULT(ERROR) << "RingBufferAllocator::Free called with a pointer that is not a live slot of the ring "
+                        << "buffer, e.g. one that was already freed. It is ignored.";
+    return;
+  }
+
+  it->released = true;
+  stats_.bytes_in_use -= narrow<int64_t>(it->size);
+
+  // space is reclaimed in allocation order
+  while (!slots_.empty() && slots_.front().released) {
+    slots_.pop_front();
+  }
+}
+
+void RingBufferAllocator::GetStats(AllocatorStats* stats) {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  *stats = stats_;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <deque>
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/framework/allocator_stats.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+ * Hands out slots of a caller provided buffer in FIFO order.
+ *
+ * This is used to place graph outputs directly into memory owned by the caller (e.g. a pinned network buffer).
+ * Every allocation takes the next free range after the most recent one, wrapping around to the start of the buffer.
+ * A slot becomes free again when it is passed to Free, which happens when the last OrtValue referring to a tensor
+ * in the slot is released. Slots may be freed in any order, but space is only reclaimed from the oldest live slot,
+ * so a long-lived slot keeps the ones after it from being reused.
+ *
+ * Unlike most allocators, Alloc returns nullptr if there is no free range large enough for the request so the
+ * caller can fall back to a regular allocator.
+ *
+ * The buffer is not owned and must outlive every tensor allocated from it.
+ */
+class RingBufferAllocator : public IAllocator {
+ public:
+  RingBufferAllocator(void* buffer, size_t buffer_size, const OrtMemoryInfo& memory_info);
+
+  void* Alloc(size_t size) override;
+  void Free(void* p) override;
+  void GetStats(AllocatorStats* stats) override;
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(RingBufferAllocator);
+
+  struct Slot {
+    size_t offset;
+    size_t size;
+    bool released;
+  };
+
+  uint8_t* const buffer_;
+  const size_t capacity_;
+
+  OrtMutex mutex_;
+  // live slots, oldest first
+  std::deque<Slot> slots_;
+  AllocatorStats stats_;
+};
+
+}  // namespace onnxruntime
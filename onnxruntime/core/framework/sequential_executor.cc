@@ -4,6 +4,7 @@
 #include "core/framework/sequential_executor.h"
 
 #include <chrono>
+#include <optional>
 #include <thread>
 #include <vector>
 #include <sstream>
@@ -138,6 +139,31 @@ static void CalculateTotalInputSizes(const OpKernelContextInternal* op_kernel_co
   input_type_shape = ss.str();
 }
 
+// Keys the parallel loops of a kernel for the loop cost table by the prefix of its node, "<domain>:<op type>:", the
+// type of its first input and the total number of elements of its inputs rounded up to a power of two, as the cost of
+// an iteration may depend on the size. The key is only built as a string when the loops are calibrated. Otherwise the
+// hash of the node's precomputed prefix is extended with the rest of the key.
+static void GetLoopCostKeySuffix(const OpKernelContextInternal& kernel_context, const char*& element_type,
+                                 int& size_class) {
+  element_type = "";
+  int64_t num_elements = 0;
+  for (int i = 0, end = kernel_context.InputCount(); i < end; ++i) {
+    const OrtValue* p_input = kernel_context.GetInputMLValue(i);
+    if (p_input != nullptr && p_input->IsTensor()) {
+      const Tensor& tensor = p_input->Get<Tensor>();
+      if (i == 0) {
+        element_type = DataTypeImpl::ToString(tensor.DataType());
+      }
+      num_elements += tensor.Shape().Size();
+    }
+  }
+
+  size_class = 0;
+  while (size_class < 62 && (int64_t{1} << size_class) < num_elements) {
+    ++size_class;
+  }
+}
+
 class KernelScope;
 
 #ifdef CONCURRENCY_VISUALIZER
@@ -334,6 +360,24 @@ class KernelScope {
     node_compute_range_.Begin();
 #endif
 
+    if (auto* loop_cost_table = session_state_.GetLoopCostTable()) {
+      const NodeIndex node_index = kernel.Node().Index();
+      const char* element_type = nullptr;
+      int size_class = 0;
+      GetLoopCostKeySuffix(kernel_context_, element_type, size_class);
+      if (session_state_.GetCalibrateLoopCosts()) {
+        loop_cost_.emplace(loop_cost_table, MakeString(session_state_.GetLoopCostKeyPrefix(node_index), element_type,
+                                                       ":", size_class),
+                           /*calibrate*/ true);
+      } else {
+        using LoopCostTable = concurrency::ThreadPool::LoopCostTable;
+        uint64_t key_hash = LoopCostTable::HashKey(element_type,
+                                                   session_state_.GetLoopCostKeyPrefixHash(node_index));
+        key_hash = LoopCostTable::HashKey(size_class, LoopCostTable::HashKey(":", key_hash));
+        loop_cost_.emplace(loop_cost_table, key_hash);
+      }
+    }
+
     if (session_state_.Profiler().IsEnabled()) {
       auto& node = kernel.Node();
       node_name_ = node.Name().empty() ? MakeString(node.OpType(), "_", node.Index()) : node.Name();
@@ -418,6 +462,8 @@ class KernelScope {
   size_t total_output_sizes_{};
   std::string input_type_shape_;
 
+  std::optional<concurrency::ThreadPool::ScopedLoopCost> loop_cost_;
+
 #ifdef CONCURRENCY_VISUALIZER
   diagnostic::span span_;
 #endif
@@ -452,7 +498,8 @@ onnxruntime::Status ExecuteKernel(StreamExecutionContext& ctx,
                                      *p_kernel,
                                      ctx.GetLogger(),
                                      terminate_flag,
-                                     ctx.GetDeviceStream(stream_idx));
+                                     ctx.GetDeviceStream(stream_idx),
+                                     ctx.GetDeadline());
   onnxruntime::Status status;
   auto& logger = ctx.GetLogger();
   if (p_kernel->IsAsync()) {
@@ -519,6 +566,31 @@ onnxruntime::Status ExecuteKernel(StreamExecutionContext& ctx,
   return Status::OK();
 }
 
+// Get the fetches of a completed execution and cache the memory pattern it traced, if any.
+static Status CollectOutputs(const SessionState& session_state, StreamExecutionContext& ctx,
+                             gsl::span<const int> feed_mlvalue_idxs, gsl::span<const OrtValue> feeds,
+                             std::vector<OrtValue>& fetches) {
+  ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GetOutputs(fetches));
+  if (ctx.GetExecutionFrame().HasMemoryPatternPlanner()) {
+    bool all_tensors = true;
+    for (const auto& feed : feeds) {
+      if (!(feed.IsTensor())) {
+        all_tensors = false;
+        break;
+      }
+    }
+
+    if (all_tensors) {
+      MemoryPatternGroup mem_patterns;
+      ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GeneratePatterns(mem_patterns));
+      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(feeds, feed_mlvalue_idxs,
+                                                                       std::move(mem_patterns)));
+    }
+  }
+
+  return Status::OK();
+}
+
 onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<const int> feed_mlvalue_idxs,
                                    gsl::span<const OrtValue> feeds, gsl::span<const int> fetch_mlvalue_idxs,
                                    std::vector<OrtValue>& fetches,
@@ -529,7 +601,8 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
 #endif
                                    const bool& terminate_flag,
                                    const bool only_execute_path_to_fetches,
-                                   bool single_thread_mode) {
+                                   bool single_thread_mode,
+                                   std::optional<std::chrono::steady_clock::time_point> deadline) {
   auto* execution_plan = session_state.GetExecutionPlan();
   LOGS(logger, VERBOSE) << "Number of streams: " << execution_plan->execution_plan.size();
   int32_t valid_streams = 0;
@@ -572,6 +645,10 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
   ORT_UNUSED_PARAMETER(only_execute_path_to_fetches);
 #endif
 
+  if (deadline) {
+    ctx.SetDeadline(*deadline);
+  }
+
   SessionScope session_scope(session_state, ctx.GetExecutionFrame());
 
   auto* tp = single_thread_mode ? nullptr : session_state.GetInterOpThreadPool();
@@ -591,24 +668,7 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
 
   ctx.WaitAll();
   ORT_RETURN_IF_ERROR(ctx.TaskStatus());
-  ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GetOutputs(fetches));
-  if (ctx.GetExecutionFrame().HasMemoryPatternPlanner()) {
-    bool all_tensors = true;
-    for (const auto& feed : feeds) {
-      if (!(feed.IsTensor())) {
-        all_tensors = false;
-        break;
-      }
-    }
-
-    if (all_tensors) {
-      MemoryPatternGroup mem_patterns;
-      ORT_RETURN_IF_ERROR(ctx.GetExecutionFrame().GeneratePatterns(mem_patterns));
-      ORT_RETURN_IF_ERROR(session_state.UpdateMemoryPatternGroupCache(feeds, std::move(mem_patterns)));
-    }
-  }
-
-  return Status::OK();
+  return CollectOutputs(session_state, ctx, feed_mlvalue_idxs, feeds, fetches);
 }
 
 #ifdef ENABLE_TRAINING
@@ -663,4 +723,121 @@ onnxruntime::Status PartialExecuteThePlan(const SessionState& session_state, gsl
 }
 #endif
 
+bool StagedPlanExecution::IsSupported(const SessionState& session_state) {
+  return NumSteps(session_state) > 0;
+}
+
+size_t StagedPlanExecution::NumSteps(const SessionState& session_state) {
+  const auto* plan = session_state.GetExecutionPlan();
+  if (plan == nullptr) {
+    return 0;
+  }
+
+  size_t num_steps = 0;
+  size_t num_streams = 0;
+  for (const auto& stream : plan->execution_plan) {
+    if (stream && !stream->steps_.empty()) {
+      num_steps = stream->steps_.size();
+      ++num_streams;
+    }
+  }
+
+  return num_streams == 1 ? num_steps : 0;
+}
+
+StagedPlanExecution::StagedPlanExecution(const SessionState& session_state,
+                                         gsl::span<const int> feed_mlvalue_idxs, std::vector<OrtValue> feeds,
+                                         gsl::span<const int> fetch_mlvalue_idxs, std::vector<OrtValue> fetches,
+                                         const logging::Logger& logger,
+                                         std::optional<std::chrono::steady_clock::time_point> deadline)
+    : session_state_(session_state),
+      feed_mlvalue_idxs_(feed_mlvalue_idxs.begin(), feed_mlvalue_idxs.end()),
+      fetch_mlvalue_idxs_(fetch_mlvalue_idxs.begin(), fetch_mlvalue_idxs.end()),
+      feeds_(std::move(feeds)),
+      fetches_(std::move(fetches)) {
+  const auto* plan = session_state.GetExecutionPlan();
+  ORT_ENFORCE(IsSupported(session_state), "The execution plan cannot be executed in stages.");
+  for (size_t i = 0; i < plan->execution_plan.size(); ++i) {
+    if (plan->execution_plan[i] && !plan->execution_plan[i]->steps_.empty()) {
+      stream_idx_ = i;
+    }
+  }
+
+  static const std::unordered_map<size_t, IExecutor::CustomAllocator> no_fetch_allocators;
+#ifdef ORT_ENABLE_STREAM
+  device_stream_collection_holder_ = std::make_unique<DeviceStreamCollectionHolder>(&session_state);
+  ctx_ = std::make_unique<StreamExecutionContext>(session_state,
+                                                  1,
+                                                  plan->notification_owners,
+                                                  plan->num_barriers,
+                                                  device_stream_collection_holder_->p_.get(),
+                                                  feed_mlvalue_idxs_,
+                                                  feeds_,
+                                                  fetch_mlvalue_idxs_,
+                                                  fetches_,
+                                                  no_fetch_allocators,
+                                                  logger,
+                                                  /*single_thread_mode*/ true);
+#else
+  ctx_ = std::make_unique<StreamExecutionContext>(session_state,
+                                                  1,
+                                                  feed_mlvalue_idxs_,
+                                                  feeds_,
+                                                  fetch_mlvalue_idxs_,
+                                                  fetches_,
+                                                  no_fetch_allocators,
+                                                  logger,
+                                                  /*single_thread_mode*/ true);
+#endif
+  if (deadline) {
+    ctx_->SetDeadline(*deadline);
+  }
+
+  session_scope_ = std::make_unique<SessionScope>(session_state, ctx_->GetExecutionFrame());
+}
+
+StagedPlanExecution::~StagedPlanExecution() {
+  // the session scope refers to the execution frame owned by the context
+  session_scope_.reset();
+  ctx_.reset();
+}
+
+Status StagedPlanExecution::ExecuteSteps(size_t begin, size_t end, const bool& terminate_flag) {
+  const auto& steps = session_state_.GetExecutionPlan()->execution_plan[stream_idx_]->steps_;
+  ORT_RETURN_IF(begin > end || end > steps.size(), "Invalid range of execution plan steps [", begin, ", ", end, ")");
+
+  for (size_t i = begin; i < end; ++i) {
+    ORT_RETURN_IF(terminate_flag, "Exiting due to terminate flag being set to true.");
+    ORT_RETURN_IF(ctx_->DeadlineExceeded(), "Exiting due to the run deadline being exceeded.");
+
+    bool continue_flag = true;
+    Status status;
+    ORT_TRY {
+      status = steps[i]->Execute(*ctx_, stream_idx_, *session_scope_, terminate_flag, continue_flag);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      });
+    }
+    ORT_RETURN_IF_ERROR(status);
+    // a single stream never waits for another one
+    ORT_RETURN_IF_NOT(continue_flag, "Execution plan step ", i, " did not complete.");
+  }
+
+  return ctx_->TaskStatus();
+}
+
+Status StagedPlanExecution::Finish(std::vector<OrtValue>& fetches) {
+  auto retval = CollectOutputs(session_state_, *ctx_, feed_mlvalue_idxs_, feeds_, fetches_);
+#ifdef ORT_ENABLE_STREAM
+  if (auto* device_stream_collection = device_stream_collection_holder_->p_.get()) {
+    ORT_CHECK_AND_SET_RETVAL(device_stream_collection->CleanUp(false));
+  }
+#endif
+  ORT_RETURN_IF_ERROR(retval);
+  fetches = std::move(fetches_);
+  return Status::OK();
+}
+
 }  // namespace onnxruntime
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <vector>
 #include "core/common/common.h"
 #include "core/common/status.h"
@@ -23,6 +25,7 @@ namespace onnxruntime {
 
 class StreamExecutionContext;
 class DeviceStreamCollection;
+struct DeviceStreamCollectionHolder;
 class SessionScope;
 
 #ifdef ENABLE_TRAINING
@@ -46,7 +49,8 @@ onnxruntime::Status ExecuteThePlan(const SessionState& session_state, gsl::span<
 #endif
                                    const bool& terminate_flag,
                                    const bool only_execute_path_to_fetches,
-                                   bool single_thread_mode);
+                                   bool single_thread_mode,
+                                   std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
 
 #ifdef ENABLE_TRAINING
 onnxruntime::Status PartialExecuteThePlan(const SessionState& session_state, gsl::span<const int> feed_mlvalue_idxs,
@@ -61,4 +65,56 @@ onnxruntime::Status PartialExecuteThePlan(const SessionState& session_state, gsl
                                           const OrtValueCachePtr& cache,
                                           int32_t partial_graph_index);
 #endif
+
+/**
+ * One execution of the main graph that is driven by the caller in contiguous ranges of execution plan steps
+ * instead of all at once. The ranges do not need to be executed on the same thread, which allows consecutive
+ * executions to overlap: the first steps of one execution can run while the last steps of the previous one are
+ * still running. Each execution has its own execution frame.
+ *
+ * Only execution plans with a single logic stream are supported.
+ */
+class StagedPlanExecution {
+ public:
+  // Whether the execution plan of session_state can be executed in stages.
+  static bool IsSupported(const SessionState& session_state);
+
+  // Number of steps of the execution plan of session_state. 0 if it cannot be executed in stages.
+  static size_t NumSteps(const SessionState& session_state);
+
+  // If deadline is set, the execution is aborted at the next step once it has passed.
+  StagedPlanExecution(const SessionState& session_state,
+                      gsl::span<const int> feed_mlvalue_idxs, std::vector<OrtValue> feeds,
+                      gsl::span<const int> fetch_mlvalue_idxs, std::vector<OrtValue> fetches,
+                      const logging::Logger& logger,
+                      std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
+  ~StagedPlanExecution();
+
+  /**
+   * Execute the steps [begin, end) of the execution plan.
+   * Ranges must be executed in order, without gaps and by one thread at a time.
+   */
+  Status ExecuteSteps(size_t begin, size_t end, const bool& terminate_flag);
+
+  /**
+   * Collect the fetches once all the steps have been executed.
+   */
+  Status Finish(std::vector<OrtValue>& fetches);
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(StagedPlanExecution);
+
+  const SessionState& session_state_;
+  const InlinedVector<int> feed_mlvalue_idxs_;
+  const InlinedVector<int> fetch_mlvalue_idxs_;
+  const std::vector<OrtValue> feeds_;
+  std::vector<OrtValue> fetches_;
+  size_t stream_idx_ = 0;
+
+#ifdef ORT_ENABLE_STREAM
+  std::unique_ptr<DeviceStreamCollectionHolder> device_stream_collection_holder_;
+#endif
+  std::unique_ptr<StreamExecutionContext> ctx_;
+  std::unique_ptr<SessionScope> session_scope_;
+};
 }  // namespace onnxruntime
@@ -3,11 +3,17 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "core/platform/ort_mutex.h"
+#include "core/common/hash_combine.h"
 #include "core/common/logging/logging.h"
+#include "core/common/parse_string.h"
+#include "core/common/path_string.h"
 #include "core/common/safeint.h"
+#include "core/common/string_utils.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/framework/allocator.h"
 #include "core/framework/node_index_info.h"
@@ -205,6 +211,27 @@ Status SessionState::PopulateKernelCreateInfo(const KernelRegistryManager& kerne
   return Status::OK();
 }
 
+void SessionState::SetLoopCostTable(concurrency::ThreadPool::LoopCostTable* table, bool calibrate) {
+  loop_cost_table_ = table;
+  calibrate_loop_costs_ = calibrate;
+  if (table != nullptr && loop_cost_key_prefixes_.empty()) {
+    // the kernels key their loops with the prefix of their node, so it is only built once
+    loop_cost_key_prefixes_.resize(graph_viewer_->MaxNodeIndex());
+    loop_cost_key_prefix_hashes_.resize(graph_viewer_->MaxNodeIndex());
+    for (const auto& node : graph_viewer_->Nodes()) {
+      auto& prefix = loop_cost_key_prefixes_[node.Index()];
+      prefix = MakeString(node.Domain(), ":", node.OpType(), ":");
+      loop_cost_key_prefix_hashes_[node.Index()] = concurrency::ThreadPool::LoopCostTable::HashKey(prefix);
+    }
+  }
+
+  for (const auto& entry : subgraph_session_states_) {
+    for (const auto& name_to_subgraph_session_state : entry.second) {
+      name_to_subgraph_session_state.second->SetLoopCostTable(table, calibrate);
+    }
+  }
+}
+
 const KernelCreateInfo& SessionState::GetNodeKernelCreateInfo(NodeIndex node_index) const {
   auto entry = kernel_create_info_map_.find(node_index);
   // invalid node index or FinalizeSessionState should have been called. Either way it's an internal logic error
@@ -384,6 +411,116 @@ static Status KernelUseSharedPrePackedBuffers(OpKernel& kernel, int input_idx,
   return Status::OK();
 }
 
+SharedMemoryPrepackedWeights* SessionState::GetSharedMemoryPrepackedWeights() {
+  if (parent_ != nullptr) {
+    return parent_->GetSharedMemoryPrepackedWeights();
+  }
+
+  if (!shared_memory_prepacked_weights_) {
+    const std::string name_prefix =
+        sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigSharedPrepackedWeightsPrefix, "");
+    if (name_prefix.empty()) {
+      return nullptr;
+    }
+
+    shared_memory_prepacked_weights_ = std::make_unique<SharedMemoryPrepackedWeights>(name_prefix, logger_);
+  }
+
+  return shared_memory_prepacked_weights_.get();
+}
+
+PrepackedWeightsDiskCache* SessionState::GetPrepackedWeightsDiskCache() {
+  if (parent_ != nullptr) {
+    return parent_->GetPrepackedWeightsDiskCache();
+  }
+
+  if (!prepacked_weights_disk_cache_) {
+    const std::string directory =
+        sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigPrepackedWeightsCacheDir, "");
+    if (directory.empty()) {
+      return nullptr;
+    }
+
+    prepacked_weights_disk_cache_ = std::make_unique<PrepackedWeightsDiskCache>(ToPathString(directory), logger_);
+  }
+
+  return prepacked_weights_disk_cache_.get();
+}
+
+Status SessionState::PrepackWithSharedMemoryOrDiskCache(const Node& node, OpKernel& kernel, int input_idx,
+                                                        const Tensor& tensor, /*out*/ bool& is_packed) {
+  SharedMemoryPrepackedWeights* shared_memory_weights = GetSharedMemoryPrepackedWeights();
+  PrepackedWeightsDiskCache* disk_cache = GetPrepackedWeightsDiskCache();
+
+  // an entry is only written if there is none, so kernels that can't use cached weights don't rewrite theirs
+  // on every session creation
+  std::string disk_cache_key;
+  bool save_to_disk_cache = false;
+  if (disk_cache != nullptr) {
+    disk_cache_key = PrepackedWeightsDiskCache::GetKey(node, input_idx, tensor);
+    const PrePackedWeights* cached_weights = disk_cache->Load(disk_cache_key);
+    save_to_disk_cache = cached_weights == nullptr;
+    if (cached_weights != nullptr) {
+      std::vector<BufferUniquePtr> cached_buffers;
+      cached_buffers.reserve(cached_weights->buffers_.size());
+      for (const auto& cached_buffer : cached_weights->buffers_) {
+        // BufferDeleter is nullptr because the buffers point into a file mapped by the cache
+        cached_buffers.emplace_back(cached_buffer.get(), BufferDeleter(nullptr));
+      }
+
+      bool used_cached_buffers = false;
+      ORT_RETURN_IF_ERROR(kernel.UseCachedPrePackedBuffers(tensor, cached_buffers, input_idx, used_cached_buffers));
+      if (used_cached_buffers) {
+        is_packed = true;
+        return Status::OK();
+      }
+    }
+  }
+
+  AllocatorPtr session_cpu_alloc = GetAllocator(kernel.Info().GetDevice(OrtMemType::OrtMemTypeDefault));
+  PrePackedWeights weights_to_be_filled_in;
+  ORT_RETURN_IF_ERROR(kernel.PrePack(tensor, input_idx, session_cpu_alloc, is_packed, &weights_to_be_filled_in));
+
+  // kernels that can't use shared pre-packed weights keep their own copy
+  if (!is_packed || weights_to_be_filled_in.buffers_.empty()) {
+    return Status::OK();
+  }
+
+  if (shared_memory_weights != nullptr) {
+    bool attached = false;
+    const PrePackedWeights& shared_weights = shared_memory_weights->Share(
+        node.OpType(), std::move(weights_to_be_filled_in), attached);
+    if (save_to_disk_cache) {
+      disk_cache->Save(disk_cache_key, shared_weights);
+    }
+
+    ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(kernel, input_idx, shared_weights, node.Name()));
+    if (attached) {
+      ++used_shared_pre_packed_weights_counter_;
+    }
+
+    return Status::OK();
+  }
+
+  if (save_to_disk_cache) {
+    disk_cache->Save(disk_cache_key, weights_to_be_filled_in);
+  }
+
+  // hand the buffers back to the kernel, which owns them as if PrePack() had been called without PrePackedWeights
+  std::vector<BufferUniquePtr> prepacked_buffers;
+  prepacked_buffers.reserve(weights_to_be_filled_in.buffers_.size());
+  for (auto& prepacked_buffer : weights_to_be_filled_in.buffers_) {
+    prepacked_buffers.emplace_back(prepacked_buffer.release(), BufferDeleter(session_cpu_alloc));
+  }
+
+  bool used_shared_buffers = false;
+  ORT_RETURN_IF_ERROR(kernel.UseSharedPrePackedBuffers(prepacked_buffers, input_idx, used_shared_buffers));
+  ORT_RETURN_IF_NOT(used_shared_buffers, "The kernel corresponding to the node ", node.Name(),
+                    " doesn't have an implementation that can consume provided pre-packed weights");
+
+  return Status::OK();
+}
+
 static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
                                                      const PrePackedWeights& pre_packed_weights) {
   std::ostringstream ss_1;
@@ -476,6 +613,11 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
                     }
                   }
 
+                } else if (node.GetExecutionProviderType() == kCpuExecutionProvider &&
+                           (GetSharedMemoryPrepackedWeights() != nullptr ||
+                            GetPrepackedWeightsDiskCache() != nullptr)) {  // pre-packed weights in shared memory or on disk
+                  ORT_RETURN_IF_ERROR(PrepackWithSharedMemoryOrDiskCache(node, *kernel, input_idx,
+                                                                         const_initialized_tensor, is_packed));
                 } else {  // caching of pre-packed weights' turned OFF
                   AllocatorPtr session_cpu_alloc = GetAllocator(kernel->Info().GetDevice(OrtMemType::OrtMemTypeDefault));
                   ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx,
@@ -523,14 +665,102 @@ Status SessionState::PrepackConstantInitializedTensors(InlinedHashMap<std::strin
   }
 }
 
-static int64_t CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs) {
-  int64_t key = 0;
-  for (const auto& input : tensor_inputs) {
-    for (auto dim : input.Get<Tensor>().Shape().GetDims()) key ^= dim;
+namespace {
+int64_t RoundUpToBucket(int64_t dim, int64_t bucket_size) {
+  if (dim <= 0) {
+    return dim;
+  }
+
+  if (bucket_size > 0) {
+    return (SafeInt<int64_t>(dim) + bucket_size - 1) / bucket_size * bucket_size;
+  }
+
+  int64_t bucket = 1;
+  while (bucket < dim && bucket <= std::numeric_limits<int64_t>::max() / 2) {
+    bucket <<= 1;
+  }
+  return std::max(bucket, dim);
+}
+
+// A pattern generated for larger inputs has blocks that are large enough for smaller inputs in the same bucket
+bool FitsMemoryPattern(gsl::span<const int64_t> dims, gsl::span<const int64_t> pattern_dims) {
+  return dims.size() == pattern_dims.size() &&
+         std::equal(dims.begin(), dims.end(), pattern_dims.begin(),
+                    [](int64_t dim, int64_t pattern_dim) { return dim <= pattern_dim; });
+}
+
+size_t TotalPeakSize(const MemoryPatternGroup& mem_patterns) {
+  size_t total = 0;
+  for (const auto& pattern : mem_patterns.patterns) {
+    total += pattern.PeakSize();
+  }
+  return total;
+}
+
+// The smallest of the patterns that fit the input dims, or end if none does
+template <typename MemoryPatterns>
+auto FindFittingMemoryPattern(MemoryPatterns& patterns, gsl::span<const int64_t> dims) {
+  auto best = patterns.end();
+  for (auto it = patterns.begin(); it != patterns.end(); ++it) {
+    if (FitsMemoryPattern(dims, it->pattern_dims) &&
+        (best == patterns.end() || TotalPeakSize(*it->patterns) < TotalPeakSize(*best->patterns))) {
+      best = it;
+    }
+  }
+  return best;
+}
+}  // namespace
+
+size_t SessionState::CalculateMemoryPatternsKey(gsl::span<const OrtValue> tensor_inputs,
+                                                gsl::span<const int> feed_mlvalue_idxs,
+                                                InlinedVector<int64_t>& dims,
+                                                InlinedVector<int64_t>& bucket_dims) const {
+  for (size_t i = 0, end = tensor_inputs.size(); i < end; ++i) {
+    const auto input_dims = tensor_inputs[i].Get<Tensor>().Shape().GetDims();
+    dims.push_back(static_cast<int64_t>(input_dims.size()));
+    dims.insert(dims.end(), input_dims.begin(), input_dims.end());
+    bucket_dims.push_back(static_cast<int64_t>(input_dims.size()));
+    const size_t offset = bucket_dims.size();
+    bucket_dims.insert(bucket_dims.end(), input_dims.begin(), input_dims.end());
+
+    if (i < feed_mlvalue_idxs.size()) {
+      auto axes = mem_pattern_bucket_axes_.find(feed_mlvalue_idxs[i]);
+      if (axes != mem_pattern_bucket_axes_.end()) {
+        for (size_t axis : axes->second) {
+          if (axis < input_dims.size()) {
+            bucket_dims[offset + axis] = RoundUpToBucket(input_dims[axis], mem_pattern_bucket_size_);
+          }
+        }
+      }
+    }
+  }
+
+  size_t key = 0;
+  for (int64_t dim : bucket_dims) {
+    HashCombine(dim, key);
   }
   return key;
 }
 
+void SessionState::InsertMemoryPatternCacheEntry(size_t key, MemoryPatternCacheEntry entry) const {
+  auto existing = mem_patterns_.find(key);
+  if (existing != mem_patterns_.end()) {
+    mem_patterns_lru_.erase(existing->second.lru_it);
+    mem_patterns_.erase(existing);
+  }
+
+  mem_patterns_lru_.push_front(key);
+  entry.lru_it = mem_patterns_lru_.begin();
+  mem_patterns_.emplace(key, std::move(entry));
+
+  if (mem_pattern_cache_max_entries_ > 0 && mem_patterns_.size() > mem_pattern_cache_max_entries_) {
+    // running execution frames keep the evicted patterns alive until they are done with them
+    mem_patterns_.erase(mem_patterns_lru_.back());
+    mem_patterns_lru_.pop_back();
+    ++mem_patterns_stats_.evictions;
+  }
+}
+
 #ifdef ENABLE_TRAINING
 namespace {
 Status ResolveDimParams(const GraphViewer& graph,
@@ -615,7 +845,7 @@ void TryCalculateSizeFromResolvedShape(int ml_value_idx, const InlinedHashMap<in
 }  // namespace
 
 // If this function fails NO memory planning will take place, hence lets ONLY FAIL and stop training where warranted, example SIZE overflow.
-Status SessionState::GeneratePatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
+Status SessionState::GeneratePatternGroupCache(gsl::span<const TensorShape> input_shapes,
                                                gsl::span<const int> feed_mlvalue_idxs,
                                                MemoryPatternGroup& output,
                                                InlinedHashMap<int, TensorShape>& resolved_shapes) const {
@@ -624,7 +854,7 @@ Status SessionState::GeneratePatternGroupCache(gsl::span<const OrtValue> tensor_
   for (size_t i = 0, end = feed_mlvalue_idxs.size(); i < end; ++i) {
     std::string name;
     ORT_RETURN_IF_ERROR(this->ort_value_name_idx_map_.GetName(feed_mlvalue_idxs[i], name));
-    feeds.emplace(std::move(name), tensor_inputs[i].Get<Tensor>().Shape());
+    feeds.emplace(std::move(name), input_shapes[i]);
   }
   InlinedHashMap<std::string, int64_t> map;
   ORT_RETURN_IF_ERROR(ResolveDimParams(*graph_viewer_, feeds, map));
@@ -765,41 +995,80 @@ Status SessionState::GeneratePatternGroupCache(gsl::span<const OrtValue> tensor_
 
 #endif
 
-// MemoryPatternGroup pointer is cached. It only inserted upon creation
-// and is not updated if already present.
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
     gsl::span<const OrtValue> tensor_inputs,
     gsl::span<const int> feed_mlvalue_idxs,
-    const InlinedHashMap<int, TensorShape>*& out_inferred_shapes) const {
+    std::shared_ptr<const InlinedHashMap<int, TensorShape>>& out_inferred_shapes) const {
   out_inferred_shapes = nullptr;
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
+  InlinedVector<int64_t> dims;
+  InlinedVector<int64_t> bucket_dims;
+  size_t key = CalculateMemoryPatternsKey(tensor_inputs, feed_mlvalue_idxs, dims, bucket_dims);
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
   auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) {
+  if (it != mem_patterns_.end() && it->second.bucket_dims == bucket_dims) {
+    auto& entry = it->second;
+    auto pattern_it = FindFittingMemoryPattern(entry.patterns, dims);
+    if (pattern_it != entry.patterns.end()) {
+      ++mem_patterns_stats_.hits;
+      mem_patterns_lru_.splice(mem_patterns_lru_.begin(), mem_patterns_lru_, entry.lru_it);
+      std::rotate(entry.patterns.begin(), pattern_it, pattern_it + 1);
+      const auto& pattern = entry.patterns.front();
+      // the inferred shapes are the exact shapes of the inputs the pattern was generated for
+      if (pattern.pattern_dims == dims) {
+        out_inferred_shapes = pattern.inferred_shapes;
+      }
+      return pattern.patterns;
+    }
+  }
+
+  ++mem_patterns_stats_.misses;
 #ifdef ENABLE_TRAINING
-    MemoryPatternGroup mem_patterns;
-    InlinedHashMap<int, TensorShape> inferred_shapes;
-    if (GeneratePatternGroupCache(tensor_inputs, feed_mlvalue_idxs, mem_patterns, inferred_shapes).IsOK()) {
-      auto patt_insert = mem_patterns_.insert_or_assign(key, std::move(mem_patterns));
-      auto ptr = &patt_insert.first->second;
-      auto shape_insert = shape_patterns_.insert_or_assign(key, std::move(inferred_shapes));
-      out_inferred_shapes = &shape_insert.first->second;
-      return ptr;
+  // generate the pattern for the upper bound of the bucket so it fits every input shape in it
+  InlinedVector<TensorShape> input_shapes;
+  input_shapes.reserve(tensor_inputs.size());
+  for (size_t pos = 0; pos < bucket_dims.size(); pos += static_cast<size_t>(bucket_dims[pos]) + 1) {
+    input_shapes.emplace_back(gsl::make_span(bucket_dims).subspan(pos + 1, static_cast<size_t>(bucket_dims[pos])));
+  }
+
+  MemoryPatternGroup mem_patterns;
+  InlinedHashMap<int, TensorShape> inferred_shapes;
+  if (GeneratePatternGroupCache(input_shapes, feed_mlvalue_idxs, mem_patterns, inferred_shapes).IsOK()) {
+    // the pattern of the upper bound of the bucket fits all the shapes of the other patterns of the bucket
+    MemoryPattern pattern;
+    pattern.pattern_dims = bucket_dims;
+    pattern.patterns = std::make_shared<const MemoryPatternGroup>(std::move(mem_patterns));
+    pattern.inferred_shapes = std::make_shared<const InlinedHashMap<int, TensorShape>>(std::move(inferred_shapes));
+    if (pattern.pattern_dims == dims) {
+      out_inferred_shapes = pattern.inferred_shapes;
     }
-#else
-    ORT_UNUSED_PARAMETER(feed_mlvalue_idxs);
-#endif
-    return nullptr;
+    auto patterns = pattern.patterns;
+    MemoryPatternCacheEntry entry;
+    entry.bucket_dims = std::move(bucket_dims);
+    entry.patterns.push_back(std::move(pattern));
+    InsertMemoryPatternCacheEntry(key, std::move(entry));
+    return patterns;
   }
+#endif
+  return nullptr;
+}
 
-  auto patt_hit = shape_patterns_.find(key);
-  if (patt_hit != shape_patterns_.cend()) {
-    out_inferred_shapes = &patt_hit->second;
+size_t SessionState::GetMemoryPatternPeakSize(gsl::span<const OrtValue> tensor_inputs,
+                                              gsl::span<const int> feed_mlvalue_idxs) const {
+  InlinedVector<int64_t> dims;
+  InlinedVector<int64_t> bucket_dims;
+  size_t key = CalculateMemoryPatternsKey(tensor_inputs, feed_mlvalue_idxs, dims, bucket_dims);
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  auto it = mem_patterns_.find(key);
+  if (it == mem_patterns_.end() || it->second.bucket_dims != bucket_dims) {
+    return 0;
   }
-  return &it->second;
+
+  const auto& patterns = it->second.patterns;
+  auto pattern_it = FindFittingMemoryPattern(patterns, dims);
+  return pattern_it != patterns.end() ? TotalPeakSize(*pattern_it->patterns) : 0;
 }
 
-void SessionState::ResolveMemoryPatternFlag() {
+Status SessionState::ResolveMemoryPatternFlag() {
   if (enable_mem_pattern_) {
     for (auto* input : graph_viewer_->GetInputs()) {
       if (!input->HasTensorOrScalarShape()) {
@@ -843,18 +1112,156 @@ void SessionState::ResolveMemoryPatternFlag() {
       }
     }
   }
+
+  if (!enable_mem_pattern_) {
+    return Status::OK();
+  }
+
+  const auto& config_options = sess_options_.config_options;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMemoryPatternCacheMaxEntries, "0"),
+      mem_pattern_cache_max_entries_));
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMemoryPatternBucketSize, "0"),
+      mem_pattern_bucket_size_));
+  ORT_RETURN_IF(mem_pattern_bucket_size_ < 0, "Invalid memory pattern bucket size: ", mem_pattern_bucket_size_);
+  mem_pattern_reuse_buffers_ =
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMemoryPatternReuseBuffers, "0") == "1";
+
+  const std::string bucket_dims = config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMemoryPatternBucketDims,
+                                                                    "");
+  if (bucket_dims.empty()) {
+    return Status::OK();
+  }
+
+  const auto dim_params = utils::SplitString(bucket_dims, ",");
+  const bool bucket_all_dims = dim_params.size() == 1 && dim_params[0] == "*";
+  for (const auto* input : graph_viewer_->GetInputs()) {
+    const auto* shape = input->Shape();
+    int ort_value_idx = -1;
+    if (!shape || !ort_value_name_idx_map_.GetIdx(input->Name(), ort_value_idx).IsOK()) {
+      continue;
+    }
+
+    InlinedVector<size_t> axes;
+    for (int axis = 0, end = shape->dim_size(); axis < end; ++axis) {
+      const auto& dim = shape->dim(axis);
+      if (dim.has_dim_param() &&
+          (bucket_all_dims ||
+           std::find(dim_params.begin(), dim_params.end(), dim.dim_param()) != dim_params.end())) {
+        axes.push_back(static_cast<size_t>(axis));
+      }
+    }
+
+    if (!axes.empty()) {
+      mem_pattern_bucket_axes_.insert_or_assign(ort_value_idx, std::move(axes));
+    }
+  }
+
+  return Status::OK();
 }
 
 Status SessionState::UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
+                                                   gsl::span<const int> feed_mlvalue_idxs,
                                                    MemoryPatternGroup mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
+  for (size_t i = 0, end = mem_patterns.patterns.size(); i < end; ++i) {
+    const auto& pattern = mem_patterns.patterns[i];
+    LOGS(logger_, INFO) << "Memory pattern for " << mem_patterns.locations[i].ToString() << ": planned peak "
+                        << pattern.PeakSize() << " bytes, lower bound " << pattern.PeakSizeLowerBound() << " bytes";
+  }
+
+  InlinedVector<int64_t> dims;
+  InlinedVector<int64_t> bucket_dims;
+  size_t key = CalculateMemoryPatternsKey(tensor_inputs, feed_mlvalue_idxs, dims, bucket_dims);
+
+  MemoryPattern pattern;
+  pattern.pattern_dims = std::move(dims);
+  pattern.patterns = std::make_shared<const MemoryPatternGroup>(std::move(mem_patterns));
 
   std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
-  // Do not update if present, as the pointer to the existing one is cached
-  mem_patterns_.emplace(key, std::move(mem_patterns));
+  auto it = mem_patterns_.find(key);
+  if (it != mem_patterns_.end() && it->second.bucket_dims == bucket_dims) {
+    auto& entry = it->second;
+    auto& patterns = entry.patterns;
+    mem_patterns_lru_.splice(mem_patterns_lru_.begin(), mem_patterns_lru_, entry.lru_it);
+    if (std::any_of(patterns.begin(), patterns.end(), [&pattern](const MemoryPattern& cached) {
+          return FitsMemoryPattern(pattern.pattern_dims, cached.pattern_dims);
+        })) {
+      // a concurrent run added a pattern that fits these shapes already
+      return Status::OK();
+    }
+
+    // drop the patterns whose shapes all fit in the new one
+    patterns.erase(std::remove_if(patterns.begin(), patterns.end(),
+                                  [&pattern](const MemoryPattern& cached) {
+                                    return FitsMemoryPattern(cached.pattern_dims, pattern.pattern_dims);
+                                  }),
+                   patterns.end());
+    patterns.insert(patterns.begin(), std::move(pattern));
+    if (patterns.size() > kMaxMemoryPatternsPerBucket) {
+      // running execution frames keep the evicted patterns alive until they are done with them
+      patterns.pop_back();
+      ++mem_patterns_stats_.evictions;
+    }
+    return Status::OK();
+  }
+
+  MemoryPatternCacheEntry entry;
+  entry.bucket_dims = std::move(bucket_dims);
+  entry.patterns.push_back(std::move(pattern));
+  InsertMemoryPatternCacheEntry(key, std::move(entry));
   return Status::OK();
 }
 
+SessionState::MemoryPatternCacheStats SessionState::GetMemoryPatternCacheStats() const {
+  std::lock_guard<OrtMutex> lock(mem_patterns_lock_);
+  MemoryPatternCacheStats stats = mem_patterns_stats_;
+  stats.num_entries = mem_patterns_.size();
+  std::lock_guard<OrtMutex> buffers_lock(mem_pattern_buffers_lock_);
+  stats.buffer_reuses = mem_pattern_buffer_reuses_;
+  return stats;
+}
+
+SessionState::MemoryPatternBuffer SessionState::AcquireMemoryPatternBuffer(const OrtDevice& location,
+                                                                           size_t size) const {
+  // freed after the lock is released
+  MemoryPatternBuffer too_small;
+  {
+    std::lock_guard<OrtMutex> lock(mem_pattern_buffers_lock_);
+    auto it = mem_pattern_buffers_.find(location);
+    if (it == mem_pattern_buffers_.end() || it->second.empty()) {
+      return {};
+    }
+
+    auto& buffers = it->second;
+    auto best = buffers.end();
+    for (auto cur = buffers.begin(); cur != buffers.end(); ++cur) {
+      if (cur->size >= size && (best == buffers.end() || cur->size < best->size)) {
+        best = cur;
+      }
+    }
+
+    if (best != buffers.end()) {
+      MemoryPatternBuffer buffer = std::move(*best);
+      buffers.erase(best);
+      ++mem_pattern_buffer_reuses_;
+      return buffer;
+    }
+
+    // the caller allocates a new buffer that is released in place of this one,
+    // so there are never more buffers than runs that executed concurrently
+    too_small = std::move(buffers.back());
+    buffers.pop_back();
+  }
+
+  return {};
+}
+
+void SessionState::ReleaseMemoryPatternBuffer(const OrtDevice& location, MemoryPatternBuffer buffer) const {
+  std::lock_guard<OrtMutex> lock(mem_pattern_buffers_lock_);
+  mem_pattern_buffers_[location].push_back(std::move(buffer));
+}
+
 bool SessionState::GetEnableMemoryPattern() const { return enable_mem_pattern_; }
 
 bool SessionState::GetEnableMemoryReuse() const { return sess_options_.enable_mem_reuse; }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <list>
 #include <memory>
 #include <map>
 #include <unordered_map>
@@ -24,6 +25,8 @@
 #include "core/framework/feeds_fetches_manager.h"
 #include "core/framework/framework_common.h"
 #include "core/framework/prepacked_weights_container.h"
+#include "core/framework/prepacked_weights_disk_cache.h"
+#include "core/framework/shared_memory_prepacked_weights.h"
 #include "core/framework/fuse_nodes_funcs.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
@@ -214,16 +217,23 @@ class SessionState {
   /**
   Get cached memory pattern based on input shapes
   Must be called only when all values contain tensors
-  In training scenarios, the cache may be updated so
-  the callers would receive a copy of inferred shapes
-  made under mutex being held. In inference scenarios,
-  it is not mutable, we do not obtain a lock and simply get a pointer
-  w/o copying a hashtable
+  The input shapes are rounded up to their bucket if memory pattern bucketing is configured, so the returned
+  pattern may have been generated for larger inputs. Its blocks are then at least as large as needed.
+  inferred_shapes is only set if the pattern was generated for exactly these input shapes.
+  The returned pointers stay valid even if the entry is evicted from the cache in the meantime.
   */
-  const MemoryPatternGroup* GetMemoryPatternGroup(
+  std::shared_ptr<const MemoryPatternGroup> GetMemoryPatternGroup(
       gsl::span<const OrtValue> tensor_inputs,
       gsl::span<const int> feed_mlvalue_idxs,
-      const InlinedHashMap<int, TensorShape>*& inferred_shapes) const;
+      std::shared_ptr<const InlinedHashMap<int, TensorShape>>& inferred_shapes) const;
+
+  /**
+  Get the total peak size over all locations of the cached memory pattern for the input shapes.
+  Returns 0 if no pattern is cached for them yet. Unlike GetMemoryPatternGroup this doesn't generate a pattern and
+  doesn't count as a use of the cache.
+  */
+  size_t GetMemoryPatternPeakSize(gsl::span<const OrtValue> tensor_inputs,
+                                  gsl::span<const int> feed_mlvalue_idxs) const;
 
   /**
   Set generated memory pattern with a given input shapes.
@@ -231,8 +241,44 @@ class SessionState {
   All inputs must represent Tensors
   */
   Status UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
+                                       gsl::span<const int> feed_mlvalue_idxs,
                                        MemoryPatternGroup mem_patterns) const;
 
+  struct MemoryPatternCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t num_entries = 0;
+    size_t buffer_reuses = 0;  // runs that took the memory pattern buffer of an earlier run
+  };
+
+  /**
+  Get the hit, miss and eviction counters of the memory pattern cache
+  */
+  MemoryPatternCacheStats GetMemoryPatternCacheStats() const;
+
+  // A memory pattern buffer released by a finished run
+  struct MemoryPatternBuffer {
+    BufferUniquePtr buffer;
+    size_t size = 0;
+  };
+
+  /**
+  Whether memory pattern buffers are kept for later runs instead of being freed at the end of a run
+  */
+  bool GetReuseMemoryPatternBuffers() const { return mem_pattern_reuse_buffers_; }
+
+  /**
+  Take the smallest released memory pattern buffer of at least `size` bytes for `location`.
+  Returns an empty buffer if there is none, in which case the caller allocates one.
+  */
+  MemoryPatternBuffer AcquireMemoryPatternBuffer(const OrtDevice& location, size_t size) const;
+
+  /**
+  Keep the memory pattern buffer of a finished run for later runs
+  */
+  void ReleaseMemoryPatternBuffer(const OrtDevice& location, MemoryPatternBuffer buffer) const;
+
   bool GetUseDeterministicCompute() const { return sess_options_.use_deterministic_compute; }
 
   /**
@@ -249,8 +295,9 @@ class SessionState {
   /**
   Update enable_mem_pattern_ flag according to the presence of graph inputs' shape
   If any one of the graph input is shapeless, enable_mem_pattern_ will be set to false
+  Reads the memory pattern cache options from the session options if memory pattern is enabled.
   */
-  void ResolveMemoryPatternFlag();
+  Status ResolveMemoryPatternFlag();
 
   struct NodeInfo {
     /**
@@ -289,6 +336,21 @@ class SessionState {
   concurrency::ThreadPool* GetThreadPool() const noexcept { return thread_pool_; }
   concurrency::ThreadPool* GetInterOpThreadPool() const noexcept { return inter_op_thread_pool_; }
 
+  /**
+  Set the table of measured loop costs used by the parallel loops of the kernels of this graph and its subgraphs.
+  If `calibrate` is true, the loops are measured into the table instead. nullptr to use the estimated costs.
+  */
+  void SetLoopCostTable(concurrency::ThreadPool::LoopCostTable* table, bool calibrate);
+  concurrency::ThreadPool::LoopCostTable* GetLoopCostTable() const noexcept { return loop_cost_table_; }
+  bool GetCalibrateLoopCosts() const noexcept { return calibrate_loop_costs_; }
+
+  /**
+  Get the prefix of the loop cost keys of a node, "<domain>:<op type>:", and its hash.
+  Only available once a loop cost table is set.
+  */
+  const std::string& GetLoopCostKeyPrefix(NodeIndex node_index) const { return loop_cost_key_prefixes_[node_index]; }
+  uint64_t GetLoopCostKeyPrefixHash(NodeIndex node_index) const { return loop_cost_key_prefix_hashes_[node_index]; }
+
   const FuncManager& GetFuncMgr() const noexcept { return fused_funcs_mgr_; }
   FuncManager& GetMutableFuncMgr() noexcept { return fused_funcs_mgr_; }
 
@@ -323,6 +385,14 @@ class SessionState {
     return used_shared_pre_packed_weights_counter_;
   }
 
+  // Returns the shared memory store of pre-packed weights of the main graph's session state, creating it on first use,
+  // or nullptr if kOrtSessionOptionsConfigSharedPrepackedWeightsPrefix is not set.
+  SharedMemoryPrepackedWeights* GetSharedMemoryPrepackedWeights();
+
+  // Returns the on-disk cache of pre-packed weights of the main graph's session state, creating it on first use,
+  // or nullptr if kOrtSessionOptionsConfigPrepackedWeightsCacheDir is not set.
+  PrepackedWeightsDiskCache* GetPrepackedWeightsDiskCache();
+
   const KernelCreateInfoMap& GetKernelCreateInfoMap() const {
     return kernel_create_info_map_;
   }
@@ -374,6 +444,10 @@ class SessionState {
   Status PrepackConstantInitializedTensors(InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
                                            const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map);
 
+  // Pre-pack a constant initializer of a CPU kernel using the shared memory store and/or the on-disk cache.
+  Status PrepackWithSharedMemoryOrDiskCache(const Node& node, OpKernel& kernel, int input_idx, const Tensor& tensor,
+                                            /*out*/ bool& is_packed);
+
   SessionState* GetMutableSubgraphSessionState(onnxruntime::NodeIndex index, const std::string& attribute_name);
 
   Status CreateSubgraphSessionState();
@@ -393,14 +467,49 @@ class SessionState {
                                   const InlinedHashMap<OrtValueName, OrtDevice>& outer_scope_node_arg_to_location_map = {},
                                   bool graph_info_already_created = false);
 
+  struct MemoryPattern {
+    // rank and dims of all inputs the pattern was generated for
+    InlinedVector<int64_t> pattern_dims;
+    std::shared_ptr<const MemoryPatternGroup> patterns;
+    std::shared_ptr<const InlinedHashMap<int, TensorShape>> inferred_shapes;
+  };
+
+  // Maximum number of memory patterns kept for the shapes of a bucket
+  static constexpr size_t kMaxMemoryPatternsPerBucket = 4;
+
+  struct MemoryPatternCacheEntry {
+    // rank and dims of all inputs after rounding up the bucketed dims. used to detect key collisions.
+    InlinedVector<int64_t> bucket_dims;
+    // patterns of the bucket, most recently used first. none of them fits all the shapes another one fits, e.g. the
+    // patterns of shapes {3, 4} and {4, 3} are both kept, but the pattern of {4, 4} replaces them.
+    InlinedVector<MemoryPattern, 1> patterns;
+    std::list<size_t>::iterator lru_it;
+  };
+
+  size_t CalculateMemoryPatternsKey(gsl::span<const OrtValue> tensor_inputs,
+                                    gsl::span<const int> feed_mlvalue_idxs,
+                                    InlinedVector<int64_t>& dims,
+                                    InlinedVector<int64_t>& bucket_dims) const;
+
+  // Add an entry to the memory pattern cache, replacing any existing entry with the same key and evicting the
+  // least recently used entry if the cache is full. mem_patterns_lock_ must be held.
+  void InsertMemoryPatternCacheEntry(size_t key, MemoryPatternCacheEntry entry) const;
+
 #ifdef ENABLE_TRAINING
   Status GeneratePatternGroupCache(
-      gsl::span<const OrtValue> inputs,
+      gsl::span<const TensorShape> input_shapes,
       gsl::span<const int> feed_mlvalue_idxs,
       MemoryPatternGroup& output,
       InlinedHashMap<int, TensorShape>& inferred_shapes) const;
 #endif
 
+  // shared memory regions that kernels' pre-packed weights point into. must outlive session_kernels_ and the
+  // subgraph session states.
+  std::unique_ptr<SharedMemoryPrepackedWeights> shared_memory_prepacked_weights_;
+
+  // mapped files that kernels' pre-packed weights point into. same lifetime requirements as above.
+  std::unique_ptr<PrepackedWeightsDiskCache> prepacked_weights_disk_cache_;
+
   // KernelCreateInfo for each node so we do kernel lookup once
   KernelCreateInfoMap kernel_create_info_map_;
 
@@ -485,16 +594,24 @@ class SessionState {
 
   // lock for the mem_patterns_
   mutable OrtMutex mem_patterns_lock_;
-  // cache for the generated mem_patterns. key is calculated based on input shapes.
-  // must be a node based container as a pointer is cached.
-  mutable NodeHashMap<int64_t, MemoryPatternGroup> mem_patterns_;
-  // This is mutable under mutex in training scenarios so execution frame would make a copy
-  // of the value when created.
-#ifdef ENABLE_TRAINING
-  mutable NodeHashMap<int64_t, InlinedHashMap<int, TensorShape>> shape_patterns_;
-#else
-  NodeHashMap<int64_t, InlinedHashMap<int, TensorShape>> shape_patterns_;
-#endif
+  // cache for the generated mem_patterns. key is calculated based on the bucketed input shapes.
+  mutable InlinedHashMap<size_t, MemoryPatternCacheEntry> mem_patterns_;
+  // keys of mem_patterns_ in order of use, most recently used first.
+  mutable std::list<size_t> mem_patterns_lru_;
+  mutable MemoryPatternCacheStats mem_patterns_stats_;
+
+  // dims of the graph inputs that are rounded up to their bucket, keyed by the OrtValue index of the input.
+  InlinedHashMap<int, InlinedVector<size_t>> mem_pattern_bucket_axes_;
+  // 0 to round up to a power of two, otherwise the multiple to round up to.
+  int64_t mem_pattern_bucket_size_ = 0;
+  // 0 for an unbounded cache.
+  size_t mem_pattern_cache_max_entries_ = 0;
+
+  bool mem_pattern_reuse_buffers_ = false;
+  mutable OrtMutex mem_pattern_buffers_lock_;
+  // memory pattern buffers released by finished runs
+  mutable InlinedHashMap<OrtDevice, std::vector<MemoryPatternBuffer>> mem_pattern_buffers_;
+  mutable size_t mem_pattern_buffer_reuses_ = 0;
 
   NameNodeInfoMapType input_names_to_nodeinfo_mapping_;
   NameNodeInfoMapType output_names_to_nodeinfo_mapping_;
@@ -505,6 +622,12 @@ class SessionState {
   concurrency::ThreadPool* const thread_pool_{};
   concurrency::ThreadPool* const inter_op_thread_pool_{};
 
+  concurrency::ThreadPool::LoopCostTable* loop_cost_table_ = nullptr;
+  bool calibrate_loop_costs_ = false;
+  // indexed by node index
+  std::vector<std::string> loop_cost_key_prefixes_;
+  std::vector<uint64_t> loop_cost_key_prefix_hashes_;
+
   const DataTransferManager& data_transfer_mgr_;
 
   const SessionOptions& sess_options_;
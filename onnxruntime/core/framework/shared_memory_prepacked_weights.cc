@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/shared_memory_prepacked_weights.h"
+
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#include "core/common/alignment.h"
+
+#if (defined(__linux__) && !defined(__ANDROID__)) || defined(__APPLE__)
+#define HAS_POSIX_SHARED_MEMORY
+#endif
+
+#if defined(HAS_POSIX_SHARED_MEMORY)
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace onnxruntime {
+
+namespace {
+// Layout of a region:
+//   ready flag, number of buffers, pid of the creator, size of each buffer, then each buffer at a kBufferAlignment
+//   aligned offset.
+// The creator sets the ready flag after writing the buffers. Placeholder buffers that are null have a size of 0.
+constexpr size_t kBufferAlignment = 64;
+
+#if defined(HAS_POSIX_SHARED_MEMORY)
+// A region that is not ready this long after it was created or last written is considered abandoned if the pid of
+// its creator is not known, i.e. the creator died before it wrote it.
+constexpr time_t kStaleRegionTimeoutSeconds = 60;
+#endif
+
+struct RegionHeader {
+  std::atomic<uint64_t> ready;
+  uint64_t num_buffers;
+  uint64_t creator_pid;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ready flag is shared between processes.");
+
+size_t GetBufferSize(const PrePackedWeights& weights, size_t i) {
+  return weights.buffers_[i] != nullptr ? weights.buffer_sizes_[i] : 0;
+}
+
+// Returns the size of the region for the weights, and the offsets of the buffers in it.
+size_t GetRegionLayout(const PrePackedWeights& weights, std::vector<size_t>& buffer_offsets) {
+  const size_t num_buffers = weights.buffers_.size();
+  size_t offset = AlignUp(sizeof(RegionHeader) + num_buffers * sizeof(uint64_t), kBufferAlignment);
+  buffer_offsets.resize(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    buffer_offsets[i] = offset;
+    offset += AlignUp(GetBufferSize(weights, i), kBufferAlignment);
+  }
+
+  return offset;
+}
+
+uint64_t* GetBufferSizes(void* address) {
+  return reinterpret_cast<uint64_t*>(static_cast<uint8_t*>(address) + sizeof(RegionHeader));
+}
+}  // namespace
+
+SharedMemoryPrepackedWeights::SharedMemoryPrepackedWeights(std::string name_prefix, const logging::Logger& logger)
+    : name_prefix_(std::move(name_prefix)), logger_(logger) {
+  ORT_ENFORCE(!name_prefix_.empty(), "A name prefix is required for shared pre-packed weights.");
+  ORT_ENFORCE(name_prefix_.find('/') == std::string::npos,
+              "The name prefix of shared pre-packed weights must not contain '/': ", name_prefix_);
+#if !defined(HAS_POSIX_SHARED_MEMORY)
+  LOGS(logger_, WARNING) << "Shared memory pre-packed weights are not supported on this platform. "
+                         << "Pre-packed weights are kept in private memory.";
+#endif
+}
+
+SharedMemoryPrepackedWeights::~SharedMemoryPrepackedWeights() {
+#if defined(HAS_POSIX_SHARED_MEMORY)
+  for (const auto& region : regions_) {
+    if (region->address != nullptr) {
+      munmap(region->address, region->size);
+    }
+  }
+#endif
+}
+
+std::string SharedMemoryPrepackedWeights::GetRegionName(const std::string& op_type, const PrePackedWeights& weights,
+                                                        size_t region_size) const {
+  std::ostringstream ss;
+  ss << "/" << name_prefix_ << "." << op_type << "." << std::hex << std::setw(16) << std::setfill('0')
+     << weights.GetHash() << "." << std::dec << region_size;
+  return ss.str();
+}
+
+const PrePackedWeights& SharedMemoryPrepackedWeights::Share(const std::string& op_type, PrePackedWeights&& weights,
+                                                            bool& attached) {
+  attached = false;
+  auto region = std::make_unique<Region>();
+
+  std::vector<size_t> buffer_offsets;
+  const size_t region_size = GetRegionLayout(weights, buffer_offsets);
+  const std::string name = GetRegionName(op_type, weights, region_size);
+
+  region->address = MapRegion(name, weights, region_size, attached);
+  if (region->address == nullptr) {
+    region->weights = std::move(weights);
+  } else {
+    region->size = region_size;
+    region->weights.buffer_sizes_ = weights.buffer_sizes_;
+    region->weights.buffers_.reserve(weights.buffers_.size());
+    for (size_t i = 0, end = weights.buffers_.size(); i < end; ++i) {
+      void* buffer = weights.buffers_[i] != nullptr ? static_cast<uint8_t*>(region->address) + buffer_offsets[i]
+                                                    : nullptr;
+      // the region is unmapped by the destructor
+      region->weights.buffers_.emplace_back(buffer, [](void*) {});
+    }
+
+    // release the private copy
+    weights.buffers_.clear();
+  }
+
+  regions_.push_back(std::move(region));
+  return regions_.back()->weights;
+}
+
+void* SharedMemoryPrepackedWeights::MapRegion(const std::string& name, const PrePackedWeights& weights,
+                                              size_t region_size, bool& attached) {
+#if defined(HAS_POSIX_SHARED_MEMORY)
+  // a region abandoned by a creator that died before it was ready is removed and created again, once
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd >= 0) {
+      return CreateRegion(name, weights, region_size, fd);
+    }
+
+    if (errno != EEXIST) {
+      LOGS(logger_, WARNING) << "Failed to create shared memory region " << name << ": " << std::strerror(errno);
+      return nullptr;
+    }
+
+    bool abandoned = false;
+    void* address = AttachRegion(name, weights, region_size, abandoned);
+    if (address != nullptr) {
+      attached = true;
+      ++num_attached_regions_;
+      return address;
+    }
+
+    if (!abandoned) {
+      return nullptr;
+    }
+
+    LOGS(logger_, WARNING) << "Shared memory region " << name << " was abandoned by its creator before it was ready. "
+                           << "It is created again.";
+    shm_unlink(name.c_str());
+  }
+
+  return nullptr;
+#else
+  ORT_UNUSED_PARAMETER(name);
+  ORT_UNUSED_PARAMETER(weights);
+  ORT_UNUSED_PARAMETER(region_size);
+  ORT_UNUSED_PARAMETER(attached);
+  return nullptr;
+#endif
+}
+
+#if defined(HAS_POSIX_SHARED_MEMORY)
+void* SharedMemoryPrepackedWeights::CreateRegion(const std::string& name, const PrePackedWeights& weights,
+                                                 size_t region_size, int fd) {
+  if (ftruncate(fd, static_cast<off_t>(region_size)) != 0) {
+    LOGS(logger_, WARNING) << "Failed to size shared memory region " << name << ": " << std::strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  void* address = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    LOGS(logger_, WARNING) << "Failed to map shared memory region " << name << ": " << std::strerror(errno);
+    shm_unlink(name.c_str());
+    return nullptr;
+  }
+
+  std::vector<size_t> buffer_offsets;
+  GetRegionLayout(weights, buffer_offsets);
+  const size_t num_buffers = weights.buffers_.size();
+
+  auto* header = new (address) RegionHeader();
+  header->num_buffers = num_buffers;
+  header->creator_pid = static_cast<uint64_t>(getpid());
+  uint64_t* buffer_sizes = GetBufferSizes(address);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    const size_t buffer_size = GetBufferSize(weights, i);
+    buffer_sizes[i] = buffer_size;
+    if (buffer_size > 0) {
+      std::memcpy(static_cast<uint8_t*>(address) + buffer_offsets[i], weights.buffers_[i].get(), buffer_size);
+    }
+  }
+
+  header->ready.store(1, std::memory_order_release);
+  mprotect(address, region_size, PROT_READ);
+
+  created_region_names_.push_back(name);
+  ++num_created_regions_;
+  return address;
+}
+
+void* SharedMemoryPrepackedWeights::AttachRegion(const std::string& name, const PrePackedWeights& weights,
+                                                 size_t region_size, bool& abandoned) {
+  abandoned = false;
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    LOGS(logger_, WARNING) << "Failed to open shared memory region " << name << ": " << std::strerror(errno);
+    return nullptr;
+  }
+
+  struct stat region_stat;
+  if (fstat(fd, &region_stat) != 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  const bool timed_out = time(nullptr) - region_stat.st_mtime > kStaleRegionTimeoutSeconds;
+  if (static_cast<size_t>(region_stat.st_size) != region_size) {
+    // the size is 0 until the creator has sized the region
+    close(fd);
+    abandoned = region_stat.st_size == 0 && timed_out;
+    return nullptr;
+  }
+
+  void* address = mmap(nullptr, region_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    LOGS(logger_, WARNING) << "Failed to map shared memory region " << name << ": " << std::strerror(errno);
+    return nullptr;
+  }
+
+  const auto* header = static_cast<const RegionHeader*>(address);
+  if (header->ready.load(std::memory_order_acquire) != 1) {
+    // the region is still written by its creator, or was left incomplete by a creator that died. a creator in
+    // another pid namespace looks dead, in which case both processes end up with a region of their own.
+    const auto creator_pid = static_cast<pid_t>(header->creator_pid);
+    abandoned = creator_pid != 0 ? kill(creator_pid, 0) != 0 && errno == ESRCH : timed_out;
+    LOGS(logger_, INFO) << "Shared memory region " << name << " is not ready.";
+    munmap(address, region_size);
+    return nullptr;
+  }
+
+  // the buffers are compared so that a hash collision can't hand a kernel the wrong weights.
+  std::vector<size_t> buffer_offsets;
+  GetRegionLayout(weights, buffer_offsets);
+  const size_t num_buffers = weights.buffers_.size();
+  bool matches = header->num_buffers == num_buffers;
+  const uint64_t* buffer_sizes = GetBufferSizes(address);
+  for (size_t i = 0; matches && i < num_buffers; ++i) {
+    const size_t buffer_size = GetBufferSize(weights, i);
+    matches = buffer_sizes[i] == buffer_size &&
+              (buffer_size == 0 || std::memcmp(static_cast<const uint8_t*>(address) + buffer_offsets[i],
+                                               weights.buffers_[i].get(), buffer_size) == 0);
+  }
+
+  if (!matches) {
+    LOGS(logger_, INFO) << "Shared memory region " << name << " doesn't match the pre-packed weights.";
+    munmap(address, region_size);
+    return nullptr;
+  }
+
+  return address;
+}
+#endif
+
+void SharedMemoryPrepackedWeights::UnlinkCreatedRegions() {
+#if defined(HAS_POSIX_SHARED_MEMORY)
+  for (const auto& name : created_region_names_) {
+    shm_unlink(name.c_str());
+  }
+#endif
+  created_region_names_.clear();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/prepacked_weights.h"
+
+namespace onnxruntime {
+
+/**
+ * Stores pre-packed weights in named shared memory regions so that processes packing the same weights share one copy.
+ *
+ * A region is named after a prefix, the op type, the hash and the size of the pre-packed buffers. The first process
+ * to pack a weight creates the region and copies the buffers into it. Other processes, and other sessions of the same
+ * process, map the existing region read-only if its content matches the buffers they packed, and release their own
+ * copy. Regions outlive the processes that created them, so processes started later attach to them as well.
+ * They are removed by UnlinkCreatedRegions() or by deleting them from /dev/shm. A region whose creator died before
+ * the region was ready is removed and created again by the next process that tries to attach to it.
+ *
+ * Weights stay in the private memory of the process if a region can't be created or attached, which includes all
+ * platforms without POSIX shared memory.
+ *
+ * Not thread-safe. An instance is used by the initialization of one session.
+ */
+class SharedMemoryPrepackedWeights {
+ public:
+  SharedMemoryPrepackedWeights(std::string name_prefix, const logging::Logger& logger);
+
+  ~SharedMemoryPrepackedWeights();
+
+  /**
+   * Move pre-packed weights into shared memory.
+   * @param op_type The op type of the kernel that packed the weights.
+   * @param weights The weights packed by the kernel. The buffers are released once they're copied to or matched
+   *                with a region.
+   * @param attached Set to true if the weights were found in an existing region.
+   * @returns The weights to pass to the kernel. They stay valid until this instance is destroyed.
+   */
+  const PrePackedWeights& Share(const std::string& op_type, PrePackedWeights&& weights, bool& attached);
+
+  size_t NumCreatedRegions() const { return num_created_regions_; }
+  size_t NumAttachedRegions() const { return num_attached_regions_; }
+
+  // Remove the names of the regions created by this instance so that they are freed once no process maps them.
+  // Existing mappings stay valid.
+  void UnlinkCreatedRegions();
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SharedMemoryPrepackedWeights);
+
+  struct Region {
+    void* address = nullptr;  // nullptr if the weights are kept in private memory
+    size_t size = 0;
+    PrePackedWeights weights;
+  };
+
+  std::string GetRegionName(const std::string& op_type, const PrePackedWeights& weights, size_t region_size) const;
+
+  // Create a new region or attach to an existing one. Returns nullptr on failure.
+  void* MapRegion(const std::string& name, const PrePackedWeights& weights, size_t region_size, bool& attached);
+
+  // Size, map and fill the region just created as `fd`. Returns nullptr on failure.
+  void* CreateRegion(const std::string& name, const PrePackedWeights& weights, size_t region_size, int fd);
+
+  // Map an existing region if it is ready and holds the weights. Returns nullptr otherwise, and sets `abandoned` if
+  // the region will never become ready because its creator died.
+  void* AttachRegion(const std::string& name, const PrePackedWeights& weights, size_t region_size, bool& abandoned);
+
+  const std::string name_prefix_;
+  const logging::Logger& logger_;
+  std::vector<std::unique_ptr<Region>> regions_;
+  std::vector<std::string> created_region_names_;
+  size_t num_created_regions_ = 0;
+  size_t num_attached_regions_ = 0;
+};
+
+}  // namespace onnxruntime
@@ -214,6 +214,12 @@ void RunSince(size_t stream_idx, StreamExecutionContext& ctx, SessionScope& sess
       ctx.CompleteTask();
       return;
     }
+    if (ctx.DeadlineExceeded()) {
+      Status status_made = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to the run deadline being exceeded.");
+      ctx.SetStatus(status_made);
+      ctx.CompleteTask();
+      return;
+    }
     bool continue_flag = true;
     Status status;
     ORT_TRY {
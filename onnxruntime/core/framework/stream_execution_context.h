@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 #pragma once
+#include <chrono>
+#include <optional>
 #include "core/common/logging/logging.h"
 #include "core/framework/device_stream_collection.h"
 #include "core/framework/execution_frame.h"
@@ -116,6 +118,18 @@ class StreamExecutionContext {
   // Release the OrtValues after a step, based on the execution plan.
   void RecycleNodeInputs(onnxruntime::NodeIndex node_index);
 
+  // Abort the execution at the next step once the deadline has passed.
+  void SetDeadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+
+  bool DeadlineExceeded() const {
+    return deadline_.has_value() && std::chrono::steady_clock::now() >= *deadline_;
+  }
+
+  // The deadline of the run, which the subgraphs executed by the kernels of the run inherit.
+  const std::optional<std::chrono::steady_clock::time_point>& GetDeadline() const noexcept { return deadline_; }
+
 #ifdef ENABLE_TRAINING
   void SetOrtValueCache(OrtValueCachePtr cache) {
     cache_ = std::move(cache);
@@ -171,6 +185,8 @@ class StreamExecutionContext {
 #endif
   const bool single_thread_mode_;
 
+  std::optional<std::chrono::steady_clock::time_point> deadline_;
+
 #ifdef ORT_ENABLE_STREAM
   InlinedVector<std::unique_ptr<synchronize::Notification>> notifications_;
   // if it is nullptr, means current session doesn't have any EP using stream feature
@@ -176,6 +176,13 @@ static Status ReadExternalDataForTensor(const ONNX_NAMESPACE::TensorProto& tenso
       tensor_byte_size));
 
   unpacked_tensor.resize(tensor_byte_size);
+  if (external_file_path == onnxruntime::utils::kTensorProtoMemoryAddressTag) {
+    // the value in location is the memory address of the data
+    std::memcpy(unpacked_tensor.data(), reinterpret_cast<const void*>(file_offset),
+                static_cast<size_t>(tensor_byte_size));
+    return Status::OK();
+  }
+
   ORT_RETURN_IF_ERROR(onnxruntime::Env::Default().ReadFileIntoBuffer(
       external_file_path.c_str(),
       file_offset,
@@ -367,14 +367,9 @@ static bool FinalizeCopyInfoForFetches(gsl::span<const OrtDevice* const>& fetch_
   return copy_needed;
 }
 
-// Finalize the copy info using the OrtDevice and OrtMemoryInfo for the feeds and fetches
-// This can be used by control flow nodes prior to the execution of the overall graph.
-void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
-                               gsl::span<const OrtDevice> feed_locations,
-                               gsl::span<const OrtDevice* const> fetch_alloc_info) {
-  if (feeds_fetches_manager.GetDeviceCopyChecks().status == DeviceCopyCheck::NoCopy)
-    return;
-
+static void FinalizeCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
+                             gsl::span<const OrtDevice> feed_locations,
+                             gsl::span<const OrtDevice* const> fetch_alloc_info) {
   bool need_copy = FinalizeCopyInfoForFeeds(feed_locations, feeds_fetches_manager.GetMutableFeedsDeviceCopyInfo());
   DeviceCopyCheck input_copy = need_copy ? DeviceCopyCheck::Copy : DeviceCopyCheck::NoCopy;
 
@@ -384,18 +379,27 @@ void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
   feeds_fetches_manager.SetDeviceCopyChecks(input_copy, output_copy);
 }
 
-// Finalize the copy info using the OrtValue instances for the feeds and fetches
-static void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
-                                      gsl::span<const OrtValue> feeds,
-                                      std::vector<OrtValue>& fetches) {
+// Finalize the copy info using the OrtDevice and OrtMemoryInfo for the feeds and fetches
+// This can be used by control flow nodes prior to the execution of the overall graph.
+void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
+                               gsl::span<const OrtDevice> feed_locations,
+                               gsl::span<const OrtDevice* const> fetch_alloc_info) {
   if (feeds_fetches_manager.GetDeviceCopyChecks().status == DeviceCopyCheck::NoCopy)
     return;
 
+  FinalizeCopyInfo(feeds_fetches_manager, feed_locations, fetch_alloc_info);
+}
+
+// Get the devices of the feeds, and of the fetches that are pre-allocated
+static void GetFeedFetchLocations(gsl::span<const OrtValue> feeds,
+                                  std::vector<OrtValue>& fetches,
+                                  size_t num_outputs,
+                                  std::vector<OrtDevice>& feed_locations,
+                                  std::vector<const OrtDevice*>& fetch_alloc_info) {
   auto num_inputs = feeds.size();
-  auto num_outputs = feeds_fetches_manager.GetFeedsFetchesInfo().output_names.size();
 
-  std::vector<OrtDevice> feed_locations(num_inputs);
-  std::vector<const OrtDevice*> fetch_alloc_info(num_outputs, nullptr);
+  feed_locations.resize(num_inputs);
+  fetch_alloc_info.assign(num_outputs, nullptr);
 
   for (size_t i = 0; i < num_inputs; ++i) {
     const auto& feed = feeds[i];
@@ -433,8 +437,43 @@ static void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager
       }
     }
   }
+}
+
+// Finalize the copy info using the OrtValue instances for the feeds and fetches
+static void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
+                                      gsl::span<const OrtValue> feeds,
+                                      std::vector<OrtValue>& fetches) {
+  if (feeds_fetches_manager.GetDeviceCopyChecks().status == DeviceCopyCheck::NoCopy)
+    return;
+
+  std::vector<OrtDevice> feed_locations;
+  std::vector<const OrtDevice*> fetch_alloc_info;
+  GetFeedFetchLocations(feeds, fetches, feeds_fetches_manager.GetFeedsFetchesInfo().output_names.size(),
+                        feed_locations, fetch_alloc_info);
+
+  FinalizeCopyInfo(feeds_fetches_manager, feed_locations, fetch_alloc_info);
+}
+
+common::Status RefinalizeFeedFetchCopyInfo(const SessionState& session_state,
+                                           FeedsFetchesManager& feeds_fetches_manager,
+                                           gsl::span<const OrtValue> feeds,
+                                           std::vector<OrtValue>& fetches) {
+  // the copy checks of a session with only CPU based EPs stay NoCopy
+  if (HaveCpuExecutionProvidersOnly(session_state.GetExecutionProviders())) {
+    return Status::OK();
+  }
 
-  FinalizeFeedFetchCopyInfo(feeds_fetches_manager, feed_locations, fetch_alloc_info);
+  // start from the static info again. a fetch that is no longer pre-allocated would otherwise keep the device of
+  // the one that was.
+  ORT_RETURN_IF_ERROR(InitializeFeedFetchCopyInfo(session_state, feeds_fetches_manager));
+
+  std::vector<OrtDevice> feed_locations;
+  std::vector<const OrtDevice*> fetch_alloc_info;
+  GetFeedFetchLocations(feeds, fetches, feeds_fetches_manager.GetFeedsFetchesInfo().output_names.size(),
+                        feed_locations, fetch_alloc_info);
+
+  FinalizeCopyInfo(feeds_fetches_manager, feed_locations, fetch_alloc_info);
+  return Status::OK();
 }
 
 static common::Status CopyInputsAcrossDevices(const SessionState& session_state,
@@ -597,7 +636,8 @@ ExecuteGraphImpl(const SessionState& session_state,
                  DeviceStreamCollection* device_stream_collection,
 #endif
                  const bool only_execute_path_to_fetches = false,
-                 Stream* parent_stream = nullptr) {
+                 Stream* parent_stream = nullptr,
+                 std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt) {
   const auto& feeds_fetches_info = feeds_fetches_manager.GetFeedsFetchesInfo();
   const auto& device_copy_checks = feeds_fetches_manager.GetDeviceCopyChecks();
 #ifdef ORT_ENABLE_STREAM
@@ -629,7 +669,8 @@ ExecuteGraphImpl(const SessionState& session_state,
                                   terminate_flag,
                                   only_execute_path_to_fetches,
                                   // single thread mode
-                                  single_thread_mode));
+                                  single_thread_mode,
+                                  deadline));
     ORT_RETURN_IF_ERROR(status);
   } else {
     auto feeds_to_use = feeds;
@@ -698,7 +739,8 @@ ExecuteGraphImpl(const SessionState& session_state,
 #endif
                                   terminate_flag,
                                   only_execute_path_to_fetches,
-                                  single_thread_mode));
+                                  single_thread_mode,
+                                  deadline));
     ORT_RETURN_IF_ERROR(status);
     InlinedVector<Stream*> fetches_streams;
     fetches_streams.reserve(feeds_fetches_info.fetches_mlvalue_idxs.size());
@@ -730,51 +772,79 @@ ExecuteGraphImpl(const SessionState& session_state,
 common::Status ExecuteGraph(const SessionState& session_state,
                             FeedsFetchesManager& feeds_fetches_manager,
                             gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches,
+                            const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                             ExecutionMode execution_mode, const bool& terminate_flag,
                             const logging::Logger& logger,
 #ifdef ORT_ENABLE_STREAM
                             DeviceStreamCollectionHolder& device_stream_collection_holder,
 #endif
                             bool only_execute_path_to_fetches,
-                            Stream* parent_stream) {
+                            Stream* parent_stream,
+                            std::optional<std::chrono::steady_clock::time_point> deadline) {
   ORT_RETURN_IF_ERROR(utils::InitializeFeedFetchCopyInfo(session_state, feeds_fetches_manager));
 
   // finalize the copy info using the provided feeds and fetches. will update device_copy_checks in the background
   FinalizeFeedFetchCopyInfo(feeds_fetches_manager, feeds, fetches);
 #ifdef ORT_ENABLE_STREAM
   DeviceStreamCollection* device_stream_collection = device_stream_collection_holder.p_.get();
-  auto retval = ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, {},
+  auto retval = ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, fetch_allocators,
                                  execution_mode, terminate_flag, logger,
                                  device_stream_collection,
                                  only_execute_path_to_fetches,
-                                 parent_stream);
+                                 parent_stream,
+                                 deadline);
   return retval;
 #else
-  return ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, {},
+  return ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, fetch_allocators,
                           execution_mode, terminate_flag, logger,
                           only_execute_path_to_fetches,
-                          parent_stream);
+                          parent_stream,
+                          deadline);
 #endif
 }
 
 common::Status ExecuteGraph(const SessionState& session_state,
                             FeedsFetchesManager& feeds_fetches_manager,
                             gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches,
+                            const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                             ExecutionMode execution_mode, const RunOptions& run_options,
 #ifdef ORT_ENABLE_STREAM
                             DeviceStreamCollectionHolder& device_stream_collection_holder,
 #endif
-                            const logging::Logger& logger) {
+                            const logging::Logger& logger,
+                            std::optional<std::chrono::steady_clock::time_point> deadline) {
   return ExecuteGraph(session_state,
                       feeds_fetches_manager,
-                      feeds, fetches,
+                      feeds, fetches, fetch_allocators,
                       execution_mode,
                       run_options.terminate,
                       logger,
 #ifdef ORT_ENABLE_STREAM
                       device_stream_collection_holder,
 #endif
-                      run_options.only_execute_path_to_fetches);
+                      run_options.only_execute_path_to_fetches,
+                      /*parent_stream*/ nullptr,
+                      deadline);
+}
+
+common::Status ExecuteFinalizedGraph(const SessionState& session_state,
+                                     const FeedsFetchesManager& feeds_fetches_manager,
+                                     gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches,
+                                     const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                                     ExecutionMode execution_mode, const RunOptions& run_options,
+#ifdef ORT_ENABLE_STREAM
+                                     DeviceStreamCollection* device_stream_collection,
+#endif
+                                     const logging::Logger& logger,
+                                     std::optional<std::chrono::steady_clock::time_point> deadline) {
+  return ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, fetch_allocators,
+                          execution_mode, run_options.terminate, logger,
+#ifdef ORT_ENABLE_STREAM
+                          device_stream_collection,
+#endif
+                          run_options.only_execute_path_to_fetches,
+                          /*parent_stream*/ nullptr,
+                          deadline);
 }
 
 #ifdef ENABLE_TRAINING
@@ -917,18 +987,20 @@ common::Status ExecuteSubgraph(const SessionState& session_state, const FeedsFet
                                const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                                ExecutionMode execution_mode, const bool& terminate_flag, const logging::Logger& logger,
                                Stream* parent_stream,
-                               bool sync_subgraph_fetches) {
+                               bool sync_subgraph_fetches,
+                               std::optional<std::chrono::steady_clock::time_point> deadline) {
 #ifdef ORT_ENABLE_STREAM
   DeviceStreamCollectionHolder device_stream_collection_holder(&session_state);
   DeviceStreamCollection* device_stream_collection = device_stream_collection_holder.p_.get();
 
   auto retval = ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, fetch_allocators,
-                                 execution_mode, terminate_flag, logger, device_stream_collection, false, parent_stream);
+                                 execution_mode, terminate_flag, logger, device_stream_collection, false, parent_stream,
+                                 deadline);
   if (device_stream_collection)
     ORT_CHECK_AND_SET_RETVAL(device_stream_collection->CleanUp(false));
 #else
   auto retval = ExecuteGraphImpl(session_state, feeds_fetches_manager, feeds, fetches, fetch_allocators,
-                                 execution_mode, terminate_flag, logger, false, parent_stream);
+                                 execution_mode, terminate_flag, logger, false, parent_stream, deadline);
 #endif
   if (retval.IsOK() && sync_subgraph_fetches && parent_stream) {
     parent_stream->Flush();
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
+
 #include "core/graph/basic_types.h"
 #include "core/framework/allocator.h"
 #include "core/framework/data_types.h"
@@ -80,23 +83,50 @@ void FinalizeFeedFetchCopyInfo(FeedsFetchesManager& feeds_fetches_manager,
                                gsl::span<const OrtDevice> feed_locations,
                                gsl::span<const OrtDevice* const> fetch_alloc_info);
 
+// Finalize the feed and fetch copy info again for the devices of feeds and fetches, even if it was finalized before
+// for other devices. Used by prepared runs when the devices of their feeds or fetches change.
+common::Status RefinalizeFeedFetchCopyInfo(const SessionState& session_state,
+                                           FeedsFetchesManager& feeds_fetches_manager,
+                                           gsl::span<const OrtValue> feeds,
+                                           std::vector<OrtValue>& fetches);
+
 // Execute the main graph. The feed_fetches_manager will be finalized based on the provided feeds and fetches.
+// fetch_allocators optionally provides custom allocators for fetches. key is index in fetches.
 common::Status ExecuteGraph(const SessionState& session_state, FeedsFetchesManager& feeds_fetches_manager,
                             gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches,
+                            const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                             ExecutionMode execution_mode, const bool& terminate_flag, const logging::Logger& logger,
 #ifdef ORT_ENABLE_STREAM
                             DeviceStreamCollectionHolder& device_stream_collection_holder,
 #endif
                             bool only_execute_path_to_fetches = false,
-                            Stream* parent_stream = nullptr);
+                            Stream* parent_stream = nullptr,
+                            std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
 
+// Execute the main graph with the terminate flag and execution settings of run_options.
+// If deadline is set, the execution is aborted at the next step of the execution plan once it has passed.
 common::Status ExecuteGraph(const SessionState& session_state, FeedsFetchesManager& feeds_fetches_manager,
                             gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches,
+                            const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
                             ExecutionMode execution_mode, const RunOptions& run_options,
 #ifdef ORT_ENABLE_STREAM
                             DeviceStreamCollectionHolder& device_stream_collection_holder,
 #endif
-                            const logging::Logger& logger);
+                            const logging::Logger& logger,
+                            std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
+
+// Execute the main graph with a feeds_fetches_manager whose copy info was already finalized for the devices of the
+// feeds and fetches. Used by prepared runs, which only finalize it again when those devices change.
+common::Status ExecuteFinalizedGraph(const SessionState& session_state,
+                                     const FeedsFetchesManager& feeds_fetches_manager,
+                                     gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches,
+                                     const std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators,
+                                     ExecutionMode execution_mode, const RunOptions& run_options,
+#ifdef ORT_ENABLE_STREAM
+                                     DeviceStreamCollection* device_stream_collection,
+#endif
+                                     const logging::Logger& logger,
+                                     std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
 
 #ifdef ENABLE_TRAINING
 common::Status ExecutePartialGraph(const SessionState& session_state, FeedsFetchesManager& feeds_fetches_manager,
@@ -118,7 +148,10 @@ common::Status ExecuteSubgraph(const SessionState& session_state, const FeedsFet
                                /*when this is enabled, we will sync the parent stream to make sure the subgraph fetches
                                is complete. this is mainly used when the parent kernel depends on the CPU value of the
                                subgraph fetches, i.e. the loop condition*/
-                               bool sync_subgraph_fetches = false);
+                               bool sync_subgraph_fetches = false,
+                               // the deadline of the run executing the parent kernel, see
+                               // OpKernelContextInternal::GetDeadline
+                               std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt);
 
 bool IsInputOnCpu(const Node& node, const KernelCreateInfo* p_kci, size_t index);
 
@@ -21,6 +21,7 @@
 #include "core/util/protobuf_parsing_utils.h"
 
 #include "core/common/gsl.h"
+#include "core/common/narrow.h"
 
 #include "core/platform/env.h"
 
@@ -706,6 +707,212 @@ Status Model::Load(int fd, const PathString& model_path, std::shared_ptr<Model>&
   return Status::OK();
 }
 
+// field numbers in onnx.proto
+static constexpr uint32_t kModelProtoGraphField = 7;
+static constexpr uint32_t kGraphProtoInitializerField = 5;
+static constexpr uint32_t kTensorProtoRawDataField = 9;
+
+static constexpr uint32_t kWireTypeVarint = 0;
+static constexpr uint32_t kWireTypeFixed64 = 1;
+static constexpr uint32_t kWireTypeLengthDelimited = 2;
+static constexpr uint32_t kWireTypeFixed32 = 5;
+
+static bool SkipField(CodedInputStream& input, uint32_t tag) {
+  switch (tag & 7) {
+    case kWireTypeVarint: {
+      uint64_t value;
+      return input.ReadVarint64(&value);
+    }
+    case kWireTypeFixed64:
+      return input.Skip(8);
+    case kWireTypeLengthDelimited: {
+      uint32_t length;
+      return input.ReadVarint32(&length) && input.Skip(static_cast<int>(length));
+    }
+    case kWireTypeFixed32:
+      return input.Skip(4);
+    default:
+      // groups are not used by onnx.proto
+      return false;
+  }
+}
+
+// Calls `fn` with the tag of each field of the message `input` is positioned at until the end of the message.
+// `fn` must consume the field and return whether it succeeded.
+template <typename Fn>
+static bool ForEachField(CodedInputStream& input, Fn fn) {
+  while (uint32_t tag = input.ReadTag()) {
+    if (!fn(tag)) {
+      return false;
+    }
+  }
+
+  return input.ConsumedEntireMessage();
+}
+
+// Calls `fn` to read an embedded message, limiting `input` to the message.
+template <typename Fn>
+static bool ReadEmbeddedMessage(CodedInputStream& input, Fn fn) {
+  uint32_t length;
+  if (!input.ReadVarint32(&length)) {
+    return false;
+  }
+
+  const auto limit = input.PushLimit(static_cast<int>(length));
+  const bool result = fn();
+  input.PopLimit(limit);
+  return result;
+}
+
+// Finds the raw_data of the initializers of the main graph in a serialized ModelProto without parsing it.
+// Returns an (offset, size) pair per initializer in the order of GraphProto.initializer.
+// The size is 0 if the initializer has no raw_data.
+static Status FindInitializerRawData(gsl::span<const uint8_t> model_bytes,
+                                     std::vector<std::pair<size_t, size_t>>& raw_data_ranges) {
+  ORT_RETURN_IF(model_bytes.size() > static_cast<size_t>(INT_MAX), "Model is too large to be parsed.");
+
+  constexpr auto MakeTag = [](uint32_t field, uint32_t wire_type) { return (field << 3) | wire_type; };
+  constexpr uint32_t graph_tag = MakeTag(kModelProtoGraphField, kWireTypeLengthDelimited);
+  constexpr uint32_t initializer_tag = MakeTag(kGraphProtoInitializerField, kWireTypeLengthDelimited);
+  constexpr uint32_t raw_data_tag = MakeTag(kTensorProtoRawDataField, kWireTypeLengthDelimited);
+
+  CodedInputStream input(model_bytes.data(), static_cast<int>(model_bytes.size()));
+
+  const auto read_tensor = [&input, &raw_data_ranges]() {
+    raw_data_ranges.emplace_back(0, 0);
+    return ForEachField(input, [&input, &raw_data_ranges](uint32_t tag) {
+      if (tag != raw_data_tag) {
+        return SkipField(input, tag);
+      }
+
+      uint32_t length;
+      if (!input.ReadVarint32(&length)) {
+        return false;
+      }
+
+      // the last occurrence of a field wins
+      raw_data_ranges.back() = {static_cast<size_t>(input.CurrentPosition()), length};
+      return input.Skip(static_cast<int>(length));
+    });
+  };
+
+  const auto read_graph = [&input, &read_tensor]() {
+    return ForEachField(input, [&input, &read_tensor](uint32_t tag) {
+      return tag == initializer_tag ? ReadEmbeddedMessage(input, read_tensor) : SkipField(input, tag);
+    });
+  };
+
+  const bool result = ForEachField(input, [&input, &read_graph](uint32_t tag) {
+    return tag == graph_tag ? ReadEmbeddedMessage(input, read_graph) : SkipField(input, tag);
+  });
+
+  ORT_RETURN_IF_NOT(result, "Protobuf parsing failed.");
+  return Status::OK();
+}
+
+Status Model::ForEachInitializer(gsl::span<const uint8_t> model_bytes,
+                                 const std::function<Status(const TensorProto&)>& fn) {
+  ORT_RETURN_IF(model_bytes.size() > static_cast<size_t>(INT_MAX), "Model is too large to be parsed.");
+
+  constexpr auto MakeTag = [](uint32_t field, uint32_t wire_type) { return (field << 3) | wire_type; };
+  constexpr uint32_t graph_tag = MakeTag(kModelProtoGraphField, kWireTypeLengthDelimited);
+  constexpr uint32_t initializer_tag = MakeTag(kGraphProtoInitializerField, kWireTypeLengthDelimited);
+
+  CodedInputStream input(model_bytes.data(), static_cast<int>(model_bytes.size()));
+  Status status;
+
+  const auto read_tensor = [&input, &fn, &status]() {
+    TensorProto tensor_proto;
+    if (!tensor_proto.ParseFromCodedStream(&input)) {
+      return false;
+    }
+
+    status = fn(tensor_proto);
+    return status.IsOK();
+  };
+
+  const auto read_graph = [&input, &read_tensor]() {
+    return ForEachField(input, [&input, &read_tensor](uint32_t tag) {
+      return tag == initializer_tag ? ReadEmbeddedMessage(input, read_tensor) : SkipField(input, tag);
+    });
+  };
+
+  const bool result = ForEachField(input, [&input, &read_graph](uint32_t tag) {
+    return tag == graph_tag ? ReadEmbeddedMessage(input, read_graph) : SkipField(input, tag);
+  });
+
+  ORT_RETURN_IF_ERROR(status);
+  if (!result) {
+    return Status(ONNXRUNTIME, INVALID_PROTOBUF, "Protobuf parsing failed.");
+  }
+
+  return Status::OK();
+}
+
+Status Model::LoadMapped(const PathString& file_path, std::shared_ptr<Model>& p_model,
+                         Env::MappedMemoryPtr& mapped_model,
+                         const IOnnxRuntimeOpSchemaRegistryList* local_registries,
+                         const logging::Logger& logger, const ModelOptions& options) {
+  const Env& env = Env::Default();
+  size_t file_length = 0;
+  ORT_RETURN_IF_ERROR(env.GetFileLength(file_path.c_str(), file_length));
+  ORT_RETURN_IF(file_length > static_cast<size_t>(INT_MAX), "Model ", ToUTF8String(file_path),
+                " is too large to be parsed.");
+
+  Env::MappedMemoryPtr mapping;
+  ORT_RETURN_IF_ERROR(env.MapFileIntoMemory(file_path.c_str(), 0, file_length, mapping));
+  const auto model_bytes = gsl::make_span(reinterpret_cast<const uint8_t*>(mapping.get()), file_length);
+
+  std::vector<std::pair<size_t, size_t>> raw_data_ranges;
+  ORT_RETURN_IF_ERROR(FindInitializerRawData(model_bytes, raw_data_ranges));
+
+  ModelProto model_proto;
+  ORT_RETURN_IF_ERROR(LoadFromBytes(static_cast<int>(file_length), mapping.get(), model_proto));
+
+  auto& initializers = *model_proto.mutable_graph()->mutable_initializer();
+  ORT_RETURN_IF_NOT(static_cast<size_t>(initializers.size()) == raw_data_ranges.size(),
+                    "Found ", raw_data_ranges.size(), " initializers in the model but parsed ", initializers.size());
+
+  for (int i = 0, end = initializers.size(); i < end; ++i) {
+    auto& initializer = initializers[i];
+    const auto& raw_data_range = raw_data_ranges[i];
+    // small initializers aren't worth the external data entries
+    if (!utils::HasRawData(initializer) || initializer.raw_data().size() != raw_data_range.second ||
+        raw_data_range.second <= 127) {
+      continue;
+    }
+
+    static_assert(sizeof(void*) <= sizeof(ExternalDataInfo::OFFSET_TYPE));
+    const void* data = model_bytes.data() + raw_data_range.first;
+    // we reinterpret_cast this back to void* in tensorprotoutils.cc:GetExtDataFromTensorProto
+    auto offset = narrow<ExternalDataInfo::OFFSET_TYPE>(reinterpret_cast<intptr_t>(data));
+
+    // swap to free the copy made by the parser. clear_raw_data() keeps the capacity.
+    std::string().swap(*initializer.mutable_raw_data());
+    initializer.clear_raw_data();
+    initializer.set_data_location(ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+
+    ONNX_NAMESPACE::StringStringEntryProto* entry = initializer.mutable_external_data()->Add();
+    entry->set_key("location");
+    entry->set_value(ToUTF8String(onnxruntime::utils::kTensorProtoMemoryAddressTag));
+    entry = initializer.mutable_external_data()->Add();
+    entry->set_key("offset");
+    entry->set_value(std::to_string(offset));
+    entry = initializer.mutable_external_data()->Add();
+    entry->set_key("length");
+    entry->set_value(std::to_string(raw_data_range.second));
+  }
+
+  p_model = std::make_shared<Model>(std::move(model_proto), file_path, local_registries, logger, options);
+
+  Graph::ResolveOptions resolve_options;
+  resolve_options.no_proto_sync_required = true;
+  ORT_RETURN_IF_ERROR(p_model->MainGraph().Resolve(resolve_options));
+
+  mapped_model = std::move(mapping);
+  return Status::OK();
+}
+
 Status Model::Save(Model& model, int p_fd) {
   if (p_fd < 0) {
     return Status(ONNXRUNTIME, INVALID_ARGUMENT, "<p_fd> is less than 0.");
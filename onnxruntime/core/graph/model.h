@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <functional>
 #include <list>
 #include <unordered_map>
 #include <memory>
@@ -13,6 +14,7 @@
 #include "core/common/path.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/ort_format_load_options.h"
+#include "core/platform/env.h"
 #include "core/session/onnxruntime_c_api.h"
 #if !defined(ORT_MINIMAL_BUILD)
 #include "core/graph/function_template.h"
@@ -245,6 +247,25 @@ class Model {
                              const logging::Logger& logger,
                              const ModelOptions& options = {});
 
+  // Load a model from a file that is mapped into memory instead of read.
+  // Initializers of the main graph with more than 127 bytes of inline raw_data are changed to refer to their data in
+  // the read-only mapping instead of holding a copy of it, so creating the session state doesn't copy them again and
+  // the pages are shared with other processes that map the same file.
+  // `mapped_model` holds the mapping, which must outlive the model and the session state created from it.
+  static common::Status LoadMapped(const PathString& file_path,
+                                   /*out*/ std::shared_ptr<Model>& p_model,
+                                   /*out*/ Env::MappedMemoryPtr& mapped_model,
+                                   const IOnnxRuntimeOpSchemaRegistryList* local_registries,
+                                   const logging::Logger& logger,
+                                   const ModelOptions& options = {});
+
+  // Call `fn` with each initializer of the main graph of a serialized ModelProto.
+  // The initializers are parsed one at a time and the rest of the model is skipped, so unlike LoadFromBytes this
+  // never holds more than one initializer in memory. Returns an INVALID_PROTOBUF error if the bytes cannot be parsed.
+  static common::Status ForEachInitializer(
+      gsl::span<const uint8_t> model_bytes,
+      const std::function<common::Status(const ONNX_NAMESPACE::TensorProto&)>& fn);
+
   // 'int' rather than 'size_t' because of a protobuf design choice; let callers handle type checks
   static common::Status LoadFromBytes(int count, void* pBytes,
                                       /*out*/ ONNX_NAMESPACE::ModelProto& model_proto);
@@ -91,8 +91,21 @@ struct ThreadOptions {
   void* custom_thread_creation_options = nullptr;
   OrtCustomJoinThreadFn custom_join_thread_fn = nullptr;
   int dynamic_block_base_ = 0;
+
+  // If set, threads that are allowed to spin do so for a duration learned from the recent gaps between their tasks,
+  // instead of a fixed number of iterations.
+  bool adaptive_spinning = false;
 };
 
+/// Capacity of the fastest logical processors, see Env::GetProcessorCapacities.
+constexpr int kMaxProcessorCapacity = 1024;
+
+/// Whether a logical processor of the capacity is an efficiency core, i.e. more than a fifth slower than the
+/// fastest processors, such as the E-cores of a hybrid x86 CPU or the LITTLE cores of an ARM CPU.
+constexpr bool IsEfficiencyProcessorCapacity(int capacity) {
+  return capacity > 0 && capacity <= kMaxProcessorCapacity * 4 / 5;
+}
+
 std::ostream& operator<<(std::ostream& os, const LogicalProcessors&);
 std::ostream& operator<<(std::ostream& os, gsl::span<const LogicalProcessors>);
 
@@ -141,6 +154,24 @@ class Env {
 
   virtual std::vector<LogicalProcessors> GetDefaultThreadAffinities() const = 0;
 
+  /// \brief Returns the logical processors of each NUMA node, indexed by node id.
+  /// Empty if the NUMA topology of the system is not known.
+  virtual std::vector<LogicalProcessors> GetNumaNodes() const { return {}; }
+
+  /// \brief Returns the relative performance of each logical processor, indexed by processor id, scaled so that the
+  /// fastest processors have a capacity of kMaxProcessorCapacity. Processors that are offline have a capacity of 0.
+  /// Empty unless the system has both efficiency cores and faster cores, or if their performance is not known.
+  virtual std::vector<int> GetProcessorCapacities() const { return {}; }
+
+  /// \brief Returns the maximum frequency of the logical processors in kHz, or 0 if it is not known.
+  virtual int64_t GetMaxProcessorFrequencyKHz() const { return 0; }
+
+  /// \brief Asks the OS to back the pages within [addr, addr + size) with memory of a NUMA node when they are
+  /// first touched. Pages that are only partially within the range are left alone.
+  virtual common::Status SetMemoryNumaNode(void* /*addr*/, size_t /*size*/, int /*numa_node*/) const {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED, "Setting the NUMA node of memory is not supported.");
+  }
+
   /// \brief Returns the number of micro-seconds since the Unix epoch.
   virtual uint64_t NowMicros() const {
     return env_time_->NowMicros();
@@ -29,7 +29,10 @@ limitations under the License.
 #include <sys/syscall.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <thread>
 #include <utility>  // for std::forward
@@ -85,6 +88,32 @@ static std::pair<int, std::string> GetSystemError(int e) {
   return std::make_pair(e, msg);
 }
 
+// Parses a list of ids in the format of the Linux sysfs, e.g. "0-3,8,10-11".
+static std::vector<int> ParseSysfsIdList(const std::string& list) {
+  std::vector<int> ids;
+  const char* p = list.c_str();
+  while (*p != '\0' && *p != '\n') {
+    char* end = nullptr;
+    const long first = std::strtol(p, &end, 10);
+    long last = first;
+    if (end == p) {
+      return {};
+    }
+    if (*end == '-') {
+      p = end + 1;
+      last = std::strtol(p, &end, 10);
+      if (end == p) {
+        return {};
+      }
+    }
+    for (long id = first; id <= last; ++id) {
+      ids.push_back(static_cast<int>(id));
+    }
+    p = *end == ',' ? end + 1 : end;
+  }
+  return ids;
+}
+
 static std::pair<int, std::string> GetSystemError() {
   auto e = errno;
   return GetSystemError(e);
@@ -328,6 +357,126 @@ class PosixEnv : public Env {
     return ret;
   }
 
+  std::vector<LogicalProcessors> GetNumaNodes() const override {
+    std::vector<LogicalProcessors> nodes;
+#if defined(__linux__)
+    std::ifstream online_file("/sys/devices/system/node/online");
+    std::string online;
+    if (!std::getline(online_file, online)) {
+      return nodes;
+    }
+
+    // node ids may have gaps. nodes that are not online have no processors.
+    for (int node : ParseSysfsIdList(online)) {
+      if (node >= static_cast<int>(nodes.size())) {
+        nodes.resize(static_cast<size_t>(node) + 1);
+      }
+      std::ifstream cpulist_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      std::string cpulist;
+      if (std::getline(cpulist_file, cpulist)) {
+        nodes[node] = ParseSysfsIdList(cpulist);
+      }
+    }
+#endif
+    return nodes;
+  }
+
+  std::vector<int> GetProcessorCapacities() const override {
+    std::vector<int> capacities;
+#if defined(__linux__)
+    std::ifstream online_file("/sys/devices/system/cpu/online");
+    std::string online;
+    if (!std::getline(online_file, online)) {
+      return capacities;
+    }
+
+    // cpu_capacity is reported for CPUs with cores of different performance on ARM and recent x86 kernels. the
+    // maximum frequency is the next best measure of the performance of a core.
+    const std::vector<int> processors = ParseSysfsIdList(online);
+    for (const char* capacity_file_name : {"cpu_capacity", "cpufreq/cpuinfo_max_freq"}) {
+      capacities.clear();
+      int64_t max_capacity = 0;
+      for (int processor : processors) {
+        std::ifstream capacity_file("/sys/devices/system/cpu/cpu" + std::to_string(processor) + "/" +
+                                    capacity_file_name);
+        int64_t capacity = 0;
+        if (!(capacity_file >> capacity) || capacity <= 0) {
+          max_capacity = 0;
+          break;
+        }
+        if (processor >= static_cast<int>(capacities.size())) {
+          capacities.resize(static_cast<size_t>(processor) + 1, 0);
+        }
+        capacities[processor] = static_cast<int>(std::min<int64_t>(capacity, std::numeric_limits<int>::max()));
+        max_capacity = std::max(max_capacity, capacity);
+      }
+
+      if (max_capacity > 0) {
+        bool has_efficiency_processors = false;
+        for (auto& capacity : capacities) {
+          capacity = static_cast<int>(capacity * int64_t{kMaxProcessorCapacity} / max_capacity);
+          has_efficiency_processors |= IsEfficiencyProcessorCapacity(capacity);
+        }
+        if (has_efficiency_processors) {
+          return capacities;
+        }
+        break;
+      }
+    }
+
+    capacities.clear();
+#endif
+    return capacities;
+  }
+
+  int64_t GetMaxProcessorFrequencyKHz() const override {
+    int64_t max_frequency = 0;
+#if defined(__linux__)
+    std::ifstream online_file("/sys/devices/system/cpu/online");
+    std::string online;
+    if (!std::getline(online_file, online)) {
+      return 0;
+    }
+
+    for (int processor : ParseSysfsIdList(online)) {
+      std::ifstream frequency_file("/sys/devices/system/cpu/cpu" + std::to_string(processor) +
+                                   "/cpufreq/cpuinfo_max_freq");
+      int64_t frequency = 0;
+      if (frequency_file >> frequency) {
+        max_frequency = std::max(max_frequency, frequency);
+      }
+    }
+#endif
+    return max_frequency;
+  }
+
+  common::Status SetMemoryNumaNode(void* addr, size_t size, int numa_node) const override {
+#if defined(__linux__) && defined(SYS_mbind)
+    ORT_RETURN_IF(numa_node < 0, "Invalid NUMA node: ", numa_node);
+    static const uintptr_t page_size = narrow<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(addr) + page_size - 1) & ~(page_size - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + size) & ~(page_size - 1);
+    if (end <= begin) {
+      return Status::OK();
+    }
+
+    constexpr size_t kBitsPerMaskWord = sizeof(unsigned long) * 8;
+    const size_t node = static_cast<size_t>(numa_node);
+    std::vector<unsigned long> node_mask(node / kBitsPerMaskWord + 1, 0);
+    node_mask[node / kBitsPerMaskWord] |= 1UL << (node % kBitsPerMaskWord);
+    // MPOL_PREFERRED from linux/mempolicy.h. falls back to other nodes when the node is out of memory.
+    constexpr int kMpolPreferred = 1;
+    if (syscall(SYS_mbind, begin, end - begin, kMpolPreferred, node_mask.data(),
+                node_mask.size() * kBitsPerMaskWord + 1, 0) != 0) {
+      auto [err_no, err_msg] = GetSystemError();
+      return common::Status(common::SYSTEM, err_no, "mbind failed: " + err_msg);
+    }
+    return Status::OK();
+#else
+    return Env::SetMemoryNumaNode(addr, size, numa_node);
+#endif
+  }
+
   void SleepForMicroseconds(int64_t micros) const override {
     while (micros > 0) {
       timespec sleep_time;
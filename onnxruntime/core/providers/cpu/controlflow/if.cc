@@ -421,7 +421,8 @@ Status IfImpl::Execute(const FeedsFetchesManager& ffm) {
 
   status = utils::ExecuteSubgraph(session_state_, ffm, feeds, fetches, fetch_allocators,
                                   ExecutionMode::ORT_SEQUENTIAL, context_.GetTerminateFlag(),
-                                  context_.Logger(), context_.GetComputeStream());
+                                  context_.Logger(), context_.GetComputeStream(),
+                                  /*sync_subgraph_fetches*/ false, context_.GetDeadline());
 
   ORT_RETURN_IF_ERROR(status);
 
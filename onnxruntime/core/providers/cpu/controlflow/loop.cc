@@ -501,7 +501,8 @@ Status LoopImpl::Execute(const FeedsFetchesManager& ffm) {
                                     context_.GetComputeStream(),
                                     // because the fetch[0] is the loop condition which we need to access on CPU,
                                     // have to perofrm a stream sync to make sure the data arrived.
-                                    true);
+                                    true,
+                                    context_.GetDeadline());
     ORT_RETURN_IF_ERROR(status);
 
     condition_mlvalue_ = fetches[0];
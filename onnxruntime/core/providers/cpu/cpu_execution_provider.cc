@@ -4,6 +4,8 @@
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/kernel_registry.h"
+#include "core/framework/huge_page_cpu_allocator.h"
+#include "core/framework/numa_cpu_allocator.h"
 #include "core/mlas/inc/mlas.h"
 
 #ifndef DISABLE_CONTRIB_OPS
@@ -37,8 +39,23 @@ std::vector<AllocatorPtr> CPUExecutionProvider::CreatePreferredAllocators() {
   // Disable Arena allocator for x86_32 build because it may run into infinite loop when integer overflow happens
   create_arena = false;
 #endif
-  AllocatorCreationInfo device_info{[](int) { return std::make_unique<CPUAllocator>(); },
+  const int numa_node = info_.numa_node;
+  const bool use_huge_pages = info_.use_huge_pages;
+  AllocatorCreationInfo device_info{[numa_node, use_huge_pages](int) -> std::unique_ptr<IAllocator> {
+                                      if (use_huge_pages) {
+                                        return std::make_unique<HugePageCPUAllocator>(numa_node);
+                                      }
+                                      if (numa_node >= 0) {
+                                        return std::make_unique<NumaCPUAllocator>(numa_node);
+                                      }
+                                      return std::make_unique<CPUAllocator>();
+                                    },
                                     DEFAULT_CPU_ALLOCATOR_DEVICE_ID, create_arena};
+  if (use_huge_pages) {
+    // grow the arena in multiples of the huge page size so that no region ends in a partially used huge page
+    constexpr int kHugePageSize = static_cast<int>(HugePageCPUAllocator::kHugePageSize);
+    device_info.arena_cfg = OrtArenaCfg(0, -1, kHugePageSize, -1, kHugePageSize, -1);
+  }
 
   return std::vector<AllocatorPtr>{CreateAllocator(device_info)};
 }
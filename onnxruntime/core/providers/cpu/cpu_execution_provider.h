@@ -11,6 +11,10 @@ namespace onnxruntime {
 // Information needed to construct CPU execution providers.
 struct CPUExecutionProviderInfo {
   bool create_arena{true};
+  // NUMA node to place the memory of the allocator on. -1 to leave the placement to the OS.
+  int numa_node{-1};
+  // Back large allocations, and with them the arena, with huge pages.
+  bool use_huge_pages{false};
 
   explicit CPUExecutionProviderInfo(bool use_arena)
       : create_arena(use_arena) {}
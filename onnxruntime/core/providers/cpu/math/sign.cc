@@ -36,15 +36,15 @@ ONNX_CPU_OPERATOR_VERSIONED_KERNEL(
     Sign,
     9,
     12,
-    KernelDefBuilder().TypeConstraint("T",
-                                      BuildKernelDefConstraintsFromTypeList<EnabledSignDataTypes>()),
+    KernelDefBuilder().MayInplace(0, 0).TypeConstraint("T",
+                                                       BuildKernelDefConstraintsFromTypeList<EnabledSignDataTypes>()),
     Sign);
 
 ONNX_CPU_OPERATOR_KERNEL(
     Sign,
     13,
-    KernelDefBuilder().TypeConstraint("T",
-                                      BuildKernelDefConstraintsFromTypeList<EnabledSignDataTypes>()),
+    KernelDefBuilder().MayInplace(0, 0).TypeConstraint("T",
+                                                       BuildKernelDefConstraintsFromTypeList<EnabledSignDataTypes>()),
     Sign);
 
 namespace sign_internal {
@@ -6,9 +6,11 @@
 #include "core/providers/common.h"
 
 namespace onnxruntime {
+// Y can reuse the buffer of X as each row of X is read before the same row of Y is written
 #define REGISTER_ONNX_KERNEL_TYPED(T)                                                            \
   ONNX_CPU_OPERATOR_TYPED_KERNEL(LayerNormalization, 17, T,                                      \
                                  KernelDefBuilder()                                              \
+                                     .MayInplace(0, 0)                                           \
                                      .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())      \
                                      .TypeConstraint("U", DataTypeImpl::GetTensorType<float>()), \
                                  LayerNorm);
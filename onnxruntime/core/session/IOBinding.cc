@@ -87,16 +87,25 @@ common::Status IOBinding::BindOutput(const std::string& name, OrtDevice device)
   return BindOutputImpl(name, {}, device);
 }
 
-common::Status IOBinding::BindOutputImpl(const std::string& name, const OrtValue& ml_value, OrtDevice device) {
+common::Status IOBinding::BindOutput(const std::string& name, std::shared_ptr<RingBufferAllocator> ring_buffer) {
+  ORT_RETURN_IF(ring_buffer == nullptr, "Ring buffer for output ", name, " is null.");
+  const OrtDevice device = ring_buffer->Info().device;
+  return BindOutputImpl(name, {}, device, std::move(ring_buffer));
+}
+
+common::Status IOBinding::BindOutputImpl(const std::string& name, const OrtValue& ml_value, OrtDevice device,
+                                         std::shared_ptr<RingBufferAllocator> ring_buffer) {
   auto it = mapped_output_names_.emplace(name, output_names_.size());
   size_t index = it.first->second;
   if (it.second) {
     output_names_.push_back(name);
     outputs_.push_back(ml_value);
     outputs_device_info_.push_back(device);
+    outputs_ring_buffers_.push_back(std::move(ring_buffer));
   } else {
     outputs_[index] = ml_value;
     outputs_device_info_[index] = device;
+    outputs_ring_buffers_[index] = std::move(ring_buffer);
   }
   ORT_ENFORCE(mapped_output_names_.size() == output_names_.size(), "Size mismatch", mapped_output_names_.size(), "!=", output_names_.size());
 
@@ -108,6 +117,7 @@ void IOBinding::ClearOutputs() {
   output_names_.clear();
   outputs_.clear();
   outputs_device_info_.clear();
+  outputs_ring_buffers_.clear();
 }
 
 const std::vector<std::string>& IOBinding::GetOutputNames() const { return output_names_; }
@@ -120,6 +130,10 @@ const std::vector<OrtDevice>& IOBinding::GetOutputsDeviceInfo() const {
   return outputs_device_info_;
 }
 
+const std::vector<std::shared_ptr<RingBufferAllocator>>& IOBinding::GetOutputsRingBuffers() const {
+  return outputs_ring_buffers_;
+}
+
 const std::vector<std::string>& IOBinding::GetInputNames() const { return feed_names_; }
 
 const std::vector<OrtValue>& IOBinding::GetInputs() const { return feeds_; }
@@ -10,6 +10,7 @@
 #include "core/common/status.h"
 #include "core/graph/basic_types.h"
 #include "core/framework/ort_value.h"
+#include "core/framework/ring_buffer_allocator.h"
 #include "core/session/inference_session.h"
 #include "core/common/logging/logging.h"
 
@@ -71,6 +72,16 @@ class IOBinding {
    */
   common::Status BindOutput(const std::string& name, OrtDevice device = {});
 
+  /**
+   * Bind an output name to a ring buffer.
+   * Each Run() places the output in the next free slot of the ring buffer instead of allocating it, which avoids
+   * an allocation and a copy for outputs whose shape is not known up front. The slot is returned to the ring buffer
+   * when the last reference to the output is released.
+   * If the ring buffer is full, the output is not a tensor, or the output is produced on a different device than
+   * the ring buffer's, the output is allocated as if it was bound to the ring buffer's device.
+   */
+  common::Status BindOutput(const std::string& name, std::shared_ptr<RingBufferAllocator> ring_buffer);
+
   /**
    * This simply collects the outputs obtained after calling Run() inside the @param outputs.
    */
@@ -106,13 +117,18 @@ class IOBinding {
   std::unordered_map<std::string, size_t> mapped_output_names_;
   std::vector<OrtValue> outputs_;
   std::vector<OrtDevice> outputs_device_info_;
+  std::vector<std::shared_ptr<RingBufferAllocator>> outputs_ring_buffers_;
 
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(IOBinding);
 
   // device info for all outputs. only used by InferenceSession if the output is not pre-allocated.
   const std::vector<OrtDevice>& GetOutputsDeviceInfo() const;
 
+  // ring buffer for all outputs. nullptr if the output is not bound to a ring buffer.
+  const std::vector<std::shared_ptr<RingBufferAllocator>>& GetOutputsRingBuffers() const;
+
   // The implementation for the BindOutput() overloads
-  common::Status BindOutputImpl(const std::string& name, const OrtValue& ml_value, OrtDevice device);
+  common::Status BindOutputImpl(const std::string& name, const OrtValue& ml_value, OrtDevice device,
+                                std::shared_ptr<RingBufferAllocator> ring_buffer = nullptr);
 };
 }  // namespace onnxruntime
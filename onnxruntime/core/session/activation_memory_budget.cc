@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/activation_memory_budget.h"
+
+#include <algorithm>
+
+#include "core/framework/tensor.h"
+#include "core/session/batching_utils.h"
+
+namespace onnxruntime {
+
+ActivationMemoryBudget::ActivationMemoryBudget(size_t budget_bytes, bool can_split, RunFn run_fn,
+                                               PeakSizeFn peak_size_fn, AllocatorPtr cpu_allocator,
+                                               const logging::Logger& logger)
+    : budget_bytes_(budget_bytes),
+      can_split_(can_split),
+      run_fn_(std::move(run_fn)),
+      peak_size_fn_(std::move(peak_size_fn)),
+      cpu_allocator_(std::move(cpu_allocator)),
+      logger_(logger) {
+  ORT_ENFORCE(budget_bytes_ > 0, "An activation memory budget must be positive.");
+  ORT_ENFORCE(cpu_allocator_ != nullptr, "An activation memory budget requires a CPU allocator.");
+}
+
+int64_t ActivationMemoryBudget::GetBatchSize(gsl::span<const OrtValue> feeds,
+                                             const std::vector<OrtValue>& fetches) const {
+  // pre-allocated fetches must be written in place, which the slices cannot do
+  if (!can_split_ || feeds.empty() ||
+      std::any_of(fetches.begin(), fetches.end(), [](const OrtValue& fetch) { return fetch.IsAllocated(); })) {
+    return 0;
+  }
+
+  int64_t batch_size = 0;
+  for (const auto& feed : feeds) {
+    if (!batching_utils::CanBatchAlongAxis(feed, 0)) {
+      return 0;
+    }
+
+    const int64_t feed_batch_size = feed.Get<Tensor>().Shape()[0];
+    if (batch_size != 0 && feed_batch_size != batch_size) {
+      return 0;
+    }
+
+    batch_size = feed_batch_size;
+  }
+
+  return batch_size;
+}
+
+void ActivationMemoryBudget::UpdatePeakSizePerEntry(size_t peak_size, int64_t batch_size) {
+  const size_t entries = static_cast<size_t>(batch_size);
+  const size_t peak_size_per_entry = (peak_size + entries - 1) / entries;
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+  peak_size_per_entry_ = std::max(peak_size_per_entry_, peak_size_per_entry);
+  if (peak_size_per_entry_ > budget_bytes_ && !warned_entry_exceeds_budget_) {
+    warned_entry_exceeds_budget_ = true;
+    LOGS(logger_, WARNING) << "A single batch entry needs " << peak_size_per_entry_
+                           << " bytes, which exceeds the activation memory budget of " << budget_bytes_
+                           << " bytes. Requests are executed one batch entry at a time.";
+  }
+}
+
+int64_t ActivationMemoryBudget::GetSliceSize(int64_t remaining) const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  if (peak_size_per_entry_ == 0) {
+    return 1;
+  }
+
+  const size_t slice_size = std::max<size_t>(budget_bytes_ / peak_size_per_entry_, 1);
+  return static_cast<int64_t>(std::min(slice_size, static_cast<size_t>(remaining)));
+}
+
+ActivationMemoryBudget::Stats ActivationMemoryBudget::GetStats() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return stats_;
+}
+
+Status ActivationMemoryBudget::Run(const RunOptions& run_options, const Deadline& deadline,
+                                   gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                   gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches) {
+  const int64_t batch_size = GetBatchSize(feeds, fetches);
+  const size_t peak_size = batch_size > 0 ? peak_size_fn_(feed_names, feeds) : 0;
+  if (peak_size > 0) {
+    UpdatePeakSizePerEntry(peak_size, batch_size);
+  }
+
+  if (batch_size <= 1 || (peak_size > 0 && peak_size <= budget_bytes_) ||
+      (peak_size == 0 && GetSliceSize(batch_size) == batch_size)) {
+    {
+      std::lock_guard<OrtMutex> lock(mutex_);
+      ++stats_.num_runs;
+    }
+
+    ORT_RETURN_IF_ERROR(run_fn_(run_options, deadline, feed_names, feeds, output_names, &fetches));
+
+    // a pattern is generated by the first run with the input shapes
+    if (batch_size > 0 && peak_size == 0) {
+      const size_t run_peak_size = peak_size_fn_(feed_names, feeds);
+      if (run_peak_size > 0) {
+        UpdatePeakSizePerEntry(run_peak_size, batch_size);
+      }
+    }
+
+    return Status::OK();
+  }
+
+  return RunSplit(run_options, deadline, feed_names, feeds, output_names, batch_size, fetches);
+}
+
+Status ActivationMemoryBudget::RunSplit(const RunOptions& run_options, const Deadline& deadline,
+                                        gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                        gsl::span<const std::string> output_names, int64_t batch_size,
+                                        std::vector<OrtValue>& fetches) {
+  const size_t num_outputs = fetches.size();
+  std::vector<std::vector<OrtValue>> slice_fetches;
+  std::vector<OrtValue> slice_feeds(feeds.size());
+  std::vector<OrtValue> parts;
+  for (int64_t offset = 0; offset < batch_size;) {
+    const int64_t slice_size = GetSliceSize(batch_size - offset);
+    const int64_t split_sizes[] = {offset, slice_size, batch_size - offset - slice_size};
+    for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+      // slices along axis 0 are views of the feeds
+      ORT_RETURN_IF_ERROR(batching_utils::SplitAlongAxis(feeds[i], 0, split_sizes, cpu_allocator_, parts));
+      slice_feeds[i] = std::move(parts[1]);
+    }
+
+    std::vector<OrtValue> outputs(num_outputs);
+    ORT_RETURN_IF_ERROR(run_fn_(run_options, deadline, feed_names, slice_feeds, output_names, &outputs));
+    for (size_t i = 0; i < num_outputs; ++i) {
+      ORT_RETURN_IF_NOT(batching_utils::CanBatchAlongAxis(outputs[i], 0) &&
+                            outputs[i].Get<Tensor>().Shape()[0] == slice_size,
+                        "Output ", output_names[i], " doesn't have the batch size on axis 0, so the request can't ",
+                        "be split to stay within the activation memory budget of ", budget_bytes_, " bytes.");
+    }
+
+    const size_t slice_peak_size = peak_size_fn_(feed_names, slice_feeds);
+    if (slice_peak_size > 0) {
+      UpdatePeakSizePerEntry(slice_peak_size, slice_size);
+    }
+
+    slice_fetches.push_back(std::move(outputs));
+    offset += slice_size;
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    ++stats_.num_split_runs;
+    stats_.num_slices += slice_fetches.size();
+  }
+
+  std::vector<const OrtValue*> output_slices(slice_fetches.size());
+  for (size_t i = 0; i < num_outputs; ++i) {
+    for (size_t slice = 0, end = slice_fetches.size(); slice < end; ++slice) {
+      output_slices[slice] = &slice_fetches[slice][i];
+    }
+
+    ORT_RETURN_IF_ERROR(batching_utils::ConcatenateAlongAxis(output_slices, 0, cpu_allocator_, fetches[i]));
+  }
+
+  VLOGS(logger_, 1) << "Executed a request with batch size " << batch_size << " as " << slice_fetches.size()
+                    << " slices to stay within the activation memory budget of " << budget_bytes_ << " bytes.";
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/logging/logging.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/run_options.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+ * Keeps the memory of the intermediate values of Run() requests within a budget by splitting their batch.
+ *
+ * The planned peak of a request is the peak of the memory pattern generated for its input shapes. A request whose
+ * peak exceeds the budget, or whose peak is not known yet, is executed as a sequence of requests over slices of
+ * axis 0 of its inputs, and the outputs of the slices are concatenated along axis 0. The slice size is the budget
+ * divided by the largest peak per batch entry seen so far. As long as nothing is known, a slice of a single batch
+ * entry is executed first to measure it. The peak of a large batch thus never has to be seen to be avoided, at the
+ * cost of more, smaller runs.
+ *
+ * Requests with inputs that are not CPU tensors with the same size of axis 0, or with pre-allocated outputs, are
+ * executed unsplit, as are all requests if axis 0 is not a batch dimension of the model (see
+ * batching_utils::ValidateBatchAxis).
+ *
+ * The deadline of a request is resolved once by the caller, so the slices of a request share it.
+ */
+class ActivationMemoryBudget {
+ public:
+  using Deadline = std::optional<std::chrono::steady_clock::time_point>;
+
+  using RunFn = std::function<Status(const RunOptions& run_options, const Deadline& deadline,
+                                     gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                     gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches)>;
+
+  // Returns the planned peak in bytes of a run with the feeds, or 0 if no memory pattern exists for them yet.
+  using PeakSizeFn = std::function<size_t(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds)>;
+
+  struct Stats {
+    size_t num_runs = 0;        // requests executed unsplit
+    size_t num_split_runs = 0;  // requests executed as slices
+    size_t num_slices = 0;      // slices executed for the split requests
+  };
+
+  // `can_split` is false if axis 0 is not a batch dimension of the model, in which case every request is
+  // executed unsplit.
+  ActivationMemoryBudget(size_t budget_bytes, bool can_split, RunFn run_fn, PeakSizeFn peak_size_fn,
+                         AllocatorPtr cpu_allocator, const logging::Logger& logger);
+
+  Status Run(const RunOptions& run_options, const Deadline& deadline,
+             gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+             gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches);
+
+  size_t GetBudget() const { return budget_bytes_; }
+
+  Stats GetStats() const;
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ActivationMemoryBudget);
+
+  // Returns the size of axis 0 shared by all feeds, or 0 if the request can't be split.
+  int64_t GetBatchSize(gsl::span<const OrtValue> feeds, const std::vector<OrtValue>& fetches) const;
+
+  // Records the peak of a run over `batch_size` batch entries.
+  void UpdatePeakSizePerEntry(size_t peak_size, int64_t batch_size);
+
+  // Returns the number of batch entries to execute at once, at most `remaining`.
+  int64_t GetSliceSize(int64_t remaining) const;
+
+  Status RunSplit(const RunOptions& run_options, const Deadline& deadline,
+                  gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                  gsl::span<const std::string> output_names, int64_t batch_size, std::vector<OrtValue>& fetches);
+
+  const size_t budget_bytes_;
+  const bool can_split_;
+  const RunFn run_fn_;
+  const PeakSizeFn peak_size_fn_;
+  const AllocatorPtr cpu_allocator_;
+  const logging::Logger& logger_;
+
+  mutable OrtMutex mutex_;
+  size_t peak_size_per_entry_ = 0;  // 0 until a peak has been seen
+  bool warned_entry_exceeds_budget_ = false;
+  Stats stats_;
+};
+
+}  // namespace onnxruntime
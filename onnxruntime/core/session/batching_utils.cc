@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/batching_utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+#include "core/framework/data_types.h"
+#include "core/framework/tensor.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/graph_viewer.h"
+
+namespace onnxruntime {
+namespace batching_utils {
+
+namespace {
+
+// Copy `num_elements` elements of `tensor`'s type from `src` to `dst`.
+void CopyElements(const Tensor& tensor, const void* src, void* dst, size_t num_elements) {
+  if (tensor.IsDataTypeString()) {
+    const auto* src_str = static_cast<const std::string*>(src);
+    auto* dst_str = static_cast<std::string*>(dst);
+    std::copy(src_str, src_str + num_elements, dst_str);
+  } else {
+    memcpy(dst, src, SafeInt<size_t>(num_elements) * tensor.DataType()->Size());
+  }
+}
+
+}  // namespace
+
+Status ValidateBatchAxis(const GraphViewer& graph, size_t axis) {
+  const auto& inputs = graph.GetInputs();
+  const auto& outputs = graph.GetOutputs();
+  ORT_RETURN_IF(inputs.empty() || outputs.empty(), "The model needs inputs and outputs to be batched.");
+
+  const std::string* batch_dim_param = nullptr;
+  for (const auto* node_args : {&inputs, &outputs}) {
+    for (const NodeArg* node_arg : *node_args) {
+      const auto* shape = node_arg->Shape();
+      ORT_RETURN_IF(shape == nullptr || static_cast<size_t>(shape->dim_size()) <= axis,
+                    "'", node_arg->Name(), "' has no dimension ", axis, " to batch along.");
+
+      const auto& dim = shape->dim(static_cast<int>(axis));
+      ORT_RETURN_IF_NOT(utils::HasDimParam(dim), "Dimension ", axis, " of '", node_arg->Name(),
+                        "' is not a symbolic dimension, so it cannot be a batch axis.");
+
+      if (batch_dim_param == nullptr) {
+        batch_dim_param = &dim.dim_param();
+      } else {
+        ORT_RETURN_IF(dim.dim_param() != *batch_dim_param, "Dimension ", axis, " of '", node_arg->Name(), "' is '",
+                      dim.dim_param(), "' but other inputs or outputs use '", *batch_dim_param,
+                      "'. Every input and output must share the batch dimension.");
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+bool CanBatchAlongAxis(const OrtValue& value, size_t axis) {
+  if (!value.IsTensor()) {
+    return false;
+  }
+
+  const auto& tensor = value.Get<Tensor>();
+#ifdef ENABLE_STRIDED_TENSORS
+  if (!tensor.IsContiguous()) {
+    return false;
+  }
+#endif
+
+  return tensor.Location().device.Type() == OrtDevice::CPU &&
+         tensor.Shape().NumDimensions() > axis;
+}
+
+bool AreBatchCompatible(const OrtValue& a, const OrtValue& b, size_t axis) {
+  const auto& tensor_a = a.Get<Tensor>();
+  const auto& tensor_b = b.Get<Tensor>();
+  if (tensor_a.DataType() != tensor_b.DataType()) {
+    return false;
+  }
+
+  const auto dims_a = tensor_a.Shape().GetDims();
+  const auto dims_b = tensor_b.Shape().GetDims();
+  if (dims_a.size() != dims_b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < dims_a.size(); ++i) {
+    if (i != axis && dims_a[i] != dims_b[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+Status ConcatenateAlongAxis(gsl::span<const OrtValue* const> values, size_t axis,
+                            const AllocatorPtr& allocator, OrtValue& output) {
+  ORT_RETURN_IF(values.empty(), "No values to concatenate.");
+
+  const auto& first = values[0]->Get<Tensor>();
+  int64_t total_axis_dim = 0;
+  for (const auto* value : values) {
+    ORT_RETURN_IF_NOT(CanBatchAlongAxis(*value, axis) && AreBatchCompatible(*values[0], *value, axis),
+                      "Tensors cannot be concatenated along axis ", axis);
+    total_axis_dim += value->Get<Tensor>().Shape()[axis];
+  }
+
+  TensorShapeVector output_dims = first.Shape().AsShapeVector();
+  output_dims[axis] = total_axis_dim;
+  Tensor::InitOrtValue(first.DataType(), TensorShape(output_dims), allocator, output);
+
+  auto& output_tensor = *output.GetMutable<Tensor>();
+  const size_t element_size = first.DataType()->Size();
+  const size_t num_outer = narrow<size_t>(first.Shape().SizeToDimension(axis));
+  auto* dst = static_cast<uint8_t*>(output_tensor.MutableDataRaw());
+
+  for (size_t outer = 0; outer < num_outer; ++outer) {
+    for (const auto* value : values) {
+      const auto& tensor = value->Get<Tensor>();
+      const size_t chunk = narrow<size_t>(tensor.Shape().SizeFromDimension(axis));
+      const auto* src = static_cast<const uint8_t*>(tensor.DataRaw()) + outer * chunk * element_size;
+      CopyElements(tensor, src, dst, chunk);
+      dst += chunk * element_size;
+    }
+  }
+
+  return Status::OK();
+}
+
+Status SplitAlongAxis(const OrtValue& value, size_t axis, gsl::span<const int64_t> split_sizes,
+                      const AllocatorPtr& allocator, std::vector<OrtValue>& outputs) {
+  ORT_RETURN_IF_NOT(CanBatchAlongAxis(value, axis), "Tensor cannot be split along axis ", axis);
+
+  const auto& tensor = value.Get<Tensor>();
+  const auto& shape = tensor.Shape();
+  const int64_t total = std::accumulate(split_sizes.begin(), split_sizes.end(), int64_t{0});
+  ORT_RETURN_IF_NOT(total == shape[axis], "Split sizes add up to ", total, " but the dimension of axis ", axis,
+                    " is ", shape[axis]);
+
+  const size_t element_size = tensor.DataType()->Size();
+  const size_t inner = narrow<size_t>(shape.SizeFromDimension(axis + 1));
+  const size_t num_outer = narrow<size_t>(shape.SizeToDimension(axis));
+  const size_t src_chunk = narrow<size_t>(shape[axis]) * inner;
+
+  outputs.clear();
+  outputs.reserve(split_sizes.size());
+
+  TensorShapeVector slice_dims = shape.AsShapeVector();
+  size_t axis_offset = 0;
+  for (const int64_t split_size : split_sizes) {
+    slice_dims[axis] = split_size;
+    TensorShape slice_shape(slice_dims);
+    OrtValue slice;
+
+    if (axis == 0 && !tensor.IsDataTypeString()) {
+      // The slice is a contiguous range of the source buffer. Hand out a view that keeps the source alive.
+      auto p_tensor = std::make_unique<Tensor>(tensor.DataType(), slice_shape,
+                                               const_cast<void*>(tensor.DataRaw()), tensor.Location(),
+                                               narrow<ptrdiff_t>(axis_offset * inner * element_size));
+      OrtValue keep_alive = value;
+      auto ml_tensor = DataTypeImpl::GetType<Tensor>();
+      slice.Init(p_tensor.release(), ml_tensor,
+                 [keep_alive](void* p) { delete static_cast<Tensor*>(p); });
+    } else {
+      Tensor::InitOrtValue(tensor.DataType(), slice_shape, allocator, slice);
+      auto& slice_tensor = *slice.GetMutable<Tensor>();
+      const size_t dst_chunk = narrow<size_t>(split_size) * inner;
+      const auto* src = static_cast<const uint8_t*>(tensor.DataRaw());
+      auto* dst = static_cast<uint8_t*>(slice_tensor.MutableDataRaw());
+      for (size_t outer = 0; outer < num_outer; ++outer) {
+        CopyElements(tensor, src + (outer * src_chunk + axis_offset * inner) * element_size,
+                     dst + outer * dst_chunk * element_size, dst_chunk);
+      }
+    }
+
+    outputs.push_back(std::move(slice));
+    axis_offset += narrow<size_t>(split_size);
+  }
+
+  return Status::OK();
+}
+
+}  // namespace batching_utils
+}  // namespace onnxruntime
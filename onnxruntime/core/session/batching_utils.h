@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+
+namespace onnxruntime {
+class GraphViewer;
+
+namespace batching_utils {
+
+/**
+ * Check that dimension `axis` of every input and output of the graph is the same symbolic dimension (dim_param).
+ * That is how a model declares a batch axis along which rows are independent, so feeds can be concatenated and
+ * outputs split along it. A dimension that is fixed or unknown, or a different symbolic dimension, is rejected,
+ * because the output of e.g. a reduction over the axis could have a matching size by coincidence.
+ */
+Status ValidateBatchAxis(const GraphViewer& graph, size_t axis);
+
+/**
+ * Returns true if the value is a tensor in CPU memory with more than `axis` dimensions, i.e. a value that
+ * ConcatenateAlongAxis and SplitAlongAxis can operate on.
+ */
+bool CanBatchAlongAxis(const OrtValue& value, size_t axis);
+
+/**
+ * Returns true if the two tensors have the same element type and the same dimensions on every axis but `axis`.
+ * Both values must satisfy CanBatchAlongAxis.
+ */
+bool AreBatchCompatible(const OrtValue& a, const OrtValue& b, size_t axis);
+
+/**
+ * Concatenate tensors along `axis` into a new tensor allocated from `allocator`.
+ * All inputs must be pairwise compatible according to AreBatchCompatible.
+ */
+Status ConcatenateAlongAxis(gsl::span<const OrtValue* const> values, size_t axis,
+                            const AllocatorPtr& allocator, OrtValue& output);
+
+/**
+ * Split a tensor along `axis` into slices of `split_sizes` entries. The sizes must add up to the size of `axis`.
+ * Slices along axis 0 are contiguous, so they are returned as views that keep `value`'s buffer alive instead
+ * of being copied. Slices along any other axis are copied into new tensors allocated from `allocator`.
+ */
+Status SplitAlongAxis(const OrtValue& value, size_t axis, gsl::span<const int64_t> split_sizes,
+                      const AllocatorPtr& allocator, std::vector<OrtValue>& outputs);
+
+}  // namespace batching_utils
+}  // namespace onnxruntime
@@ -0,0 +1,234 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/dynamic_batcher.h"
+
+#include <algorithm>
+
+#include "core/framework/tensor.h"
+#include "core/session/batching_utils.h"
+
+namespace onnxruntime {
+
+DynamicBatcher::DynamicBatcher(const Options& options, RunFn run_fn, AllocatorPtr cpu_allocator)
+    : options_(options), run_fn_(std::move(run_fn)), cpu_allocator_(std::move(cpu_allocator)) {
+  ORT_ENFORCE(options_.max_batch_size > 1, "Dynamic batching requires a max batch size greater than 1.");
+  ORT_ENFORCE(cpu_allocator_ != nullptr, "Dynamic batching requires a CPU allocator.");
+}
+
+bool DynamicBatcher::IsBatchable(gsl::span<const OrtValue> feeds, const std::vector<OrtValue>& fetches) const {
+  if (feeds.empty()) {
+    return false;
+  }
+
+  // pre-allocated fetches must be written in place, which a batched run cannot do
+  for (const auto& fetch : fetches) {
+    if (fetch.IsAllocated()) {
+      return false;
+    }
+  }
+
+  const size_t axis = options_.batch_axis;
+  if (!std::all_of(feeds.begin(), feeds.end(), [axis](const OrtValue& feed) {
+        return batching_utils::CanBatchAlongAxis(feed, axis);
+      })) {
+    return false;
+  }
+
+  // the feeds share the batch dimension, so a request whose feeds disagree on it is invalid on its own and must not
+  // be concatenated with others into feeds that happen to agree
+  const int64_t batch_size = feeds[0].Get<Tensor>().Shape()[axis];
+  return std::all_of(feeds.begin(), feeds.end(), [axis, batch_size](const OrtValue& feed) {
+    return feed.Get<Tensor>().Shape()[axis] == batch_size;
+  });
+}
+
+bool DynamicBatcher::AreRunOptionsCompatible(const RunOptions& a, const RunOptions& b) {
+  // the config entries include the run priority and deadline
+  return !a.terminate && !b.terminate &&
+         a.run_log_severity_level == b.run_log_severity_level &&
+         a.run_log_verbosity_level == b.run_log_verbosity_level &&
+         a.run_tag == b.run_tag &&
+         a.only_execute_path_to_fetches == b.only_execute_path_to_fetches &&
+#ifdef ENABLE_TRAINING
+         a.training_mode == b.training_mode &&
+#endif
+         a.config_options.configurations == b.config_options.configurations;
+}
+
+bool DynamicBatcher::CanJoin(const Request& leader, const Request& request) const {
+  if (!AreRunOptionsCompatible(*leader.run_options, *request.run_options) ||
+      !std::equal(leader.feed_names.begin(), leader.feed_names.end(),
+                  request.feed_names.begin(), request.feed_names.end()) ||
+      !std::equal(leader.output_names.begin(), leader.output_names.end(),
+                  request.output_names.begin(), request.output_names.end())) {
+    return false;
+  }
+
+  for (size_t i = 0, end = leader.feeds.size(); i < end; ++i) {
+    if (!batching_utils::AreBatchCompatible(leader.feeds[i], request.feeds[i], options_.batch_axis)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+Status DynamicBatcher::Run(const RunOptions& run_options, const Deadline& deadline,
+                           gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                           gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches) {
+  if (!IsBatchable(feeds, fetches)) {
+    return run_fn_(run_options, deadline, feed_names, feeds, output_names, &fetches);
+  }
+
+  Request request{&run_options, deadline, feed_names, feeds, output_names, &fetches, Status::OK()};
+
+  std::unique_lock<OrtMutex> lock(mutex_);
+  pending_.push_back(&request);
+  if (pending_.size() >= options_.max_batch_size) {
+    batch_full_cv_.notify_one();
+  }
+
+  while (!request.done) {
+    if (leader_active_) {
+      batch_done_cv_.wait(lock);
+      continue;
+    }
+
+    // become the leader for the next batch
+    leader_active_ = true;
+    const auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+    for (auto now = std::chrono::steady_clock::now();
+         pending_.size() < options_.max_batch_size && now < deadline;
+         now = std::chrono::steady_clock::now()) {
+      batch_full_cv_.wait_for(lock, deadline - now);
+    }
+
+    const size_t batch_size = std::min(pending_.size(), options_.max_batch_size);
+    InlinedVector<Request*> batch(pending_.begin(), pending_.begin() + batch_size);
+    pending_.erase(pending_.begin(), pending_.begin() + batch_size);
+
+    lock.unlock();
+    ORT_TRY {
+      ExecuteBatch(batch);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        for (auto* batched_request : batch) {
+          batched_request->status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+        }
+      });
+    }
+    lock.lock();
+
+    for (auto* batched_request : batch) {
+      batched_request->done = true;
+    }
+
+    leader_active_ = false;
+    batch_done_cv_.notify_all();
+  }
+
+  return request.status;
+}
+
+void DynamicBatcher::ExecuteBatch(gsl::span<Request* const> batch) {
+  // partition the batch into groups of requests whose feeds can be concatenated
+  InlinedVector<bool> assigned(batch.size(), false);
+  InlinedVector<Request*> group;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (assigned[i]) {
+      continue;
+    }
+
+    group.clear();
+    group.push_back(batch[i]);
+    for (size_t j = i + 1; j < batch.size(); ++j) {
+      if (!assigned[j] && CanJoin(*batch[i], *batch[j])) {
+        assigned[j] = true;
+        group.push_back(batch[j]);
+      }
+    }
+
+    if (group.size() == 1 || !ExecuteGroup(group)) {
+      ExecuteIndividually(group);
+    }
+  }
+}
+
+bool DynamicBatcher::ExecuteGroup(gsl::span<Request* const> group) {
+  const size_t axis = options_.batch_axis;
+  const Request& leader = *group[0];
+  const size_t num_feeds = leader.feeds.size();
+  const size_t num_fetches = leader.output_names.size();
+
+  InlinedVector<int64_t> batch_sizes;
+  batch_sizes.reserve(group.size());
+  Deadline deadline;
+  for (const auto* request : group) {
+    batch_sizes.push_back(request->feeds[0].Get<Tensor>().Shape()[axis]);
+    if (request->deadline && (!deadline || *request->deadline < *deadline)) {
+      deadline = request->deadline;
+    }
+  }
+
+  std::vector<OrtValue> batched_feeds(num_feeds);
+  InlinedVector<const OrtValue*> to_concat;
+  for (size_t i = 0; i < num_feeds; ++i) {
+    to_concat.clear();
+    for (const auto* request : group) {
+      to_concat.push_back(&request->feeds[i]);
+    }
+
+    if (!batching_utils::ConcatenateAlongAxis(to_concat, axis, cpu_allocator_, batched_feeds[i]).IsOK()) {
+      return false;
+    }
+  }
+
+  std::vector<OrtValue> batched_fetches(num_fetches);
+  auto status = run_fn_(*leader.run_options, deadline, leader.feed_names, batched_feeds, leader.output_names,
+                        &batched_fetches);
+  if (!status.IsOK()) {
+    // the requests would fail the same way on their own
+    for (auto* request : group) {
+      request->status = status;
+    }
+    return true;
+  }
+
+  // split every output before handing any of them out so a failure leaves all requests untouched
+  std::vector<std::vector<OrtValue>> per_output_slices(num_fetches);
+  for (size_t i = 0; i < num_fetches; ++i) {
+    if (!batching_utils::SplitAlongAxis(batched_fetches[i], axis, batch_sizes, cpu_allocator_,
+                                        per_output_slices[i])
+             .IsOK()) {
+      // the output does not carry the batch dimension
+      return false;
+    }
+  }
+
+  for (size_t r = 0; r < group.size(); ++r) {
+    // only the leader's terminate flag was checked during the run
+    if (group[r]->run_options->terminate) {
+      group[r]->status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exiting due to terminate flag being set to true.");
+      continue;
+    }
+
+    auto& fetches = *group[r]->fetches;
+    fetches.resize(num_fetches);
+    for (size_t i = 0; i < num_fetches; ++i) {
+      fetches[i] = std::move(per_output_slices[i][r]);
+    }
+  }
+
+  return true;
+}
+
+void DynamicBatcher::ExecuteIndividually(gsl::span<Request* const> group) {
+  for (auto* request : group) {
+    request->status = run_fn_(*request->run_options, request->deadline, request->feed_names, request->feeds,
+                              request->output_names, request->fetches);
+  }
+}
+
+}  // namespace onnxruntime
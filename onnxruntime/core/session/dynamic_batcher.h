@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/run_options.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+ * Collects concurrent Run() requests against one session and executes them as a single batched run.
+ *
+ * The first request to arrive becomes the leader of a batch. It waits for up to `timeout` or until
+ * `max_batch_size` requests are pending, concatenates the feeds of all compatible requests along `batch_axis`,
+ * executes once, and splits every output along the same axis back to the individual callers.
+ * Requests that cannot be batched (non-CPU or non-tensor feeds, pre-allocated fetches, mismatched shapes) are
+ * executed individually, as is a batch whose outputs do not carry the batch dimension. Any other failure of a
+ * batched run, e.g. an error of the model, the deadline or the terminate flag, fails every request in the batch.
+ * The caller must check with batching_utils::ValidateBatchAxis that the model declares `batch_axis` as a batch
+ * dimension.
+ *
+ * Only requests with equal RunOptions are batched together, and the batched run uses the RunOptions of the first
+ * request in the batch. A request whose terminate flag is set while the batch runs fails as if it ran on its own.
+ * The deadline of a request is resolved by the caller when the request arrives, so the time it waits for a batch
+ * counts towards it. A batch runs with the earliest deadline of its requests.
+ */
+class DynamicBatcher {
+ public:
+  struct Options {
+    size_t max_batch_size = 1;
+    std::chrono::microseconds timeout{1000};
+    size_t batch_axis = 0;
+  };
+
+  using Deadline = std::optional<std::chrono::steady_clock::time_point>;
+
+  using RunFn = std::function<Status(const RunOptions& run_options, const Deadline& deadline,
+                                     gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                     gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches)>;
+
+  DynamicBatcher(const Options& options, RunFn run_fn, AllocatorPtr cpu_allocator);
+
+  /**
+   * Run the request, possibly as part of a batch with other concurrent requests.
+   * Blocks until the outputs for this request are available.
+   */
+  Status Run(const RunOptions& run_options, const Deadline& deadline,
+             gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+             gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches);
+
+  const Options& GetOptions() const { return options_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(DynamicBatcher);
+
+  struct Request {
+    const RunOptions* run_options;
+    Deadline deadline;
+    gsl::span<const std::string> feed_names;
+    gsl::span<const OrtValue> feeds;
+    gsl::span<const std::string> output_names;
+    std::vector<OrtValue>* fetches;
+    Status status;
+    bool done = false;
+  };
+
+  bool IsBatchable(gsl::span<const OrtValue> feeds, const std::vector<OrtValue>& fetches) const;
+  bool CanJoin(const Request& leader, const Request& request) const;
+  static bool AreRunOptionsCompatible(const RunOptions& a, const RunOptions& b);
+
+  // Execute a set of requests taken off the queue. Sets the status and fetches of every request.
+  void ExecuteBatch(gsl::span<Request* const> batch);
+  // Execute the requests of a group as one batched run and set the status and fetches of every request.
+  // Returns false without touching the requests if the group cannot be batched.
+  bool ExecuteGroup(gsl::span<Request* const> group);
+  void ExecuteIndividually(gsl::span<Request* const> group);
+
+  const Options options_;
+  const RunFn run_fn_;
+  const AllocatorPtr cpu_allocator_;
+
+  OrtMutex mutex_;
+  OrtCondVar batch_full_cv_;  // signalled when the pending queue reaches max_batch_size
+  OrtCondVar batch_done_cv_;  // signalled when a leader has finished executing a batch
+  InlinedVector<Request*> pending_;
+  bool leader_active_ = false;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,140 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/execution_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/common/logging/logging.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+ExecutionPipeline::ExecutionPipeline(size_t num_steps, size_t num_stages, concurrency::ThreadPool* thread_pool,
+                                     StageDoneFn stage_done)
+    : thread_pool_(thread_pool), stage_done_(std::move(stage_done)) {
+  ORT_ENFORCE(num_steps > 0, "An execution pipeline requires at least one step.");
+  num_stages = std::clamp<size_t>(num_stages, 1, num_steps);
+
+  stages_.reserve(num_stages);
+  for (size_t i = 0; i < num_stages; ++i) {
+    auto stage = std::make_unique<Stage>();
+    stage->begin_step = num_steps * i / num_stages;
+    stage->end_step = num_steps * (i + 1) / num_stages;
+    stages_.push_back(std::move(stage));
+  }
+}
+
+ExecutionPipeline::~ExecutionPipeline() {
+  std::unique_lock<OrtMutex> lock(in_flight_mutex_);
+  all_done_cv_.wait(lock, [this]() { return num_in_flight_ == 0 && num_active_tasks_ == 0; });
+}
+
+void ExecutionPipeline::Submit(std::unique_ptr<StagedPlanExecution> execution, const bool& terminate_flag,
+                               concurrency::ThreadPool::RunPriority priority, DoneFn done) {
+  {
+    std::lock_guard<OrtMutex> lock(in_flight_mutex_);
+    ++num_in_flight_;
+  }
+
+  if (priority == concurrency::ThreadPool::RunPriority::kHigh) {
+    concurrency::ThreadPool::BeginHighPriorityRun(thread_pool_);
+  }
+
+  auto run = std::make_unique<Run>();
+  run->execution = std::move(execution);
+  run->terminate_flag = &terminate_flag;
+  run->priority = priority;
+  run->done = std::move(done);
+  Enqueue(0, std::move(run));
+}
+
+void ExecutionPipeline::Enqueue(size_t stage_idx, std::unique_ptr<Run> run) {
+  auto& stage = *stages_[stage_idx];
+  {
+    std::lock_guard<OrtMutex> lock(stage.mutex);
+    if (stage.busy) {
+      // the task executing the stage picks it up when it is done with the runs ahead of it
+      stage.queue.push_back(std::move(run));
+      return;
+    }
+
+    stage.busy = true;
+  }
+
+  {
+    std::lock_guard<OrtMutex> lock(in_flight_mutex_);
+    ++num_active_tasks_;
+  }
+
+  // the thread pool takes a copyable function, so ownership is passed as a raw pointer
+  auto* p_run = run.release();
+  concurrency::ThreadPool::Schedule(thread_pool_, [this, stage_idx, p_run]() {
+    ExecuteStage(stage_idx, std::unique_ptr<Run>(p_run));
+  });
+}
+
+void ExecutionPipeline::ExecuteStage(size_t stage_idx, std::unique_ptr<Run> run) {
+  auto& stage = *stages_[stage_idx];
+  const bool is_last_stage = stage_idx + 1 == stages_.size();
+
+  while (run) {
+    ORT_TRY {
+      concurrency::ThreadPool::ScopedRunPriority scoped_run_priority(thread_pool_, run->priority);
+      run->status = run->execution->ExecuteSteps(stage.begin_step, stage.end_step, *run->terminate_flag);
+      if (stage_done_) {
+        stage_done_();
+      }
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        run->status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+      });
+    }
+
+    if (is_last_stage || !run->status.IsOK()) {
+      Complete(std::move(run));
+    } else {
+      Enqueue(stage_idx + 1, std::move(run));
+    }
+
+    std::lock_guard<OrtMutex> lock(stage.mutex);
+    if (stage.queue.empty()) {
+      stage.busy = false;
+    } else {
+      run = std::move(stage.queue.front());
+      stage.queue.pop_front();
+    }
+  }
+
+  std::lock_guard<OrtMutex> lock(in_flight_mutex_);
+  if (--num_active_tasks_ == 0 && num_in_flight_ == 0) {
+    all_done_cv_.notify_all();
+  }
+}
+
+void ExecutionPipeline::Complete(std::unique_ptr<Run> run) {
+  ORT_TRY {
+    run->done(run->status, *run->execution);
+  }
+  ORT_CATCH(const std::exception& ex) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      LOGS_DEFAULT(ERROR) << "Completion callback of a pipelined run threw an exception: " << ex.what();
+    });
+  }
+
+  if (run->priority == concurrency::ThreadPool::RunPriority::kHigh) {
+    concurrency::ThreadPool::EndHighPriorityRun(thread_pool_);
+  }
+
+  // release the execution frame before the pipeline can be destroyed
+  run.reset();
+
+  std::lock_guard<OrtMutex> lock(in_flight_mutex_);
+  if (--num_in_flight_ == 0 && num_active_tasks_ == 0) {
+    all_done_cv_.notify_all();
+  }
+}
+
+}  // namespace onnxruntime
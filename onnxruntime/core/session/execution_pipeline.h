@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/status.h"
+#include "core/framework/sequential_executor.h"
+#include "core/platform/ort_mutex.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+
+/**
+ * Executes consecutive runs of one session as a pipeline.
+ *
+ * The steps of the execution plan are split into `num_stages` contiguous ranges of about the same number of steps.
+ * Each stage executes one run at a time, in the order the runs were submitted, and hands the run over to the next
+ * stage when it is done. Stage k of run N+1 can therefore execute while stage k+1 of run N is still executing,
+ * so the nodes at the start of the graph of a new request don't wait for the tail of the previous request.
+ *
+ * Stages are executed as tasks on a thread pool. No thread is blocked waiting for a run to reach a stage.
+ */
+class ExecutionPipeline {
+ public:
+  using DoneFn = std::function<void(Status status, StagedPlanExecution& execution)>;
+  // Called on the thread that executed a stage of a run, after the stage, e.g. to release per-thread caches.
+  using StageDoneFn = std::function<void()>;
+
+  ExecutionPipeline(size_t num_steps, size_t num_stages, concurrency::ThreadPool* thread_pool,
+                    StageDoneFn stage_done = nullptr);
+
+  // Waits until all submitted runs are done. Must not be called from a completion callback.
+  ~ExecutionPipeline();
+
+  /**
+   * Submit a run. Returns immediately.
+   * `done` is called on a thread pool thread after the last stage, or after the first stage that failed.
+   * `terminate_flag` must stay valid until `done` is called.
+   * The stages of the run execute with `priority`. A high priority run counts as in progress on the thread pool
+   * from submission to completion, including while it waits for a stage.
+   */
+  void Submit(std::unique_ptr<StagedPlanExecution> execution, const bool& terminate_flag,
+              concurrency::ThreadPool::RunPriority priority, DoneFn done);
+
+  size_t NumStages() const { return stages_.size(); }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExecutionPipeline);
+
+  struct Run {
+    std::unique_ptr<StagedPlanExecution> execution;
+    const bool* terminate_flag;
+    concurrency::ThreadPool::RunPriority priority;
+    DoneFn done;
+    Status status;
+  };
+
+  struct Stage {
+    size_t begin_step;
+    size_t end_step;
+    OrtMutex mutex;
+    // runs waiting for this stage, oldest first
+    std::deque<std::unique_ptr<Run>> queue;
+    // whether a task is executing this stage
+    bool busy = false;
+  };
+
+  // Hand a run to a stage. Starts a task for the stage if it is idle.
+  void Enqueue(size_t stage_idx, std::unique_ptr<Run> run);
+
+  // Task executing a stage until its queue is empty.
+  void ExecuteStage(size_t stage_idx, std::unique_ptr<Run> run);
+
+  void Complete(std::unique_ptr<Run> run);
+
+  concurrency::ThreadPool* const thread_pool_;
+  const StageDoneFn stage_done_;
+  std::vector<std::unique_ptr<Stage>> stages_;
+
+  OrtMutex in_flight_mutex_;
+  // signalled when there are no runs in flight and no tasks executing a stage
+  OrtCondVar all_done_cv_;
+  size_t num_in_flight_ = 0;     // runs submitted but not completed
+  size_t num_active_tasks_ = 0;  // thread pool tasks executing a stage
+};
+
+}  // namespace onnxruntime
@@ -4,6 +4,7 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/session/inference_session.h"
 
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <list>
@@ -13,11 +14,14 @@
 
 #include "core/common/denormal.h"
 #include "core/common/logging/logging.h"
+#include "core/common/narrow.h"
 #include "core/common/parse_string.h"
 #include "core/common/path_string.h"
+#include "core/common/string_utils.h"
 #include "core/flatbuffers/flatbuffers_utils.h"
 #include "core/flatbuffers/ort_format_version.h"
 #include "core/framework/bfc_arena.h"
+#include "core/framework/data_types_internal.h"
 #include "core/framework/error_code_helper.h"
 #include "core/framework/execution_frame.h"
 #include "core/framework/feeds_fetches_manager.h"
@@ -55,11 +59,15 @@
 #include "core/providers/dml/DmlExecutionProvider/src/GraphTransformer.h"
 #include "core/providers/dml/dml_session_options_config_keys.h"
 #endif
+#include "core/session/batching_utils.h"
+#include "core/session/dynamic_batcher.h"
 #include "core/session/environment.h"
+#include "core/session/execution_pipeline.h"
 #include "core/session/IOBinding.h"
 #include "core/session/inference_session_utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/session/onnxruntime_run_options_config_keys.h"
+#include "core/session/prepared_run.h"
 #include "core/util/protobuf_parsing_utils.h"
 #include "core/util/thread_utils.h"
 
@@ -331,6 +339,10 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
 
   use_per_session_threads_ = session_options.use_per_session_threads;
   force_spinning_stop_between_runs_ = session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigForceSpinningStop, "0") == "1";
+  ORT_THROW_IF_ERROR(ParseStringWithClassicLocale(
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigNumaNode, "-1"), numa_node_));
+  ORT_ENFORCE(numa_node_ >= -1, "Invalid value for ", kOrtSessionOptionsConfigNumaNode, ": ", numa_node_,
+              ". Expected -1 or a NUMA node index.");
 
   if (use_per_session_threads_) {
     LOGS(*session_logger_, INFO) << "Creating and using per session threadpools since use_per_session_threads_ is true";
@@ -350,6 +362,11 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         // If the thread pool can use all the processors, then
         // we set affinity of each thread to each processor.
         to.allow_spinning = allow_intra_op_spinning;
+        const std::string spin_mode =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpSpinMode, "fixed");
+        ORT_ENFORCE(spin_mode == "fixed" || spin_mode == "adaptive", "Invalid value for ",
+                    kOrtSessionOptionsConfigIntraOpSpinMode, ": ", spin_mode, ". Expected fixed or adaptive.");
+        to.adaptive_spinning = spin_mode == "adaptive";
         to.dynamic_block_base_ = std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBlockBase, "0"));
         LOGS(*session_logger_, INFO) << "Dynamic block base set to " << to.dynamic_block_base_;
 
@@ -360,6 +377,15 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         if (session_options_.config_options.TryGetConfigEntry(kOrtSessionOptionsConfigIntraOpThreadAffinities, to.affinity_str)) {
           ORT_ENFORCE(!to.affinity_str.empty(), "Affinity string must not be empty");
         }
+        to.numa_node = numa_node_;
+        const std::string core_class =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpCoreClass, "all");
+        ORT_ENFORCE(core_class == "all" || core_class == "performance" || core_class == "efficiency",
+                    "Invalid value for ", kOrtSessionOptionsConfigIntraOpCoreClass, ": ", core_class,
+                    ". Expected all, performance or efficiency.");
+        to.core_class = core_class == "performance"  ? OrtCoreClass::kPerformance
+                        : core_class == "efficiency" ? OrtCoreClass::kEfficiency
+                                                     : OrtCoreClass::kAll;
         to.auto_set_affinity = to.thread_pool_size == 0 &&
                                session_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL &&
                                to.affinity_str.empty();
@@ -393,6 +419,7 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         to.custom_create_thread_fn = session_options_.custom_create_thread_fn;
         to.custom_thread_creation_options = session_options.custom_thread_creation_options;
         to.custom_join_thread_fn = session_options_.custom_join_thread_fn;
+        to.numa_node = numa_node_;
 
         if (to.custom_create_thread_fn) {
           ORT_ENFORCE(to.custom_join_thread_fn, "custom join thread function not set for inter op thread pool");
@@ -412,6 +439,12 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
     ORT_ENFORCE(session_env.EnvCreatedWithGlobalThreadPools(),
                 "When the session is not configured to use per session"
                 " threadpools, the env must be created with the the CreateEnvWithGlobalThreadPools API.");
+    ORT_ENFORCE(numa_node_ < 0, kOrtSessionOptionsConfigNumaNode,
+                " requires per session threadpools, as the global threadpools are shared with other sessions.");
+    ORT_ENFORCE(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigIntraOpCoreClass, "all") ==
+                    "all",
+                kOrtSessionOptionsConfigIntraOpCoreClass,
+                " requires per session threadpools, as the global threadpools are shared with other sessions.");
   }
 
   session_profiler_.Initialize(session_logger_);
@@ -499,6 +532,9 @@ InferenceSession::InferenceSession(const SessionOptions& session_options, const
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
 InferenceSession::~InferenceSession() {
+  // wait for the pipelined runs in flight, which end their profiling and telemetry when they complete
+  execution_pipeline_.reset();
+
   if (session_options_.enable_profiling) {
     ORT_TRY {
       EndProfiling();
@@ -765,6 +801,17 @@ common::Status InferenceSession::LoadOnnxModel(const PathString& model_uri) {
 #endif
     const bool strict_shape_type_inference = session_options_.config_options.GetConfigOrDefault(
                                                  kOrtSessionOptionsConfigStrictShapeTypeInference, "0") == "1";
+    // the initializers would be saved with the address of their data in the mapping
+    const bool map_inline_initializers =
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMapInlineInitializers, "0") == "1" &&
+        session_options_.optimized_model_filepath.empty();
+    if (map_inline_initializers) {
+      return onnxruntime::Model::LoadMapped(model_location_, model, mapped_onnx_model_,
+                                            HasLocalSchema() ? &custom_schema_registries_ : nullptr,
+                                            *session_logger_,
+                                            ModelOptions(true, strict_shape_type_inference));
+    }
+
     return onnxruntime::Model::Load(model_location_, model, HasLocalSchema() ? &custom_schema_registries_ : nullptr,
                                     *session_logger_,
                                     ModelOptions(true, strict_shape_type_inference));
@@ -1375,14 +1422,16 @@ Status ApplyOrtFormatModelRuntimeOptimizations(
 #endif  // !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
 }  // namespace
 
-static void ResolveMemoryPatternFlags(SessionState& session_state) {
-  session_state.ResolveMemoryPatternFlag();
+static Status ResolveMemoryPatternFlags(SessionState& session_state) {
+  ORT_RETURN_IF_ERROR(session_state.ResolveMemoryPatternFlag());
 
   for (const auto& entry : session_state.GetSubgraphSessionStateMap()) {
     for (const auto& name_to_subgraph_session_state : entry.second) {
-      ResolveMemoryPatternFlags(*name_to_subgraph_session_state.second);
+      ORT_RETURN_IF_ERROR(ResolveMemoryPatternFlags(*name_to_subgraph_session_state.second));
     }
   }
+
+  return Status::OK();
 }
 #if defined(_MSC_VER) && !defined(__clang__)
 #pragma warning(push)
@@ -1436,6 +1485,9 @@ common::Status InferenceSession::Initialize() {
     if (!have_cpu_ep) {
       LOGS(*session_logger_, INFO) << "Adding default CPU execution provider.";
       CPUExecutionProviderInfo epi{session_options_.enable_cpu_mem_arena};
+      epi.numa_node = numa_node_;
+      epi.use_huge_pages =
+          session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigUseHugePages, "0") == "1";
       auto p_cpu_exec_provider = std::make_unique<CPUExecutionProvider>(epi);
       ORT_RETURN_IF_ERROR_SESSIONID_(RegisterExecutionProvider(std::move(p_cpu_exec_provider)));
       execution_providers_.SetCpuProviderWasImplicitlyAdded(true);
@@ -1752,7 +1804,14 @@ common::Status InferenceSession::Initialize() {
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
     // Resolve memory pattern flags of the main graph and subgraph session states
-    ResolveMemoryPatternFlags(*session_state_);
+    ORT_RETURN_IF_ERROR_SESSIONID_(ResolveMemoryPatternFlags(*session_state_));
+
+    ORT_RETURN_IF_ERROR_SESSIONID_(InitDynamicBatching());
+    ORT_RETURN_IF_ERROR_SESSIONID_(InitResultCache());
+    ORT_RETURN_IF_ERROR_SESSIONID_(InitActivationMemoryBudget());
+    ORT_RETURN_IF_ERROR_SESSIONID_(InitThreadPoolShare());
+    ORT_RETURN_IF_ERROR_SESSIONID_(InitLoopCostTable());
+    ORT_RETURN_IF_ERROR_SESSIONID_(InitPipelinedExecution());
 
     is_inited_ = true;
 
@@ -1803,6 +1862,15 @@ common::Status InferenceSession::Initialize() {
     }
   }
 
+  if (status.IsOK()) {
+    status = WarmUp();
+    if (!status.IsOK()) {
+      // the runs of the warm-up need an initialized session, but a session that failed to warm up is not usable
+      std::lock_guard<onnxruntime::OrtMutex> l(session_mutex_);
+      is_inited_ = false;
+    }
+  }
+
   return status;
 }
 #if defined(_MSC_VER) && !defined(__clang__)
@@ -2107,193 +2175,295 @@ struct ThreadPoolSpinningSwitch {
     }
   }
 };
+
+Status GetRunPriority(const RunOptions& run_options, concurrency::ThreadPool::RunPriority& priority) {
+  const std::string value = run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigRunPriority, "normal");
+  if (value == "low") {
+    priority = concurrency::ThreadPool::RunPriority::kLow;
+  } else if (value == "normal") {
+    priority = concurrency::ThreadPool::RunPriority::kNormal;
+  } else if (value == "high") {
+    priority = concurrency::ThreadPool::RunPriority::kHigh;
+  } else {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid value for ", kOrtRunOptionsConfigRunPriority,
+                           ": ", value, ". Expected one of low, normal or high.");
+  }
+
+  return Status::OK();
+}
+
+// Deadline of a run that started at `start`. nullopt if the run has no deadline.
+Status GetRunDeadline(const RunOptions& run_options, std::chrono::steady_clock::time_point start,
+                      std::optional<std::chrono::steady_clock::time_point>& deadline) {
+  int64_t deadline_ms = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigRunDeadlineMillis, "0"), deadline_ms));
+  ORT_RETURN_IF(deadline_ms < 0, "Run deadline must not be negative. Got ", deadline_ms);
+
+  deadline.reset();
+  if (deadline_ms > 0) {
+    deadline = start + std::chrono::milliseconds(deadline_ms);
+  }
+
+  return Status::OK();
+}
 }  // namespace
 
 Status InferenceSession::Run(const RunOptions& run_options,
                              gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
                              gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
-                             const std::vector<OrtDevice>* p_fetches_device_info) {
-  TimePoint tp;
-  if (session_profiler_.IsEnabled()) {
-    tp = session_profiler_.Start();
-  }
+                             const std::vector<OrtDevice>* p_fetches_device_info,
+                             const std::unordered_map<size_t, IExecutor::CustomAllocator>* p_fetch_allocators) {
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  ORT_RETURN_IF_ERROR_SESSIONID_(GetRunDeadline(run_options, std::chrono::steady_clock::now(), deadline));
+  return RunWithDeadline(run_options, deadline, feed_names, feeds, output_names, p_fetches, p_fetches_device_info,
+                         p_fetch_allocators);
+}
+
+// Bookkeeping of a run from when it starts to when it ends, which may be on a different thread: profiling,
+// telemetry, the count of concurrent runs that controls thread pool spinning, and the arena shrinkage and thread
+// cache flush at the end.
+class InferenceSession::RunScope {
+ public:
+  RunScope(InferenceSession& session, InlinedVector<AllocatorPtr> arenas_to_shrink)
+      : session_(session),
+        spinning_switch_(ControlsSpinning(session) ? session.thread_pool_.get() : nullptr,
+                         ControlsSpinning(session) ? session.inter_op_thread_pool_.get() : nullptr,
+                         session.current_num_runs_),
+        arenas_to_shrink_(std::move(arenas_to_shrink)) {
+    if (session_.session_profiler_.IsEnabled()) {
+      tp_ = session_.session_profiler_.Start();
+    }
 
 #ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
-  TraceLoggingActivity<telemetry_provider_handle> ortrun_activity;
-  ortrun_activity.SetRelatedActivity(session_activity);
-  TraceLoggingWriteStart(ortrun_activity, "OrtRun");
+    ortrun_activity_.SetRelatedActivity(session_.session_activity);
+    TraceLoggingWriteStart(ortrun_activity_, "OrtRun");
 #endif
-  Status retval = Status::OK();
-  const Env& env = Env::Default();
+    // log evaluation start to trace logging provider
+    Env::Default().GetTelemetryProvider().LogEvaluationStart();
+  }
 
-  // Increment/decrement concurrent_num_runs_ and control
-  // session threads spinning as configured. Do nothing for graph replay except the counter.
-  const bool control_spinning = use_per_session_threads_ &&
-                                force_spinning_stop_between_runs_ &&
-                                !cached_execution_provider_for_graph_replay_.IsGraphCaptured();
-  auto* intra_tp = (control_spinning) ? thread_pool_.get() : nullptr;
-  auto* inter_tp = (control_spinning) ? inter_op_thread_pool_.get() : nullptr;
-  ThreadPoolSpinningSwitch runs_refcounter_and_tp_spin_control(intra_tp, inter_tp, current_num_runs_);
+  ~RunScope() {
+    if (!arenas_to_shrink_.empty()) {
+      session_.ShrinkMemoryArenas(arenas_to_shrink_);
+    }
 
-  // Check if this Run() is simply going to be a CUDA Graph replay.
-  if (cached_execution_provider_for_graph_replay_.IsGraphCaptured()) {
-    LOGS(*session_logger_, INFO) << "Replaying the captured "
-                                 << cached_execution_provider_for_graph_replay_.Type()
-                                 << " CUDA Graph for this model with tag: " << run_options.run_tag;
-    ORT_RETURN_IF_ERROR_SESSIONID_(cached_execution_provider_for_graph_replay_.ReplayGraph());
-  } else {
-    InlinedVector<IExecutionProvider*> exec_providers_to_stop;
-    exec_providers_to_stop.reserve(execution_providers_.NumProviders());
+    session_.FlushArenaThreadCaches();
 
-    InlinedVector<AllocatorPtr> arenas_to_shrink;
+    // keep track of telemetry
+    session_.UpdateRunTelemetry(tp_);
 
-    ORT_TRY {
-      if (!is_inited_) {
-        LOGS(*session_logger_, ERROR) << "Session was not initialized";
-        return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+    // log evaluation stop to trace logging provider
+    Env::Default().GetTelemetryProvider().LogEvaluationStop();
+
+    // send out profiling events (optional)
+    auto& profiler = session_.session_profiler_;
+    if (profiler.IsEnabled()) {
+      const auto& session_state = *session_.session_state_;
+      if (session_state.GetEnableMemoryPattern()) {
+        const auto mem_pattern_stats = session_state.GetMemoryPatternCacheStats();
+        profiler.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp_,
+                                       {{"mem_pattern_cache_hits", std::to_string(mem_pattern_stats.hits)},
+                                        {"mem_pattern_cache_misses", std::to_string(mem_pattern_stats.misses)},
+                                        {"mem_pattern_cache_evictions", std::to_string(mem_pattern_stats.evictions)},
+                                        {"mem_pattern_cache_entries", std::to_string(mem_pattern_stats.num_entries)}});
+      } else {
+        profiler.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp_);
       }
+    }
+#ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
+    TraceLoggingWriteStop(ortrun_activity_, "OrtRun");
+#endif
+  }
 
-      // log evaluation start to trace logging provider
-      env.GetTelemetryProvider().LogEvaluationStart();
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(RunScope);
 
-      ORT_RETURN_IF_ERROR_SESSIONID_(ValidateInputs(feed_names, feeds));
-      ORT_RETURN_IF_ERROR_SESSIONID_(ValidateOutputs(output_names, p_fetches));
+  // Session threads stop spinning between runs if configured. Nothing is done for graph replay except counting.
+  static bool ControlsSpinning(const InferenceSession& session) {
+    return session.use_per_session_threads_ && session.force_spinning_stop_between_runs_ &&
+           !session.cached_execution_provider_for_graph_replay_.IsGraphCaptured();
+  }
 
-      // shrink certain default memory arenas if the user has requested for it
-      const std::string& shrink_memory_arenas =
-          run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigEnableMemoryArenaShrinkage, "");
+  InferenceSession& session_;
+  TimePoint tp_;
+  ThreadPoolSpinningSwitch spinning_switch_;
+  const InlinedVector<AllocatorPtr> arenas_to_shrink_;
+#ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
+  TraceLoggingActivity<telemetry_provider_handle> ortrun_activity_;
+#endif
+};
 
-      if (!shrink_memory_arenas.empty()) {
-        ORT_RETURN_IF_ERROR_SESSIONID_(ValidateAndParseShrinkArenaString(shrink_memory_arenas, arenas_to_shrink));
-      }
+Status InferenceSession::GetArenasToShrink(const RunOptions& run_options,
+                                           InlinedVector<AllocatorPtr>& arenas_to_shrink) const {
+  // shrink certain default memory arenas if the user has requested for it
+  const std::string& shrink_memory_arenas =
+      run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigEnableMemoryArenaShrinkage, "");
+  if (!shrink_memory_arenas.empty()) {
+    ORT_RETURN_IF_ERROR(ValidateAndParseShrinkArenaString(shrink_memory_arenas, arenas_to_shrink));
+  }
 
-      FeedsFetchesInfo info(feed_names, output_names, session_state_->GetOrtValueNameIdxMap());
-      FeedsFetchesManager feeds_fetches_manager{std::move(info)};
+  return Status::OK();
+}
 
-      if (p_fetches_device_info) {
-        // populate the target device info. ignored if pre-allocated fetches are provided
-        const auto& fetch_device_info = *p_fetches_device_info;
-        auto& fetch_info = feeds_fetches_manager.GetMutableFetchesDeviceCopyInfo();
+Status InferenceSession::ExecuteRun(const RunOptions& run_options, const logging::Logger* run_logger,
+                                    const ExecuteRunFn& execute) {
+  concurrency::ThreadPool::RunPriority run_priority;
+  ORT_RETURN_IF_ERROR_SESSIONID_(GetRunPriority(run_options, run_priority));
+  InlinedVector<AllocatorPtr> arenas_to_shrink;
+  ORT_RETURN_IF_ERROR_SESSIONID_(GetArenasToShrink(run_options, arenas_to_shrink));
 
-        for (size_t i = 0, end = output_names.size(); i < end; ++i) {
-          fetch_info[i].target_device = fetch_device_info[i];
-        }
-      }
+  RunScope run_scope(*this, std::move(arenas_to_shrink));
+  concurrency::ThreadPool::ScopedRunPriority scoped_run_priority(GetIntraOpThreadPoolToUse(), run_priority);
+  concurrency::ThreadPool::ScopedShare scoped_share(thread_pool_share_.get());
 
-      if (!run_options.run_tag.empty()) {
-        LOGS(*session_logger_, INFO) << "Running with tag: " << run_options.run_tag;
-      }
+  // Check if this Run() is simply going to be a CUDA Graph replay.
+  if (cached_execution_provider_for_graph_replay_.IsGraphCaptured()) {
+    LOGS(*session_logger_, INFO) << "Replaying the captured "
+                                 << cached_execution_provider_for_graph_replay_.Type()
+                                 << " CUDA Graph for this model with tag: " << run_options.run_tag;
+    ORT_RETURN_IF_ERROR_SESSIONID_(cached_execution_provider_for_graph_replay_.ReplayGraph());
+    return Status::OK();
+  }
 
-      // scope of owned_run_logger is just the call to Execute.
-      // If Execute ever becomes async we need a different approach
-      std::unique_ptr<logging::Logger> owned_run_logger;
-      const auto& run_logger = CreateLoggerForRun(run_options, owned_run_logger);
+  Status retval = Status::OK();
+  InlinedVector<IExecutionProvider*> exec_providers_to_stop;
+  exec_providers_to_stop.reserve(execution_providers_.NumProviders());
 
-      std::optional<std::lock_guard<OrtMutex>> sequential_run_lock;
-      if (is_concurrent_run_supported_ == false) {
-        sequential_run_lock.emplace(session_mutex_);
-      }
+  ORT_TRY {
+    if (!run_options.run_tag.empty()) {
+      LOGS(*session_logger_, INFO) << "Running with tag: " << run_options.run_tag;
+    }
 
-      // info all execution providers InferenceSession:Run started
-      // TODO: only call OnRunStart for all providers in-use
-      for (auto& xp : execution_providers_) {
-        // call OnRunStart and add to exec_providers_to_stop if successful
-        auto start_func = [&xp, &exec_providers_to_stop]() {
-          auto status = xp->OnRunStart();
-          if (status.IsOK())
-            exec_providers_to_stop.push_back(xp.get());
+    // scope of owned_run_logger is just the call to execute.
+    // If execute ever becomes async we need a different approach
+    std::unique_ptr<logging::Logger> owned_run_logger;
+    const auto& logger = run_logger ? *run_logger : CreateLoggerForRun(run_options, owned_run_logger);
 
-          return status;
-        };
+    std::optional<std::lock_guard<OrtMutex>> sequential_run_lock;
+    if (is_concurrent_run_supported_ == false) {
+      sequential_run_lock.emplace(session_mutex_);
+    }
 
-        ORT_CHECK_AND_SET_RETVAL(start_func());
-      }
+    // info all execution providers InferenceSession:Run started
+    // TODO: only call OnRunStart for all providers in-use
+    for (auto& xp : execution_providers_) {
+      // call OnRunStart and add to exec_providers_to_stop if successful
+      auto start_func = [&xp, &exec_providers_to_stop]() {
+        auto status = xp->OnRunStart();
+        if (status.IsOK())
+          exec_providers_to_stop.push_back(xp.get());
 
-#ifdef ENABLE_TRAINING
-      if (run_options.only_execute_path_to_fetches) {
-        // TODO: this method is not thread safe, if multiple Run happened in parallel we might hit race condition issue.
-        // currently it only used in training, there is no parallel run execution in training so it is ok.
-        // but it is better we can fix it with a better solution.
-        session_state_->UpdateToBeExecutedRange(feeds_fetches_manager.GetFeedsFetchesInfo().fetches_mlvalue_idxs);
-      }
-#endif
+        return status;
+      };
+
+      ORT_CHECK_AND_SET_RETVAL(start_func());
+    }
 
-      // execute the graph
+    // execute the graph
 #ifdef DEBUG_NODE_INPUTS_OUTPUTS
-      session_state_->IncrementGraphExecutionCounter();
+    session_state_->IncrementGraphExecutionCounter();
 #endif
 
-#ifdef ORT_ENABLE_STREAM
-      DeviceStreamCollectionHolder device_stream_collection_holder(session_state_.get());
-#endif
+    DeviceStreamCollection* device_stream_collection = nullptr;
+    if (retval.IsOK()) {
+      retval = execute(logger, device_stream_collection);
+    }
+
+    // info all execution providers InferenceSession:Run ended
+    const bool synchronize_execution_providers =
+        run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigDisableSynchronizeExecutionProviders,
+                                                      "0") == "0";
+    for (auto* xp : exec_providers_to_stop) {
+      auto status = xp->OnRunEnd(synchronize_execution_providers);
+      ORT_CHECK_AND_SET_RETVAL(status);
+    }
 
-      if (retval.IsOK()) {
-        retval = utils::ExecuteGraph(*session_state_, feeds_fetches_manager, feeds, *p_fetches,
-                                     session_options_.execution_mode,
-                                     run_options,
+    // Move stream cleanup from ExecuteGraph to here for cuda graph capture.
+    // Cleanup will call cudaStreamSyncronize, which is not allowed for graph capture.
+    // Note that graph capture ends when we call xp->OnRunEnd() in the above code so it is safe here.
 #ifdef ORT_ENABLE_STREAM
-                                     device_stream_collection_holder,
+    if (device_stream_collection) {
+      ORT_CHECK_AND_SET_RETVAL(device_stream_collection->CleanUp(synchronize_execution_providers));
+    }
+#else
+    ORT_UNUSED_PARAMETER(device_stream_collection);
 #endif
-                                     run_logger);
-      }
+  }
+  ORT_CATCH(const std::exception& e) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
+    });
+  }
+  ORT_CATCH(...) {
+    retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
+  }
 
-      // info all execution providers InferenceSession:Run ended
-      for (auto* xp : exec_providers_to_stop) {
-        bool synchronize_execution_providers = run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigDisableSynchronizeExecutionProviders, "0") == "0";
-        auto status = xp->OnRunEnd(synchronize_execution_providers);
-        ORT_CHECK_AND_SET_RETVAL(status);
-      }
+  return retval;
+}
 
-      // Move stream cleanup from ExecuteGraph to here for cuda graph capture.
-      // Cleanup will call cudaStreamSyncronize, which is not allowed for graph capture.
-      // Note that graph capture ends when we call xp->OnRunEnd() in the above code so it is safe here.
-#ifdef ORT_ENABLE_STREAM
-      DeviceStreamCollection* device_stream_collection = device_stream_collection_holder.p_.get();
-      if (device_stream_collection) {
-        bool sync_execution_provider = run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigDisableSynchronizeExecutionProviders, "0") == "0";
-        ORT_CHECK_AND_SET_RETVAL(device_stream_collection->CleanUp(sync_execution_provider));
-      }
-#endif
-    }
-    ORT_CATCH(const std::exception& e) {
-      ORT_HANDLE_EXCEPTION([&]() {
-        retval = Status(common::ONNXRUNTIME, common::FAIL, e.what());
-      });
-    }
-    ORT_CATCH(...) {
-      retval = Status(common::ONNXRUNTIME, common::RUNTIME_EXCEPTION, "Encountered unknown exception in Run()");
+Status InferenceSession::RunWithDeadline(
+    const RunOptions& run_options, const std::optional<std::chrono::steady_clock::time_point>& deadline,
+    gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+    gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
+    const std::vector<OrtDevice>* p_fetches_device_info,
+    const std::unordered_map<size_t, IExecutor::CustomAllocator>* p_fetch_allocators) {
+  if (!cached_execution_provider_for_graph_replay_.IsGraphCaptured()) {
+    if (!is_inited_) {
+      LOGS(*session_logger_, ERROR) << "Session was not initialized";
+      return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
     }
 
-    if (!arenas_to_shrink.empty()) {
-      ShrinkMemoryArenas(arenas_to_shrink);
-    }
+    ORT_RETURN_IF_ERROR_SESSIONID_(ValidateInputs(feed_names, feeds));
+    ORT_RETURN_IF_ERROR_SESSIONID_(ValidateOutputs(output_names, p_fetches));
   }
 
-  // keep track of telemetry
-  ++telemetry_.total_runs_since_last_;
-  telemetry_.total_run_duration_since_last_ += TimeDiffMicroSeconds(tp);
+#ifdef ORT_ENABLE_STREAM
+  std::optional<DeviceStreamCollectionHolder> device_stream_collection_holder;
+#endif
+  auto execute = [&](const logging::Logger& run_logger, DeviceStreamCollection*& device_streams) -> Status {
+    FeedsFetchesInfo info(feed_names, output_names, session_state_->GetOrtValueNameIdxMap());
+    FeedsFetchesManager feeds_fetches_manager{std::move(info)};
 
-  // time to send telemetry?
-  if (TimeDiffMicroSeconds(telemetry_.time_sent_last_) > Telemetry::kDurationBetweenSending) {
-    // send the telemetry
-    env.GetTelemetryProvider().LogRuntimePerf(session_id_, telemetry_.total_runs_since_last_,
-                                              telemetry_.total_run_duration_since_last_);
-    // reset counters
-    telemetry_.time_sent_last_ = std::chrono::high_resolution_clock::now();
-    telemetry_.total_runs_since_last_ = 0;
-    telemetry_.total_run_duration_since_last_ = 0;
-  }
+    if (p_fetches_device_info) {
+      // populate the target device info. ignored if pre-allocated fetches are provided
+      const auto& fetch_device_info = *p_fetches_device_info;
+      auto& fetch_info = feeds_fetches_manager.GetMutableFetchesDeviceCopyInfo();
 
-  // log evaluation stop to trace logging provider
-  env.GetTelemetryProvider().LogEvaluationStop();
+      for (size_t i = 0, end = output_names.size(); i < end; ++i) {
+        fetch_info[i].target_device = fetch_device_info[i];
+      }
+    }
 
-  // send out profiling events (optional)
-  if (session_profiler_.IsEnabled()) {
-    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "model_run", tp);
-  }
-#ifdef ONNXRUNTIME_ENABLE_INSTRUMENT
-  TraceLoggingWriteStop(ortrun_activity, "OrtRun");
+#ifdef ENABLE_TRAINING
+    if (run_options.only_execute_path_to_fetches) {
+      // TODO: this method is not thread safe, if multiple Run happened in parallel we might hit race condition issue.
+      // currently it only used in training, there is no parallel run execution in training so it is ok.
+      // but it is better we can fix it with a better solution.
+      session_state_->UpdateToBeExecutedRange(feeds_fetches_manager.GetFeedsFetchesInfo().fetches_mlvalue_idxs);
+    }
+#endif
+
+    static const std::unordered_map<size_t, IExecutor::CustomAllocator> no_fetch_allocators;
+#ifdef ORT_ENABLE_STREAM
+    // the device streams are cleaned up by ExecuteRun once the execution providers were told the run ended
+    device_stream_collection_holder.emplace(session_state_.get());
+    device_streams = device_stream_collection_holder->p_.get();
+#else
+    ORT_UNUSED_PARAMETER(device_streams);
+#endif
+    return utils::ExecuteGraph(*session_state_, feeds_fetches_manager, feeds, *p_fetches,
+                               p_fetch_allocators ? *p_fetch_allocators : no_fetch_allocators,
+                               session_options_.execution_mode,
+                               run_options,
+#ifdef ORT_ENABLE_STREAM
+                               *device_stream_collection_holder,
 #endif
+                               run_logger,
+                               deadline);
+  };
+
+  Status retval = ExecuteRun(run_options, nullptr, execute);
 
   // As N+1 inference runs (N for memory allocation and 1 for graph capturing)
   // are needed before replaying the captured graph, here run N inference runs recursively until graph captured,
@@ -2302,7 +2472,8 @@ Status InferenceSession::Run(const RunOptions& run_options,
   if (retval.IsOK() && cached_execution_provider_for_graph_replay_.IsGraphCaptureEnabled() &&
       !cached_execution_provider_for_graph_replay_.IsGraphCaptured()) {
     LOGS(*session_logger_, INFO) << "Start another run for necessary memory allocation or graph capture.";
-    ORT_RETURN_IF_ERROR(Run(run_options, feed_names, feeds, output_names, p_fetches, p_fetches_device_info));
+    ORT_RETURN_IF_ERROR(RunWithDeadline(run_options, deadline, feed_names, feeds, output_names, p_fetches,
+                                        p_fetches_device_info, p_fetch_allocators));
   }
   return retval;
 }
@@ -2352,11 +2523,7 @@ Status InferenceSession::Run(const RunOptions& run_options,
     }
   }
 
-  Status status;
-  status = Run(run_options, feed_name_vec, feed_vec, fetch_name_vec, &fetch_vec, nullptr);
-
-  if (!status.IsOK())
-    return status;
+  ORT_RETURN_IF_ERROR(RunRequest(run_options, feed_name_vec, feed_vec, fetch_name_vec, fetch_vec));
 
   // We do it in two loops to make sure copy __ctors does not throw
   InlinedVector<std::unique_ptr<OrtValue>> fetch_unique_ptrs;
@@ -2378,6 +2545,195 @@ Status InferenceSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+Status InferenceSession::RunRequest(const RunOptions& run_options,
+                                   gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                   gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches) {
+  // the time a request waits for a batch or for the slices of its batch counts towards its deadline
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  ORT_RETURN_IF_ERROR_SESSIONID_(GetRunDeadline(run_options, std::chrono::steady_clock::now(), deadline));
+
+  // pre-allocated fetches must be written in place, which a cached result cannot do
+  const bool use_result_cache =
+      result_cache_ && ResultCache::IsCacheable(feeds) &&
+      std::none_of(fetches.begin(), fetches.end(), [](const OrtValue& fetch) { return fetch.IsAllocated(); });
+
+  uint64_t result_cache_hash = 0;
+  if (use_result_cache && result_cache_->Lookup(feed_names, feeds, output_names, fetches, result_cache_hash)) {
+    return Status::OK();
+  }
+
+  if (dynamic_batcher_) {
+    ORT_RETURN_IF_ERROR(dynamic_batcher_->Run(run_options, deadline, feed_names, feeds, output_names, fetches));
+  } else {
+    ORT_RETURN_IF_ERROR(RunWithinActivationMemoryBudget(run_options, deadline, feed_names, feeds, output_names,
+                                                        fetches));
+  }
+
+  if (use_result_cache) {
+    result_cache_->Insert(result_cache_hash, feed_names, feeds, output_names, fetches);
+  }
+
+  return Status::OK();
+}
+
+common::Status InferenceSession::PrepareRun(gsl::span<const std::string> feed_names,
+                                            gsl::span<const std::string> output_names,
+                                            std::unique_ptr<PreparedRun>& prepared_run) {
+  if (!is_inited_) {
+    LOGS(*session_logger_, ERROR) << "Session was not initialized";
+    return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+  }
+
+  // a graph replay bypasses the executor, so there is nothing to prepare
+  ORT_RETURN_IF(cached_execution_provider_for_graph_replay_.IsGraphCaptureEnabled(),
+                "Prepared runs are not supported when graph capture is enabled.");
+  ORT_RETURN_IF(activation_memory_budget_ != nullptr,
+                "Prepared runs are not supported when an activation memory budget is set with ",
+                kOrtSessionOptionsConfigActivationMemoryBudgetBytes, ".");
+
+  const std::vector<OrtValue> no_fetches;
+  ORT_RETURN_IF_ERROR_SESSIONID_(ValidateOutputs(output_names, &no_fetches));
+
+  InlinedVector<MLDataType> feed_element_types;
+  InlinedVector<TensorShape> feed_shapes;
+  feed_element_types.reserve(feed_names.size());
+  feed_shapes.reserve(feed_names.size());
+  for (const auto& feed_name : feed_names) {
+    auto iter = input_def_map_.find(feed_name);
+    if (input_def_map_.end() == iter) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid Feed Input Name:", feed_name);
+    }
+
+    const auto& input_def = iter->second;
+    if (!input_def.ml_data_type->IsTensorType() || input_def.node_arg->Shape() == nullptr ||
+        input_def.tensor_shape.Size() < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input with name: ", feed_name,
+                             " is not a tensor with a fixed shape, which a prepared run requires.");
+    }
+
+    feed_element_types.push_back(input_def.ml_data_type->AsTensorType()->GetElementType());
+    feed_shapes.push_back(input_def.tensor_shape);
+  }
+
+  for (const auto& required_input : required_inputs_) {
+    if (std::find(feed_names.begin(), feed_names.end(), required_input) == feed_names.end()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Missing required input: ", required_input);
+    }
+  }
+
+  FeedsFetchesInfo info(feed_names, output_names, session_state_->GetOrtValueNameIdxMap());
+
+  std::unique_ptr<logging::Logger> owned_logger;
+  const auto& logger = CreateLoggerForRun(RunOptions(), owned_logger);
+
+  auto prepared = std::make_unique<PreparedRun>(*this, *session_state_, std::move(info),
+                                                std::move(feed_element_types), std::move(feed_shapes),
+                                                std::move(owned_logger), logger);
+  // the copy info is finalized by the first run, for the devices of its feeds and fetches
+  ORT_RETURN_IF_ERROR_SESSIONID_(utils::InitializeFeedFetchCopyInfo(*session_state_,
+                                                                    prepared->GetFeedsFetchesManager()));
+  prepared_run = std::move(prepared);
+  return Status::OK();
+}
+
+common::Status InferenceSession::RunPrepared(const RunOptions& run_options, PreparedRun& prepared_run,
+                                             gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches) {
+  const auto run_start = std::chrono::steady_clock::now();
+  if (&prepared_run.GetSession() != this) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "The run was prepared by a different session.");
+  }
+
+  const auto& feeds_fetches_info = prepared_run.GetFeedsFetchesManager().GetFeedsFetchesInfo();
+  if (feeds.size() != prepared_run.NumFeeds()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Size mismatch: the run was prepared with ",
+                           prepared_run.NumFeeds(), " feeds, but feeds has ", feeds.size(), " elements.");
+  }
+
+  // the copy info only needs to be finalized again if the devices of the feeds or fetches changed
+  bool finalize_copy_info = !prepared_run.IsCopyInfoFinalized();
+  auto& finalized_feed_devices = prepared_run.GetFinalizedFeedDevices();
+  finalized_feed_devices.resize(feeds.size());
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    if (!feeds[i].IsTensor()) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input with name: ", feeds_fetches_info.feed_names[i],
+                             " is not expected to be of type tensor.");
+    }
+
+    const auto& tensor = feeds[i].Get<Tensor>();
+    if (tensor.DataType() != prepared_run.GetFeedElementType(i) || tensor.Shape() != prepared_run.GetFeedShape(i)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Input with name: ", feeds_fetches_info.feed_names[i],
+                             " does not match the prepared run. Expected type: ",
+                             DataTypeImpl::ToString(prepared_run.GetFeedElementType(i)),
+                             " shape: ", prepared_run.GetFeedShape(i), " Got type: ",
+                             DataTypeImpl::ToString(tensor.DataType()), " shape: ", tensor.Shape());
+    }
+
+    const auto& device = tensor.Location().device;
+    if (finalized_feed_devices[i] != device) {
+      finalized_feed_devices[i] = device;
+      finalize_copy_info = true;
+    }
+  }
+
+  if (fetches.empty()) {
+    fetches.resize(prepared_run.NumFetches());
+  } else if (fetches.size() != prepared_run.NumFetches()) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Size mismatch: the run was prepared with ",
+                           prepared_run.NumFetches(), " fetches, but fetches has ", fetches.size(), " elements.");
+  }
+
+  auto& finalized_fetch_devices = prepared_run.GetFinalizedFetchDevices();
+  finalized_fetch_devices.resize(fetches.size());
+  for (size_t i = 0, end = fetches.size(); i < end; ++i) {
+    std::optional<OrtDevice> device;
+    if (fetches[i].IsAllocated()) {
+      if (!fetches[i].IsTensor()) {
+        // the device of other pre-allocated values is not tracked
+        finalize_copy_info = true;
+        continue;
+      }
+      device = fetches[i].Get<Tensor>().Location().device;
+    }
+
+    if (finalized_fetch_devices[i] != device) {
+      finalized_fetch_devices[i] = device;
+      finalize_copy_info = true;
+    }
+  }
+
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  ORT_RETURN_IF_ERROR_SESSIONID_(GetRunDeadline(run_options, run_start, deadline));
+
+  // a per-run logger is only needed to apply the run tag or run specific log levels
+  const bool use_prepared_logger = run_options.run_tag.empty() && run_options.run_log_severity_level == -1 &&
+                                   run_options.run_log_verbosity_level == 0;
+
+  auto execute = [&](const logging::Logger& run_logger, DeviceStreamCollection*& device_streams) -> Status {
+    if (finalize_copy_info) {
+      auto status = utils::RefinalizeFeedFetchCopyInfo(*session_state_, prepared_run.GetFeedsFetchesManager(),
+                                                       feeds, fetches);
+      prepared_run.SetCopyInfoFinalized(status.IsOK());
+      ORT_RETURN_IF_ERROR(status);
+    }
+
+    static const std::unordered_map<size_t, IExecutor::CustomAllocator> no_fetch_allocators;
+#ifdef ORT_ENABLE_STREAM
+    // the device streams of the prepared run are kept for its next run
+    device_streams = prepared_run.GetDeviceStreamCollection();
+#else
+    ORT_UNUSED_PARAMETER(device_streams);
+#endif
+    return utils::ExecuteFinalizedGraph(*session_state_, prepared_run.GetFeedsFetchesManager(), feeds, fetches,
+                                        no_fetch_allocators, session_options_.execution_mode, run_options,
+#ifdef ORT_ENABLE_STREAM
+                                        prepared_run.GetDeviceStreamCollection(),
+#endif
+                                        run_logger, deadline);
+  };
+
+  return ExecuteRun(run_options, use_prepared_logger ? &prepared_run.GetLogger() : nullptr, execute);
+}
+
 common::Status InferenceSession::RunAsync(const RunOptions* run_options,
                                           gsl::span<const char* const> feed_names,
                                           gsl::span<const OrtValue* const> feeds,
@@ -2390,7 +2746,32 @@ common::Status InferenceSession::RunAsync(const RunOptions* run_options,
   if (!tp || concurrency::ThreadPool::DegreeOfParallelism(tp) < 2) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "intra op thread pool must have at least one thread for RunAsync");
   }
+
+  concurrency::ThreadPool::RunPriority run_priority = concurrency::ThreadPool::RunPriority::kNormal;
+  if (run_options) {
+    ORT_RETURN_IF_ERROR(GetRunPriority(*run_options, run_priority));
+  }
+
+  if (execution_pipeline_) {
+    bool submitted = false;
+    ORT_RETURN_IF_ERROR(RunPipelined(run_options, feed_names, feeds, fetch_names, fetches, callback, user_data,
+                                     run_priority, submitted));
+    if (submitted) {
+      return Status::OK();
+    }
+  }
+
+  // a queued high priority run already makes low priority loops yield. Run() counts it once it starts.
+  const bool high_priority = run_priority == concurrency::ThreadPool::RunPriority::kHigh;
+  if (high_priority) {
+    concurrency::ThreadPool::BeginHighPriorityRun(tp);
+  }
+
   std::function<void()> run_fn = [=]() {
+    if (high_priority) {
+      concurrency::ThreadPool::EndHighPriorityRun(tp);
+    }
+
     Status status = Status::OK();
     ORT_TRY {
       if (run_options) {
@@ -2414,6 +2795,134 @@ common::Status InferenceSession::RunAsync(const RunOptions* run_options,
   return Status::OK();
 }
 
+common::Status InferenceSession::RunPipelined(const RunOptions* run_options,
+                                              gsl::span<const char* const> feed_names,
+                                              gsl::span<const OrtValue* const> feeds,
+                                              gsl::span<const char* const> fetch_names,
+                                              gsl::span<OrtValue*> fetches,
+                                              RunAsyncCallbackFn callback,
+                                              void* user_data,
+                                              concurrency::ThreadPool::RunPriority run_priority,
+                                              bool& submitted) {
+  const auto run_start = std::chrono::steady_clock::now();
+  submitted = false;
+  if (!is_inited_) {
+    return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+  }
+
+  // the time a run waits for the stages of the pipeline counts towards its deadline
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  if (run_options) {
+    ORT_RETURN_IF_ERROR_SESSIONID_(GetRunDeadline(*run_options, run_start, deadline));
+  }
+
+  // pre-allocated outputs are written in place by a regular run
+  if (std::any_of(fetches.begin(), fetches.end(), [](const OrtValue* fetch) { return fetch != nullptr; })) {
+    return Status::OK();
+  }
+
+  std::vector<std::string> feed_name_vec;
+  std::vector<OrtValue> feed_vec;
+  feed_name_vec.reserve(feed_names.size());
+  feed_vec.reserve(feeds.size());
+  for (size_t i = 0, end = feed_names.size(); i < end; ++i) {
+    ORT_RETURN_IF(feed_names[i] == nullptr || feed_names[i][0] == '\0', "input name cannot be empty");
+    ORT_RETURN_IF(feeds[i] == nullptr, "NULL input supplied for input ", feed_names[i]);
+    feed_name_vec.emplace_back(feed_names[i]);
+    feed_vec.push_back(*feeds[i]);
+  }
+
+  std::vector<std::string> fetch_name_vec;
+  fetch_name_vec.reserve(fetch_names.size());
+  for (const char* fetch_name : fetch_names) {
+    ORT_RETURN_IF(fetch_name == nullptr || fetch_name[0] == '\0', "output name cannot be empty");
+    fetch_name_vec.emplace_back(fetch_name);
+  }
+
+  std::vector<OrtValue> fetch_vec(fetch_names.size());
+  ORT_RETURN_IF_ERROR_SESSIONID_(ValidateInputs(feed_name_vec, feed_vec));
+  ORT_RETURN_IF_ERROR_SESSIONID_(ValidateOutputs(fetch_name_vec, &fetch_vec));
+
+  FeedsFetchesInfo info(feed_name_vec, fetch_name_vec, session_state_->GetOrtValueNameIdxMap());
+  FeedsFetchesManager feeds_fetches_manager{std::move(info)};
+  ORT_RETURN_IF_ERROR_SESSIONID_(utils::InitializeFeedFetchCopyInfo(*session_state_, feeds_fetches_manager));
+  if (feeds_fetches_manager.GetDeviceCopyChecks().status != DeviceCopyCheck::NoCopy) {
+    return Status::OK();
+  }
+
+  InlinedVector<AllocatorPtr> arenas_to_shrink;
+  if (run_options) {
+    ORT_RETURN_IF_ERROR_SESSIONID_(GetArenasToShrink(*run_options, arenas_to_shrink));
+  }
+
+  // the run ends when its completion callback is called, on the thread that executed its last stage
+  auto run_scope = std::make_shared<RunScope>(*this, std::move(arenas_to_shrink));
+
+  std::unique_ptr<logging::Logger> owned_run_logger;
+  const auto& run_logger = CreateLoggerForRun(run_options ? *run_options : RunOptions(), owned_run_logger);
+  // the logger must outlive the execution, which is destroyed after the completion callback
+  std::shared_ptr<logging::Logger> run_logger_holder(std::move(owned_run_logger));
+
+  InlinedVector<IExecutionProvider*> exec_providers_to_stop;
+  exec_providers_to_stop.reserve(execution_providers_.NumProviders());
+  Status retval;
+  for (auto& xp : execution_providers_) {
+    auto status = xp->OnRunStart();
+    if (status.IsOK()) {
+      exec_providers_to_stop.push_back(xp.get());
+    }
+    ORT_CHECK_AND_SET_RETVAL(status);
+  }
+
+  if (retval.IsOK()) {
+    const auto& feeds_fetches_info = feeds_fetches_manager.GetFeedsFetchesInfo();
+    auto execution = std::make_unique<StagedPlanExecution>(*session_state_,
+                                                           feeds_fetches_info.feeds_mlvalue_idxs, std::move(feed_vec),
+                                                           feeds_fetches_info.fetches_mlvalue_idxs, std::move(fetch_vec),
+                                                           run_logger, deadline);
+
+    auto done = [fetches, callback, user_data, exec_providers_to_stop, run_logger_holder, run_scope](
+                    Status status, StagedPlanExecution& staged_execution) mutable {
+      std::vector<OrtValue> outputs;
+      if (status.IsOK()) {
+        status = staged_execution.Finish(outputs);
+      }
+
+      for (auto* xp : exec_providers_to_stop) {
+        auto end_status = xp->OnRunEnd(/*sync_stream*/ false);
+        if (status.IsOK()) {
+          status = end_status;
+        }
+      }
+
+      // end the run before the callback, which may start the next one
+      run_scope.reset();
+
+      size_t num_outputs = 0;
+      if (status.IsOK()) {
+        for (size_t i = 0, end = fetches.size(); i < end; ++i) {
+          fetches[i] = new OrtValue(std::move(outputs[i]));
+        }
+        num_outputs = fetches.size();
+      }
+
+      callback(user_data, fetches.data(), num_outputs, ToOrtStatus(status));
+    };
+
+    static const bool no_terminate = false;
+    execution_pipeline_->Submit(std::move(execution), run_options ? run_options->terminate : no_terminate,
+                                run_priority, std::move(done));
+    submitted = true;
+    return Status::OK();
+  }
+
+  for (auto* xp : exec_providers_to_stop) {
+    ORT_IGNORE_RETURN_VALUE(xp->OnRunEnd(/*sync_stream*/ false));
+  }
+
+  return retval;
+}
+
 common::Status InferenceSession::Run(const NameMLValMap& feeds, gsl::span<const std::string> output_names,
                                      std::vector<OrtValue>* p_fetches) {
   return Run(RunOptions(), feeds, output_names, p_fetches);
@@ -2433,7 +2942,8 @@ common::Status InferenceSession::Run(const RunOptions& run_options, const NameML
     feeds.push_back(pair.second);
   }
 
-  return Run(run_options, feed_names, feeds, output_names, p_fetches, nullptr);
+  ORT_RETURN_IF(p_fetches == nullptr, "Output vector pointer is NULL");
+  return RunRequest(run_options, feed_names, feeds, output_names, *p_fetches);
 }
 
 std::pair<common::Status, const ModelMetadata*> InferenceSession::GetModelMetadata() const {
@@ -2502,8 +3012,71 @@ common::Status InferenceSession::NewIOBinding(std::unique_ptr<IOBinding>* io_bin
 common::Status InferenceSession::Run(const RunOptions& run_options, IOBinding& io_binding) {
   // TODO should Run() call io_binding.SynchronizeInputs() or should it let the callers do it?
   // io_binding.SynchronizeInputs();
+  // the outputs of a binding may be on a device or in a ring buffer, which the slices of a split run cannot fill
+  ORT_RETURN_IF(activation_memory_budget_ != nullptr,
+                "Runs with an IOBinding are not supported when an activation memory budget is set with ",
+                kOrtSessionOptionsConfigActivationMemoryBudgetBytes, ". Run with feeds and fetches instead.");
+  std::unordered_map<size_t, IExecutor::CustomAllocator> fetch_allocators;
+  ORT_RETURN_IF_ERROR_SESSIONID_(CreateRingBufferFetchAllocators(io_binding, fetch_allocators));
+
   return Run(run_options, io_binding.GetInputNames(), io_binding.GetInputs(), io_binding.GetOutputNames(),
-             &io_binding.GetOutputs(), &io_binding.GetOutputsDeviceInfo());
+             &io_binding.GetOutputs(), &io_binding.GetOutputsDeviceInfo(),
+             fetch_allocators.empty() ? nullptr : &fetch_allocators);
+}
+
+common::Status InferenceSession::CreateRingBufferFetchAllocators(
+    IOBinding& io_binding, std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) const {
+  const auto& output_names = io_binding.GetOutputNames();
+  const auto& ring_buffers = io_binding.GetOutputsRingBuffers();
+  auto& outputs = io_binding.GetOutputs();
+
+  for (size_t i = 0, end = output_names.size(); i < end; ++i) {
+    if (!ring_buffers[i]) {
+      continue;
+    }
+
+    // every run gets a new slot. the output of the previous run stays valid while the caller holds on to it.
+    outputs[i] = OrtValue();
+
+    auto output_def = std::find_if(output_def_list_.cbegin(), output_def_list_.cend(),
+                                   [&](const NodeArg* def) { return def->Name() == output_names[i]; });
+    ORT_RETURN_IF(output_def == output_def_list_.cend(), "Invalid output name: ", output_names[i]);
+
+    const auto* ml_type = utils::GetMLDataType(**output_def);
+    if (ml_type == nullptr || !ml_type->IsTensorType()) {
+      continue;
+    }
+
+    const auto* element_type = ml_type->AsTensorType()->GetElementType();
+    if (utils::IsDataTypeString(element_type)) {
+      continue;
+    }
+
+    fetch_allocators[i] = [ring_buffer = ring_buffers[i], element_type](const TensorShape& shape,
+                                                                         const OrtDevice& location,
+                                                                         OrtValue& ort_value, bool& allocated) {
+      if (location != ring_buffer->Info().device) {
+        // the output is copied to the ring buffer's device after execution, into a regular allocation
+        return Status::OK();
+      }
+
+      size_t size_in_bytes = 0;
+      ORT_RETURN_IF_NOT(IAllocator::CalcMemSizeForArray(narrow<size_t>(shape.Size()), element_type->Size(),
+                                                        &size_in_bytes),
+                        "Size overflow for output with shape ", shape);
+
+      void* p_data = ring_buffer->Alloc(size_in_bytes);
+      if (p_data != nullptr) {
+        // the tensor frees the slot when the last reference to it is released
+        Tensor::InitOrtValue(element_type, shape, p_data, ring_buffer, ort_value);
+        allocated = true;
+      }
+
+      return Status::OK();
+    };
+  }
+
+  return Status::OK();
 }
 
 common::Status InferenceSession::Run(IOBinding& io_binding) {
@@ -2675,6 +3248,34 @@ void InferenceSession::ShrinkMemoryArenas(gsl::span<const AllocatorPtr> arenas_t
   }
 }
 
+void InferenceSession::UpdateRunTelemetry(const TimePoint& tp) {
+  ++telemetry_.total_runs_since_last_;
+  telemetry_.total_run_duration_since_last_ += TimeDiffMicroSeconds(tp);
+
+  // time to send telemetry?
+  if (TimeDiffMicroSeconds(telemetry_.time_sent_last_) > Telemetry::kDurationBetweenSending) {
+    // send the telemetry
+    Env::Default().GetTelemetryProvider().LogRuntimePerf(session_id_, telemetry_.total_runs_since_last_,
+                                                         telemetry_.total_run_duration_since_last_);
+    // reset counters
+    telemetry_.time_sent_last_ = std::chrono::high_resolution_clock::now();
+    telemetry_.total_runs_since_last_ = 0;
+    telemetry_.total_run_duration_since_last_ = 0;
+  }
+}
+
+void InferenceSession::FlushArenaThreadCaches() {
+  for (const auto& device_allocator : session_state_->GetAllocators()) {
+    const auto& alloc = device_allocator.second;
+    if (alloc->Info().alloc_type == OrtAllocatorType::OrtArenaAllocator) {
+      auto* arena = static_cast<BFCArena*>(alloc.get());
+      if (arena->HasThreadCaches()) {
+        arena->FlushThreadCache();
+      }
+    }
+  }
+}
+
 #if !defined(ORT_MINIMAL_BUILD)
 // assumes model has already been loaded before
 common::Status InferenceSession::DoPostLoadProcessing(onnxruntime::Model& model) {
@@ -2783,6 +3384,376 @@ const logging::Logger& InferenceSession::CreateLoggerForRun(const RunOptions& ru
   return *run_logger;
 }
 
+common::Status InferenceSession::InitDynamicBatching() {
+  const auto& config_options = session_options_.config_options;
+  size_t max_batch_size = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize, "0"), max_batch_size));
+  if (max_batch_size <= 1) {
+    return Status::OK();
+  }
+
+  DynamicBatcher::Options options;
+  options.max_batch_size = max_batch_size;
+
+  int64_t timeout_us = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBatchingTimeoutMicros, "1000"), timeout_us));
+  ORT_RETURN_IF(timeout_us < 0, "Dynamic batching timeout must not be negative. Got ", timeout_us);
+  options.timeout = std::chrono::microseconds(timeout_us);
+
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBatchingBatchAxis, "0"), options.batch_axis));
+  ORT_RETURN_IF_ERROR(batching_utils::ValidateBatchAxis(session_state_->GetGraphViewer(), options.batch_axis));
+
+  auto cpu_allocator = session_state_->GetAllocator(OrtDevice());
+  ORT_RETURN_IF(cpu_allocator == nullptr, "Dynamic batching requires a CPU allocator.");
+
+  auto run_fn = [this](const RunOptions& run_options, const DynamicBatcher::Deadline& deadline,
+                       gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                       gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches) {
+    return RunWithinActivationMemoryBudget(run_options, deadline, feed_names, feeds, output_names, *p_fetches);
+  };
+
+  dynamic_batcher_ = std::make_unique<DynamicBatcher>(options, std::move(run_fn), std::move(cpu_allocator));
+  LOGS(*session_logger_, INFO) << "Dynamic batching enabled with max batch size " << options.max_batch_size
+                               << ", timeout " << timeout_us << "us and batch axis " << options.batch_axis;
+  return Status::OK();
+}
+
+common::Status InferenceSession::InitResultCache() {
+  const auto& config_options = session_options_.config_options;
+  ResultCache::Options options;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigResultCacheMaxBytes, "0"), options.max_bytes));
+  if (options.max_bytes == 0) {
+    return Status::OK();
+  }
+
+  int64_t ttl_ms = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsConfigResultCacheTtlMillis, "0"), ttl_ms));
+  ORT_RETURN_IF(ttl_ms < 0, "Result cache time to live must not be negative. Got ", ttl_ms);
+  options.ttl = std::chrono::milliseconds(ttl_ms);
+
+  auto cpu_allocator = session_state_->GetAllocator(OrtDevice());
+  ORT_RETURN_IF(cpu_allocator == nullptr, "The result cache requires a CPU allocator.");
+
+  result_cache_ = std::make_unique<ResultCache>(options, std::move(cpu_allocator));
+  LOGS(*session_logger_, INFO) << "Result cache enabled with a budget of " << options.max_bytes
+                               << " bytes and a time to live of " << ttl_ms << "ms";
+  return Status::OK();
+}
+
+ResultCache::Stats InferenceSession::GetResultCacheStats() const {
+  return result_cache_ ? result_cache_->GetStats() : ResultCache::Stats{};
+}
+
+common::Status InferenceSession::InitActivationMemoryBudget() {
+  size_t budget_bytes = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigActivationMemoryBudgetBytes, "0"),
+      budget_bytes));
+  if (budget_bytes == 0) {
+    return Status::OK();
+  }
+
+  // the peak of a request is taken from its memory pattern
+  ORT_RETURN_IF_NOT(session_state_->GetEnableMemoryPattern(),
+                    "An activation memory budget requires memory patterns, which are disabled for this session.");
+
+  auto cpu_allocator = session_state_->GetAllocator(OrtDevice());
+  ORT_RETURN_IF(cpu_allocator == nullptr, "An activation memory budget requires a CPU allocator.");
+
+  // the batch is split along axis 0, which must be a batch dimension of every input and output. otherwise rows
+  // of a slice could depend on rows of other slices, e.g. through a reduction over axis 0.
+  const Status batch_axis_status = batching_utils::ValidateBatchAxis(session_state_->GetGraphViewer(), 0);
+  if (!batch_axis_status.IsOK()) {
+    LOGS(*session_logger_, WARNING) << "Requests are not split to stay within the activation memory budget: "
+                                    << batch_axis_status.ErrorMessage();
+  }
+
+  auto run_fn = [this](const RunOptions& run_options, const ActivationMemoryBudget::Deadline& deadline,
+                       gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                       gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches) {
+    return RunWithDeadline(run_options, deadline, feed_names, feeds, output_names, p_fetches);
+  };
+
+  auto peak_size_fn = [this](gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds) -> size_t {
+    const auto& name_idx_map = session_state_->GetOrtValueNameIdxMap();
+    InlinedVector<int> feed_mlvalue_idxs(feed_names.size());
+    for (size_t i = 0, end = feed_names.size(); i < end; ++i) {
+      if (!name_idx_map.GetIdx(feed_names[i], feed_mlvalue_idxs[i]).IsOK()) {
+        return 0;
+      }
+    }
+
+    return session_state_->GetMemoryPatternPeakSize(feeds, feed_mlvalue_idxs);
+  };
+
+  activation_memory_budget_ = std::make_unique<ActivationMemoryBudget>(
+      budget_bytes, batch_axis_status.IsOK(), std::move(run_fn), std::move(peak_size_fn), std::move(cpu_allocator), *session_logger_);
+  LOGS(*session_logger_, INFO) << "Activation memory budget of " << budget_bytes << " bytes";
+  return Status::OK();
+}
+
+common::Status InferenceSession::RunWithinActivationMemoryBudget(
+    const RunOptions& run_options, const std::optional<std::chrono::steady_clock::time_point>& deadline,
+    gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+    gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches) {
+  if (activation_memory_budget_) {
+    // the slices of a split request share the deadline of the request
+    return activation_memory_budget_->Run(run_options, deadline, feed_names, feeds, output_names, fetches);
+  }
+
+  return RunWithDeadline(run_options, deadline, feed_names, feeds, output_names, &fetches);
+}
+
+ActivationMemoryBudget::Stats InferenceSession::GetActivationMemoryBudgetStats() const {
+  return activation_memory_budget_ ? activation_memory_budget_->GetStats() : ActivationMemoryBudget::Stats{};
+}
+
+common::Status InferenceSession::InitThreadPoolShare() {
+  int weight = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigThreadPoolShareWeight, "0"), weight));
+  ORT_RETURN_IF(weight < 0, "The thread pool share weight must not be negative: ", weight);
+  if (weight == 0) {
+    return Status::OK();
+  }
+
+  if (use_per_session_threads_) {
+    LOGS(*session_logger_, INFO) << "The session has its own intra-op thread pool, so its thread pool share only "
+                                 << "accounts its CPU time.";
+  }
+
+  thread_pool_share_ = std::make_unique<concurrency::ThreadPool::Share>(GetIntraOpThreadPoolToUse(), weight);
+  LOGS(*session_logger_, INFO) << "Thread pool share with a weight of " << weight;
+  return Status::OK();
+}
+
+concurrency::ThreadPool::ShareStats InferenceSession::GetThreadPoolShareStats() const {
+  return thread_pool_share_ ? thread_pool_share_->GetStats() : concurrency::ThreadPool::ShareStats{};
+}
+
+concurrency::ThreadPool::SpinStats InferenceSession::GetIntraOpSpinStats() const {
+  return concurrency::ThreadPool::GetSpinStats(GetIntraOpThreadPoolToUse());
+}
+
+common::Status InferenceSession::InitLoopCostTable() {
+  const std::string file =
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigLoopCostTableFile, "");
+  const std::string calibration =
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigLoopCostCalibration, "0");
+  ORT_RETURN_IF(calibration != "0" && calibration != "1", "Invalid value for ",
+                kOrtSessionOptionsConfigLoopCostCalibration, ": ", calibration);
+  calibrate_loop_costs_ = calibration == "1";
+  if (file.empty() && !calibrate_loop_costs_) {
+    return Status::OK();
+  }
+
+  ORT_RETURN_IF(calibrate_loop_costs_ &&
+                    session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigWarmUpInputShapes,
+                                                                       "")
+                        .empty(),
+                "Loop cost calibration requires warm-up input shapes in ", kOrtSessionOptionsConfigWarmUpInputShapes);
+
+  // the cost model takes cycles. the measured costs are converted with the frequency of the processors, in GHz
+  const int64_t frequency_khz = Env::Default().GetMaxProcessorFrequencyKHz();
+  const double cycles_per_ns = frequency_khz > 0
+                                   ? static_cast<double>(frequency_khz) / 1e6
+                                   : concurrency::ThreadPool::LoopCostTable::kDefaultCyclesPerNanosecond;
+  loop_cost_table_ = std::make_unique<concurrency::ThreadPool::LoopCostTable>(cycles_per_ns);
+  // a calibrated table replaces the file
+  if (!file.empty() && !calibrate_loop_costs_) {
+    std::ifstream stream(ToPathString(file));
+    if (stream) {
+      ORT_RETURN_IF_ERROR(loop_cost_table_->Load(stream));
+      LOGS(*session_logger_, INFO) << "Loaded the costs of " << loop_cost_table_->Size() << " parallel loops from "
+                                   << file;
+    } else {
+      LOGS(*session_logger_, WARNING) << "Loop cost table file " << file << " doesn't exist. The estimated costs of "
+                                      << "the parallel loops are used.";
+    }
+  }
+
+  // the loops are measured during the warm-up runs
+  loop_cost_table_->Freeze();
+  session_state_->SetLoopCostTable(loop_cost_table_.get(), /*calibrate*/ false);
+  return Status::OK();
+}
+
+common::Status InferenceSession::SaveLoopCostTable() const {
+  const std::string file =
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigLoopCostTableFile, "");
+  if (file.empty()) {
+    return Status::OK();
+  }
+
+  std::ofstream stream(ToPathString(file), std::ios::trunc);
+  ORT_RETURN_IF(!stream, "Failed to open loop cost table file ", file, " for writing.");
+  ORT_RETURN_IF_ERROR(loop_cost_table_->Save(stream));
+  LOGS(*session_logger_, INFO) << "Saved the costs of " << loop_cost_table_->Size() << " parallel loops to " << file;
+  return Status::OK();
+}
+
+common::Status InferenceSession::InitPipelinedExecution() {
+  size_t num_stages = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigPipelinedExecutionNumStages, "0"),
+      num_stages));
+  if (num_stages <= 1) {
+    return Status::OK();
+  }
+
+  auto* tp = GetIntraOpThreadPoolToUse();
+  if (!tp || concurrency::ThreadPool::DegreeOfParallelism(tp) < 2) {
+    LOGS(*session_logger_, WARNING) << "Pipelined execution requires an intra op thread pool with at least one "
+                                    << "thread. It is disabled.";
+    return Status::OK();
+  }
+
+  const size_t num_steps = StagedPlanExecution::NumSteps(*session_state_);
+  if (num_steps == 0 || !is_concurrent_run_supported_) {
+    LOGS(*session_logger_, WARNING) << "Pipelined execution requires an execution plan with a single stream and "
+                                    << "execution providers that support concurrent runs. It is disabled.";
+    return Status::OK();
+  }
+
+  // the stages of a run execute on different threads, so each of them flushes the arena caches of its thread
+  execution_pipeline_ = std::make_unique<ExecutionPipeline>(num_steps, num_stages, tp,
+                                                            [this]() { FlushArenaThreadCaches(); });
+  LOGS(*session_logger_, INFO) << "Pipelined execution enabled with " << execution_pipeline_->NumStages()
+                               << " stages for " << num_steps << " execution plan steps";
+  return Status::OK();
+}
+
+common::Status InferenceSession::WarmUp() {
+  const std::string input_shapes =
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigWarmUpInputShapes, "");
+  if (input_shapes.empty()) {
+    return Status::OK();
+  }
+
+  const auto start = std::chrono::high_resolution_clock::now();
+  TimePoint tp;
+  if (session_profiler_.IsEnabled()) {
+    tp = session_profiler_.Start();
+  }
+
+  std::vector<std::string> output_names;
+  output_names.reserve(output_def_list_.size());
+  for (const auto* output : output_def_list_) {
+    output_names.push_back(output->Name());
+  }
+
+  auto cpu_allocator = session_state_->GetAllocator(OrtDevice());
+  size_t num_runs = 0;
+  for (const auto shape_set : utils::SplitString(input_shapes, ";")) {
+    InlinedHashMap<std::string, TensorShapeVector> declared_shapes;
+    for (const auto input_shape : utils::SplitString(shape_set, ",")) {
+      const auto separator = input_shape.rfind(':');
+      ORT_RETURN_IF(separator == std::string_view::npos, "Invalid warm-up input shape '", input_shape,
+                    "'. Expected input_name:dim_0x...xdim_n.");
+      const std::string name{input_shape.substr(0, separator)};
+      ORT_RETURN_IF(input_def_map_.find(name) == input_def_map_.end(), "Warm-up input shape for unknown input ", name);
+
+      TensorShapeVector dims;
+      for (const auto dim : utils::SplitString(input_shape.substr(separator + 1), "x")) {
+        int64_t dim_value = 0;
+        ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(dim, dim_value));
+        ORT_RETURN_IF(dim_value < 0, "Invalid dimension in warm-up input shape '", input_shape, "'");
+        dims.push_back(dim_value);
+      }
+
+      declared_shapes[name] = std::move(dims);
+    }
+
+    std::vector<std::string> feed_names;
+    std::vector<OrtValue> feeds;
+    for (const auto& [name, input_def] : input_def_map_) {
+      auto it = declared_shapes.find(name);
+      if (it == declared_shapes.end() && required_inputs_.count(name) == 0) {
+        // overridable initializer
+        continue;
+      }
+
+      ORT_RETURN_IF(!input_def.ml_data_type->IsTensorType(), "Cannot warm up the session. Input ", name,
+                    " is not a tensor.");
+      TensorShape shape;
+      if (it != declared_shapes.end()) {
+        shape = TensorShape(it->second);
+      } else {
+        ORT_RETURN_IF(input_def.node_arg->Shape() == nullptr || input_def.tensor_shape.Size() < 0,
+                      "Cannot warm up the session. Input ", name, " does not have a fixed shape and is not listed in ",
+                      kOrtSessionOptionsConfigWarmUpInputShapes);
+        shape = input_def.tensor_shape;
+      }
+
+      const auto* element_type = input_def.ml_data_type->AsTensorType()->GetElementType();
+      OrtValue feed;
+      Tensor::InitOrtValue(element_type, shape, cpu_allocator, feed);
+      auto& tensor = *feed.GetMutable<Tensor>();
+      if (!tensor.IsDataTypeString()) {
+        memset(tensor.MutableDataRaw(), 0, tensor.SizeInBytes());
+      }
+
+      feed_names.push_back(name);
+      feeds.push_back(std::move(feed));
+    }
+
+    RunOptions run_options;
+    run_options.run_tag = "warm_up";
+    std::vector<OrtValue> fetches;
+    if (calibrate_loop_costs_) {
+      // the loops are measured in a second run, once the caches and arenas are warm
+      session_state_->SetLoopCostTable(loop_cost_table_.get(), /*calibrate*/ false);
+      ORT_RETURN_IF_ERROR_SESSIONID_(RunWithDeadline(run_options, std::nullopt, feed_names, feeds, output_names,
+                                                     &fetches));
+      ++num_runs;
+      fetches.clear();
+      session_state_->SetLoopCostTable(loop_cost_table_.get(), /*calibrate*/ true);
+    }
+
+    // the warm-up runs bypass the result cache and the dynamic batcher
+    ORT_RETURN_IF_ERROR_SESSIONID_(RunWithDeadline(run_options, std::nullopt, feed_names, feeds, output_names,
+                                                   &fetches));
+    ++num_runs;
+  }
+
+  if (calibrate_loop_costs_) {
+    loop_cost_table_->Freeze();
+    session_state_->SetLoopCostTable(loop_cost_table_.get(), /*calibrate*/ false);
+    LOGS(*session_logger_, INFO) << "Calibrated the costs of " << loop_cost_table_->Size() << " parallel loops";
+    ORT_RETURN_IF_ERROR_SESSIONID_(SaveLoopCostTable());
+  }
+
+  // the runs already grew the arenas, unless they were shrunk since
+  for (const auto& [device, alloc] : session_state_->GetAllocators()) {
+    if (alloc->Info().alloc_type != OrtAllocatorType::OrtArenaAllocator) {
+      continue;
+    }
+
+    auto status = static_cast<BFCArena*>(alloc.get())->PreGrowToPeak(/*touch_pages*/ device.Type() == OrtDevice::CPU);
+    if (!status.IsOK()) {
+      LOGS(*session_logger_, WARNING) << "Unable to pre-grow arena: " << alloc->Info().ToString()
+                                      << " error message: " << status.ErrorMessage();
+    }
+  }
+
+  warm_up_duration_ =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start);
+  if (session_profiler_.IsEnabled()) {
+    session_profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "session_warm_up", tp,
+                                            {{"num_runs", std::to_string(num_runs)}});
+  }
+
+  LOGS(*session_logger_, INFO) << "Session warmed up with " << num_runs << " runs in "
+                               << std::chrono::duration_cast<std::chrono::microseconds>(warm_up_duration_).count()
+                               << " us";
+  return Status::OK();
+}
+
 void InferenceSession::InitLogger(logging::LoggingManager* logging_manager) {
   // create logger for session, using provided logging manager if possible
   if (logging_manager != nullptr) {
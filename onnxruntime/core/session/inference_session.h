@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <string>
 #include <unordered_map>
 
@@ -25,6 +27,8 @@
 #include "core/optimizer/graph_transformer_mgr.h"
 #include "core/optimizer/insert_cast_transformer.h"
 #include "core/framework/session_options.h"
+#include "core/session/activation_memory_budget.h"
+#include "core/session/result_cache.h"
 #ifdef ENABLE_LANGUAGE_INTEROP_OPS
 #include "core/language_interop_ops/language_interop_ops.h"
 #endif
@@ -39,11 +43,15 @@ class ModelProto;
 
 namespace onnxruntime {  // forward declarations
 class CustomRegistry;
+class DeviceStreamCollection;
+class DynamicBatcher;
 class Environment;
+class ExecutionPipeline;
 class GraphTransformer;
 class IExecutionProvider;
 class IOBinding;
 struct Notification;
+class PreparedRun;
 
 #ifdef ENABLE_TRAINING
 struct PartialGraphExecutionState;
@@ -300,17 +308,38 @@ class InferenceSession {
    */
   [[nodiscard]] common::Status Initialize();
 
+  /**
+   * @param p_fetches_device_info Optional device for each fetch that is not pre-allocated.
+   * @param p_fetch_allocators Optional custom allocators for fetches that are not pre-allocated. Key is index in
+   *        p_fetches. An allocator that does not allocate falls back to the regular allocation.
+   */
   [[nodiscard]] common::Status Run(const RunOptions& run_options, gsl::span<const std::string> feed_names,
                                    gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names,
                                    std::vector<OrtValue>* p_fetches,
-                                   const std::vector<OrtDevice>* p_fetches_device_info = nullptr);
+                                   const std::vector<OrtDevice>* p_fetches_device_info = nullptr,
+                                   const std::unordered_map<size_t, IExecutor::CustomAllocator>* p_fetch_allocators =
+                                       nullptr);
 
+  /**
+   * Run the model with C API style inputs and outputs.
+   * If dynamic batching is enabled via the "session.dynamic_batching.max_batch_size" config option, the request
+   * may be executed as part of a batch together with other concurrent calls of this method.
+   * If the result cache is enabled via the "session.result_cache.max_bytes" config option, the outputs of a request
+   * whose inputs match a cached request are returned without executing the model.
+   * If an activation memory budget is set via the "session.activation_memory_budget_bytes" config option, a request
+   * may be executed as several runs over slices of its batch.
+   */
   [[nodiscard]] common::Status Run(const RunOptions& run_options,
                                    gsl::span<const char* const> feed_names,
                                    gsl::span<const OrtValue* const> feeds,
                                    gsl::span<const char* const> fetch_names,
                                    gsl::span<OrtValue*> fetches);
 
+  /**
+   * Run the model asynchronously on the intra-op thread pool. `callback` is called when the run is done.
+   * If pipelined execution is enabled via the "session.pipelined_execution.num_stages" config option, consecutive
+   * requests may overlap.
+   */
   [[nodiscard]] common::Status RunAsync(const RunOptions* run_options,
                                         gsl::span<const char* const> feed_names,
                                         gsl::span<const OrtValue* const> feeds,
@@ -334,7 +363,8 @@ class InferenceSession {
 
   /**
    * See Run(const NameMLValMap& feeds, const std::vector<std::string>& output_names, std::vector<OrtValue>* p_fetches)
-   * for details.
+   * for details. Like the C API style Run, this uses dynamic batching, the result cache and the activation memory
+   * budget if they are enabled.
    * @param run_options use this to tune the Run call to your needs.
    */
   [[nodiscard]] common::Status Run(const RunOptions& run_options, const NameMLValMap& feeds,
@@ -348,9 +378,36 @@ class InferenceSession {
    */
   [[nodiscard]] common::Status NewIOBinding(std::unique_ptr<IOBinding>* io_binding);
 
+  /**
+   * Run with the inputs and outputs of an IOBinding.
+   * Fails if an activation memory budget is set, as the bound outputs cannot be filled slice by slice.
+   */
   [[nodiscard]] virtual common::Status Run(const RunOptions& run_options, IOBinding& io_binding);
   [[nodiscard]] common::Status Run(IOBinding& io_binding);
 
+  /**
+   * Resolve the feeds and fetches of a run once, for running the model repeatedly with RunPrepared.
+   * Every feed must be a tensor input with a fixed shape in the model.
+   * @param feed_names names of the inputs, in the order RunPrepared takes them.
+   * @param output_names names of the outputs, in the order RunPrepared returns them.
+   */
+  [[nodiscard]] common::Status PrepareRun(gsl::span<const std::string> feed_names,
+                                          gsl::span<const std::string> output_names,
+                                          std::unique_ptr<PreparedRun>& prepared_run);
+
+  /**
+   * Run the model with a run prepared by PrepareRun. The names of the feeds and fetches are not resolved again and
+   * the feeds are only checked against the element types and shapes of the prepared run.
+   * The device copy info is only finalized again when the devices of the feeds or fetches change.
+   * The run tag and log levels of `run_options` are only applied if they are set, at the cost of a per-run logger.
+   * Arena shrinkage requested by `run_options` and the run telemetry are handled as in Run.
+   * @param feeds inputs in the order of the prepared feed names.
+   * @param fetches outputs in the order of the prepared output names. Either empty or with one, possibly
+   *        pre-allocated, value per output.
+   */
+  [[nodiscard]] common::Status RunPrepared(const RunOptions& run_options, PreparedRun& prepared_run,
+                                           gsl::span<const OrtValue> feeds, std::vector<OrtValue>& fetches);
+
 #ifdef ENABLE_TRAINING
   /**
    * Partially run a pre-loaded and pre-intialized model.
@@ -457,6 +514,40 @@ class InferenceSession {
     */
   const profiling::Profiler& GetProfiling() const;
 
+  /**
+    * Return the time spent warming up the session at the end of Initialize().
+    * Zero if no warm-up input shapes are configured in the session options.
+    */
+  std::chrono::nanoseconds GetWarmUpDuration() const { return warm_up_duration_; }
+
+  /**
+    * Return the hit, miss and eviction counters of the result cache. All zero if the result cache is disabled.
+    */
+  ResultCache::Stats GetResultCacheStats() const;
+
+  /**
+    * Return how many requests were executed unsplit and split to stay within the activation memory budget.
+    * All zero if no budget is set.
+    */
+  ActivationMemoryBudget::Stats GetActivationMemoryBudgetStats() const;
+
+  /**
+    * Return the parallel loops and CPU time of the runs of this session on its share of the intra-op thread pool.
+    * All zero if the session has no share.
+    */
+  concurrency::ThreadPool::ShareStats GetThreadPoolShareStats() const;
+
+  /**
+    * Return the time the threads of the intra-op thread pool spent spinning and the latency of waking them.
+    * All zero if the session has no intra-op thread pool.
+    */
+  concurrency::ThreadPool::SpinStats GetIntraOpSpinStats() const;
+
+  /**
+    * Return the measured costs of the parallel loops of the kernels, or nullptr if the session uses the estimated costs.
+    */
+  const concurrency::ThreadPool::LoopCostTable* GetLoopCostTable() const { return loop_cost_table_.get(); }
+
 #if !defined(ORT_MINIMAL_BUILD)
   /**
    * Get the TuningResults of TunableOp for every execution providers.
@@ -563,6 +654,10 @@ class InferenceSession {
   /// convenience pointer to logger. should always be the same as session_state_.Logger();
   const logging::Logger* session_logger_;
 
+  // Mapping of the ONNX model file that initializers refer to if the model was loaded with
+  // kOrtSessionOptionsConfigMapInlineInitializers. Declared before model_ and session_state_ so it outlives them.
+  Env::MappedMemoryPtr mapped_onnx_model_;
+
   // The model served by this inference session instance.
   // Currently this has to be a shared ptr because the Model::Load method
   // returns a shared_ptr only. Ideally factory functions should always return
@@ -625,8 +720,88 @@ class InferenceSession {
   const logging::Logger& CreateLoggerForRun(const RunOptions& run_options,
                                             std::unique_ptr<logging::Logger>& new_run_logger);
 
+  // Create the custom allocators that place the outputs bound to a ring buffer in the next free slot of it.
+  // Resets those outputs so that every run gets a new slot.
+  common::Status CreateRingBufferFetchAllocators(
+      IOBinding& io_binding, std::unordered_map<size_t, IExecutor::CustomAllocator>& fetch_allocators) const;
+
   void InitLogger(logging::LoggingManager* logging_manager);
 
+  // Create the dynamic batcher if it was requested in the session options.
+  [[nodiscard]] common::Status InitDynamicBatching();
+
+  // Create the result cache if it is enabled in the session options.
+  [[nodiscard]] common::Status InitResultCache();
+
+  // Create the activation memory budget if one is set in the session options.
+  [[nodiscard]] common::Status InitActivationMemoryBudget();
+
+  // Create the session's share of the intra-op thread pool if a weight is set in the session options.
+  [[nodiscard]] common::Status InitThreadPoolShare();
+
+  // Load the table of measured loop costs and set up its calibration if configured in the session options.
+  [[nodiscard]] common::Status InitLoopCostTable();
+
+  // Write the calibrated loop costs to the file configured in the session options, if any.
+  [[nodiscard]] common::Status SaveLoopCostTable() const;
+
+  class RunScope;
+
+  // Executes the graph with the logger of the run. Sets `device_streams` to the device streams to clean up once the
+  // execution providers were told that the run ended, if there are any.
+  using ExecuteRunFn = std::function<common::Status(const logging::Logger& run_logger,
+                                                    DeviceStreamCollection*& device_streams)>;
+
+  // Run `execute` within the bookkeeping shared by the ways to run the session: the run priority, the thread pool
+  // share, profiling and telemetry, and telling the execution providers that the run starts and ends. Replays the
+  // captured graph instead if there is one. The logger of the run is created from the run options if `run_logger`
+  // is null.
+  [[nodiscard]] common::Status ExecuteRun(const RunOptions& run_options, const logging::Logger* run_logger,
+                                          const ExecuteRunFn& execute);
+
+  // The arenas to shrink at the end of a run with these run options.
+  [[nodiscard]] common::Status GetArenasToShrink(const RunOptions& run_options,
+                                                 InlinedVector<AllocatorPtr>& arenas_to_shrink) const;
+
+  // Run with a deadline resolved by the caller instead of from the run options.
+  [[nodiscard]] common::Status RunWithDeadline(
+      const RunOptions& run_options, const std::optional<std::chrono::steady_clock::time_point>& deadline,
+      gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+      gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
+      const std::vector<OrtDevice>* p_fetches_device_info = nullptr,
+      const std::unordered_map<size_t, IExecutor::CustomAllocator>* p_fetch_allocators = nullptr);
+
+  // Run a request through the result cache, the dynamic batcher and the activation memory budget, whichever are
+  // enabled.
+  [[nodiscard]] common::Status RunRequest(const RunOptions& run_options,
+                                          gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                          gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches);
+
+  // Run the request, split into slices of its batch if it would exceed the activation memory budget.
+  common::Status RunWithinActivationMemoryBudget(
+      const RunOptions& run_options, const std::optional<std::chrono::steady_clock::time_point>& deadline,
+      gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+      gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches);
+
+  // Create the execution pipeline if pipelined execution is enabled in the session options.
+  [[nodiscard]] common::Status InitPipelinedExecution();
+
+  // Run the session with zero filled inputs for each set of input shapes in the session options, then grow the
+  // memory arenas to the peak usage seen and pre-fault their pages.
+  [[nodiscard]] common::Status WarmUp();
+
+  // Submit a RunAsync request to the execution pipeline. `submitted` is false if the request cannot be pipelined,
+  // in which case it must be executed as a whole.
+  [[nodiscard]] common::Status RunPipelined(const RunOptions* run_options,
+                                            gsl::span<const char* const> feed_names,
+                                            gsl::span<const OrtValue* const> feeds,
+                                            gsl::span<const char* const> fetch_names,
+                                            gsl::span<OrtValue*> fetches,
+                                            RunAsyncCallbackFn callback,
+                                            void* user_data,
+                                            concurrency::ThreadPool::RunPriority run_priority,
+                                            bool& submitted);
+
   [[nodiscard]] common::Status CheckShapes(const std::string& input_name, const TensorShape& input_shape,
                                            const TensorShape& expected_shape) const;
 
@@ -657,6 +832,13 @@ class InferenceSession {
    */
   void ShrinkMemoryArenas(gsl::span<const AllocatorPtr> arenas_to_shrink);
 
+  // Returns the chunks cached by the calling thread in the thread caches of the session's arenas to the arenas.
+  // Done at the end of a run.
+  void FlushArenaThreadCaches();
+
+  // Counts a run that started at `tp` in the runtime telemetry, and sends the telemetry when it is due.
+  void UpdateRunTelemetry(const TimePoint& tp);
+
 #if !defined(ORT_MINIMAL_BUILD)
   virtual common::Status AddPredefinedTransformers(
       GraphTransformerManager& transformer_manager,
@@ -706,6 +888,10 @@ class InferenceSession {
   // Spinning is restarted on the next Run()
   bool force_spinning_stop_between_runs_ = false;
 
+  // NUMA node the intra-op threads and the memory of the implicitly added CPU execution provider are bound to.
+  // -1 if the session is not bound to a node.
+  int numa_node_ = -1;
+
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> thread_pool_;
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> inter_op_thread_pool_;
 
@@ -757,6 +943,27 @@ class InferenceSession {
   // Number of concurrently running executors
   std::atomic<int> current_num_runs_ = 0;
 
+  // Batches concurrent Run() calls if dynamic batching is enabled. nullptr otherwise.
+  std::unique_ptr<DynamicBatcher> dynamic_batcher_;
+
+  // Pipelines RunAsync() calls if pipelined execution is enabled. nullptr otherwise.
+  std::unique_ptr<ExecutionPipeline> execution_pipeline_;
+
+  // Caches the outputs of Run() calls if the result cache is enabled. nullptr otherwise.
+  std::unique_ptr<ResultCache> result_cache_;
+
+  // Splits Run() calls to stay within the activation memory budget if one is set. nullptr otherwise.
+  std::unique_ptr<ActivationMemoryBudget> activation_memory_budget_;
+
+  // The session's share of the intra-op thread pool if a weight is set. nullptr otherwise.
+  std::unique_ptr<concurrency::ThreadPool::Share> thread_pool_share_;
+
+  // Measured costs of the parallel loops of the kernels if configured. nullptr otherwise.
+  std::unique_ptr<concurrency::ThreadPool::LoopCostTable> loop_cost_table_;
+  bool calibrate_loop_costs_ = false;
+
+  std::chrono::nanoseconds warm_up_duration_{0};
+
   mutable onnxruntime::OrtMutex session_mutex_;  // to ensure only one thread can invoke Load/Initialize
   bool is_model_loaded_ = false;                 // GUARDED_BY(session_mutex_)
   bool is_inited_ = false;                       // GUARDED_BY(session_mutex_)
@@ -33,6 +33,8 @@
 #include "core/session/inference_session.h"
 #include "core/session/ort_apis.h"
 #include "core/session/ort_env.h"
+#include "core/session/prepared_run.h"
+#include "core/session/session_pool.h"
 #include "core/framework/data_types.h"
 #include "abi_session_options_impl.h"
 #include "core/framework/TensorSeq.h"
@@ -877,6 +879,95 @@ struct OrtIoBinding {
   OrtIoBinding& operator=(const OrtIoBinding&) = delete;
 };
 
+struct OrtRingBuffer {
+  std::shared_ptr<::onnxruntime::RingBufferAllocator> ring_buffer_;
+  explicit OrtRingBuffer(std::shared_ptr<::onnxruntime::RingBufferAllocator>&& ring_buffer)
+      : ring_buffer_(std::move(ring_buffer)) {}
+  OrtRingBuffer(const OrtRingBuffer&) = delete;
+  OrtRingBuffer& operator=(const OrtRingBuffer&) = delete;
+};
+
+struct OrtPreparedRun {
+  std::unique_ptr<::onnxruntime::PreparedRun> prepared_run_;
+  explicit OrtPreparedRun(std::unique_ptr<::onnxruntime::PreparedRun>&& prepared_run)
+      : prepared_run_(std::move(prepared_run)) {}
+  OrtPreparedRun(const OrtPreparedRun&) = delete;
+  OrtPreparedRun& operator=(const OrtPreparedRun&) = delete;
+};
+
+ORT_API_STATUS_IMPL(OrtApis::CreatePreparedRun, _Inout_ OrtSession* sess,
+                    _In_reads_(input_len) const char* const* input_names, size_t input_len,
+                    _In_reads_(output_names_len) const char* const* output_names, size_t output_names_len,
+                    _Outptr_ OrtPreparedRun** out) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  std::vector<std::string> input_name_vec(input_names, input_names + input_len);
+  std::vector<std::string> output_name_vec(output_names, output_names + output_names_len);
+  std::unique_ptr<::onnxruntime::PreparedRun> prepared_run;
+  auto status = session->PrepareRun(input_name_vec, output_name_vec, prepared_run);
+  if (!status.IsOK()) {
+    return ToOrtStatus(status);
+  }
+  *out = std::make_unique<OrtPreparedRun>(std::move(prepared_run)).release();
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::RunPrepared, _Inout_ OrtSession* sess, _In_opt_ const OrtRunOptions* run_options,
+                    _Inout_ OrtPreparedRun* prepared_run,
+                    _In_reads_(input_len) const OrtValue* const* inputs, size_t input_len,
+                    _Inout_updates_all_(output_len) OrtValue** outputs, size_t output_len) {
+  API_IMPL_BEGIN
+  auto session = reinterpret_cast<::onnxruntime::InferenceSession*>(sess);
+  auto& prepared = *prepared_run->prepared_run_;
+
+  // the buffers of the prepared run keep their capacity, so they are only allocated by the first run
+  auto& feeds = prepared.GetFeedBuffer();
+  auto& fetches = prepared.GetFetchBuffer();
+  auto clear_buffers = gsl::finally([&feeds, &fetches]() {
+    feeds.clear();
+    fetches.clear();
+  });
+
+  for (size_t i = 0; i != input_len; ++i) {
+    if (inputs[i] == nullptr) {
+      return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "NULL input supplied");
+    }
+    feeds.push_back(*inputs[i]);
+  }
+
+  for (size_t i = 0; i != output_len; ++i) {
+    if (outputs[i] != nullptr) {
+      fetches.push_back(*outputs[i]);
+    } else {
+      fetches.emplace_back();
+    }
+  }
+
+  Status status;
+  if (run_options) {
+    status = session->RunPrepared(*run_options, prepared, feeds, fetches);
+  } else {
+    const RunOptions default_run_options;
+    status = session->RunPrepared(default_run_options, prepared, feeds, fetches);
+  }
+  if (!status.IsOK()) {
+    return ToOrtStatus(status);
+  }
+
+  for (size_t i = 0; i != output_len; ++i) {
+    if (outputs[i] == nullptr) {
+      outputs[i] = std::make_unique<OrtValue>(std::move(fetches[i])).release();
+    }
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API(void, OrtApis::ReleasePreparedRun, _Frees_ptr_opt_ OrtPreparedRun* prepared_run) {
+  delete prepared_run;
+}
+
 ORT_API_STATUS_IMPL(OrtApis::RunWithBinding, _Inout_ OrtSession* sess, _In_ const OrtRunOptions* run_options,
                     _In_ const OrtIoBinding* binding_ptr) {
   API_IMPL_BEGIN
@@ -942,6 +1033,32 @@ ORT_API_STATUS_IMPL(OrtApis::BindOutputToDevice, _Inout_ OrtIoBinding* binding_p
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtApis::CreateRingBuffer, _In_ const OrtMemoryInfo* mem_info, _In_ void* buffer,
+                    size_t buffer_size, _Outptr_ OrtRingBuffer** out) {
+  API_IMPL_BEGIN
+  if (buffer == nullptr || buffer_size == 0) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "buffer must not be null or empty");
+  }
+  *out = new OrtRingBuffer(std::make_shared<::onnxruntime::RingBufferAllocator>(buffer, buffer_size, *mem_info));
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::BindOutputToRingBuffer, _Inout_ OrtIoBinding* binding_ptr, _In_ const char* name,
+                    _In_ const OrtRingBuffer* ring_buffer) {
+  API_IMPL_BEGIN
+  auto st = binding_ptr->binding_->BindOutput(name, ring_buffer->ring_buffer_);
+  if (!st.IsOK()) {
+    return ToOrtStatus(st);
+  }
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API(void, OrtApis::ReleaseRingBuffer, _Frees_ptr_opt_ OrtRingBuffer* ptr) {
+  delete ptr;
+}
+
 ORT_API_STATUS_IMPL(OrtApis::GetBoundOutputNames, _In_ const OrtIoBinding* binding_ptr, _In_ OrtAllocator* allocator,
                     _Out_ char** buffer, _Outptr_result_maybenull_ size_t** lengths, _Out_ size_t* count) {
   API_IMPL_BEGIN
@@ -2196,6 +2313,14 @@ ORT_API_STATUS_IMPL(OrtApis::SessionGetProfilingStartTimeNs, _In_ const OrtSessi
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtApis::SessionGetWarmUpDurationNs, _In_ const OrtSession* sess, _Out_ uint64_t* out) {
+  API_IMPL_BEGIN
+  const auto* session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  *out = static_cast<uint64_t>(session->GetWarmUpDuration().count());
+  return nullptr;
+  API_IMPL_END
+}
+
 // End support for non-tensor types
 
 ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfg, _In_ size_t max_mem, int arena_extend_strategy, int initial_chunk_size_bytes,
@@ -2230,6 +2355,8 @@ ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfgV2, _In_reads_(num_keys) const char*
       cfg->initial_growth_chunk_size_bytes = static_cast<int>(arena_config_values[i]);
     } else if (strcmp(arena_config_keys[i], "max_power_of_two_extend_bytes") == 0) {
       cfg->max_power_of_two_extend_bytes = static_cast<int64_t>(arena_config_values[i]);
+    } else if (strcmp(arena_config_keys[i], "max_thread_cache_bytes") == 0) {
+      cfg->max_thread_cache_bytes = arena_config_values[i];
     } else {
       std::ostringstream oss;
       oss << "Invalid key found: " << arena_config_keys[i];
@@ -2310,6 +2437,101 @@ ORT_API_STATUS_IMPL(OrtApis::CreateSessionFromArrayWithPrepackedWeightsContainer
   API_IMPL_END
 }
 
+namespace {
+ORT_STATUS_PTR CreateSessionPoolImpl(_In_ const OrtEnv* env, _In_opt_z_ const ORTCHAR_T* model_path,
+                                     _In_opt_ const void* model_data, size_t model_data_length,
+                                     _In_opt_ const OrtSessionOptions* options, size_t num_sessions,
+                                     _Outptr_ OrtSessionPool** out) {
+  // the pool reads the initializers to share from model_data, or from model_path if there is no model_data
+  const auto model_span = gsl::make_span(static_cast<const char*>(model_data), model_data_length);
+
+  auto create_session = [&](const SessionOptions& session_options,
+                            PrepackedWeightsContainer& prepacked_weights_container,
+                            std::unique_ptr<InferenceSession>& sess) -> Status {
+    // keep the execution provider factories and custom op domains of the user's options
+    OrtSessionOptions replica_options = options == nullptr ? OrtSessionOptions() : *options;
+    replica_options.value = session_options;
+
+    std::unique_ptr<OrtStatus, decltype(&OrtApis::ReleaseStatus)> status(
+        CreateSessionAndLoadModel(&replica_options, env, model_path, model_data, model_data_length, sess),
+        OrtApis::ReleaseStatus);
+    if (status == nullptr) {
+      status.reset(InitializeSession(&replica_options, sess,
+                                     reinterpret_cast<OrtPrepackedWeightsContainer*>(&prepacked_weights_container)));
+    }
+
+    return status == nullptr ? Status::OK() : ToStatus(status.get());
+  };
+
+  SessionPool* pool = nullptr;
+  ORT_API_RETURN_IF_STATUS_NOT_OK(SessionPool::Create(
+      options == nullptr ? SessionOptions() : options->value, model_path, model_span, num_sessions,
+      create_session, pool));
+
+  *out = reinterpret_cast<OrtSessionPool*>(pool);
+  return nullptr;
+}
+}  // namespace
+
+ORT_API_STATUS_IMPL(OrtApis::CreateSessionPool, _In_ const OrtEnv* env, _In_ const ORTCHAR_T* model_path,
+                    _In_ const OrtSessionOptions* options, size_t num_sessions, _Outptr_ OrtSessionPool** out) {
+  API_IMPL_BEGIN
+  OrtStatus* status = nullptr;
+  *out = nullptr;
+
+  ORT_TRY {
+    status = CreateSessionPoolImpl(env, model_path, nullptr, 0, options, num_sessions, out);
+  }
+  ORT_CATCH(const std::exception& e) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      status = OrtApis::CreateStatus(ORT_FAIL, e.what());
+    });
+  }
+
+  return status;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::CreateSessionPoolFromArray, _In_ const OrtEnv* env, _In_ const void* model_data,
+                    size_t model_data_length, _In_ const OrtSessionOptions* options, size_t num_sessions,
+                    _Outptr_ OrtSessionPool** out) {
+  API_IMPL_BEGIN
+  OrtStatus* status = nullptr;
+  *out = nullptr;
+
+  ORT_TRY {
+    status = CreateSessionPoolImpl(env, nullptr, model_data, model_data_length, options, num_sessions, out);
+  }
+  ORT_CATCH(const std::exception& e) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      status = OrtApis::CreateStatus(ORT_FAIL, e.what());
+    });
+  }
+
+  return status;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::SessionPoolAcquireSession, _Inout_ OrtSessionPool* pool, _Outptr_result_maybenull_ OrtSession** out) {
+  API_IMPL_BEGIN
+  *out = reinterpret_cast<OrtSession*>(reinterpret_cast<SessionPool*>(pool)->TryAcquire());
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::SessionPoolReturnSession, _Inout_ OrtSessionPool* pool, _In_ OrtSession* session) {
+  API_IMPL_BEGIN
+  ORT_API_RETURN_IF_STATUS_NOT_OK(reinterpret_cast<SessionPool*>(pool)->Return(
+      reinterpret_cast<InferenceSession*>(session)));
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API(void, OrtApis::ReleaseSessionPool, _Frees_ptr_opt_ OrtSessionPool* ptr) {
+  // the pool is freed once the sessions still in use are given back
+  SessionPool::Release(reinterpret_cast<SessionPool*>(ptr));
+}
+
 ORT_API_STATUS_IMPL(OrtApis::GetTensorMemoryInfo, _In_ const OrtValue* value, _Outptr_ const OrtMemoryInfo** memory_info) {
   TENSOR_READ_API_BEGIN
   *memory_info = &tensor.Location();
@@ -2714,6 +2936,18 @@ static constexpr OrtApi ort_api_1_to_16 = {
     // End of Version 16 - DO NOT MODIFY ABOVE (see above text for more information)
 
     &OrtApis::KernelContext_GetResource,
+    &OrtApis::CreateSessionPool,
+    &OrtApis::CreateSessionPoolFromArray,
+    &OrtApis::SessionPoolAcquireSession,
+    &OrtApis::SessionPoolReturnSession,
+    &OrtApis::ReleaseSessionPool,
+    &OrtApis::CreateRingBuffer,
+    &OrtApis::BindOutputToRingBuffer,
+    &OrtApis::ReleaseRingBuffer,
+    &OrtApis::SessionGetWarmUpDurationNs,
+    &OrtApis::CreatePreparedRun,
+    &OrtApis::RunPrepared,
+    &OrtApis::ReleasePreparedRun,
 };
 
 // OrtApiBase can never change as there is no way to know what version of OrtApiBase is returned by OrtGetApiBase.
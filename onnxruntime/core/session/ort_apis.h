@@ -491,4 +491,31 @@ ORT_API_STATUS_IMPL(GetTensorRTProviderOptionsByName, _In_ const OrtTensorRTProv
 ORT_API_STATUS_IMPL(UpdateCUDAProviderOptionsWithValue, _Inout_ OrtCUDAProviderOptionsV2* cuda_options, _In_ const char* key, _In_ void* value);
 ORT_API_STATUS_IMPL(GetCUDAProviderOptionsByName, _In_ const OrtCUDAProviderOptionsV2* cuda_options, _In_ const char* key, _Outptr_ void** ptr);
 ORT_API_STATUS_IMPL(KernelContext_GetResource, _In_ const OrtKernelContext* context, _In_ int resource_version, _In_ int resource_id, _Outptr_ void** stream);
+
+ORT_API_STATUS_IMPL(CreateSessionPool, _In_ const OrtEnv* env, _In_ const ORTCHAR_T* model_path,
+                    _In_ const OrtSessionOptions* options, size_t num_sessions, _Outptr_ OrtSessionPool** out);
+ORT_API_STATUS_IMPL(CreateSessionPoolFromArray, _In_ const OrtEnv* env, _In_ const void* model_data,
+                    size_t model_data_length, _In_ const OrtSessionOptions* options, size_t num_sessions,
+                    _Outptr_ OrtSessionPool** out);
+ORT_API_STATUS_IMPL(SessionPoolAcquireSession, _Inout_ OrtSessionPool* pool, _Outptr_result_maybenull_ OrtSession** out);
+ORT_API_STATUS_IMPL(SessionPoolReturnSession, _Inout_ OrtSessionPool* pool, _In_ OrtSession* session);
+ORT_API(void, ReleaseSessionPool, _Frees_ptr_opt_ OrtSessionPool*);
+
+ORT_API_STATUS_IMPL(CreateRingBuffer, _In_ const OrtMemoryInfo* mem_info, _In_ void* buffer, size_t buffer_size,
+                    _Outptr_ OrtRingBuffer** out);
+ORT_API_STATUS_IMPL(BindOutputToRingBuffer, _Inout_ OrtIoBinding* binding_ptr, _In_ const char* name,
+                    _In_ const OrtRingBuffer* ring_buffer);
+ORT_API(void, ReleaseRingBuffer, _Frees_ptr_opt_ OrtRingBuffer*);
+
+ORT_API_STATUS_IMPL(SessionGetWarmUpDurationNs, _In_ const OrtSession* sess, _Out_ uint64_t* out);
+
+ORT_API_STATUS_IMPL(CreatePreparedRun, _Inout_ OrtSession* sess,
+                    _In_reads_(input_len) const char* const* input_names, size_t input_len,
+                    _In_reads_(output_names_len) const char* const* output_names, size_t output_names_len,
+                    _Outptr_ OrtPreparedRun** out);
+ORT_API_STATUS_IMPL(RunPrepared, _Inout_ OrtSession* sess, _In_opt_ const OrtRunOptions* run_options,
+                    _Inout_ OrtPreparedRun* prepared_run,
+                    _In_reads_(input_len) const OrtValue* const* inputs, size_t input_len,
+                    _Inout_updates_all_(output_len) OrtValue** outputs, size_t output_len);
+ORT_API(void, ReleasePreparedRun, _Frees_ptr_opt_ OrtPreparedRun*);
 }  // namespace OrtApis
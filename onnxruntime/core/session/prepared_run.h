@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/data_types.h"
+#ifdef ORT_ENABLE_STREAM
+#include "core/framework/device_stream_collection.h"
+#endif
+#include "core/framework/feeds_fetches_manager.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/tensor_shape.h"
+
+namespace onnxruntime {
+
+class InferenceSession;
+class SessionState;
+
+/**
+ * The feeds and fetches of a run resolved once by InferenceSession::PrepareRun.
+ *
+ * A prepared run is executed with InferenceSession::RunPrepared, which takes the feeds in the order of the feed names
+ * it was prepared with. The names are not looked up again and the feeds are only checked against the element types
+ * and the fixed shapes resolved when the run was prepared.
+ *
+ * The device copy info is only finalized again when the devices of the feeds or fetches differ from those of the
+ * previous run, and the device streams and the feed and fetch buffers of the C API are kept between runs. A prepared
+ * run must therefore not be used by concurrent calls to RunPrepared. Each thread should prepare its own.
+ */
+class PreparedRun {
+ public:
+  PreparedRun(const InferenceSession& session,
+              const SessionState& session_state,
+              FeedsFetchesInfo&& feeds_fetches_info,
+              InlinedVector<MLDataType>&& feed_element_types,
+              InlinedVector<TensorShape>&& feed_shapes,
+              std::unique_ptr<logging::Logger> owned_logger,
+              const logging::Logger& logger)
+      : session_(session),
+        feeds_fetches_manager_(std::move(feeds_fetches_info)),
+        feed_element_types_(std::move(feed_element_types)),
+        feed_shapes_(std::move(feed_shapes)),
+        owned_logger_(std::move(owned_logger)),
+        logger_(logger)
+#ifdef ORT_ENABLE_STREAM
+        ,
+        device_stream_collection_holder_(&session_state)
+#endif
+  {
+    ORT_UNUSED_PARAMETER(session_state);
+  }
+
+  const InferenceSession& GetSession() const { return session_; }
+
+  FeedsFetchesManager& GetFeedsFetchesManager() { return feeds_fetches_manager_; }
+
+  size_t NumFeeds() const { return feed_shapes_.size(); }
+  size_t NumFetches() const { return feeds_fetches_manager_.GetFeedsFetchesInfo().output_names.size(); }
+
+  // element type and shape of the feed at index i
+  MLDataType GetFeedElementType(size_t i) const { return feed_element_types_[i]; }
+  const TensorShape& GetFeedShape(size_t i) const { return feed_shapes_[i]; }
+
+  // logger for runs that don't have a run tag or a run specific log level
+  const logging::Logger& GetLogger() const { return logger_; }
+
+  // devices of the feeds and of the pre-allocated fetches the copy info was last finalized for.
+  // a fetch that was not pre-allocated has no device. empty until the first run finalizes the copy info.
+  InlinedVector<OrtDevice>& GetFinalizedFeedDevices() { return finalized_feed_devices_; }
+  InlinedVector<std::optional<OrtDevice>>& GetFinalizedFetchDevices() { return finalized_fetch_devices_; }
+  bool IsCopyInfoFinalized() const { return copy_info_finalized_; }
+  void SetCopyInfoFinalized(bool finalized) { copy_info_finalized_ = finalized; }
+
+#ifdef ORT_ENABLE_STREAM
+  DeviceStreamCollection* GetDeviceStreamCollection() { return device_stream_collection_holder_.p_.get(); }
+#endif
+
+  // buffers the C API fills with the feeds and fetches of a run, so they are not allocated on every run.
+  // they are cleared after each run, which keeps their capacity.
+  std::vector<OrtValue>& GetFeedBuffer() { return feed_buffer_; }
+  std::vector<OrtValue>& GetFetchBuffer() { return fetch_buffer_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PreparedRun);
+
+  const InferenceSession& session_;
+  FeedsFetchesManager feeds_fetches_manager_;
+  InlinedVector<MLDataType> feed_element_types_;
+  InlinedVector<TensorShape> feed_shapes_;
+  std::unique_ptr<logging::Logger> owned_logger_;
+  const logging::Logger& logger_;
+  InlinedVector<OrtDevice> finalized_feed_devices_;
+  InlinedVector<std::optional<OrtDevice>> finalized_fetch_devices_;
+  bool copy_info_finalized_ = false;
+#ifdef ORT_ENABLE_STREAM
+  DeviceStreamCollectionHolder device_stream_collection_holder_;
+#endif
+  std::vector<OrtValue> feed_buffer_;
+  std::vector<OrtValue> fetch_buffer_;
+};
+
+}  // namespace onnxruntime
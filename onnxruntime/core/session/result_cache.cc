@@ -0,0 +1,202 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/result_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/framework/murmurhash3.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+
+namespace {
+bool IsCacheableValue(const OrtValue& value) {
+  if (!value.IsAllocated() || !value.IsTensor()) {
+    return false;
+  }
+
+  const auto& tensor = value.Get<Tensor>();
+  return !tensor.IsDataTypeString() && tensor.Location().device.Type() == OrtDevice::CPU;
+}
+}  // namespace
+
+ResultCache::ResultCache(const Options& options, AllocatorPtr cpu_allocator)
+    : options_(options), cpu_allocator_(std::move(cpu_allocator)) {
+  ORT_ENFORCE(options_.max_bytes > 0, "The result cache requires a byte budget.");
+  ORT_ENFORCE(cpu_allocator_ != nullptr, "The result cache requires a CPU allocator.");
+}
+
+bool ResultCache::IsCacheable(gsl::span<const OrtValue> feeds) {
+  return std::all_of(feeds.begin(), feeds.end(), IsCacheableValue);
+}
+
+uint64_t ResultCache::ComputeHash(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                                  gsl::span<const std::string> output_names) {
+  MurmurHash3::Hasher hasher;
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    hasher.Add(feed_names[i].data(), feed_names[i].size());
+    const auto& tensor = feeds[i].Get<Tensor>();
+    const int32_t element_type = tensor.GetElementType();
+    hasher.Add(&element_type, sizeof(element_type));
+    const auto dims = tensor.Shape().GetDims();
+    hasher.Add(dims.data(), dims.size_bytes());
+    hasher.Add(tensor.DataRaw(), tensor.SizeInBytes());
+  }
+
+  for (const auto& output_name : output_names) {
+    hasher.Add(output_name.data(), output_name.size());
+  }
+
+  return hasher.Get64();
+}
+
+bool ResultCache::Matches(const Entry& entry, gsl::span<const std::string> feed_names,
+                          gsl::span<const OrtValue> feeds, gsl::span<const std::string> output_names) {
+  if (!std::equal(entry.feed_names.begin(), entry.feed_names.end(), feed_names.begin(), feed_names.end()) ||
+      !std::equal(entry.output_names.begin(), entry.output_names.end(), output_names.begin(), output_names.end())) {
+    return false;
+  }
+
+  for (size_t i = 0, end = feeds.size(); i < end; ++i) {
+    const auto& cached = entry.feeds[i].Get<Tensor>();
+    const auto& tensor = feeds[i].Get<Tensor>();
+    if (cached.DataType() != tensor.DataType() || cached.Shape() != tensor.Shape() ||
+        std::memcmp(cached.DataRaw(), tensor.DataRaw(), tensor.SizeInBytes()) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+OrtValue ResultCache::Copy(const OrtValue& value) const {
+  const auto& src = value.Get<Tensor>();
+  OrtValue copy;
+  Tensor::InitOrtValue(src.DataType(), src.Shape(), cpu_allocator_, copy);
+  auto& dst = *copy.GetMutable<Tensor>();
+  if (src.SizeInBytes() > 0) {
+    std::memcpy(dst.MutableDataRaw(), src.DataRaw(), src.SizeInBytes());
+  }
+  return copy;
+}
+
+bool ResultCache::Lookup(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                         gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches,
+                         uint64_t& hash) {
+  hash = ComputeHash(feed_names, feeds, output_names);
+  const auto now = std::chrono::steady_clock::now();
+
+  std::shared_ptr<const Entry> entry;
+  {
+    std::lock_guard<OrtMutex> lock(mutex_);
+    auto range = index_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      auto entry_it = it->second;
+      if (Matches(**entry_it, feed_names, feeds, output_names)) {
+        if (options_.ttl.count() > 0 && (*entry_it)->expiry <= now) {
+          Erase(entry_it);
+          ++stats_.evictions;
+        } else {
+          entry = *entry_it;
+          entries_.splice(entries_.begin(), entries_, entry_it);
+        }
+        break;
+      }
+    }
+
+    if (entry) {
+      ++stats_.hits;
+    } else {
+      ++stats_.misses;
+      return false;
+    }
+  }
+
+  // the entry stays valid while it's referenced, even if it's evicted meanwhile
+  fetches.clear();
+  fetches.reserve(entry->fetches.size());
+  for (const auto& fetch : entry->fetches) {
+    fetches.push_back(Copy(fetch));
+  }
+
+  return true;
+}
+
+void ResultCache::Insert(uint64_t hash, gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                         gsl::span<const std::string> output_names, gsl::span<const OrtValue> fetches) {
+  if (!IsCacheable(feeds) || !std::all_of(fetches.begin(), fetches.end(), IsCacheableValue)) {
+    return;
+  }
+
+  size_t num_bytes = 0;
+  for (const auto& value : feeds) {
+    num_bytes += value.Get<Tensor>().SizeInBytes();
+  }
+  for (const auto& value : fetches) {
+    num_bytes += value.Get<Tensor>().SizeInBytes();
+  }
+
+  if (num_bytes > options_.max_bytes) {
+    return;
+  }
+
+  auto entry = std::make_shared<Entry>();
+  entry->hash = hash;
+  entry->feed_names.assign(feed_names.begin(), feed_names.end());
+  entry->output_names.assign(output_names.begin(), output_names.end());
+  entry->feeds.reserve(feeds.size());
+  for (const auto& feed : feeds) {
+    entry->feeds.push_back(Copy(feed));
+  }
+  entry->fetches.reserve(fetches.size());
+  for (const auto& fetch : fetches) {
+    entry->fetches.push_back(Copy(fetch));
+  }
+  entry->num_bytes = num_bytes;
+  entry->expiry = std::chrono::steady_clock::now() + options_.ttl;
+
+  std::lock_guard<OrtMutex> lock(mutex_);
+
+  // a concurrent run of the same request may have inserted it already
+  auto range = index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (Matches(**it->second, feed_names, feeds, output_names)) {
+      Erase(it->second);
+      break;
+    }
+  }
+
+  while (stats_.num_bytes + num_bytes > options_.max_bytes) {
+    Erase(std::prev(entries_.end()));
+    ++stats_.evictions;
+  }
+
+  entries_.push_front(std::move(entry));
+  index_.emplace(hash, entries_.begin());
+  stats_.num_bytes += num_bytes;
+  ++stats_.num_entries;
+}
+
+void ResultCache::Erase(EntryList::iterator it) {
+  const auto& entry = **it;
+  auto range = index_.equal_range(entry.hash);
+  for (auto index_it = range.first; index_it != range.second; ++index_it) {
+    if (index_it->second == it) {
+      index_.erase(index_it);
+      break;
+    }
+  }
+
+  stats_.num_bytes -= entry.num_bytes;
+  --stats_.num_entries;
+  entries_.erase(it);
+}
+
+ResultCache::Stats ResultCache::GetStats() const {
+  std::lock_guard<OrtMutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace onnxruntime
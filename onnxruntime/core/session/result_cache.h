@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/platform/ort_mutex.h"
+
+namespace onnxruntime {
+
+/**
+ * Caches the outputs of Run() requests keyed by the content of their feeds.
+ *
+ * The key is a MurmurHash3 of the feed names, element types, shapes and data, and of the requested output names.
+ * A hit is confirmed by comparing the cached feeds with the request's feeds, so hash collisions never return the
+ * outputs of a different request. Feeds and outputs are copied into and out of the cache, so neither the caller
+ * nor the cache can observe changes the other makes to its buffers.
+ *
+ * Only requests whose feeds and outputs are non-string CPU tensors are cached. Entries are evicted in least
+ * recently used order to stay within the byte budget, and expire after the time to live if one is set.
+ */
+class ResultCache {
+ public:
+  struct Options {
+    // maximum number of bytes of feeds and outputs held by the cache
+    size_t max_bytes = 0;
+    // time after which an entry expires. zero means entries don't expire.
+    std::chrono::milliseconds ttl{0};
+  };
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;  // entries removed to stay within the byte budget or because they expired
+    size_t num_entries = 0;
+    size_t num_bytes = 0;
+  };
+
+  ResultCache(const Options& options, AllocatorPtr cpu_allocator);
+
+  // Whether the outputs of a run with these feeds can be cached
+  static bool IsCacheable(gsl::span<const OrtValue> feeds);
+
+  /**
+   * Look up the outputs of a request.
+   * `hash` is set to the key of the request, to be passed to Insert on a miss so the feeds are hashed once.
+   * @returns true on a hit, in which case `fetches` is set to copies of the cached outputs.
+   */
+  bool Lookup(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+              gsl::span<const std::string> output_names, std::vector<OrtValue>& fetches, uint64_t& hash);
+
+  // Add the outputs of a request whose key Lookup returned in `hash`. Does nothing if the outputs cannot be cached
+  // or don't fit in the byte budget.
+  void Insert(uint64_t hash, gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+              gsl::span<const std::string> output_names, gsl::span<const OrtValue> fetches);
+
+  Stats GetStats() const;
+
+  const Options& GetOptions() const { return options_; }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ResultCache);
+
+  struct Entry {
+    uint64_t hash;
+    std::vector<std::string> feed_names;
+    std::vector<std::string> output_names;
+    std::vector<OrtValue> feeds;
+    std::vector<OrtValue> fetches;
+    size_t num_bytes;
+    std::chrono::steady_clock::time_point expiry;
+  };
+
+  using EntryList = std::list<std::shared_ptr<const Entry>>;
+
+  static uint64_t ComputeHash(gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                              gsl::span<const std::string> output_names);
+
+  static bool Matches(const Entry& entry, gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
+                      gsl::span<const std::string> output_names);
+
+  OrtValue Copy(const OrtValue& value) const;
+
+  // Remove an entry. mutex_ must be held.
+  void Erase(EntryList::iterator it);
+
+  const Options options_;
+  const AllocatorPtr cpu_allocator_;
+
+  mutable OrtMutex mutex_;
+  // most recently used first
+  EntryList entries_;
+  std::unordered_multimap<uint64_t, EntryList::iterator> index_;
+  Stats stats_;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,204 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/session_pool.h"
+
+#include <limits>
+
+#include "core/common/narrow.h"
+#include "core/framework/allocator.h"
+#include "core/framework/mem_buffer.h"
+#include "core/flatbuffers/flatbuffers_utils.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/model.h"
+#include "core/graph/onnx_protobuf.h"
+#include "core/platform/env.h"
+#include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+
+namespace onnxruntime {
+
+namespace {
+constexpr uint64_t kFreeListIndexMask = std::numeric_limits<uint32_t>::max();
+
+uint64_t MakeFreeListHead(uint64_t old_head, uint32_t first) {
+  const uint64_t tag = (old_head >> 32) + 1;
+  return (tag << 32) | first;
+}
+}  // namespace
+
+SessionPool::SessionPool(const SessionOptions& session_options)
+    : session_options_(session_options),
+      cpu_allocator_(std::make_shared<CPUAllocator>()) {
+}
+
+SessionPool::~SessionPool() = default;
+
+Status SessionPool::Create(const SessionOptions& session_options, const ORTCHAR_T* model_path,
+                           gsl::span<const char> model_data, size_t num_sessions,
+                           const CreateSessionFn& create_session_fn, SessionPool*& pool) {
+  ORT_RETURN_IF(num_sessions == 0, "A session pool needs at least one session.");
+  ORT_RETURN_IF(num_sessions >= kFreeListIndexMask, "Too many sessions in the pool: ", num_sessions);
+
+  // private constructor and destructor
+  std::unique_ptr<SessionPool, decltype(&Release)> new_pool(new SessionPool(session_options), &Release);
+  ORT_RETURN_IF_ERROR(new_pool->LoadSharedInitializers(model_path, model_data));
+
+  // the activation arenas are the only allocators that differ between replicas unless the
+  // user registered allocators with the environment, so use those if there are any
+  std::string use_env_allocators;
+  if (!new_pool->session_options_.config_options.TryGetConfigEntry(kOrtSessionOptionsConfigUseEnvAllocators,
+                                                                    use_env_allocators)) {
+    ORT_RETURN_IF_ERROR(new_pool->session_options_.config_options.AddConfigEntry(
+        kOrtSessionOptionsConfigUseEnvAllocators, "1"));
+  }
+
+  new_pool->sessions_.reserve(num_sessions);
+  new_pool->session_indices_.reserve(num_sessions);
+  new_pool->next_free_ = std::make_unique<std::atomic<uint32_t>[]>(num_sessions);
+  new_pool->in_use_ = std::make_unique<std::atomic<bool>[]>(num_sessions);
+  for (size_t i = 0; i < num_sessions; ++i) {
+    std::unique_ptr<InferenceSession> session;
+    ORT_RETURN_IF_ERROR(create_session_fn(new_pool->session_options_, new_pool->prepacked_weights_container_,
+                                          session));
+    ORT_RETURN_IF(session == nullptr, "Failed to create session ", i, " of the pool.");
+
+    const auto index = static_cast<uint32_t>(i);
+    new_pool->session_indices_.emplace(session.get(), index);
+    new_pool->sessions_.push_back(std::move(session));
+    new_pool->PushFree(index);
+  }
+
+  pool = new_pool.release();
+  return Status::OK();
+}
+
+Status SessionPool::LoadSharedInitializers(const ORTCHAR_T* model_path, gsl::span<const char> model_data) {
+#if !defined(ORT_MINIMAL_BUILD)
+  // read the initializers from a mapping of the file instead of a copy of it. they are parsed one at a time, so
+  // loading them doesn't need memory for a second copy of the model next to the one each replica loads.
+  Env::MappedMemoryPtr mapped_model;
+  if (model_data.empty() && model_path != nullptr) {
+    size_t file_length = 0;
+    ORT_RETURN_IF_ERROR(Env::Default().GetFileLength(model_path, file_length));
+    ORT_RETURN_IF_ERROR(Env::Default().MapFileIntoMemory(model_path, 0, file_length, mapped_model));
+    model_data = gsl::make_span(mapped_model.get(), file_length);
+  }
+
+  if (model_data.empty() ||
+      fbs::utils::IsOrtFormatModelBytes(model_data.data(), narrow<int>(model_data.size()))) {
+    // every replica will load its own initializers.
+    return Status::OK();
+  }
+
+  const auto model_bytes = gsl::make_span(reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size());
+  InlinedVector<std::string> names;
+  const auto status = Model::ForEachInitializer(
+      model_bytes, [this, model_path, &names](const ONNX_NAMESPACE::TensorProto& tensor_proto) -> Status {
+        // string tensors cannot live in a caller provided buffer, and an initializer given
+        // explicitly in the session options takes precedence
+        if (tensor_proto.data_type() == ONNX_NAMESPACE::TensorProto_DataType_STRING ||
+            session_options_.initializers_to_share_map.count(tensor_proto.name()) > 0) {
+          return Status::OK();
+        }
+
+        size_t size_in_bytes = 0;
+        ORT_RETURN_IF_ERROR(utils::GetSizeInBytesFromTensorProto<kAllocAlignment>(tensor_proto, &size_in_bytes));
+
+        auto buffer = IAllocator::MakeUniquePtr<void>(cpu_allocator_, size_in_bytes);
+        OrtValue value;
+        ORT_RETURN_IF_ERROR(utils::TensorProtoToMLValue(Env::Default(), model_path, tensor_proto,
+                                                        MemBuffer(buffer.get(), size_in_bytes,
+                                                                  cpu_allocator_->Info()),
+                                                        value));
+        initializer_buffers_.push_back(std::move(buffer));
+        shared_initializers_.push_back(std::move(value));
+        names.push_back(tensor_proto.name());
+        return Status::OK();
+      });
+
+  if (status.Code() == common::INVALID_PROTOBUF) {
+    // not an ONNX model. every replica will load its own initializers.
+    shared_initializers_.clear();
+    initializer_buffers_.clear();
+    return Status::OK();
+  }
+
+  ORT_RETURN_IF_ERROR(status);
+
+  // the session options refer to the values by pointer, so only add them once shared_initializers_ stops growing
+  for (size_t i = 0; i < names.size(); ++i) {
+    ORT_RETURN_IF_ERROR(session_options_.AddInitializer(names[i].c_str(), &shared_initializers_[i]));
+  }
+#else
+  // minimal builds only load ORT format models, whose initializers every replica loads itself.
+  ORT_UNUSED_PARAMETER(model_path);
+  ORT_UNUSED_PARAMETER(model_data);
+#endif
+
+  return Status::OK();
+}
+
+InferenceSession* SessionPool::TryAcquire() {
+  uint64_t head = free_list_head_.load(std::memory_order_acquire);
+  while (true) {
+    const auto first = static_cast<uint32_t>(head & kFreeListIndexMask);
+    if (first == 0) {
+      return nullptr;
+    }
+
+    const uint32_t next = next_free_[first - 1].load(std::memory_order_relaxed);
+    if (free_list_head_.compare_exchange_weak(head, MakeFreeListHead(head, next),
+                                              std::memory_order_acq_rel, std::memory_order_acquire)) {
+      in_use_[first - 1].store(true, std::memory_order_relaxed);
+      num_refs_.fetch_add(1, std::memory_order_relaxed);
+      return sessions_[first - 1].get();
+    }
+  }
+}
+
+Status SessionPool::Return(InferenceSession* session) {
+  auto it = session_indices_.find(session);
+  ORT_RETURN_IF(it == session_indices_.end(), "The session does not belong to this pool.");
+
+  bool in_use = true;
+  ORT_RETURN_IF_NOT(in_use_[it->second].compare_exchange_strong(in_use, false, std::memory_order_relaxed),
+                    "The session is not in use. It was already given back to the pool or never taken out of it.");
+  PushFree(it->second);
+  // may destroy the pool if it was released
+  Unref();
+  return Status::OK();
+}
+
+void SessionPool::Release(SessionPool* pool) {
+  if (pool != nullptr) {
+    pool->Unref();
+  }
+}
+
+void SessionPool::Unref() {
+  if (num_refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+size_t SessionPool::NumSessionsInUse() const {
+  size_t num_in_use = 0;
+  for (size_t i = 0; i < sessions_.size(); ++i) {
+    if (in_use_[i].load(std::memory_order_relaxed)) {
+      ++num_in_use;
+    }
+  }
+
+  return num_in_use;
+}
+
+void SessionPool::PushFree(uint32_t index) {
+  uint64_t head = free_list_head_.load(std::memory_order_relaxed);
+  do {
+    next_free_[index].store(static_cast<uint32_t>(head & kFreeListIndexMask), std::memory_order_relaxed);
+  } while (!free_list_head_.compare_exchange_weak(head, MakeFreeListHead(head, index + 1),
+                                                  std::memory_order_release, std::memory_order_relaxed));
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/status.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/prepacked_weights_container.h"
+#include "core/framework/session_options.h"
+
+namespace onnxruntime {
+
+class InferenceSession;
+
+/**
+ * A fixed set of InferenceSession replicas of one model that share their immutable state.
+ *
+ * The initializers of the main graph are deserialized once into buffers owned by the pool and handed to every
+ * replica through SessionOptions::AddInitializer, so the replicas and their pre-packed weights (which are cached in
+ * a PrepackedWeightsContainer owned by the pool) refer to the same memory. Replicas also use the allocators
+ * registered with the environment unless the session options say otherwise.
+ * What remains per replica is mainly the graph, the kernels and the activation memory.
+ *
+ * Idle replicas are kept in a lock-free free list. TryAcquire never blocks and returns nullptr if every replica
+ * is in use.
+ *
+ * The owner of the pool gives it up with Release. The pool is destroyed once the owner released it and every
+ * replica was given back, by whichever of the calls comes last.
+ */
+class SessionPool {
+ public:
+  // Creates, loads and initializes one replica. The replica must be created with `session_options` and
+  // must use `prepacked_weights_container`.
+  using CreateSessionFn = std::function<Status(const SessionOptions& session_options,
+                                               PrepackedWeightsContainer& prepacked_weights_container,
+                                               std::unique_ptr<InferenceSession>& session)>;
+
+  /**
+   * Create a pool of `num_sessions` replicas.
+   * @param session_options Options of the replicas. The pool adds the shared initializers to a copy of them.
+   * @param model_path Path of the model. Used to resolve external data, and to read the initializers from if
+   *                   `model_data` is empty. Can be nullptr.
+   * @param model_data Serialized ONNX model to read the initializers from. Can be empty.
+   *                   If the model is not an ONNX model (e.g. an ORT format model), the initializers are not shared.
+   * @param create_session_fn Function creating each replica.
+   * @param pool The pool. Must be given up with Release.
+   */
+  static Status Create(const SessionOptions& session_options, const ORTCHAR_T* model_path,
+                       gsl::span<const char> model_data, size_t num_sessions,
+                       const CreateSessionFn& create_session_fn, SessionPool*& pool);
+
+  /**
+   * Give up the pool. It is destroyed right away if no replica is in use. Otherwise the replicas in use stay valid
+   * and the pool is destroyed when the last of them is given back with Return, which is the only call allowed on
+   * the pool after Release.
+   */
+  static void Release(SessionPool* pool);
+
+  /**
+   * Take an idle replica out of the pool. Returns nullptr if all replicas are in use.
+   * The replica must be given back with Return.
+   */
+  InferenceSession* TryAcquire();
+
+  /**
+   * Give a replica obtained from TryAcquire back to the pool.
+   * Fails if the replica does not belong to the pool or is not in use.
+   */
+  Status Return(InferenceSession* session);
+
+  size_t NumSessions() const { return sessions_.size(); }
+
+  // Number of replicas taken out of the pool and not given back yet
+  size_t NumSessionsInUse() const;
+
+  // Number of initializers shared by the replicas
+  size_t NumSharedInitializers() const { return shared_initializers_.size(); }
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(SessionPool);
+
+  explicit SessionPool(const SessionOptions& session_options);
+
+  // the pool is destroyed by Release or Return
+  ~SessionPool();
+
+  // Drop a reference. Destroys the pool if it was the last one.
+  void Unref();
+
+  Status LoadSharedInitializers(const ORTCHAR_T* model_path, gsl::span<const char> model_data);
+
+  void PushFree(uint32_t index);
+
+  SessionOptions session_options_;
+
+  // the shared initializers must outlive the sessions, and the pre-packed weights
+  // container must outlive the kernels of the sessions using it.
+  AllocatorPtr cpu_allocator_;
+  std::vector<IAllocatorUniquePtr<void>> initializer_buffers_;
+  std::vector<OrtValue> shared_initializers_;
+  PrepackedWeightsContainer prepacked_weights_container_;
+
+  std::vector<std::unique_ptr<InferenceSession>> sessions_;
+  InlinedHashMap<const InferenceSession*, uint32_t> session_indices_;
+
+  // Treiber stack of idle sessions.
+  // The low 32 bits of free_list_head_ hold the index + 1 of the first idle session (0 if there is none) and the
+  // high 32 bits hold a tag that changes on every update so a compare-exchange cannot succeed on a stale head
+  // (ABA problem). next_free_[i] holds the index + 1 of the session after session i.
+  std::atomic<uint64_t> free_list_head_{0};
+  std::unique_ptr<std::atomic<uint32_t>[]> next_free_;
+
+  // in_use_[i] is set while session i is taken out of the pool. Return clears it with a compare-exchange so a
+  // session given back twice cannot be pushed onto the free list twice, which would make the list a cycle and hand
+  // the same session to two callers.
+  std::unique_ptr<std::atomic<bool>[]> in_use_;
+
+  // one reference for the owner until Release, and one for each replica in use
+  std::atomic<size_t> num_refs_{1};
+};
+
+}  // namespace onnxruntime
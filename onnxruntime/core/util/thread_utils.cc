@@ -71,9 +71,61 @@ static std::vector<LogicalProcessors> ReadThreadAffinityConfig(const std::string
 }
 #endif
 
+// Returns the number of physical cores of the logical processors, or the number of processors if the cores are not
+// known.
+static int CountPhysicalCores(Env* env, const LogicalProcessors& processors) {
+  int num_cores = 0;
+  for (const auto& core : env->GetDefaultThreadAffinities()) {
+    if (!core.empty() && std::find(processors.begin(), processors.end(), core.front()) != processors.end()) {
+      ++num_cores;
+    }
+  }
+  return num_cores > 0 ? num_cores : static_cast<int>(processors.size());
+}
+
 static std::unique_ptr<ThreadPool>
 CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
   ThreadOptions to;
+  if (options.numa_node >= 0) {
+    ORT_ENFORCE(options.affinity_str.empty(), "Thread affinities can't be combined with a NUMA node.");
+    auto numa_nodes = env->GetNumaNodes();
+    ORT_ENFORCE(static_cast<size_t>(options.numa_node) < numa_nodes.size() &&
+                    !numa_nodes[options.numa_node].empty(),
+                "NUMA node ", options.numa_node, " has no logical processors. Number of NUMA nodes: ",
+                numa_nodes.size());
+    const LogicalProcessors& node_processors = numa_nodes[options.numa_node];
+    if (options.thread_pool_size <= 0) {
+      // a thread per physical core of the node
+      options.thread_pool_size = CountPhysicalCores(env, node_processors);
+    }
+    // the threads may move between the processors of the node. the first entry is for the main thread, which
+    // isn't pinned.
+    to.affinities.assign(static_cast<size_t>(options.thread_pool_size), node_processors);
+  }
+  if (options.core_class != OrtCoreClass::kAll) {
+    ORT_ENFORCE(options.affinity_str.empty() && options.numa_node < 0,
+                "Thread affinities and NUMA nodes can't be combined with a class of cores.");
+    LogicalProcessors class_processors;
+    const auto capacities = env->GetProcessorCapacities();
+    for (int processor = 0, end = static_cast<int>(capacities.size()); processor < end; ++processor) {
+      if (capacities[processor] > 0 && IsEfficiencyProcessorCapacity(capacities[processor]) ==
+                                           (options.core_class == OrtCoreClass::kEfficiency)) {
+        class_processors.push_back(processor);
+      }
+    }
+
+    if (class_processors.empty()) {
+      LOGS_DEFAULT(INFO) << "The CPU doesn't have cores of different performance, so the threads are not pinned to "
+                         << "a class of cores.";
+    } else {
+      if (options.thread_pool_size <= 0) {
+        // a thread per physical core of the class
+        options.thread_pool_size = CountPhysicalCores(env, class_processors);
+      }
+      // as for a NUMA node, the main thread isn't pinned
+      to.affinities.assign(static_cast<size_t>(options.thread_pool_size), class_processors);
+    }
+  }
   if (options.thread_pool_size <= 0) {  // default
     auto default_affinities = Env::Default().GetDefaultThreadAffinities();
     if (default_affinities.size() <= 1) {
@@ -115,6 +167,7 @@ CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
   to.custom_thread_creation_options = options.custom_thread_creation_options;
   to.custom_join_thread_fn = options.custom_join_thread_fn;
   to.dynamic_block_base_ = options.dynamic_block_base_;
+  to.adaptive_spinning = options.adaptive_spinning;
   if (to.custom_create_thread_fn) {
     ORT_ENFORCE(to.custom_join_thread_fn, "custom join thread function not set");
   }
@@ -7,6 +7,13 @@
 #include <memory>
 #include <string>
 
+// The cores the threads of a pool run on, on CPUs with cores of different performance.
+enum class OrtCoreClass : uint8_t {
+  kAll,          // any core
+  kPerformance,  // the cores that are not efficiency cores
+  kEfficiency,   // the efficiency cores, e.g. for background work that leaves the faster cores to other work
+};
+
 struct OrtThreadPoolParams {
   // 0: Use default setting. (All the physical cores or half of the logical cores)
   // 1: Don't create thread pool
@@ -21,6 +28,10 @@ struct OrtThreadPoolParams {
   // If it is true, the thread pool will spin a while after the queue became empty.
   bool allow_spinning = true;
 
+  // If it is true, the thread pool spins for a duration learned from the recent gaps between tasks, rather than a
+  // fixed number of iterations. Only used if allow_spinning is true.
+  bool adaptive_spinning = false;
+
   // It it is non-negative, thread pool will split a task by a decreasing block size
   // of remaining_of_total_iterations / (num_of_threads * dynamic_block_base_)
   int dynamic_block_base_ = 0;
@@ -37,6 +48,16 @@ struct OrtThreadPoolParams {
   // meaning ith thread will be attached to first 8 logical processors
   std::string affinity_str;
 
+  // -1: Don't pin the threads to a NUMA node.
+  // n: Pin every thread to the logical processors of NUMA node n. If thread_pool_size is 0, the pool gets a thread
+  // per physical core of the node. Can't be combined with affinity_str.
+  int numa_node = -1;
+
+  // Pin every thread to the logical processors of a class of cores. If thread_pool_size is 0, the pool gets a thread
+  // per physical core of the class. Ignored if the CPU doesn't have cores of different performance. Can't be combined
+  // with affinity_str or numa_node.
+  OrtCoreClass core_class = OrtCoreClass::kAll;
+
   const ORTCHAR_T* name = nullptr;
 
   // Set or unset denormal as zero
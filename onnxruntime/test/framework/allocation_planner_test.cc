@@ -343,6 +343,14 @@ class PlannerTest : public ::testing::Test {
     EXPECT_EQ(plan_->allocation_plan[id].alloc_kind, kind) << "Error in allocation kind for " << name;
   }
 
+  void CheckReusedBuffer(const std::string& name, const std::string& reused_name) {
+    int id;
+    index(name, id);
+    int reused_id;
+    index(reused_name, reused_id);
+    EXPECT_EQ(plan_->allocation_plan[id].reused_buffer, reused_id) << "Error in reused buffer for " << name;
+  }
+
   void CheckFreed(int step_number, std::initializer_list<std::string> freed_items) {
     // TODO: add the checker for new implementation of release plan
     //// create set and check equality
@@ -500,6 +508,42 @@ TEST_F(PlannerTest, InPlaceTest) {
   CheckFreed(2, {X1});
 }
 
+TEST_F(PlannerTest, InPlaceSecondInputTest) {
+  // tensor variables:
+  std::string X1("X1"), X2("X2"), X3("X3"), X4("X4");
+
+  // a binary operator whose output may reuse either input, like Add
+  auto binary_in_place_kernel = KernelDefBuilder()
+                                    .SetName("Add")
+                                    .Provider(kCpuExecutionProvider)
+                                    .SinceVersion(7, 12)
+                                    .MayInplace(0, 0)
+                                    .MayInplace(1, 0)
+                                    .Build();
+
+  // graph structure:
+  AddNormalNode(X1, X2);  // no in-place operator; X1: input; X2: temporary
+  std::string node_name("add");
+  std::vector<onnxruntime::NodeArg*> add_inputs{Arg(X1), Arg(X2)};
+  std::vector<onnxruntime::NodeArg*> add_outputs{Arg(X3)};
+  AddNode(*binary_in_place_kernel, node_name, add_inputs, add_outputs);  // X3: temporary
+  AddNormalNode(X3, X4);                                                 // no in-place operator; X4: output
+
+  // simulate shape-inference results:
+  Shape shape1{"M", "N"};
+  auto shape = &shape1.value;
+  SetShape({{X1, shape}, {X2, shape}, {X3, shape}, {X4, shape}});
+
+  CreatePlan();
+
+  // X1 is a graph input and can't be overwritten, so X3 is computed in place of X2
+  CheckAllocKind(X1, AllocKind::kPreExisting);
+  CheckAllocKind(X2, AllocKind::kAllocate);
+  CheckAllocKind(X3, AllocKind::kReuse);
+  CheckAllocKind(X4, AllocKind::kAllocateOutput);
+  CheckReusedBuffer(X3, X2);
+}
+
 TEST_F(PlannerTest, ExternalOutputsTest) {
   // tensor variables:
   std::string X1("X1"), X2("X2"), X3("X3"), X4("X4");
@@ -2,6 +2,9 @@
 // Licensed under the MIT License.
 
 #include "core/framework/allocator.h"
+#include "core/framework/allocator_stats.h"
+#include "core/framework/huge_page_cpu_allocator.h"
+#include "core/framework/ring_buffer_allocator.h"
 
 #include "test_utils.h"
 #include "gtest/gtest.h"
@@ -109,5 +112,86 @@ TEST(AllocatorTest, TestOverflowChecks) {
   EXPECT_TRUE(IAllocator::CalcMemSizeForArrayWithAlignment<kAllocAlignment>(num_elements, element_size - (kAllocAlignment / num_elements), &size));
   EXPECT_FALSE(IAllocator::CalcMemSizeForArrayWithAlignment<kAllocAlignment>(num_elements, element_size, &size));
 }
+
+TEST(AllocatorTest, RingBufferAllocatorTest) {
+  alignas(64) uint8_t buffer[256];
+  RingBufferAllocator ring_buffer(buffer, sizeof(buffer), OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator));
+  ASSERT_EQ(ring_buffer.Capacity(), sizeof(buffer));
+
+  // slots are handed out in order and rounded up to 64 bytes
+  void* a = ring_buffer.Alloc(100);
+  void* b = ring_buffer.Alloc(64);
+  EXPECT_EQ(a, buffer);
+  EXPECT_EQ(b, buffer + 128);
+  EXPECT_EQ(ring_buffer.Alloc(128), nullptr);  // only 64 bytes left at the end
+
+  // freeing a slot that is not the oldest does not make room
+  ring_buffer.Free(b);
+  EXPECT_EQ(ring_buffer.Alloc(128), nullptr);
+
+  // once the oldest slot is freed the ring wraps around
+  void* c = ring_buffer.Alloc(64);
+  EXPECT_EQ(c, buffer + 192);
+  ring_buffer.Free(a);
+  void* d = ring_buffer.Alloc(128);
+  EXPECT_EQ(d, buffer);
+  // the only free range lies between d and c
+  void* e = ring_buffer.Alloc(1);
+  EXPECT_EQ(e, buffer + 128);
+  EXPECT_EQ(ring_buffer.Alloc(1), nullptr);
+
+  AllocatorStats stats;
+  ring_buffer.GetStats(&stats);
+  EXPECT_EQ(stats.num_allocs, 5);
+  EXPECT_EQ(stats.bytes_in_use, 256);
+  EXPECT_EQ(stats.max_bytes_in_use, 256);
+
+  ring_buffer.Free(c);
+  ring_buffer.Free(d);
+  ring_buffer.Free(e);
+
+  // pointers that are not live slots are ignored
+  uint8_t other;
+  ring_buffer.Free(&other);
+  ring_buffer.Free(e);
+  ring_buffer.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+
+  EXPECT_EQ(ring_buffer.Alloc(256), buffer);
+}
+
+TEST(AllocatorTest, HugePageCPUAllocatorTest) {
+  HugePageCPUAllocator allocator;
+  constexpr size_t large_size = 2 * HugePageCPUAllocator::kHugePageSize;
+
+  void* large = allocator.Alloc(large_size);
+  ASSERT_NE(large, nullptr);
+  // touch the memory so the kernel backs it
+  memset(large, 0, large_size);
+#ifdef __linux__
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % HugePageCPUAllocator::kHugePageSize, 0u);
+#endif
+
+  void* small = allocator.Alloc(64);
+  ASSERT_NE(small, nullptr);
+  memset(small, 0, 64);
+
+  // whether huge pages are available depends on the system, so only the bounds can be checked. the small allocation
+  // uses regular pages, and the large one is backed by whole huge pages, if any.
+  AllocatorStats stats;
+  allocator.GetStats(&stats);
+  EXPECT_LE(stats.huge_page_bytes, static_cast<int64_t>(large_size));
+#ifdef __linux__
+  EXPECT_EQ(stats.huge_page_bytes % static_cast<int64_t>(HugePageCPUAllocator::kHugePageSize), 0);
+#else
+  EXPECT_EQ(stats.huge_page_bytes, 0);
+#endif
+
+  allocator.Free(small);
+  allocator.Free(large);
+
+  allocator.GetStats(&stats);
+  EXPECT_EQ(stats.huge_page_bytes, 0);
+}
 }  // namespace test
 }  // namespace onnxruntime
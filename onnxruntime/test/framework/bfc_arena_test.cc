@@ -6,6 +6,8 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <cstdlib>
+#include <future>
+#include <thread>
 #include "core/framework/stream_handles.h"
 
 namespace onnxruntime {
@@ -303,6 +305,111 @@ TEST(BFCArenaTest, TestShrink) {
   EXPECT_EQ(stats.total_allocated_bytes, 10 * 1024 * 1024) << "Expect 10M bytes but actually " << stats.total_allocated_bytes << " bytes";
 }
 
+TEST(BFCArenaTest, TestPreGrowToPeak) {
+  AllocatorStats stats;
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, ArenaExtendStrategy::kSameAsRequested);
+  void* p1k = a.Alloc(1024);
+  void* p10M = a.Alloc(10 * 1024 * 1024);
+  a.Free(p1k);
+  a.Free(p10M);
+  EXPECT_EQ(a.Shrink(), Status::OK());
+
+  EXPECT_EQ(a.PreGrowToPeak(/*touch_pages*/ true), Status::OK());
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.total_allocated_bytes, stats.max_bytes_in_use) << "Expect the arena to hold the peak usage again";
+  const auto num_arena_extensions = stats.num_arena_extensions;
+
+  p10M = a.Alloc(10 * 1024 * 1024);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_arena_extensions, num_arena_extensions) << "Expect no extension after pre-growing";
+  a.Free(p10M);
+}
+
+TEST(BFCArenaTest, TestThreadCache) {
+  AllocatorStats stats;
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, ArenaExtendStrategy::kSameAsRequested,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+             /*max_thread_cache_bytes*/ 4096);
+
+  void* p1 = a.Alloc(1000);
+  a.Free(p1);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.thread_cache_bytes, 1024) << "Expect the freed chunk to be cached";
+  EXPECT_EQ(stats.bytes_in_use, 1024) << "Cached chunks count as in use";
+
+  // same size class
+  void* p2 = a.Alloc(900);
+  EXPECT_EQ(p2, p1);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_thread_cache_hits, 1);
+  EXPECT_EQ(stats.num_thread_cache_misses, 1);
+  EXPECT_EQ(stats.thread_cache_bytes, 0);
+  EXPECT_EQ(stats.num_allocs, 2);
+
+  // larger than the cache, so it's never cached
+  void* p8k = a.Alloc(8192);
+  a.Free(p8k);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_thread_cache_misses, 1);
+  EXPECT_EQ(stats.thread_cache_bytes, 0);
+
+  // a chunk goes to the cache of the thread that frees it, which is returned to the arena when the thread exits
+  std::thread([&a, p2]() {
+    a.Free(p2);
+    AllocatorStats thread_stats;
+    a.GetStats(&thread_stats);
+    EXPECT_EQ(thread_stats.thread_cache_bytes, 1024);
+  }).join();
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.thread_cache_bytes, 0) << "Expect the cache of an exited thread to be returned to the arena";
+  EXPECT_EQ(stats.bytes_in_use, 0);
+
+  void* p3 = a.Alloc(1000);
+  a.Free(p3);
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_thread_cache_misses, 2);
+  EXPECT_EQ(stats.thread_cache_bytes, 1024);
+
+  // done at the end of a run
+  a.FlushThreadCache();
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.thread_cache_bytes, 0);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+
+  void* p4 = a.Alloc(1000);
+  a.Free(p4);
+  EXPECT_EQ(a.Shrink(), Status::OK());
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.thread_cache_bytes, 0) << "Expect shrinking to flush the thread caches";
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+TEST(BFCArenaTest, TestThreadCacheOutlivingArena) {
+  auto a = std::make_unique<BFCArena>(
+      std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, ArenaExtendStrategy::kSameAsRequested,
+      BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+      BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+      /*max_thread_cache_bytes*/ 4096);
+
+  std::promise<void> cached;
+  std::promise<void> arena_destroyed;
+  std::thread thread([&a, &cached, &arena_destroyed]() {
+    a->Free(a->Alloc(1000));
+    cached.set_value();
+    // the thread exits after the arena is gone and must not return its cache to it
+    arena_destroyed.get_future().wait();
+  });
+
+  cached.get_future().wait();
+  AllocatorStats stats;
+  a->GetStats(&stats);
+  EXPECT_EQ(stats.thread_cache_bytes, 1024);
+  a.reset();
+  arena_destroyed.set_value();
+  thread.join();
+}
+
 class BadAllocator : public IAllocator {
  public:
   BadAllocator() : IAllocator(OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator)) {}
@@ -8,6 +8,7 @@
 #include "core/graph/model.h"
 #include "core/providers/cpu/cpu_execution_provider.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test_utils.h"
 #include "test/test_environment.h"
 #include "test/framework/TestAllocatorManager.h"
@@ -330,6 +331,107 @@ TEST_F(ExecutionFrameTest, MemPatternTest) {
   ASSERT_EQ(p->GetBlock(4)->offset_, kAllocAlignment);
 }
 
+TEST_F(ExecutionFrameTest, MemPatternBufferReuseTest) {
+  auto cpu_xp = CreateCPUExecutionProvider();
+  auto xp_type = cpu_xp->Type();
+  std::unordered_map<std::string, int> domain_to_version;
+  domain_to_version[onnxruntime::kOnnxDomain] = 7;
+  onnxruntime::Model model("test", true, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           domain_to_version, {}, DefaultLoggingManager().DefaultLogger());
+  onnxruntime::Graph& graph = model.MainGraph();
+  TypeProto tensor_float;
+  tensor_float.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  onnxruntime::NodeArg input_def1("X1", &tensor_float),
+      input_def2("X2", &tensor_float),
+      gemm_out_def("T1", &tensor_float),
+      clip_out_def("T2", &tensor_float);
+
+  graph.AddNode("node1", "MatMul", "gemm1", ArgMap{&input_def1, &input_def2}, ArgMap{&gemm_out_def})
+      .SetExecutionProviderType(xp_type);
+  graph.AddNode("node2", "Clip", "clip1", ArgMap{&gemm_out_def}, ArgMap{&clip_out_def})
+      .SetExecutionProviderType(xp_type);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  KernelRegistryManager kernel_registry_manager;
+
+  ExecutionProviders execution_providers;
+  ASSERT_STATUS_OK(execution_providers.Add(xp_type, std::move(cpu_xp)));
+  ASSERT_STATUS_OK(kernel_registry_manager.RegisterKernels(execution_providers));
+
+  DataTransferManager dtm;
+  profiling::Profiler profiler;
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  ASSERT_STATUS_OK(sess_options.config_options.AddConfigEntry(kOrtSessionOptionsConfigMemoryPatternReuseBuffers, "1"));
+
+  SessionState state(graph, execution_providers, &tp_, nullptr, dtm,
+                     DefaultLoggingManager().DefaultLogger(), profiler, sess_options);
+
+  ASSERT_STATUS_OK(state.FinalizeSessionState(ORT_TSTR(""), kernel_registry_manager));
+  ASSERT_TRUE(state.GetReuseMemoryPatternBuffers());
+
+  const OrtValueNameIdxMap& mlvalue_name_idx_map(state.GetOrtValueNameIdxMap());
+
+  int x1_idx = -1, x2_idx = -1, t1_idx = -1, t2_idx = -1;
+  ASSERT_TRUE(mlvalue_name_idx_map.GetIdx("X1", x1_idx).IsOK());
+  ASSERT_TRUE(mlvalue_name_idx_map.GetIdx("X2", x2_idx).IsOK());
+  ASSERT_TRUE(mlvalue_name_idx_map.GetIdx("T1", t1_idx).IsOK());
+  ASSERT_TRUE(mlvalue_name_idx_map.GetIdx("T2", t2_idx).IsOK());
+
+  auto cpu_allocator = execution_providers.Get(xp_type)->CreatePreferredAllocators()[0];
+
+  OrtValue v1, v2;
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{1, 2}, std::vector<float>{1.0f, 1.0f}, &v1);
+  CreateMLValue<float>(cpu_allocator, std::vector<int64_t>{2, 2}, std::vector<float>(4, 1.0f), &v2);
+  const std::vector<int> feed_idxs{x1_idx, x2_idx};
+  const std::vector<OrtValue> feeds{v1, v2};
+
+  // allocates T1 in a frame and returns its buffer
+  auto allocate_t1 = [&](ExecutionFrame& frame) -> const void* {
+    OrtValue& t1 = *frame.GetMutableNodeInputOrOutputMLValue(t1_idx);
+    EXPECT_STATUS_OK(frame.AllocateMLValueTensorSelfOwnBuffer(t1, t1_idx, DataTypeImpl::GetType<float>(),
+                                                              cpu_allocator->Info().device,
+                                                              TensorShape(std::vector<int64_t>{1, 2})));
+    return t1.Get<Tensor>().DataRaw();
+  };
+
+  {
+    // trace the memory pattern
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(feed_idxs, feeds, AsSpan({t2_idx}), outputs, {}, {}, state);
+    allocate_t1(frame);
+    MemoryPatternGroup pattern;
+    ASSERT_STATUS_OK(frame.GeneratePatterns(pattern));
+    ASSERT_STATUS_OK(state.UpdateMemoryPatternGroupCache(feeds, feed_idxs, std::move(pattern)));
+  }
+
+  const void* first_buffer = nullptr;
+  {
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(feed_idxs, feeds, AsSpan({t2_idx}), outputs, {}, {}, state);
+    first_buffer = allocate_t1(frame);
+  }
+  EXPECT_EQ(state.GetMemoryPatternCacheStats().buffer_reuses, 0u);
+
+  {
+    std::vector<OrtValue> outputs;
+    ExecutionFrame frame(feed_idxs, feeds, AsSpan({t2_idx}), outputs, {}, {}, state);
+    EXPECT_EQ(allocate_t1(frame), first_buffer);
+    EXPECT_EQ(state.GetMemoryPatternCacheStats().buffer_reuses, 1u);
+
+    // a concurrent run allocates its own buffer
+    std::vector<OrtValue> concurrent_outputs;
+    ExecutionFrame concurrent_frame(feed_idxs, feeds, AsSpan({t2_idx}), concurrent_outputs, {}, {}, state);
+    EXPECT_NE(allocate_t1(concurrent_frame), first_buffer);
+    EXPECT_EQ(state.GetMemoryPatternCacheStats().buffer_reuses, 1u);
+  }
+}
+
 #ifdef ENABLE_TRAINING
 TEST_F(ExecutionFrameTest, MemPatternWithExternalOutputsTest) {
   auto cpu_xp = CreateCPUExecutionProvider();
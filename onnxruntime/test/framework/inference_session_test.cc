@@ -5,9 +5,14 @@
 #include "core/session/inference_session.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <cmath>
+#include <condition_variable>
 #include <functional>
 #include <iterator>
+#include <mutex>
+#include <numeric>
 #include <thread>
 #include <fstream>
 
@@ -18,11 +23,13 @@
 #include "core/common/profiler.h"
 #include "core/framework/compute_capability.h"
 #include "core/framework/data_transfer_manager.h"
+#include "core/framework/device_stream_collection.h"
 #include "core/framework/execution_provider.h"
 #include "core/framework/kernel_registry.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/session_state.h"
 #include "core/framework/tensorprotoutils.h"
+#include "core/framework/utils.h"
 #include "core/framework/bfc_arena.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -42,11 +49,14 @@
 #include "core/providers/rocm/rocm_provider_factory.h"
 #include "core/providers/rocm/gpu_data_transfer.h"
 #endif
+#include "core/session/dynamic_batcher.h"
 #include "core/session/environment.h"
 #include "core/session/IOBinding.h"
 #include "core/session/inference_session_utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/session/onnxruntime_run_options_config_keys.h"
+#include "core/session/ort_apis.h"
+#include "core/session/prepared_run.h"
 #include "dummy_provider.h"
 #include "test_utils.h"
 #include "test/capturing_sink.h"
@@ -55,6 +65,7 @@
 #include "test/optimizer/dummy_graph_transformer.h"
 #include "test/util/include/default_providers.h"
 #include "test/util/include/inference_session_wrapper.h"
+#include "test/util/include/temp_dir.h"
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -2609,6 +2620,50 @@ TEST(InferenceSessionTests, InvalidSessionEnvCombination) {
   }
 }
 
+// a NUMA node requires per session threadpools, and must be -1 or a node index
+TEST(InferenceSessionTests, InvalidNumaNode) {
+  auto logging_manager = std::make_unique<logging::LoggingManager>(
+      std::unique_ptr<ISink>(new CLogSink()), logging::Severity::kVERBOSE, false,
+      LoggingManager::InstanceType::Temporal);
+
+  std::unique_ptr<Environment> env;
+  OrtThreadingOptions tp_options;
+  auto st = Environment::Create(std::move(logging_manager), env, &tp_options, true /*create_global_thread_pools*/);
+  ASSERT_TRUE(st.IsOK());
+
+  auto expect_error = [&env](const SessionOptions& so, const std::string& expected) {
+    bool threw = false;
+    ORT_TRY {
+      InferenceSessionTestGlobalThreadPools session_object{so, *env.get()};
+    }
+    ORT_CATCH(const std::exception& e) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        threw = true;
+        EXPECT_THAT(e.what(), testing::HasSubstr(expected));
+      });
+    }
+    EXPECT_TRUE(threw);
+  };
+
+  SessionOptions so;
+  so.session_logid = "InvalidNumaNode";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigNumaNode, "-2"));
+  expect_error(so, "Invalid value for session.numa_node: -2");
+
+  SessionOptions global_so;
+  global_so.session_logid = "InvalidNumaNode";
+  global_so.use_per_session_threads = false;
+  ASSERT_STATUS_OK(global_so.config_options.AddConfigEntry(kOrtSessionOptionsConfigNumaNode, "0"));
+  expect_error(global_so, "session.numa_node requires per session threadpools");
+
+  SessionOptions core_class_so;
+  core_class_so.session_logid = "InvalidNumaNode";
+  core_class_so.use_per_session_threads = false;
+  ASSERT_STATUS_OK(core_class_so.config_options.AddConfigEntry(kOrtSessionOptionsConfigIntraOpCoreClass,
+                                                               "efficiency"));
+  expect_error(core_class_so, "session.intra_op.core_class requires per session threadpools");
+}
+
 // Tests for sharing allocators between sessions
 class InferenceSessionTestSharingAllocator : public InferenceSessionWrapper {
  public:
@@ -2955,5 +3010,936 @@ TEST(InferenceSessionTests, InterThreadPoolWithDenormalAsZero) {
   VerifyThreadPoolWithDenormalAsZero(session2.GetInterOpThreadPoolToUse(), false);
 }
 
+TEST(InferenceSessionTests, DynamicBatchingOfConcurrentRuns) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.DynamicBatchingOfConcurrentRuns";
+  constexpr int kNumRequests = 4;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize,
+                                                    std::to_string(kNumRequests).c_str()));
+  // long enough for all the requests to join the first batch
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingTimeoutMicros,
+                                                    "5000000"));
+
+  InferenceSession session{so, GetEnvironment()};
+  // A has shape [M, 2] with dynamic M, Y = MatMul(A, B) with B = [[0, 1, 2, 3], [4, 5, 6, 7]]
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  std::vector<Status> statuses(kNumRequests);
+  std::vector<OrtValue*> outputs(kNumRequests, nullptr);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumRequests; ++i) {
+    threads.emplace_back([&, i]() {
+      // request i has i + 1 rows of [i, 1]
+      const int64_t rows = i + 1;
+      std::vector<float> values;
+      for (int64_t r = 0; r < rows; ++r) {
+        values.push_back(static_cast<float>(i));
+        values.push_back(1.f);
+      }
+      OrtValue input;
+      CreateMLValue<float>(cpu_allocator, {rows, 2}, values, &input);
+
+      const char* const input_names[] = {"A"};
+      const OrtValue* const inputs[] = {&input};
+      const char* const output_names[] = {"Y"};
+      RunOptions run_options;
+      statuses[i] = session.Run(run_options, input_names, inputs, output_names,
+                                gsl::make_span(&outputs[i], 1));
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumRequests; ++i) {
+    ASSERT_STATUS_OK(statuses[i]);
+    ASSERT_NE(outputs[i], nullptr);
+    std::unique_ptr<OrtValue> output{outputs[i]};
+    const float a = static_cast<float>(i);
+    std::vector<float> expected_row = {4.f, a + 5.f, 2.f * a + 6.f, 3.f * a + 7.f};
+    std::vector<float> expected_values;
+    for (int r = 0; r <= i; ++r) {
+      expected_values.insert(expected_values.end(), expected_row.begin(), expected_row.end());
+    }
+    VerifyOutputs(output->Get<Tensor>(), {i + 1, 4}, expected_values);
+  }
+}
+
+TEST(InferenceSessionTests, DynamicBatchingFallsBackForPreallocatedOutputs) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.DynamicBatchingFallsBackForPreallocatedOutputs";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize, "8"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  OrtValue input;
+  CreateMLValue<float>(cpu_allocator, {1, 2}, {1.f, 2.f}, &input);
+  OrtValue output;
+  AllocateMLValue<float>(cpu_allocator, {1, 4}, &output);
+
+  const char* const input_names[] = {"A"};
+  const OrtValue* const inputs[] = {&input};
+  const char* const output_names[] = {"Y"};
+  OrtValue* outputs[] = {&output};
+  RunOptions run_options;
+  ASSERT_STATUS_OK(session.Run(run_options, input_names, inputs, output_names, outputs));
+  VerifyOutputs(output.Get<Tensor>(), {1, 4}, {8.f, 11.f, 14.f, 17.f});
+}
+
+TEST(InferenceSessionTests, DynamicBatchingFailsAllRequestsOfAFailedBatch) {
+  std::atomic<int> num_runs{0};
+  DynamicBatcher::Deadline batch_deadline;
+  auto run_fn = [&](const RunOptions&, const DynamicBatcher::Deadline& deadline, gsl::span<const std::string>,
+                    gsl::span<const OrtValue>, gsl::span<const std::string>, std::vector<OrtValue>*) {
+    ++num_runs;
+    batch_deadline = deadline;
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "model error");
+  };
+
+  DynamicBatcher::Options options;
+  options.max_batch_size = 2;
+  // long enough for both requests to join the first batch
+  options.timeout = std::chrono::seconds(5);
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  DynamicBatcher batcher{options, run_fn, cpu_allocator};
+
+  const auto now = std::chrono::steady_clock::now();
+  const std::vector<DynamicBatcher::Deadline> deadlines{now + std::chrono::hours(2), now + std::chrono::hours(1)};
+  std::vector<Status> statuses(deadlines.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < deadlines.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      std::vector<OrtValue> feeds(1);
+      CreateMLValue<float>(cpu_allocator, {1, 2}, {1.f, 2.f}, &feeds[0]);
+      const std::vector<std::string> feed_names{"A"};
+      const std::vector<std::string> output_names{"Y"};
+      std::vector<OrtValue> fetches;
+      RunOptions run_options;
+      statuses[i] = batcher.Run(run_options, deadlines[i], feed_names, feeds, output_names, fetches);
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // the batch is not retried request by request, and it runs with the earliest deadline
+  EXPECT_EQ(num_runs, 1);
+  EXPECT_EQ(batch_deadline, deadlines[1]);
+  for (const auto& status : statuses) {
+    ASSERT_FALSE(status.IsOK());
+    EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("model error"));
+  }
+}
+
+TEST(InferenceSessionTests, DynamicBatchingRequiresASymbolicBatchAxis) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.DynamicBatchingRequiresASymbolicBatchAxis";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingMaxBatchSize, "8"));
+
+  // axis 1 of A is fixed to 2
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingBatchAxis, "1"));
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_NOT_OK_AND_HAS_SUBSTR(session.Initialize(), "is not a symbolic dimension");
+
+  // every dimension of the inputs and outputs is fixed
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigDynamicBatchingBatchAxis, "0"));
+  InferenceSession fixed_session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(fixed_session.Load(ORT_TSTR("testdata/mul_1.onnx")));
+  ASSERT_STATUS_NOT_OK_AND_HAS_SUBSTR(fixed_session.Initialize(), "is not a symbolic dimension");
+}
+
+TEST(InferenceSessionTests, MemoryPatternCacheWithShapeBuckets) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.MemoryPatternCacheWithShapeBuckets";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigMemoryPatternBucketDims, "M"));
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigMemoryPatternCacheMaxEntries, "1"));
+
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const std::vector<std::string> feed_names{"A"};
+  const std::vector<std::string> output_names{"Y"};
+  auto run = [&](int64_t rows) {
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(cpu_allocator, {rows, 2}, std::vector<float>(static_cast<size_t>(rows * 2), 1.f), &feeds[0]);
+    std::vector<float> expected;
+    for (int64_t r = 0; r < rows; ++r) {
+      expected.insert(expected.end(), {4.f, 6.f, 8.f, 10.f});
+    }
+
+    std::vector<OrtValue> fetches;
+    RunOptions run_options;
+    ASSERT_STATUS_OK(session.Run(run_options, feed_names, feeds, output_names, &fetches));
+    VerifyOutputs(fetches[0].Get<Tensor>(), {rows, 4}, expected);
+  };
+
+  const auto& session_state = session.GetSessionState();
+  run(3);  // miss, the pattern traced for 3 rows is cached for the bucket of 4 rows
+  run(4);  // miss as the pattern is too small, replaced by the one traced for 4 rows
+  run(4);  // hit
+  run(3);  // hit, fits in the pattern for 4 rows
+  auto stats = session_state.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.num_entries, 1u);
+
+  run(2);  // miss in the bucket of 2 rows, which evicts the bucket of 4 rows
+  stats = session_state.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.num_entries, 1u);
+}
+
+// The patterns of shapes of a bucket that don't fit in each other are all kept
+TEST(InferenceSessionTests, MemoryPatternCacheKeepsPatternsOfBucket) {
+  onnxruntime::Model model("two_symbolic_dims", false, ModelMetaData(), PathString(),
+                           IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                           DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("M");
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N");
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& abs_out = graph.GetOrCreateNodeArg("abs_out", &float_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("abs", "Abs", "", {&x}, {&abs_out});
+  graph.AddNode("neg", "Neg", "", {&abs_out}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  std::stringstream model_stream(model_data);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.MemoryPatternCacheKeepsPatternsOfBucket";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigMemoryPatternBucketDims, "M,N"));
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(model_stream));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+  auto run = [&](int64_t rows, int64_t cols) {
+    const size_t size = static_cast<size_t>(rows * cols);
+    std::vector<OrtValue> feeds(1);
+    CreateMLValue<float>(cpu_allocator, {rows, cols}, std::vector<float>(size, 2.f), &feeds[0]);
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+    VerifyOutputs(fetches[0].Get<Tensor>(), {rows, cols}, std::vector<float>(size, -2.f));
+  };
+
+  // all the shapes are in the bucket of {4, 4}
+  const auto& session_state = session.GetSessionState();
+  run(3, 4);  // miss
+  run(4, 3);  // miss, as {4, 3} doesn't fit in {3, 4}. both patterns are kept.
+  run(3, 4);  // hit
+  run(4, 3);  // hit
+  run(3, 3);  // hit, fits in both
+  auto stats = session_state.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.hits, 3u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.num_entries, 1u);
+
+  run(4, 4);  // miss, the pattern replaces the others of the bucket
+  run(3, 4);  // hit
+  run(4, 3);  // hit
+  stats = session_state.GetMemoryPatternCacheStats();
+  EXPECT_EQ(stats.hits, 5u);
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.num_entries, 1u);
+}
+
+// Add with a broadcast second input, Sign and LayerNormalization compute their output in place of their first input,
+// so a chain of them needs a single buffer.
+TEST(InferenceSessionTests, InplaceElementwiseChain) {
+  constexpr int64_t rows = 4;
+  constexpr int64_t cols = 64;
+  onnxruntime::Model model("inplace_chain", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           {{kOnnxDomain, 17}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto matrix_type;
+  matrix_type.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  matrix_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(rows);
+  matrix_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(cols);
+  ONNX_NAMESPACE::TypeProto row_type;
+  row_type.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  row_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(cols);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &matrix_type);
+  auto& b = graph.GetOrCreateNodeArg("B", &row_type);
+  auto& scale = graph.GetOrCreateNodeArg("scale", &row_type);
+  auto& bias = graph.GetOrCreateNodeArg("bias", &row_type);
+  auto& abs_out = graph.GetOrCreateNodeArg("abs_out", &matrix_type);
+  auto& add_out = graph.GetOrCreateNodeArg("add_out", &matrix_type);
+  auto& sign_out = graph.GetOrCreateNodeArg("sign_out", &matrix_type);
+  auto& norm_out = graph.GetOrCreateNodeArg("norm_out", &matrix_type);
+  auto& y = graph.GetOrCreateNodeArg("Y", &matrix_type);
+  // the graph input can't be overwritten, so the chain starts with the output of Abs
+  graph.AddNode("abs", "Abs", "", {&x}, {&abs_out});
+  graph.AddNode("add", "Add", "", {&abs_out, &b}, {&add_out});
+  graph.AddNode("sign", "Sign", "", {&add_out}, {&sign_out});
+  graph.AddNode("norm", "LayerNormalization", "", {&sign_out, &scale, &bias}, {&norm_out});
+  graph.AddNode("neg", "Neg", "", {&norm_out}, {&y});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  std::stringstream model_stream(model_data);
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.InplaceElementwiseChain";
+  so.graph_optimization_level = TransformerLevel::Default;
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(model_stream));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  // each intermediate value reuses the buffer of the value it's computed from
+  const auto& session_state = session.GetSessionState();
+  const auto& name_idx_map = session_state.GetOrtValueNameIdxMap();
+  const auto& allocation_plan = session_state.GetExecutionPlan()->allocation_plan;
+  int abs_out_idx = -1;
+  ASSERT_STATUS_OK(name_idx_map.GetIdx("abs_out", abs_out_idx));
+  EXPECT_EQ(allocation_plan[abs_out_idx].alloc_kind, AllocKind::kAllocate);
+  for (const char* name : {"add_out", "sign_out", "norm_out"}) {
+    int idx = -1;
+    ASSERT_STATUS_OK(name_idx_map.GetIdx(name, idx));
+    EXPECT_EQ(allocation_plan[idx].alloc_kind, AllocKind::kReuse) << name;
+    EXPECT_EQ(allocation_plan[idx].reused_buffer, abs_out_idx) << name;
+  }
+
+  std::vector<float> x_values(static_cast<size_t>(rows * cols));
+  std::vector<float> b_values(static_cast<size_t>(cols));
+  std::vector<float> scale_values(static_cast<size_t>(cols));
+  std::vector<float> bias_values(static_cast<size_t>(cols));
+  for (int64_t i = 0; i < rows * cols; ++i) {
+    x_values[i] = static_cast<float>(i % 7) - 3.f;
+  }
+  for (int64_t j = 0; j < cols; ++j) {
+    b_values[j] = static_cast<float>(j % 5) - 2.5f;
+    scale_values[j] = 1.f + 0.25f * static_cast<float>(j % 4);
+    bias_values[j] = 0.5f * static_cast<float>(j % 3);
+  }
+
+  std::vector<float> expected(x_values.size());
+  for (int64_t r = 0; r < rows; ++r) {
+    std::vector<float> signs(static_cast<size_t>(cols));
+    float mean = 0.f;
+    for (int64_t j = 0; j < cols; ++j) {
+      const float sum = std::abs(x_values[r * cols + j]) + b_values[j];
+      signs[j] = static_cast<float>((sum > 0.f) - (sum < 0.f));
+      mean += signs[j] / cols;
+    }
+    float variance = 0.f;
+    for (int64_t j = 0; j < cols; ++j) {
+      variance += (signs[j] - mean) * (signs[j] - mean) / cols;
+    }
+    for (int64_t j = 0; j < cols; ++j) {
+      expected[r * cols + j] = -((signs[j] - mean) / std::sqrt(variance + 1e-5f) * scale_values[j] + bias_values[j]);
+    }
+  }
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const std::vector<std::string> feed_names{"X", "B", "scale", "bias"};
+  std::vector<OrtValue> feeds(4);
+  CreateMLValue<float>(cpu_allocator, {rows, cols}, x_values, &feeds[0]);
+  CreateMLValue<float>(cpu_allocator, {cols}, b_values, &feeds[1]);
+  CreateMLValue<float>(cpu_allocator, {cols}, scale_values, &feeds[2]);
+  CreateMLValue<float>(cpu_allocator, {cols}, bias_values, &feeds[3]);
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session.Run(RunOptions(), feed_names, feeds, output_names, &fetches));
+  ASSERT_EQ(fetches.size(), 1u);
+  auto output = fetches[0].Get<Tensor>().DataAsSpan<float>();
+  ASSERT_EQ(output.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(output[i], expected[i], 1e-4f) << "at " << i;
+  }
+
+  // the planned peak is the one intermediate buffer. computed out of place, the input and the output of each node
+  // would be live at the same time.
+  InlinedVector<int> feed_idxs(feed_names.size());
+  for (size_t i = 0; i < feed_names.size(); ++i) {
+    ASSERT_STATUS_OK(name_idx_map.GetIdx(feed_names[i], feed_idxs[i]));
+  }
+  const size_t buffer_size = static_cast<size_t>(rows * cols) * sizeof(float);
+  const size_t peak_size = session_state.GetMemoryPatternPeakSize(feeds, feed_idxs);
+  EXPECT_GE(peak_size, buffer_size);
+  EXPECT_LT(peak_size, 2 * buffer_size);
+}
+
+TEST(InferenceSessionTests, IOBindingOutputToRingBuffer) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.IOBindingOutputToRingBuffer";
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  alignas(64) uint8_t buffer[1024];
+  auto ring_buffer = std::make_shared<RingBufferAllocator>(buffer, sizeof(buffer),
+                                                           OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator));
+
+  unique_ptr<IOBinding> io_binding;
+  ASSERT_STATUS_OK(session.NewIOBinding(&io_binding));
+  ASSERT_STATUS_OK(io_binding->BindOutput("Y", ring_buffer));
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  auto run = [&](int64_t rows, OrtValue& output) {
+    OrtValue input;
+    CreateMLValue<float>(cpu_allocator, {rows, 2}, std::vector<float>(static_cast<size_t>(rows * 2), 1.f), &input);
+    ASSERT_STATUS_OK(io_binding->BindInput("A", input));
+    ASSERT_STATUS_OK(session.Run(*io_binding));
+
+    output = io_binding->GetOutputs()[0];
+    std::vector<float> expected;
+    for (int64_t r = 0; r < rows; ++r) {
+      expected.insert(expected.end(), {4.f, 6.f, 8.f, 10.f});
+    }
+    VerifyOutputs(output.Get<Tensor>(), {rows, 4}, expected);
+  };
+
+  // every run places the output in the next slot. 3 x 4 floats take one slot of 64 bytes.
+  OrtValue output1;
+  OrtValue output2;
+  run(3, output1);
+  run(5, output2);
+  EXPECT_EQ(output1.Get<Tensor>().DataRaw(), buffer);
+  EXPECT_EQ(output2.Get<Tensor>().DataRaw(), buffer + 64);
+
+  AllocatorStats stats;
+  ring_buffer->GetStats(&stats);
+  EXPECT_EQ(stats.num_allocs, 2);
+  EXPECT_EQ(stats.bytes_in_use, 64 + 128);
+
+  // the slots are returned once the caller releases the outputs
+  output1 = OrtValue();
+  output2 = OrtValue();
+  io_binding->ClearOutputs();
+  ring_buffer->GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+}
+
+TEST(InferenceSessionTests, PipelinedRunAsync) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.PipelinedRunAsync";
+  so.intra_op_param.thread_pool_size = 2;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigPipelinedExecutionNumStages, "2"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  struct Request {
+    OrtValue input;
+    OrtValue* output = nullptr;
+    std::string error;
+    bool done = false;
+    std::mutex* mutex;
+    std::condition_variable* cv;
+  };
+
+  constexpr int kNumRequests = 8;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<Request> requests(kNumRequests);
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const char* const input_names[] = {"A"};
+  const char* const output_names[] = {"Y"};
+  RunOptions run_options;
+  for (int i = 0; i < kNumRequests; ++i) {
+    auto& request = requests[i];
+    request.mutex = &mutex;
+    request.cv = &cv;
+    const int64_t rows = i + 1;
+    CreateMLValue<float>(cpu_allocator, {rows, 2}, std::vector<float>(static_cast<size_t>(rows * 2), 1.f),
+                         &request.input);
+    const OrtValue* const inputs[] = {&request.input};
+    auto callback = [](void* user_data, OrtValue** outputs, size_t num_outputs, OrtStatusPtr status) {
+      auto* request = static_cast<Request*>(user_data);
+      std::lock_guard<std::mutex> lock(*request->mutex);
+      if (status != nullptr) {
+        request->error = OrtApis::GetErrorMessage(status);
+        OrtApis::ReleaseStatus(status);
+      } else if (num_outputs != 1) {
+        request->error = "unexpected number of outputs";
+      } else {
+        request->output = outputs[0];
+      }
+      request->done = true;
+      request->cv->notify_all();
+    };
+    ASSERT_STATUS_OK(session.RunAsync(&run_options, input_names, inputs, output_names,
+                                      gsl::make_span(&request.output, 1), callback, &request));
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() {
+      return std::all_of(requests.begin(), requests.end(), [](const Request& request) { return request.done; });
+    });
+  }
+
+  for (int i = 0; i < kNumRequests; ++i) {
+    auto& request = requests[i];
+    ASSERT_EQ(request.error, "");
+    ASSERT_NE(request.output, nullptr);
+    std::unique_ptr<OrtValue> output{request.output};
+    std::vector<float> expected;
+    for (int r = 0; r <= i; ++r) {
+      expected.insert(expected.end(), {4.f, 6.f, 8.f, 10.f});
+    }
+    VerifyOutputs(output->Get<Tensor>(), {i + 1, 4}, expected);
+  }
+}
+
+TEST(InferenceSessionTests, WarmUpDuringInitialize) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.WarmUpDuringInitialize";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigWarmUpInputShapes, "A:1x2;A:4x2"));
+
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+  EXPECT_GT(session.GetWarmUpDuration().count(), 0);
+
+  // the memory patterns of the warm-up shapes are cached
+  const auto& session_state = session.GetSessionState();
+  EXPECT_EQ(session_state.GetMemoryPatternCacheStats().num_entries, 2u);
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  std::vector<OrtValue> feeds(1);
+  CreateMLValue<float>(cpu_allocator, {4, 2}, std::vector<float>(8, 1.f), &feeds[0]);
+  const std::vector<std::string> feed_names{"A"};
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches;
+  RunOptions run_options;
+  ASSERT_STATUS_OK(session.Run(run_options, feed_names, feeds, output_names, &fetches));
+  EXPECT_EQ(session_state.GetMemoryPatternCacheStats().hits, 1u);
+}
+
+TEST(InferenceSessionTests, WarmUpRequiresShapesOfDynamicInputs) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.WarmUpRequiresShapesOfDynamicInputs";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigWarmUpInputShapes, "B:1x2"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  auto status = session.Initialize();
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("unknown input B"));
+  EXPECT_FALSE(session.IsInitialized());
+}
+
+TEST(InferenceSessionTests, WarmUpBypassesResultCache) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.WarmUpBypassesResultCache";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigWarmUpInputShapes, "X:3x2"));
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigResultCacheMaxBytes, "48"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  // the zero filled feeds of the warm-up are not cached
+  auto stats = session.GetResultCacheStats();
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.num_entries, 0u);
+}
+
+TEST(InferenceSessionTests, PreparedRun) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.PreparedRun";
+
+  InferenceSession session{so, GetEnvironment()};
+  // X has a fixed shape of [3, 2], Y = X * W with W = [[1, 2], [3, 4], [5, 6]]
+  ASSERT_STATUS_OK(session.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+  std::unique_ptr<PreparedRun> prepared_run;
+  ASSERT_STATUS_OK(session.PrepareRun(feed_names, output_names, prepared_run));
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  std::vector<OrtValue> feeds(1);
+  CreateMLValue<float>(cpu_allocator, {3, 2}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f}, &feeds[0]);
+  RunOptions run_options;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session.RunPrepared(run_options, *prepared_run, feeds, fetches));
+    VerifyOutputs(fetches, {3, 2}, {1.f, 4.f, 9.f, 16.f, 25.f, 36.f});
+  }
+
+  // pre-allocated outputs are written in place
+  std::vector<OrtValue> fetches(1);
+  AllocateMLValue<float>(cpu_allocator, {3, 2}, &fetches[0]);
+  const void* output_buffer = fetches[0].Get<Tensor>().DataRaw();
+  ASSERT_STATUS_OK(session.RunPrepared(run_options, *prepared_run, feeds, fetches));
+  EXPECT_EQ(fetches[0].Get<Tensor>().DataRaw(), output_buffer);
+  VerifyOutputs(fetches, {3, 2}, {1.f, 4.f, 9.f, 16.f, 25.f, 36.f});
+
+  // arena shrinkage is requested as for Run
+  RunOptions shrink_run_options;
+  ASSERT_STATUS_OK(shrink_run_options.config_options.AddConfigEntry(kOrtRunOptionsConfigEnableMemoryArenaShrinkage,
+                                                                    "tpu:0"));
+  fetches.clear();
+  ASSERT_STATUS_NOT_OK_AND_HAS_SUBSTR(session.RunPrepared(shrink_run_options, *prepared_run, feeds, fetches),
+                                      "Unsupported device specified in the memory arena shrink list");
+
+  // feeds are checked against the prepared shapes
+  CreateMLValue<float>(cpu_allocator, {2, 3}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f}, &feeds[0]);
+  fetches.clear();
+  auto status = session.RunPrepared(run_options, *prepared_run, feeds, fetches);
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("does not match the prepared run"));
+}
+
+TEST(InferenceSessionTests, PrepareRunRequiresFixedInputShapes) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.PrepareRunRequiresFixedInputShapes";
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  const std::vector<std::string> feed_names{"A"};
+  const std::vector<std::string> output_names{"Y"};
+  std::unique_ptr<PreparedRun> prepared_run;
+  auto status = session.PrepareRun(feed_names, output_names, prepared_run);
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("fixed shape"));
+}
+
+TEST(InferenceSessionTests, ResultCache) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ResultCache";
+  // room for the feeds and outputs of one request: 2 * 6 floats
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigResultCacheMaxBytes, "48"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const char* const input_names[] = {"X"};
+  const char* const output_names[] = {"Y"};
+  RunOptions run_options;
+  auto run = [&](const std::vector<float>& values, std::unique_ptr<OrtValue>& output) {
+    OrtValue input;
+    CreateMLValue<float>(cpu_allocator, {3, 2}, values, &input);
+    const OrtValue* const inputs[] = {&input};
+    OrtValue* outputs[] = {nullptr};
+    ASSERT_STATUS_OK(session.Run(run_options, input_names, inputs, output_names, outputs));
+    output.reset(outputs[0]);
+  };
+
+  const std::vector<float> values{1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  const std::vector<float> expected{1.f, 4.f, 9.f, 16.f, 25.f, 36.f};
+  std::unique_ptr<OrtValue> first;
+  std::unique_ptr<OrtValue> second;
+  run(values, first);
+  run(values, second);
+  VerifyOutputs(first->Get<Tensor>(), {3, 2}, expected);
+  VerifyOutputs(second->Get<Tensor>(), {3, 2}, expected);
+  // a hit returns a copy of the cached outputs
+  EXPECT_NE(first->Get<Tensor>().DataRaw(), second->Get<Tensor>().DataRaw());
+
+  auto stats = session.GetResultCacheStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.num_entries, 1u);
+
+  // a different request replaces the only entry that fits in the budget
+  std::unique_ptr<OrtValue> third;
+  run({6.f, 5.f, 4.f, 3.f, 2.f, 1.f}, third);
+  VerifyOutputs(third->Get<Tensor>(), {3, 2}, {6.f, 10.f, 12.f, 12.f, 10.f, 6.f});
+  run(values, second);
+  VerifyOutputs(second->Get<Tensor>(), {3, 2}, expected);
+
+  stats = session.GetResultCacheStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.evictions, 2u);
+  EXPECT_EQ(stats.num_bytes, 48u);
+}
+
+TEST(InferenceSessionTests, RunDeadline) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunDeadline";
+
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  std::vector<OrtValue> feeds(1);
+  CreateMLValue<float>(cpu_allocator, {3, 2}, {1.f, 2.f, 3.f, 4.f, 5.f, 6.f}, &feeds[0]);
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+
+  // a run that meets its deadline
+  RunOptions run_options;
+  ASSERT_STATUS_OK(run_options.config_options.AddConfigEntry(kOrtRunOptionsConfigRunDeadlineMillis, "60000"));
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session.Run(run_options, feed_names, feeds, output_names, &fetches));
+  VerifyOutputs(fetches, {3, 2}, {1.f, 4.f, 9.f, 16.f, 25.f, 36.f});
+
+  // an execution whose deadline has passed is aborted before its first step
+  const auto& session_state = session.GetSessionState();
+  FeedsFetchesManager feeds_fetches_manager{
+      FeedsFetchesInfo(feed_names, output_names, session_state.GetOrtValueNameIdxMap())};
+#ifdef ORT_ENABLE_STREAM
+  DeviceStreamCollectionHolder device_stream_collection_holder(&session_state);
+#endif
+  const std::unordered_map<size_t, IExecutor::CustomAllocator> no_fetch_allocators;
+  fetches.clear();
+  auto status = utils::ExecuteGraph(session_state, feeds_fetches_manager, feeds, fetches, no_fetch_allocators,
+                                    ExecutionMode::ORT_SEQUENTIAL, RunOptions(),
+#ifdef ORT_ENABLE_STREAM
+                                    device_stream_collection_holder,
+#endif
+                                    DefaultLoggingManager().DefaultLogger(),
+                                    std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("run deadline being exceeded"));
+
+  RunOptions invalid_run_options;
+  ASSERT_STATUS_OK(invalid_run_options.config_options.AddConfigEntry(kOrtRunOptionsConfigRunDeadlineMillis, "-1"));
+  status = session.Run(invalid_run_options, feed_names, feeds, output_names, &fetches);
+  ASSERT_FALSE(status.IsOK());
+  EXPECT_THAT(status.ErrorMessage(), testing::HasSubstr("must not be negative"));
+}
+
+TEST(InferenceSessionTests, MapInlineInitializers) {
+  // Y = X + W with 64 elements of W stored inline in raw_data
+  onnxruntime::Model model("graph_1", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(64);
+
+  auto& x_arg = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& w_arg = graph.GetOrCreateNodeArg("W", &float_tensor);
+  auto& y_arg = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  graph.AddNode("add", "Add", "add node", {&x_arg, &w_arg}, {&y_arg});
+
+  std::vector<float> w_values(64);
+  std::iota(w_values.begin(), w_values.end(), 0.f);
+  ONNX_NAMESPACE::TensorProto w{};
+  w.set_name("W");
+  w.add_dims(64);
+  w.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  w.set_raw_data(w_values.data(), w_values.size() * sizeof(float));
+  graph.AddInitializedTensor(w);
+
+  ASSERT_STATUS_OK(graph.Resolve());
+  const PathString model_file_name = ORT_TSTR("map_inline_initializers_test.onnx");
+  ASSERT_STATUS_OK(onnxruntime::Model::Save(model, model_file_name));
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.MapInlineInitializers";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigMapInlineInitializers, "1"));
+
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(model_file_name));
+
+  // the initializer refers to its data in the mapped model
+  const ONNX_NAMESPACE::TensorProto* w_proto = nullptr;
+  ASSERT_TRUE(session.GetGraph().GetInitializedTensor("W", w_proto));
+  EXPECT_TRUE(utils::HasExternalData(*w_proto));
+  EXPECT_FALSE(utils::HasRawData(*w_proto));
+
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  std::vector<OrtValue> feeds(1);
+  CreateMLValue<float>(cpu_allocator, {64}, std::vector<float>(64, 1.f), &feeds[0]);
+  const std::vector<std::string> feed_names{"X"};
+  const std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches;
+  RunOptions run_options;
+  ASSERT_STATUS_OK(session.Run(run_options, feed_names, feeds, output_names, &fetches));
+
+  std::vector<float> expected(64);
+  std::iota(expected.begin(), expected.end(), 1.f);
+  VerifyOutputs(fetches, {64}, expected);
+}
+
+TEST(InferenceSessionTests, ActivationMemoryBudget) {
+  // Y = Transpose(Transpose(X)) with X of shape [N, 16], so the only intermediate value takes 64 bytes per row
+  onnxruntime::Model model("graph_1", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto batch_tensor;
+  batch_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  batch_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N");
+  batch_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(16);
+  ONNX_NAMESPACE::TypeProto transposed_tensor;
+  transposed_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  transposed_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(16);
+  transposed_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_param("N");
+
+  auto& x_arg = graph.GetOrCreateNodeArg("X", &batch_tensor);
+  auto& t_arg = graph.GetOrCreateNodeArg("T", &transposed_tensor);
+  auto& y_arg = graph.GetOrCreateNodeArg("Y", &batch_tensor);
+  graph.AddNode("transpose_1", "Transpose", "transpose node 1", {&x_arg}, {&t_arg});
+  graph.AddNode("transpose_2", "Transpose", "transpose node 2", {&t_arg}, {&y_arg});
+  ASSERT_STATUS_OK(graph.Resolve());
+  TemporaryDirectory temp_dir{ORT_TSTR("activation_memory_budget_test_dir")};
+  const PathString model_file_name = ORT_TSTR("activation_memory_budget_test_dir/activation_memory_budget_test.onnx");
+  ASSERT_STATUS_OK(onnxruntime::Model::Save(model, model_file_name));
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ActivationMemoryBudget";
+  // keep the transposes from being removed
+  so.graph_optimization_level = TransformerLevel::Default;
+  // room for the intermediate value of 4 rows
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigActivationMemoryBudgetBytes, "256"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(model_file_name));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  auto cpu_allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  const char* const input_names[] = {"X"};
+  const char* const output_names[] = {"Y"};
+  RunOptions run_options;
+  auto run = [&](int64_t rows) {
+    std::vector<float> values(static_cast<size_t>(rows) * 16);
+    std::iota(values.begin(), values.end(), 0.f);
+    OrtValue input;
+    CreateMLValue<float>(cpu_allocator, {rows, 16}, values, &input);
+    const OrtValue* const inputs[] = {&input};
+    OrtValue* outputs[] = {nullptr};
+    ASSERT_STATUS_OK(session.Run(run_options, input_names, inputs, output_names, outputs));
+    std::unique_ptr<OrtValue> output{outputs[0]};
+    VerifyOutputs(output->Get<Tensor>(), {rows, 16}, values);
+  };
+
+  // nothing is known about the peak, so a single row is run first, then slices of 4 rows
+  run(10);
+  auto stats = session.GetActivationMemoryBudgetStats();
+  EXPECT_EQ(stats.num_split_runs, 1u);
+  EXPECT_EQ(stats.num_slices, 4u);
+  EXPECT_EQ(stats.num_runs, 0u);
+
+  // 4 rows are known to fit from the pattern of the slices, 3 rows are estimated to fit
+  run(4);
+  run(3);
+  stats = session.GetActivationMemoryBudgetStats();
+  EXPECT_EQ(stats.num_split_runs, 1u);
+  EXPECT_EQ(stats.num_runs, 2u);
+
+  // the estimate of 64 bytes per row splits 5 rows into 4 and 1
+  run(5);
+  stats = session.GetActivationMemoryBudgetStats();
+  EXPECT_EQ(stats.num_split_runs, 2u);
+  EXPECT_EQ(stats.num_slices, 6u);
+
+  // the budget also applies to runs with named feeds
+  std::vector<float> values(8 * 16);
+  std::iota(values.begin(), values.end(), 0.f);
+  OrtValue input;
+  CreateMLValue<float>(cpu_allocator, {8, 16}, values, &input);
+  NameMLValMap feeds{{"X", input}};
+  const std::vector<std::string> output_name_vec{"Y"};
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(session.Run(run_options, feeds, output_name_vec, &fetches));
+  VerifyOutputs(fetches[0].Get<Tensor>(), {8, 16}, values);
+  stats = session.GetActivationMemoryBudgetStats();
+  EXPECT_EQ(stats.num_split_runs, 3u);
+  EXPECT_EQ(stats.num_slices, 8u);
+
+  // bound outputs cannot be filled slice by slice
+  std::unique_ptr<IOBinding> io_binding;
+  ASSERT_STATUS_OK(session.NewIOBinding(&io_binding));
+  ASSERT_STATUS_OK(io_binding->BindInput("X", input));
+  ASSERT_STATUS_OK(io_binding->BindOutput("Y", OrtValue()));
+  ASSERT_STATUS_NOT_OK_AND_HAS_SUBSTR(session.Run(run_options, *io_binding), "activation memory budget");
+}
+
+TEST(InferenceSessionTests, ThreadPoolShare) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.ThreadPoolShare";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigThreadPoolShareWeight, "2"));
+
+  InferenceSession session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session.Initialize());
+
+  RunOptions run_options;
+  RunModel(session, run_options);
+  RunModel(session, run_options);
+
+  // the time of the runs is accounted to the session's share
+  const auto stats = session.GetThreadPoolShareStats();
+  EXPECT_GT(stats.cpu_time.count(), 0);
+  EXPECT_EQ(stats.num_limited_loops, 0u);
+
+  SessionOptions invalid_so;
+  ASSERT_STATUS_OK(invalid_so.config_options.AddConfigEntry(kOrtSessionOptionsConfigThreadPoolShareWeight, "-1"));
+  InferenceSession invalid_session{invalid_so, GetEnvironment()};
+  ASSERT_STATUS_OK(invalid_session.Load(MODEL_URI));
+  ASSERT_FALSE(invalid_session.Initialize().IsOK());
+}
+
+TEST(InferenceSessionTests, LoopCostCalibration) {
+  TemporaryDirectory temp_dir{ORT_TSTR("loop_cost_calibration_test_dir")};
+  const std::string file = "loop_cost_calibration_test_dir/loop_costs.txt";
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.LoopCostCalibration";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigWarmUpInputShapes, "A:1x2;A:64x2"));
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigLoopCostCalibration, "1"));
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsConfigLoopCostTableFile, file.c_str()));
+
+  InferenceSessionWrapper session{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(session.Initialize());
+  ASSERT_NE(session.GetLoopCostTable(), nullptr);
+  EXPECT_FALSE(session.GetSessionState().GetCalibrateLoopCosts());
+
+  // a later session uses the calibrated table
+  std::ifstream stream(file);
+  ASSERT_TRUE(stream.good());
+  stream.close();
+
+  SessionOptions load_so;
+  ASSERT_STATUS_OK(load_so.config_options.AddConfigEntry(kOrtSessionOptionsConfigLoopCostTableFile, file.c_str()));
+  InferenceSessionWrapper load_session{load_so, GetEnvironment()};
+  ASSERT_STATUS_OK(load_session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_STATUS_OK(load_session.Initialize());
+  ASSERT_NE(load_session.GetLoopCostTable(), nullptr);
+  EXPECT_EQ(load_session.GetLoopCostTable()->Size(), session.GetLoopCostTable()->Size());
+  EXPECT_EQ(load_session.GetSessionState().GetLoopCostTable(), load_session.GetLoopCostTable());
+
+  // calibration needs the warm-up runs
+  SessionOptions invalid_so;
+  ASSERT_STATUS_OK(invalid_so.config_options.AddConfigEntry(kOrtSessionOptionsConfigLoopCostCalibration, "1"));
+  InferenceSession invalid_session{invalid_so, GetEnvironment()};
+  ASSERT_STATUS_OK(invalid_session.Load(ORT_TSTR("testdata/matmul_with_dynamic_input_shape.onnx")));
+  ASSERT_FALSE(invalid_session.Initialize().IsOK());
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 
 #include "asserts.h"
@@ -10,6 +12,7 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/bfc_arena.h"
 #include "core/framework/session_state.h"
+#include "core/framework/shared_memory_prepacked_weights.h"
 #include "core/graph/graph_utils.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -22,6 +25,13 @@
 #include "test/util/include/default_providers.h"
 #include "core/optimizer/layout_transformation/layout_transformation.h"
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace ONNX_NAMESPACE;
 using namespace std;
 namespace onnxruntime {
@@ -359,6 +369,19 @@ class PrePackingTestOpKernel : public OpKernel {
     return Status::OK();
   }
 
+  Status UseCachedPrePackedBuffers(const Tensor& tensor,
+                                   std::vector<BufferUniquePtr>& prepacked_buffers,
+                                   int input_idx,
+                                   /*out*/ bool& used_cached_buffers) override {
+    ORT_UNUSED_PARAMETER(tensor);
+    ORT_UNUSED_PARAMETER(input_idx);
+
+    weight_packed_ = std::move(prepacked_buffers[0]);
+    used_cached_buffers = true;
+    ++use_cached_pre_packed_weight_calls_count;
+    return Status::OK();
+  }
+
   Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
                  /*out*/ bool& is_packed, /*out*/ PrePackedWeights* prepacked_weights) override {
     ORT_UNUSED_PARAMETER(tensor);
@@ -382,6 +405,7 @@ class PrePackingTestOpKernel : public OpKernel {
 
   int prepack_calls_count = 0;
   int store_pre_packed_weight_calls_count = 0;
+  int use_cached_pre_packed_weight_calls_count = 0;
   IAllocatorUniquePtr<void> weight_packed_;
 };
 
@@ -850,6 +874,214 @@ TEST_F(SessionStateTestSharedInitalizersWithPrePacking, test3) {
   ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(1));
 }
 
+// Pre-packing enabled + shared memory prefix = pre-packed weights shared through shared memory regions
+TEST_F(SessionStateTestSharedInitalizersWithPrePacking, SharedMemoryPrepackedWeights) {
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  // Enable pre-packing
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+  // a prefix per process so that concurrent test runs don't attach to each other's regions
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigSharedPrepackedWeightsPrefix] =
+      "ort_session_state_test_" + std::to_string(Env::Default().GetSelfPid());
+
+  // First session/model
+  Model model_1("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                DefaultLoggingManager().DefaultLogger());
+
+  CreateSimpleGraph(model_1.MainGraph());
+  PlaceAllNodesToCPUEP(model_1.MainGraph());
+  SessionState session_state_1(model_1.MainGraph(),
+                               execution_providers,
+                               tp.get(),
+                               nullptr, /*inter_op_thread_pool*/
+                               dtm,
+                               DefaultLoggingManager().DefaultLogger(),
+                               profiler,
+                               sess_options);
+
+  ASSERT_STATUS_OK(session_state_1.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                        kernel_registry_manager));
+
+  const auto* kernel_1 = reinterpret_cast<const PrePackingTestOpKernel*>(session_state_1.GetKernel(0));
+
+  // Assert that the kernel was handed the weight it packed
+  ASSERT_EQ(session_state_1.GetNumberOfPrepacksCounter(), static_cast<size_t>(1));
+  ASSERT_EQ(kernel_1->prepack_calls_count, 1);
+  ASSERT_EQ(kernel_1->store_pre_packed_weight_calls_count, 1);
+  ASSERT_EQ(session_state_1.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(0));
+
+  // Second session/model
+  Model model_2("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                DefaultLoggingManager().DefaultLogger());
+
+  CreateSimpleGraph(model_2.MainGraph());
+  PlaceAllNodesToCPUEP(model_2.MainGraph());
+  SessionState session_state_2(model_2.MainGraph(),
+                               execution_providers,
+                               tp.get(),
+                               nullptr, /*inter_op_thread_pool*/
+                               dtm,
+                               DefaultLoggingManager().DefaultLogger(),
+                               profiler,
+                               sess_options);
+
+  ASSERT_STATUS_OK(session_state_2.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                        kernel_registry_manager));
+
+  const auto* kernel_2 = reinterpret_cast<const PrePackingTestOpKernel*>(session_state_2.GetKernel(0));
+  ASSERT_EQ(kernel_2->store_pre_packed_weight_calls_count, 1);
+
+#if (defined(__linux__) && !defined(__ANDROID__)) || defined(__APPLE__)
+  // Assert that the second session attached to the region created by the first one
+  ASSERT_EQ(session_state_1.GetSharedMemoryPrepackedWeights()->NumCreatedRegions(), static_cast<size_t>(1));
+  ASSERT_EQ(session_state_2.GetSharedMemoryPrepackedWeights()->NumAttachedRegions(), static_cast<size_t>(1));
+  ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(1));
+#endif
+
+  // the regions are mapped separately, but hold the same weight
+  const float* weight_1 = static_cast<const float*>(kernel_1->weight_packed_.get());
+  const float* weight_2 = static_cast<const float*>(kernel_2->weight_packed_.get());
+  ASSERT_EQ(weight_1[0], 1.2345f);
+  ASSERT_EQ(weight_2[0], 1.2345f);
+  ASSERT_EQ(weight_2[1], weight_2[0] * 2.f);
+
+  session_state_1.GetSharedMemoryPrepackedWeights()->UnlinkCreatedRegions();
+}
+
+#if defined(__linux__) && !defined(__ANDROID__)
+TEST(SharedMemoryPrepackedWeightsTest, RecreatesRegionAbandonedByItsCreator) {
+  const std::string prefix = "ort_abandoned_region_test_" + std::to_string(Env::Default().GetSelfPid());
+  AllocatorPtr cpu_allocator = std::make_shared<CPUAllocator>();
+  auto make_weights = [&]() {
+    PrePackedWeights weights;
+    weights.buffers_.push_back(IAllocator::MakeUniquePtr<void>(cpu_allocator, 16));
+    std::memset(weights.buffers_[0].get(), 7, 16);
+    weights.buffer_sizes_.push_back(16);
+    return weights;
+  };
+
+  SharedMemoryPrepackedWeights creator(prefix, DefaultLoggingManager().DefaultLogger());
+  bool attached = false;
+  creator.Share("Test", make_weights(), attached);
+  ASSERT_EQ(creator.NumCreatedRegions(), static_cast<size_t>(1));
+
+  std::string name;
+  for (const auto& entry : std::filesystem::directory_iterator("/dev/shm")) {
+    if (entry.path().filename().string().rfind(prefix, 0) == 0) {
+      name = "/" + entry.path().filename().string();
+    }
+  }
+  ASSERT_FALSE(name.empty());
+
+  // make the region look like its creator died before it was ready: the ready flag is the first 8 bytes of the
+  // region and the pid of the creator the third 8 bytes
+  const pid_t dead_pid = fork();
+  if (dead_pid == 0) {
+    _exit(0);
+  }
+  ASSERT_GT(dead_pid, 0);
+  ASSERT_EQ(waitpid(dead_pid, nullptr, 0), dead_pid);
+
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  ASSERT_GE(fd, 0);
+  auto* header = static_cast<uint64_t*>(mmap(nullptr, 64, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  close(fd);
+  ASSERT_NE(static_cast<void*>(header), MAP_FAILED);
+  header[0] = 0;
+  header[2] = static_cast<uint64_t>(dead_pid);
+  munmap(header, 64);
+
+  SharedMemoryPrepackedWeights next(prefix, DefaultLoggingManager().DefaultLogger());
+  const auto& weights = next.Share("Test", make_weights(), attached);
+  EXPECT_FALSE(attached);
+  EXPECT_EQ(next.NumCreatedRegions(), static_cast<size_t>(1));
+  EXPECT_EQ(static_cast<const uint8_t*>(weights.buffers_[0].get())[15], 7);
+
+  next.UnlinkCreatedRegions();
+}
+#endif
+
+TEST_F(SessionStateTestSharedInitalizersWithPrePacking, PrepackedWeightsDiskCache) {
+  const auto cache_dir = std::filesystem::temp_directory_path() /
+                         ("ort_prepacked_weights_cache_test_" + std::to_string(Env::Default().GetSelfPid()));
+  std::filesystem::remove_all(cache_dir);
+
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  // Enable pre-packing
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigPrepackedWeightsCacheDir] = cache_dir.string();
+
+  // First session/model
+  Model model_1("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                DefaultLoggingManager().DefaultLogger());
+
+  CreateSimpleGraph(model_1.MainGraph());
+  PlaceAllNodesToCPUEP(model_1.MainGraph());
+  SessionState session_state_1(model_1.MainGraph(),
+                               execution_providers,
+                               tp.get(),
+                               nullptr, /*inter_op_thread_pool*/
+                               dtm,
+                               DefaultLoggingManager().DefaultLogger(),
+                               profiler,
+                               sess_options);
+
+  ASSERT_STATUS_OK(session_state_1.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                        kernel_registry_manager));
+
+  // Assert that the weight was packed and written to the cache
+  const auto* kernel_1 = reinterpret_cast<const PrePackingTestOpKernel*>(session_state_1.GetKernel(0));
+  ASSERT_EQ(session_state_1.GetNumberOfPrepacksCounter(), static_cast<size_t>(1));
+  ASSERT_EQ(kernel_1->prepack_calls_count, 1);
+  ASSERT_EQ(kernel_1->use_cached_pre_packed_weight_calls_count, 0);
+  ASSERT_EQ(session_state_1.GetPrepackedWeightsDiskCache()->NumMisses(), static_cast<size_t>(1));
+  ASSERT_EQ(session_state_1.GetPrepackedWeightsDiskCache()->NumSaved(), static_cast<size_t>(1));
+
+  // Second session/model
+  Model model_2("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+                DefaultLoggingManager().DefaultLogger());
+
+  CreateSimpleGraph(model_2.MainGraph());
+  PlaceAllNodesToCPUEP(model_2.MainGraph());
+  SessionState session_state_2(model_2.MainGraph(),
+                               execution_providers,
+                               tp.get(),
+                               nullptr, /*inter_op_thread_pool*/
+                               dtm,
+                               DefaultLoggingManager().DefaultLogger(),
+                               profiler,
+                               sess_options);
+
+  ASSERT_STATUS_OK(session_state_2.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                        kernel_registry_manager));
+
+  // Assert that the second session loaded the weight from the cache instead of packing it
+  const auto* kernel_2 = reinterpret_cast<const PrePackingTestOpKernel*>(session_state_2.GetKernel(0));
+  ASSERT_EQ(session_state_2.GetNumberOfPrepacksCounter(), static_cast<size_t>(1));
+  ASSERT_EQ(kernel_2->prepack_calls_count, 0);
+  ASSERT_EQ(kernel_2->use_cached_pre_packed_weight_calls_count, 1);
+  ASSERT_EQ(session_state_2.GetPrepackedWeightsDiskCache()->NumHits(), static_cast<size_t>(1));
+  ASSERT_EQ(session_state_2.GetPrepackedWeightsDiskCache()->NumSaved(), static_cast<size_t>(0));
+
+  const float* weight_2 = static_cast<const float*>(kernel_2->weight_packed_.get());
+  ASSERT_EQ(weight_2[0], 1.2345f);
+  ASSERT_EQ(weight_2[1], weight_2[0] * 2.f);
+
+  std::error_code error;
+  std::filesystem::remove_all(cache_dir, error);
+}
+
 INSTANTIATE_TEST_SUITE_P(SessionStateTests,
                          SessionStatePrepackingTest,
                          testing::Values(PrepackingTestParam{false, false},
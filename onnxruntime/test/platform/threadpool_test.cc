@@ -12,8 +12,13 @@
 
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <functional>
+#include <optional>
+#include <sstream>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -229,6 +234,149 @@ void TestStagedMultiLoopSections(const std::string& name, int num_threads, int n
   }
 }
 
+void TestRunPriority(const std::string& name, int dynamic_block_base) {
+  // While a high priority run is in progress, a low priority loop runs all its iterations in the calling
+  // thread, and a normal priority loop still runs every iteration exactly once.
+  CreateThreadPoolAndTest(
+      name, 4, [&](ThreadPool* tp) {
+        constexpr int num_tasks = 1024;
+        ThreadPool::BeginHighPriorityRun(tp);
+        {
+          ThreadPool::ScopedRunPriority scoped_priority(tp, ThreadPool::RunPriority::kLow);
+          EXPECT_EQ(ThreadPool::CurrentRunPriority(), ThreadPool::RunPriority::kLow);
+          auto test_data = CreateTestData(num_tasks);
+          const auto caller_id = std::this_thread::get_id();
+          std::atomic<bool> ran_on_other_thread{false};
+          ThreadPool::TryParallelFor(tp, num_tasks, 1000.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            if (std::this_thread::get_id() != caller_id) {
+              ran_on_other_thread = true;
+            }
+            for (std::ptrdiff_t i = first; i < last; ++i) {
+              IncrementElement(*test_data, i);
+            }
+          });
+          ValidateTestData(*test_data);
+          EXPECT_FALSE(ran_on_other_thread);
+        }
+        EXPECT_EQ(ThreadPool::CurrentRunPriority(), ThreadPool::RunPriority::kNormal);
+
+        auto test_data = CreateTestData(num_tasks);
+        ThreadPool::TryParallelFor(tp, num_tasks, 1000.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            IncrementElement(*test_data, i);
+          }
+        });
+        ValidateTestData(*test_data);
+        ThreadPool::EndHighPriorityRun(tp);
+      },
+      dynamic_block_base);
+}
+
+void TestThreadPoolShare(const std::string& name, int dynamic_block_base) {
+  // While runs of another share are in progress, a loop of a share with a quarter of the total weight uses at most
+  // 2 of the 5 threads of the pool, and still runs every iteration exactly once.
+  CreateThreadPoolAndTest(
+      name, 5, [&](ThreadPool* tp) {
+        constexpr int num_tasks = 1024;
+        ThreadPool::Share share(tp, 1);
+        ThreadPool::Share other_share(tp, 3);
+        auto run_loop = [&]() {
+          auto test_data = CreateTestData(num_tasks);
+          onnxruntime::OrtMutex mutex;
+          std::vector<std::thread::id> thread_ids;
+          ThreadPool::TryParallelFor(tp, num_tasks, 1000.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            {
+              std::lock_guard<onnxruntime::OrtMutex> lock(mutex);
+              if (std::find(thread_ids.begin(), thread_ids.end(), std::this_thread::get_id()) == thread_ids.end()) {
+                thread_ids.push_back(std::this_thread::get_id());
+              }
+            }
+            for (std::ptrdiff_t i = first; i < last; ++i) {
+              IncrementElement(*test_data, i);
+            }
+          });
+          ValidateTestData(*test_data);
+          return thread_ids.size();
+        };
+
+        {
+          ThreadPool::ScopedShare scoped_share(&share);
+          run_loop();
+        }
+        EXPECT_EQ(share.GetStats().num_loops, 1u);
+        EXPECT_EQ(share.GetStats().num_limited_loops, 0u);
+
+        std::atomic<bool> other_run_started{false};
+        std::atomic<bool> other_run_done{false};
+        std::thread other_run([&]() {
+          ThreadPool::ScopedShare scoped_share(&other_share);
+          other_run_started = true;
+          while (!other_run_done) {
+            std::this_thread::yield();
+          }
+        });
+        while (!other_run_started) {
+          std::this_thread::yield();
+        }
+
+        {
+          ThreadPool::ScopedShare scoped_share(&share);
+          EXPECT_LE(run_loop(), 2u);
+        }
+        other_run_done = true;
+        other_run.join();
+
+        const auto stats = share.GetStats();
+        EXPECT_EQ(stats.num_loops, 2u);
+        EXPECT_EQ(stats.num_limited_loops, 1u);
+        EXPECT_GT(stats.cpu_time.count(), 0);
+        EXPECT_EQ(other_share.GetStats().num_loops, 0u);
+        EXPECT_GT(other_share.GetStats().cpu_time.count(), 0);
+
+        // loops outside of a share are not limited or accounted
+        EXPECT_GE(run_loop(), 1u);
+        EXPECT_EQ(share.GetStats().num_loops, 2u);
+      },
+      dynamic_block_base);
+}
+
+// Test parallel loops nested in parallel loops, optionally inside a
+// parallel section.  Every inner iteration must run exactly once.
+void TestNestedParallelFor(const std::string& name, int num_threads, bool use_parallel_section) {
+  constexpr int num_reps = 10;
+  constexpr int num_outer = 3;
+  constexpr int num_inner = 64;
+  auto test_data = CreateTestData(num_outer * num_inner);
+  CreateThreadPoolAndTest(name, num_threads, [&](ThreadPool* tp) {
+    ThreadPool::StartProfiling(tp);
+    {
+      std::optional<ThreadPool::ParallelSection> ps;
+      if (use_parallel_section) {
+        ps.emplace(tp);
+      }
+      for (int rep = 0; rep < num_reps; rep++) {
+        ThreadPool::TrySimpleParallelFor(tp, num_outer, [&](std::ptrdiff_t outer) {
+          ThreadPool::TryParallelFor(tp, num_inner, 10000.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+            for (std::ptrdiff_t i = first; i < last; ++i) {
+              IncrementElement(*test_data, outer * num_inner + i);
+            }
+          });
+        });
+      }
+    }
+#if !defined(ORT_MINIMAL_BUILD)
+    const std::string profile = ThreadPool::StopProfiling(tp);
+    if (tp) {
+      EXPECT_NE(profile.find("\"num_steal\""), std::string::npos);
+      EXPECT_NE(profile.find("\"idle_us\""), std::string::npos);
+    }
+#else
+    ThreadPool::StopProfiling(tp);
+#endif
+  });
+  ValidateTestData(*test_data, num_reps);
+}
+
 }  // namespace
 
 namespace onnxruntime {
@@ -510,6 +658,155 @@ TEST(ThreadPoolTest, TestStagedMultiLoopSections_4Thread_100Loop) {
   TestStagedMultiLoopSections("TestStagedMultiLoopSections_4Thread_100Loop", 4, 100);
 }
 
+TEST(ThreadPoolTest, TestNestedParallelFor_0Thread) {
+  TestNestedParallelFor("TestNestedParallelFor_0Thread", 0, false);
+}
+
+TEST(ThreadPoolTest, TestNestedParallelFor_4Thread) {
+  TestNestedParallelFor("TestNestedParallelFor_4Thread", 4, false);
+}
+
+TEST(ThreadPoolTest, TestNestedParallelFor_8Thread) {
+  TestNestedParallelFor("TestNestedParallelFor_8Thread", 8, false);
+}
+
+TEST(ThreadPoolTest, TestNestedParallelForInParallelSection_4Thread) {
+  TestNestedParallelFor("TestNestedParallelForInParallelSection_4Thread", 4, true);
+}
+
+TEST(ThreadPoolTest, TestRunPriority) {
+  TestRunPriority("TestRunPriority", 0);
+}
+
+TEST(ThreadPoolTest, TestRunPriority_dynamic_block_base_4) {
+  TestRunPriority("TestRunPriority_dynamic_block_base_4", 4);
+}
+
+TEST(ThreadPoolTest, TestThreadPoolShare) {
+  TestThreadPoolShare("TestThreadPoolShare", 0);
+}
+
+TEST(ThreadPoolTest, TestThreadPoolShare_dynamic_block_base_4) {
+  TestThreadPoolShare("TestThreadPoolShare_dynamic_block_base_4", 4);
+}
+
+TEST(ThreadPoolTest, TestAdaptiveSpinning) {
+  // Gaps of 10ms between loops are longer than the threads may spin for, so after the first gap the threads block
+  // right away instead of spinning.
+  constexpr int num_threads = 4;
+  constexpr int num_loops = 20;
+  onnxruntime::ThreadOptions thread_options;
+  thread_options.adaptive_spinning = true;
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), thread_options, nullptr, num_threads, true);
+  for (int loop = 0; loop < num_loops; ++loop) {
+    auto test_data = CreateTestData(num_threads);
+    ThreadPool::TrySimpleParallelFor(tp.get(), num_threads, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); });
+    ValidateTestData(*test_data);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  const auto stats = ThreadPool::GetSpinStats(tp.get());
+  EXPECT_GT(stats.num_blocks, 0u);
+  EXPECT_LE(stats.num_wake_ups, stats.num_blocks);
+  // each thread spins for at most ~8ms once, rather than after every loop
+  EXPECT_LT(stats.spin_time, std::chrono::milliseconds(num_threads * num_loops * 8 / 2));
+  EXPECT_EQ(ThreadPool::GetSpinStats(nullptr).num_blocks, 0u);
+}
+
+TEST(ThreadPoolTest, TestLoopCostTable) {
+  // The estimated cost of 1 cycle per iteration runs the loop in one block. The measured cost of an iteration that
+  // sleeps for 20us makes it run in parallel.
+  constexpr int num_tasks = 64;
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), onnxruntime::ThreadOptions(), nullptr, 4, true);
+  auto run_loop = [&]() {
+    auto test_data = CreateTestData(num_tasks);
+    std::atomic<int> num_blocks{0};
+    ThreadPool::TryParallelFor(tp.get(), num_tasks, 1.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+      ++num_blocks;
+      for (std::ptrdiff_t i = first; i < last; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+        IncrementElement(*test_data, i);
+      }
+    });
+    ValidateTestData(*test_data);
+    return num_blocks.load();
+  };
+
+  ThreadPool::LoopCostTable table;
+  {
+    ThreadPool::ScopedLoopCost scoped_loop_cost(&table, "kernel", /*calibrate*/ true);
+    EXPECT_EQ(run_loop(), 1);
+    // loops are keyed by their order in the scope
+    EXPECT_EQ(run_loop(), 1);
+  }
+  ASSERT_EQ(table.Size(), 2u);
+  double ns_per_iteration = 0;
+  ASSERT_TRUE(table.TryGetCost("kernel#0", ns_per_iteration));
+  EXPECT_GE(ns_per_iteration, 20000.0);
+  EXPECT_FALSE(table.TryGetCost("kernel#2", ns_per_iteration));
+
+  // the loops only use the costs once the table is frozen
+  table.Freeze();
+  {
+    ThreadPool::ScopedLoopCost scoped_loop_cost(&table, "kernel", /*calibrate*/ false);
+    EXPECT_GT(run_loop(), 1);
+  }
+  {
+    ThreadPool::ScopedLoopCost scoped_loop_cost(&table, "other_kernel", /*calibrate*/ false);
+    EXPECT_EQ(run_loop(), 1);
+  }
+  EXPECT_EQ(run_loop(), 1);
+  EXPECT_EQ(table.Size(), 2u);
+}
+
+TEST(ThreadPoolTest, TestLoopCostTableFrozenCosts) {
+  ThreadPool::LoopCostTable table(/*cycles_per_ns*/ 2.5);
+  table.Record("Add:float:4#0", std::chrono::nanoseconds(1000), 10);
+
+  // costs are looked up by the hash of the key, which can be built in pieces
+  using LoopCostTable = ThreadPool::LoopCostTable;
+  const uint64_t key_hash = LoopCostTable::HashKey(
+      0, LoopCostTable::HashKey("#", LoopCostTable::HashKey(4, LoopCostTable::HashKey("Add:float:"))));
+  EXPECT_EQ(key_hash, LoopCostTable::HashKey("Add:float:4#0"));
+  EXPECT_EQ(LoopCostTable::HashKey(1234567, LoopCostTable::kEmptyKeyHash), LoopCostTable::HashKey("1234567"));
+
+  double cycles_per_iteration = 0;
+  EXPECT_FALSE(table.TryGetFrozenCost(key_hash, cycles_per_iteration));
+  table.Freeze();
+  ASSERT_TRUE(table.TryGetFrozenCost(key_hash, cycles_per_iteration));
+  // 100ns per iteration at 2.5 cycles per ns
+  EXPECT_DOUBLE_EQ(cycles_per_iteration, 250.0);
+  EXPECT_FALSE(table.TryGetFrozenCost(LoopCostTable::HashKey("Add:float:4#1"), cycles_per_iteration));
+}
+
+TEST(ThreadPoolTest, TestLoopCostTableSaveLoad) {
+  ThreadPool::LoopCostTable table;
+  table.Record("a#0", std::chrono::nanoseconds(1000), 10);
+  table.Record("a#0", std::chrono::nanoseconds(3000), 10);
+  table.Record("b#1", std::chrono::nanoseconds(7), 2);
+
+  std::stringstream stream;
+  ASSERT_TRUE(table.Save(stream).IsOK());
+
+  ThreadPool::LoopCostTable loaded;
+  ASSERT_TRUE(loaded.Load(stream).IsOK());
+  ASSERT_EQ(loaded.Size(), 2u);
+  double ns_per_iteration = 0;
+  ASSERT_TRUE(loaded.TryGetCost("a#0", ns_per_iteration));
+  EXPECT_DOUBLE_EQ(ns_per_iteration, 200.0);
+  ASSERT_TRUE(loaded.TryGetCost("b#1", ns_per_iteration));
+  EXPECT_DOUBLE_EQ(ns_per_iteration, 3.5);
+
+  // loaded loops are added to the measurements of the table, weighted by their iterations
+  std::stringstream more("a#0\t500\t20\n");
+  ASSERT_TRUE(loaded.Load(more).IsOK());
+  ASSERT_TRUE(loaded.TryGetCost("a#0", ns_per_iteration));
+  EXPECT_DOUBLE_EQ(ns_per_iteration, 350.0);
+
+  std::stringstream invalid("a#0\t500\n");
+  EXPECT_FALSE(loaded.Load(invalid).IsOK());
+}
+
 #ifdef _WIN32
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
 #pragma warning(push)
@@ -613,6 +910,189 @@ TEST(ThreadPoolTest, TestAffinityStringWellShaped) {
   }
 }
 
+TEST(ThreadPoolTest, TestNumaNode) {
+  const auto numa_nodes = Env::Default().GetNumaNodes();
+  if (numa_nodes.empty() || numa_nodes[0].empty()) {
+    return;
+  }
+
+  OrtThreadPoolParams tp_params;
+  tp_params.thread_pool_size = 2;
+  tp_params.numa_node = 0;
+  auto tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tp_params,
+                                          concurrency::ThreadPoolType::INTRA_OP);
+  ASSERT_NE(tp, nullptr);
+  std::atomic<int> num_iterations{0};
+  concurrency::ThreadPool::TrySimpleParallelFor(tp.get(), 16, [&](std::ptrdiff_t) { ++num_iterations; });
+  ASSERT_EQ(num_iterations, 16);
+
+#ifndef ORT_NO_EXCEPTIONS
+  tp_params.numa_node = static_cast<int>(numa_nodes.size());
+  ASSERT_THROW(concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tp_params,
+                                             concurrency::ThreadPoolType::INTRA_OP),
+               std::exception);
+
+  tp_params.numa_node = 0;
+  tp_params.affinity_str = "1";
+  ASSERT_THROW(concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tp_params,
+                                             concurrency::ThreadPoolType::INTRA_OP),
+               std::exception);
+#endif
+}
+
+// Env of the platform, reporting the given processor capacities, and recording the affinities of the threads it
+// creates.
+class ProcessorCapacitiesEnv : public Env {
+ public:
+  explicit ProcessorCapacitiesEnv(std::vector<int> capacities) : capacities_(std::move(capacities)) {}
+
+  std::vector<int> GetProcessorCapacities() const override { return capacities_; }
+
+  const std::vector<LogicalProcessors>& GetThreadAffinities() const { return thread_affinities_; }
+
+  EnvThread* CreateThread(_In_opt_z_ const ORTCHAR_T* name_prefix, int index,
+                          _In_ unsigned (*start_address)(int id, Eigen::ThreadPoolInterface* param),
+                          Eigen::ThreadPoolInterface* threadpool, const ThreadOptions& thread_options) override {
+    if (static_cast<size_t>(index) < thread_options.affinities.size()) {
+      thread_affinities_.push_back(thread_options.affinities[index]);
+    }
+    return default_env_.CreateThread(name_prefix, index, start_address, threadpool, thread_options);
+  }
+
+  int GetNumPhysicalCpuCores() const override { return default_env_.GetNumPhysicalCpuCores(); }
+  std::vector<LogicalProcessors> GetDefaultThreadAffinities() const override {
+    return default_env_.GetDefaultThreadAffinities();
+  }
+  void SleepForMicroseconds(int64_t micros) const override { default_env_.SleepForMicroseconds(micros); }
+  common::Status GetFileLength(_In_z_ const ORTCHAR_T* file_path, size_t& length) const override {
+    return default_env_.GetFileLength(file_path, length);
+  }
+  common::Status GetFileLength(int fd, size_t& file_size) const override {
+    return default_env_.GetFileLength(fd, file_size);
+  }
+  common::Status ReadFileIntoBuffer(_In_z_ const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
+                                    gsl::span<char> buffer) const override {
+    return default_env_.ReadFileIntoBuffer(file_path, offset, length, buffer);
+  }
+  common::Status MapFileIntoMemory(_In_z_ const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    return default_env_.MapFileIntoMemory(file_path, offset, length, mapped_memory);
+  }
+#ifdef _WIN32
+  bool FolderExists(const std::wstring& path) const override { return default_env_.FolderExists(path); }
+  common::Status CreateFolder(const std::wstring& path) const override { return default_env_.CreateFolder(path); }
+  common::Status FileOpenRd(const std::wstring& path, int& fd) const override {
+    return default_env_.FileOpenRd(path, fd);
+  }
+  common::Status FileOpenWr(const std::wstring& path, int& fd) const override {
+    return default_env_.FileOpenWr(path, fd);
+  }
+#endif
+  bool FolderExists(const std::string& path) const override { return default_env_.FolderExists(path); }
+  common::Status CreateFolder(const std::string& path) const override { return default_env_.CreateFolder(path); }
+  common::Status DeleteFolder(const PathString& path) const override { return default_env_.DeleteFolder(path); }
+  common::Status FileOpenRd(const std::string& path, int& fd) const override {
+    return default_env_.FileOpenRd(path, fd);
+  }
+  common::Status FileOpenWr(const std::string& path, int& fd) const override {
+    return default_env_.FileOpenWr(path, fd);
+  }
+  common::Status FileClose(int fd) const override { return default_env_.FileClose(fd); }
+  common::Status GetCanonicalPath(const PathString& path, PathString& canonical_path) const override {
+    return default_env_.GetCanonicalPath(path, canonical_path);
+  }
+  PIDType GetSelfPid() const override { return default_env_.GetSelfPid(); }
+  common::Status LoadDynamicLibrary(const PathString& library_filename, bool global_symbols,
+                                    void** handle) const override {
+    return default_env_.LoadDynamicLibrary(library_filename, global_symbols, handle);
+  }
+  common::Status UnloadDynamicLibrary(void* handle) const override {
+    return default_env_.UnloadDynamicLibrary(handle);
+  }
+  common::Status GetSymbolFromLibrary(void* handle, const std::string& symbol_name, void** symbol) const override {
+    return default_env_.GetSymbolFromLibrary(handle, symbol_name, symbol);
+  }
+  std::string FormatLibraryFileName(const std::string& name, const std::string& version) const override {
+    return default_env_.FormatLibraryFileName(name, version);
+  }
+  const Telemetry& GetTelemetryProvider() const override { return default_env_.GetTelemetryProvider(); }
+  std::string GetEnvironmentVar(const std::string& var_name) const override {
+    return default_env_.GetEnvironmentVar(var_name);
+  }
+
+ private:
+  Env& default_env_ = Env::Default();
+  const std::vector<int> capacities_;
+  std::vector<LogicalProcessors> thread_affinities_;
+};
+
+TEST(ThreadPoolTest, TestCoreClass) {
+  // on CPUs whose cores are alike the threads are not pinned
+  constexpr int num_tasks = 1000;
+  for (auto core_class : {OrtCoreClass::kPerformance, OrtCoreClass::kEfficiency}) {
+    OrtThreadPoolParams tp_params;
+    tp_params.thread_pool_size = 3;
+    tp_params.core_class = core_class;
+    auto tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tp_params,
+                                            concurrency::ThreadPoolType::INTRA_OP);
+    ASSERT_NE(tp, nullptr);
+    auto test_data = CreateTestData(num_tasks);
+    concurrency::ThreadPool::TryBatchParallelFor(
+        tp.get(), num_tasks, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); }, 0);
+    ValidateTestData(*test_data);
+  }
+
+#ifndef ORT_NO_EXCEPTIONS
+  OrtThreadPoolParams tp_params;
+  tp_params.thread_pool_size = 2;
+  tp_params.core_class = OrtCoreClass::kEfficiency;
+  tp_params.affinity_str = "1";
+  ASSERT_THROW(concurrency::CreateThreadPool(&onnxruntime::Env::Default(), tp_params,
+                                             concurrency::ThreadPoolType::INTRA_OP),
+               std::exception);
+#endif
+}
+
+TEST(ThreadPoolTest, TestCoreClassHybrid) {
+  // a hybrid CPU: the first half of the processors are performance cores, the others efficiency cores that are
+  // half as fast
+  const int num_processors = std::max(static_cast<int>(std::thread::hardware_concurrency()), 2);
+  std::vector<int> capacities(static_cast<size_t>(num_processors), kMaxProcessorCapacity / 2);
+  std::fill_n(capacities.begin(), (num_processors + 1) / 2, kMaxProcessorCapacity);
+
+  for (auto core_class : {OrtCoreClass::kAll, OrtCoreClass::kPerformance, OrtCoreClass::kEfficiency}) {
+    ProcessorCapacitiesEnv env(capacities);
+    OrtThreadPoolParams tp_params;
+    tp_params.thread_pool_size = 3;
+    tp_params.core_class = core_class;
+    auto tp = concurrency::CreateThreadPool(&env, tp_params, concurrency::ThreadPoolType::INTRA_OP);
+    ASSERT_NE(tp, nullptr);
+
+    // the threads of a pool of all the cores take chunks of the iterations by the capacity of their cores. there
+    // are fewer iterations than chunks in the small loops.
+    for (int num_tasks : {1, 5, 1000}) {
+      auto test_data = CreateTestData(num_tasks);
+      concurrency::ThreadPool::TryBatchParallelFor(
+          tp.get(), num_tasks, [&](std::ptrdiff_t i) { IncrementElement(*test_data, i); }, 0);
+      ValidateTestData(*test_data);
+    }
+
+    if (core_class == OrtCoreClass::kAll) {
+      EXPECT_TRUE(env.GetThreadAffinities().empty());
+      continue;
+    }
+
+    // the threads are pinned to the cores of the class
+    ASSERT_EQ(env.GetThreadAffinities().size(), 2u);
+    for (const auto& affinity : env.GetThreadAffinities()) {
+      ASSERT_FALSE(affinity.empty());
+      for (int processor : affinity) {
+        EXPECT_EQ(IsEfficiencyProcessorCapacity(capacities[processor]), core_class == OrtCoreClass::kEfficiency);
+      }
+    }
+  }
+}
+
 #ifdef _WIN32
 TEST(ThreadPoolTest, TestDefaultAffinity) {
   test::CpuGroup cpu_group = {{0, 1},
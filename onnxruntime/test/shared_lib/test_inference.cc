@@ -2629,6 +2629,78 @@ TEST(CApiTest, TestSharingOfInitializerAndItsPrepackedVersion) {
                     nullptr);
 }
 
+TEST(CApiTest, TestSessionPool) {
+  Ort::MemoryInfo mem_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+  float x_data[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  constexpr size_t x_data_len = sizeof(x_data) / sizeof(x_data[0]);
+  const int64_t x_shape[] = {3, 2};
+  constexpr size_t x_shape_len = sizeof(x_shape) / sizeof(x_shape[0]);
+  Ort::Value x = Ort::Value::CreateTensor<float>(mem_info, x_data, x_data_len, x_shape, x_shape_len);
+
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"Y"};
+  // W in the model is {1, 2}
+  const std::vector<float> expected_values_y = {5.0f, 11.0f, 17.0f};
+
+  Ort::SessionOptions session_options;
+  Ort::SessionPool pool(*ort_env, MATMUL_MODEL_URI, session_options, 2);
+
+  Ort::UnownedSession session1 = pool.TryAcquireSession();
+  Ort::UnownedSession session2 = pool.TryAcquireSession();
+  ASSERT_NE(static_cast<OrtSession*>(session1), nullptr);
+  ASSERT_NE(static_cast<OrtSession*>(session2), nullptr);
+  ASSERT_NE(static_cast<OrtSession*>(session1), static_cast<OrtSession*>(session2));
+
+  // every session is in use
+  ASSERT_EQ(static_cast<OrtSession*>(pool.TryAcquireSession()), nullptr);
+
+  for (auto* session : {&session1, &session2}) {
+    auto outputs = session->Run(Ort::RunOptions{nullptr}, input_names, &x, 1, output_names, 1);
+    ASSERT_EQ(outputs.size(), 1u);
+    const float* y = outputs[0].GetTensorData<float>();
+    ASSERT_EQ(std::vector<float>(y, y + expected_values_y.size()), expected_values_y);
+  }
+
+  pool.ReturnSession(session2);
+  Ort::UnownedSession session3 = pool.TryAcquireSession();
+  ASSERT_EQ(static_cast<OrtSession*>(session3), static_cast<OrtSession*>(session2));
+
+  pool.ReturnSession(session1);
+  pool.ReturnSession(session3);
+
+  // a session cannot be given back twice
+  ASSERT_THROW(pool.ReturnSession(session3), Ort::Exception);
+
+  // both sessions are idle exactly once
+  Ort::UnownedSession session4 = pool.TryAcquireSession();
+  Ort::UnownedSession session5 = pool.TryAcquireSession();
+  ASSERT_NE(static_cast<OrtSession*>(session4), static_cast<OrtSession*>(session5));
+  ASSERT_EQ(static_cast<OrtSession*>(pool.TryAcquireSession()), nullptr);
+  pool.ReturnSession(session4);
+  pool.ReturnSession(session5);
+}
+
+TEST(CApiTest, TestSessionPoolReleasedWhileInUse) {
+  Ort::MemoryInfo mem_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+  float x_data[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  const int64_t x_shape[] = {3, 2};
+  Ort::Value x = Ort::Value::CreateTensor<float>(mem_info, x_data, 6, x_shape, 2);
+  const char* input_names[] = {"X"};
+  const char* output_names[] = {"Y"};
+
+  Ort::SessionOptions session_options;
+  Ort::SessionPool pool(*ort_env, MATMUL_MODEL_URI, session_options, 2);
+  Ort::UnownedSession session = pool.TryAcquireSession();
+  ASSERT_NE(static_cast<OrtSession*>(session), nullptr);
+
+  // the session stays valid until it is given back, which frees the pool
+  OrtSessionPool* released_pool = pool.release();
+  Ort::GetApi().ReleaseSessionPool(released_pool);
+  auto outputs = session.Run(Ort::RunOptions{nullptr}, input_names, &x, 1, output_names, 1);
+  ASSERT_EQ(outputs.size(), 1u);
+  Ort::ThrowOnError(Ort::GetApi().SessionPoolReturnSession(released_pool, session));
+}
+
 #ifndef ORT_NO_RTTI
 TEST(CApiTest, TestIncorrectInputTypeToModel_Tensors) {
   // simple inference test